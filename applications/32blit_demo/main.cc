@@ -11,8 +11,10 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <array>
 #include <chrono>
 #include <cstdint>
+#include <string_view>
 
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
@@ -20,6 +22,7 @@
 #include "graphics/surface.hpp"
 #include "libkudzu/framecounter.h"
 #include "libkudzu/random.h"
+#include "libkudzu/text_layout.h"
 #include "pw_assert/assert.h"
 #include "pw_assert/check.h"
 #include "pw_color/color.h"
@@ -56,7 +59,7 @@ void rain_generate(test_particle& p, blit::Surface screen) {
 };
 
 void rain(blit::Surface screen,
-          pw::chrono::SystemClock::duration elapsed_time,
+          std::chrono::microseconds elapsed_time,
           blit::Rect floor_position) {
   static test_particle s[300];
   static int generate_index = 0;
@@ -109,7 +112,7 @@ void rain(blit::Surface screen,
 
 void MainTask(void*) {
   // Timing variables
-  kudzu::FrameCounter frame_counter = kudzu::FrameCounter();
+  static kudzu::FrameCounter frame_counter(Common::GetTimingClock());
 
   PW_CHECK_OK(Common::Init());
 
@@ -126,12 +129,26 @@ void MainTask(void*) {
 
   display.ReleaseFramebuffer(std::move(framebuffer));
 
+  // The title never changes, so lay it out once up front.
+  const kudzu::TextLayout title(screen, "Pigweed + 32blit", blit::minimal_font);
+  auto text_size = title.size();
+  const blit::Rect text_rect(
+      blit::Point((screen.bounds.w / 2) - (text_size.w / 2),
+                  (screen.bounds.h * .75) - (text_size.h / 2)),
+      text_size);
+
+  // Strings which change every frame, such as the frame rate, are formatted
+  // here instead of on the stack.
+  static std::array<char, 64> text_arena_buffer;
+  kudzu::TextArena text_arena(text_arena_buffer);
+
   // The display loop.
   while (1) {
     frame_counter.StartFrame();
 
     framebuffer = display.GetFramebuffer();
     PW_ASSERT(framebuffer.is_valid());
+    frame_counter.EndAcquire();
     screen.data = (uint8_t*)framebuffer.data();
 
     // Draw Phase
@@ -140,17 +157,14 @@ void MainTask(void*) {
     screen.clear();
 
     // Draw 32blit animation
-    std::string text = "Pigweed + 32blit";
-    auto text_size = screen.measure_text(text, blit::minimal_font, true);
-    blit::Rect text_rect(
-        blit::Point((screen.bounds.w / 2) - (text_size.w / 2),
-                    (screen.bounds.h * .75) - (text_size.h / 2)),
-        text_size);
-
     rain(screen, frame_counter.LastFrameDuration(), text_rect);
     screen.pen = blit::Pen(0xFF, 0xFF, 0xFF);
-    screen.text(
-        text, blit::minimal_font, text_rect, true, blit::TextAlign::top_left);
+    title.Draw(screen, blit::Point(text_rect.x, text_rect.y));
+
+    text_arena.Reset();
+    const std::string_view fps =
+        text_arena.Format("FPS: %d", frame_counter.FramesPerSecond());
+    screen.text(fps, blit::minimal_font, blit::Point(2, 2));
 
     // Update timers
     frame_counter.EndDraw();
@@ -15,6 +15,10 @@
 
 #include "kudzu_buttons/buttons.h"
 #include "kudzu_imu/imu.h"
+#include "libkudzu/text_mode.h"
+#include "libkudzu/timing_scope.h"
+#include "libkudzu/touch_calibration.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_display/display.h"
 #include "pw_status/status.h"
 #include "pw_thread/thread.h"
@@ -30,19 +34,50 @@ class Common {
   // any other methods in this class.
   static pw::Status Init();
 
+  // Initialize application common objects for an application which only draws
+  // text with GetTextModeDisplay(). The framebuffers used by GetDisplay() are
+  // not set up, and are left out of the binary if GetDisplay() isn't used, so
+  // GetDisplay() must not be called after this.
+  static pw::Status InitTextMode();
+
+  // Returns UNAVAILABLE if a peripheral stopped answering. This only reads
+  // cached state, so it's cheap enough to call every frame.
   static pw::Status EndOfFrameCallback();
 
   // Return an initialized display.
   static pw::display::Display& GetDisplay();
 
+  // Return a text mode display covering the whole screen, which writes
+  // changed characters straight to the panel without a framebuffer.
+  static kudzu::TextModeDisplay& GetTextModeDisplay();
+
   // Return an initialized display.
   static kudzu::imu::PollingImu& GetImu();
 
+  // Return the same IMU for reading in batches. It is initialized by Init(),
+  // which on the badge switches it to FIFO mode.
+  static kudzu::imu::BatchImu& GetBatchImu();
+
   // Return an initialized touchscreen.
   static pw::touchscreen::Touchscreen& GetTouchscreen();
 
+  // Applies `calibration` to the touchscreen and saves it, so it's used from
+  // then on, across resets. Fit one to the raw points of GetContacts() with
+  // kudzu::TouchCalibrator. Returns UNIMPLEMENTED where touches need no
+  // calibration.
+  static pw::Status SaveTouchCalibration(
+      const kudzu::TouchCalibration& calibration);
+
   static kudzu::Buttons& GetButtons();
 
+  // Return a clock for timing sections of a frame with kudzu::TimingScope.
+  static const kudzu::TimingClock& GetTimingClock();
+
+  // Returns the shortest frame the board's power budget allows right now, or
+  // zero if frames can run flat out. Apps should sleep out the rest of any
+  // frame which finishes sooner.
+  static pw::chrono::SystemClock::duration MinFramePeriod();
+
   // Provides thread options for the display thread.
   static const pw::thread::Options& DisplayDrawThreadOptions();
 
@@ -11,13 +11,32 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "app_common/common.h"
 #include "kudzu_buttons_imgui/buttons.h"
+#include "kudzu_imu/polled_batch_imu.h"
 #include "kudzu_imu_imgui/imu.h"
+#include "kudzu_imu_trace/trace.h"
+#include "kudzu_imu_trace/trace_imu.h"
+#include "libkudzu/text_mode.h"
+#include "libkudzu/timing_scope.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_color/color.h"
 #include "pw_display_driver_imgui/display_driver.h"
 #include "pw_display_imgui/display.h"
+#include "pw_draw/font6x8.h"
 #include "pw_framebuffer_pool/framebuffer_pool.h"
+#include "pw_log/log.h"
 #include "pw_status/status.h"
 #include "pw_status/try.h"
 #include "pw_thread/thread.h"
@@ -46,6 +65,10 @@ constexpr uint16_t kFramebufferRowBytes =
 constexpr pw::geometry::Size<uint16_t> kDisplaySize = {DISPLAY_WIDTH,
                                                        DISPLAY_HEIGHT};
 
+// Text mode draws pw::draw::GetFont6x8() at the panel's native resolution.
+constexpr int kTextModeColumns = DISPLAY_WIDTH / 6;
+constexpr int kTextModeRows = DISPLAY_HEIGHT / 8;
+
 color_rgb565_t s_pixel_data[kNumPixels];
 const pw::Vector<void*, 1> s_pixel_buffers{s_pixel_data};
 FramebufferPool s_fb_pool({
@@ -56,6 +79,75 @@ FramebufferPool s_fb_pool({
 });
 pw::display_driver::DisplayDriverImgUI s_display_driver;
 
+// The steady clock in microseconds, truncated to 32 bits, like the Pico's
+// 1 MHz timer. Nanoseconds would wrap every 4.3 seconds.
+uint32_t SteadyClockTicks() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+constexpr kudzu::TimingClock kTimingClock = {SteadyClockTicks, 1'000'000};
+
+// CSV traces are in g and dps, scaled to the badge IMU's ranges.
+constexpr kudzu::imu::ImuFullScale kCsvTraceFullScale = {.accel_g = 8,
+                                                         .gyro_dps = 1000};
+
+std::vector<kudzu::imu::TimestampedImuSample> s_trace_samples;
+
+// Loads the CSV or binary trace named by KUDZU_IMU_TRACE, if it's set.
+std::optional<kudzu::imu::ImuTrace> LoadImuTrace() {
+  const char* path = std::getenv("KUDZU_IMU_TRACE");
+  if (path == nullptr) {
+    return std::nullopt;
+  }
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    PW_LOG_ERROR("Can't open IMU trace %s", path);
+    return std::nullopt;
+  }
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+  pw::Result<kudzu::imu::ImuTrace> trace = pw::Status::DataLoss();
+  if (std::string_view(contents).substr(0, 4) == "KIMU") {
+    s_trace_samples.resize(contents.size() /
+                           kudzu::imu::kImuTraceRecordSize);
+    trace = kudzu::imu::ParseImuTraceBinary(
+        pw::as_bytes(pw::span(contents)), s_trace_samples);
+  } else {
+    s_trace_samples.resize(
+        std::count(contents.begin(), contents.end(), '\n') + 1);
+    trace = kudzu::imu::ParseImuTraceCsv(
+        contents, kCsvTraceFullScale, s_trace_samples);
+  }
+  if (!trace.ok()) {
+    PW_LOG_ERROR("Can't parse IMU trace %s", path);
+    return std::nullopt;
+  }
+  PW_LOG_INFO("Replaying %u IMU samples from %s",
+              static_cast<unsigned>(trace->samples.size()),
+              path);
+  return *trace;
+}
+
+// Replays KUDZU_IMU_TRACE in place of the fixed simulated IMU readings, at
+// KUDZU_IMU_TRACE_SPEEDUP times its recorded rate if that's set. Returns null
+// when there's no trace.
+kudzu::imu::TraceImu* GetTraceImu() {
+  static const std::optional<kudzu::imu::ImuTrace> s_trace = LoadImuTrace();
+  if (!s_trace.has_value()) {
+    return nullptr;
+  }
+  kudzu::imu::TraceImu::Options options;
+  if (const char* speedup = std::getenv("KUDZU_IMU_TRACE_SPEEDUP")) {
+    options.speedup = static_cast<uint32_t>(std::strtoul(speedup, nullptr, 10));
+  }
+  static kudzu::imu::TraceImu s_trace_imu(*s_trace, options);
+  return &s_trace_imu;
+}
+
 }  // namespace
 
 // static
@@ -70,9 +162,18 @@ Status Common::Init() {
   if (!status.ok()) {
     return status;
   }
+  // Starts a replayed trace. The simulated IMU has nothing to set up and
+  // reports UNIMPLEMENTED, but reads fine.
+  status = GetBatchImu().Init();
+  if (!status.ok() && !status.IsUnimplemented()) {
+    PW_LOG_WARN("Failed to start the IMU: %s", status.str());
+  }
   return pw::OkStatus();
 }
 
+// static
+Status Common::InitTextMode() { return Init(); }
+
 // static
 pw::display::Display& Common::GetDisplay() {
   static pw::display::DisplayImgUI s_display(
@@ -80,8 +181,18 @@ pw::display::Display& Common::GetDisplay() {
   return s_display;
 }
 
+// static
+kudzu::TextModeDisplay& Common::GetTextModeDisplay() {
+  static kudzu::DisplayDriverScanlineWriter s_scanline_writer(
+      s_display_driver);
+  static kudzu::TextModeDisplayBuffer<kTextModeColumns, kTextModeRows>
+      s_text_mode(s_scanline_writer, pw::draw::GetFont6x8());
+  return s_text_mode;
+}
+
 pw::touchscreen::Touchscreen& Common::GetTouchscreen() {
-  static Touchscreen s_touchscreen = Touchscreen(s_display_driver);
+  static Touchscreen s_touchscreen =
+      Touchscreen(s_display_driver, &kTimingClock);
   return s_touchscreen;
 }
 
@@ -91,10 +202,39 @@ kudzu::Buttons& Common::GetButtons() {
 }
 
 kudzu::imu::PollingImu& Common::GetImu() {
+  if (kudzu::imu::TraceImu* trace_imu = GetTraceImu()) {
+    return *trace_imu;
+  }
   static kudzu::imu::PollingImuImGui s_imu = kudzu::imu::PollingImuImGui();
   return s_imu;
 }
 
+kudzu::imu::BatchImu& Common::GetBatchImu() {
+  if (kudzu::imu::TraceImu* trace_imu = GetTraceImu()) {
+    return *trace_imu;
+  }
+  // The simulated IMU has no FIFO, so it's polled at a typical rate.
+  static kudzu::imu::PolledBatchImu s_batch_imu(
+      GetImu(),
+      pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(10)));
+  return s_batch_imu;
+}
+
+// static
+const kudzu::TimingClock& Common::GetTimingClock() { return kTimingClock; }
+
+// static
+pw::Status Common::SaveTouchCalibration(const kudzu::TouchCalibration&) {
+  // The mouse lands exactly where it points.
+  return pw::Status::Unimplemented();
+}
+
+// static
+pw::chrono::SystemClock::duration Common::MinFramePeriod() {
+  // The host has no battery to save.
+  return pw::chrono::SystemClock::duration::zero();
+}
+
 const pw::thread::Options& Common::DisplayDrawThreadOptions() {
   static pw::thread::stl::Options display_draw_thread_options;
   return display_draw_thread_options;
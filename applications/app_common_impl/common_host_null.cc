@@ -11,11 +11,19 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <chrono>
+#include <cstdint>
+
 #include "app_common/common.h"
 #include "kudzu_buttons_null/buttons.h"
+#include "kudzu_imu/imu.h"
+#include "libkudzu/text_mode.h"
+#include "libkudzu/timing_scope.h"
 #include "pw_display/display.h"
 #include "pw_display_driver_null/display_driver.h"
+#include "pw_draw/font6x8.h"
 #include "pw_status/try.h"
+#include "pw_thread/sleep.h"
 #include "pw_thread/thread.h"
 #include "pw_thread_stl/options.h"
 #include "pw_touchscreen_null/touchscreen.h"
@@ -31,6 +39,10 @@ namespace {
 constexpr pw::geometry::Size<uint16_t> kDisplaySize = {DISPLAY_WIDTH,
                                                        DISPLAY_HEIGHT};
 
+// Text mode draws pw::draw::GetFont6x8() at the panel's native resolution.
+constexpr int kTextModeColumns = DISPLAY_WIDTH / 6;
+constexpr int kTextModeRows = DISPLAY_HEIGHT / 8;
+
 pw::display_driver::DisplayDriverNULL s_display_driver;
 const pw::Vector<void*, 0> s_pixel_buffers;
 pw::framebuffer_pool::FramebufferPool s_fb_pool({
@@ -40,6 +52,32 @@ pw::framebuffer_pool::FramebufferPool s_fb_pool({
     .pixel_format = PixelFormat::None,
 });
 
+// The steady clock in microseconds, truncated to 32 bits, like the Pico's
+// 1 MHz timer. Nanoseconds would wrap every 4.3 seconds.
+uint32_t SteadyClockTicks() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+constexpr kudzu::TimingClock kTimingClock = {SteadyClockTicks, 1'000'000};
+
+// An IMU which never has any samples.
+class BatchImuNull : public kudzu::imu::BatchImu {
+ public:
+  pw::Status Init() override { return pw::OkStatus(); }
+  kudzu::imu::ImuFullScale full_scale() const override {
+    return {.accel_g = 8, .gyro_dps = 1000};
+  }
+  pw::Result<pw::span<kudzu::imu::TimestampedImuSample>> ReadBatch(
+      pw::span<kudzu::imu::TimestampedImuSample>,
+      pw::chrono::SystemClock::duration timeout) override {
+    pw::this_thread::sleep_for(timeout);
+    return pw::Status::DeadlineExceeded();
+  }
+};
+
 }  // namespace
 
 // static
@@ -47,6 +85,8 @@ Status Common::EndOfFrameCallback() { return pw::OkStatus(); }
 
 Status Common::Init() { return s_display_driver.Init(); }
 
+Status Common::InitTextMode() { return s_display_driver.Init(); }
+
 // static
 pw::display::Display& Common::GetDisplay() {
   static pw::display::Display s_display(
@@ -54,6 +94,15 @@ pw::display::Display& Common::GetDisplay() {
   return s_display;
 }
 
+// static
+kudzu::TextModeDisplay& Common::GetTextModeDisplay() {
+  static kudzu::DisplayDriverScanlineWriter s_scanline_writer(
+      s_display_driver);
+  static kudzu::TextModeDisplayBuffer<kTextModeColumns, kTextModeRows>
+      s_text_mode(s_scanline_writer, pw::draw::GetFont6x8());
+  return s_text_mode;
+}
+
 pw::touchscreen::Touchscreen& Common::GetTouchscreen() {
   static pw::touchscreen::TouchscreenNull s_touchscreen =
       pw::touchscreen::TouchscreenNull();
@@ -65,6 +114,26 @@ kudzu::Buttons& Common::GetButtons() {
   return s_buttons;
 }
 
+kudzu::imu::BatchImu& Common::GetBatchImu() {
+  static BatchImuNull s_batch_imu;
+  return s_batch_imu;
+}
+
+// static
+const kudzu::TimingClock& Common::GetTimingClock() { return kTimingClock; }
+
+// static
+pw::Status Common::SaveTouchCalibration(const kudzu::TouchCalibration&) {
+  // There is no touchscreen to calibrate.
+  return pw::Status::Unimplemented();
+}
+
+// static
+pw::chrono::SystemClock::duration Common::MinFramePeriod() {
+  // The host has no battery to save.
+  return pw::chrono::SystemClock::duration::zero();
+}
+
 const pw::thread::Options& Common::DisplayDrawThreadOptions() {
   static pw::thread::stl::Options display_draw_thread_options;
   return display_draw_thread_options;
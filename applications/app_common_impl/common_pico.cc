@@ -11,7 +11,14 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <optional>
 
 #include "app_common/common.h"
 
@@ -21,30 +28,50 @@
 #include "FreeRTOS.h"
 #include "ft6236/device.h"
 #include "hardware/adc.h"
+#include "hardware/flash.h"
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
 #include "hardware/vreg.h"
 #include "icm42670p/device.h"
 #include "kudzu_buttons_pi4ioe5v6416/buttons.h"
 #include "kudzu_imu_icm42670p/imu.h"
+#include "libkudzu/device_health.h"
+#include "libkudzu/i2c_scheduler.h"
+#include "libkudzu/overrun_log.h"
+#include "libkudzu/power_governor.h"
+#include "libkudzu/profiling_initiator.h"
+#include "libkudzu/task_cpu_freertos.h"
+#include "libkudzu/telemetry.h"
+#include "libkudzu/text_mode.h"
+#include "libkudzu/timing_scope.h"
+#include "libkudzu/touch_calibration.h"
 #include "max17048/device.h"
 #include "pi4ioe5v6416/device.h"
 #include "pico/stdlib.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono/system_timer.h"
 #include "pw_digital_io_rp2040/digital_io.h"
+#include "pw_draw/font6x8.h"
 #include "pw_i2c_rp2040/initiator.h"
 #include "pw_log/log.h"
 #include "pw_pixel_pusher_rp2040_pio/pixel_pusher.h"
 #include "pw_spi/chip_selector_digital_out.h"
 #include "pw_spi_rp2040/initiator.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
 #include "pw_sync/borrow.h"
 #include "pw_sync/mutex.h"
+#include "pw_system/work_queue.h"
 #include "pw_thread/detached_thread.h"
+#include "pw_thread/sleep.h"
 #include "pw_thread/thread.h"
 #include "pw_thread_freertos/context.h"
 #include "pw_thread_freertos/options.h"
 #include "pw_touchscreen_ft6236/touchscreen.h"
+#include "task.h"
 
 #if defined(DISPLAY_TYPE_ILI9341)
 #include "pw_display_driver_ili9341/display_driver.h"
@@ -110,6 +137,24 @@ constexpr pw::geometry::Size<uint16_t> kDisplaySize{DISPLAY_WIDTH,
 constexpr size_t kNumPixels = kFramebufferWidth * kFramebufferHeight;
 constexpr uint16_t kFramebufferRowBytes = sizeof(uint16_t) * kFramebufferWidth;
 
+// The touch panel is 240x320 and lies turned against the display. Touches are
+// reported in framebuffer pixels, which are doubled on the display.
+constexpr kudzu::TouchCalibration kDefaultTouchCalibration =
+    kudzu::TouchCalibration::FromRotation(
+        kudzu::TouchCalibration::Rotation::k90,
+        {240, 320},
+        {DISPLAY_WIDTH / kDisplayScaleFactor,
+         DISPLAY_HEIGHT / kDisplayScaleFactor});
+
+// A calibrated unit keeps its calibration in the last sector of flash, well
+// clear of the firmware.
+constexpr uint32_t kTouchCalibrationFlashOffset =
+    PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+
+// Text mode draws pw::draw::GetFont6x8() at the panel's native resolution.
+constexpr int kTextModeColumns = DISPLAY_WIDTH / 6;
+constexpr int kTextModeRows = DISPLAY_HEIGHT / 8;
+
 constexpr uint32_t kBaudRate = 31'250'000;
 constexpr pw::spi::Config kSpiConfig8Bit{
     .polarity = pw::spi::ClockPolarity::kActiveHigh,
@@ -164,15 +209,23 @@ PixelPusherRp2040Pio s_pixel_pusher(DISPLAY_DC_GPIO,
                                     DISPLAY_TE_GPIO,
                                     pio0);
 #endif
-uint16_t s_pixel_data1[kNumPixels];
-uint16_t s_pixel_data2[kNumPixels];
-const pw::Vector<void*, 2> s_pixel_buffers{s_pixel_data1, s_pixel_data2};
-pw::framebuffer_pool::FramebufferPool s_fb_pool({
-    .fb_addr = s_pixel_buffers,
-    .dimensions = {kFramebufferWidth, kFramebufferHeight},
-    .row_bytes = kFramebufferRowBytes,
-    .pixel_format = PixelFormat::RGB565,
-});
+
+// The framebuffers are only created on first use so that text mode
+// applications, which never call this, don't link them in.
+FramebufferPool& GetFramebufferPool() {
+  static uint16_t s_pixel_data1[kNumPixels];
+  static uint16_t s_pixel_data2[kNumPixels];
+  static const pw::Vector<void*, 2> s_pixel_buffers{s_pixel_data1,
+                                                    s_pixel_data2};
+  static FramebufferPool s_fb_pool({
+      .fb_addr = s_pixel_buffers,
+      .dimensions = {kFramebufferWidth, kFramebufferHeight},
+      .row_bytes = kFramebufferRowBytes,
+      .pixel_format = PixelFormat::RGB565,
+  });
+  return s_fb_pool;
+}
+
 DisplayDriver s_display_driver({
     .data_cmd_gpio = s_display_dc_pin.as<pw::digital_io::DigitalOut>(),
     .spi_cs_gpio = s_display_cs_pin.as<pw::digital_io::DigitalOut>(),
@@ -245,14 +298,65 @@ constexpr pw::i2c::Rp2040Initiator::Config ki2c1Config{
     .sda_pin = I2C_BUS1_SDA,
     .scl_pin = I2C_BUS1_SCL,
 };
-pw::i2c::Rp2040Initiator i2c0_bus(ki2c0Config, i2c0);
-pw::i2c::Rp2040Initiator i2c1_bus(ki2c1Config, i2c1);
+// The Cortex-M0+ has no cycle counter and FreeRTOS owns SysTick, so use the
+// RP2040's free running 1 MHz timer.
+uint32_t TimerTicks() { return time_us_32(); }
+
+constexpr kudzu::TimingClock kTimingClock = {TimerTicks, 1'000'000};
+
+pw::i2c::Rp2040Initiator i2c0_initiator(ki2c0Config, i2c0);
+pw::i2c::Rp2040Initiator i2c1_initiator(ki2c1Config, i2c1);
+
+// Devices talk through these to account for each one's share of the bus.
+kudzu::ProfilingInitiator i2c0_bus("i2c0", i2c0_initiator, kTimingClock);
+kudzu::ProfilingInitiator i2c1_bus("i2c1", i2c1_initiator, kTimingClock);
+
+// Bus 0 is shared by the touch controller, IMU and fuel gauge, so its
+// transactions run from one thread which lets touch reads go first. Bus 1
+// only has the IO expander.
+kudzu::I2cScheduler i2c0_scheduler(i2c0_bus);
+kudzu::ScheduledInitiator i2c0_touch(i2c0_scheduler,
+                                     kudzu::I2cPriority::kHigh);
+kudzu::ScheduledInitiator i2c0_imu(i2c0_scheduler,
+                                   kudzu::I2cPriority::kNormal);
+kudzu::ScheduledInitiator i2c0_fuel_gauge(i2c0_scheduler,
+                                          kudzu::I2cPriority::kLow);
+
+// How often to log each device's bus use.
+constexpr auto kI2cStatsLogPeriod = std::chrono::seconds(30);
+
+void LogI2cStats(pw::chrono::SystemClock::time_point expired_deadline);
+
+pw::chrono::SystemTimer s_i2c_stats_timer(LogI2cStats);
+
+void LogI2cStats(pw::chrono::SystemClock::time_point expired_deadline) {
+  // Logging doesn't belong in the timer's callback.
+  pw::system::GetWorkQueue()
+      .PushWork([]() {
+        i2c0_bus.LogStats();
+        i2c1_bus.LogStats();
+      })
+      .IgnoreError();
+  s_i2c_stats_timer.InvokeAt(expired_deadline + kI2cStatsLogPeriod);
+}
 
 pw::pi4ioe5v6416::Device io_expander(i2c1_bus);
-kudzu::icm42670p::Device imu(i2c0_bus);
-pw::max17048::Device fuel_guage(i2c0_bus);
-pw::ft6236::Device touch_screen_controller(i2c0_bus);
-
+kudzu::icm42670p::Device imu(i2c0_imu);
+pw::max17048::Device fuel_guage(i2c0_fuel_gauge);
+pw::ft6236::Device touch_screen_controller(i2c0_touch);
+Buttons s_buttons(&io_expander, &kTimingClock);
+// The FT6236 doesn't answer until this long after leaving reset.
+constexpr auto kTouchStartupDelay =
+    pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(300));
+Touchscreen s_touchscreen(&touch_screen_controller,
+                          kDefaultTouchCalibration,
+                          &kTimingClock);
+// 400 Hz in batches of 8 wakes the reader at 50 Hz.
+kudzu::imu::BatchImuICM42670P s_batch_imu(
+    &imu, kudzu::icm42670p::Device::OutputDataRate::k400Hz, 8);
+
+// Apps keep their FrameCounter and other large per-app state in statics, so
+// the frame loop itself only needs a small stack.
 static constexpr size_t kDisplayDrawThreadStackWords = 512;
 static pw::thread::freertos::StaticContextWithStack<
     kDisplayDrawThreadStackWords>
@@ -263,42 +367,270 @@ static pw::thread::freertos::StaticContextWithStack<
     kTouchscreenThreadStackWords>
     touchscreen_thread_context;
 
+static constexpr size_t kDeviceHealthThreadStackWords = 512;
+static pw::thread::freertos::StaticContextWithStack<
+    kDeviceHealthThreadStackWords>
+    device_health_thread_context;
+
+static constexpr size_t kI2cSchedulerThreadStackWords = 512;
+static pw::thread::freertos::StaticContextWithStack<
+    kI2cSchedulerThreadStackWords>
+    i2c_scheduler_thread_context;
+
+static constexpr size_t kButtonThreadStackWords = 512;
+static pw::thread::freertos::StaticContextWithStack<kButtonThreadStackWords>
+    button_thread_context;
+
+static constexpr size_t kTouchInterruptThreadStackWords = 512;
+static pw::thread::freertos::StaticContextWithStack<
+    kTouchInterruptThreadStackWords>
+    touch_interrupt_thread_context;
+
 Rp2040DigitalInOut s_io_reset_n({
     .pin = 10,
     // IO expander resets when this pin is pulled low.
     .polarity = pw::digital_io::Polarity::kActiveLow,
 });
-Rp2040DigitalInOut s_io_interrupt_n({
-    .pin = 11,
+constexpr uint kIoExpanderInterruptPin = 11;
+Rp2040DigitalIn s_io_interrupt_n({
+    .pin = kIoExpanderInterruptPin,
+    // Open drain, pulled low by the IO expander when a button changes.
     .polarity = pw::digital_io::Polarity::kActiveLow,
 });
+constexpr uint kTouchInterruptPin = 22;
+Rp2040DigitalIn s_touch_interrupt_n({
+    .pin = kTouchInterruptPin,
+    // Pulsed low by the touch controller for each new report.
+    .polarity = pw::digital_io::Polarity::kActiveLow,
+});
+constexpr uint kImuInterruptPin = 12;
+Rp2040DigitalIn s_imu_interrupt({
+    .pin = kImuInterruptPin,
+    // INT2, pulsed high by the IMU while its FIFO is over the watermark.
+    .polarity = pw::digital_io::Polarity::kActiveHigh,
+});
 Rp2040DigitalInOut s_imu_fsync({
     .pin = 13,
     .polarity = pw::digital_io::Polarity::kActiveHigh,
 });
 
-}  // namespace
+std::optional<kudzu::BatteryTelemetry> ReadBattery() {
+  auto battery = fuel_guage.Read();
+  if (!battery.ok()) {
+    return std::nullopt;
+  }
+  return kudzu::BatteryTelemetry{battery->millivolts, battery->percent()};
+}
 
-Status Common::EndOfFrameCallback() {
-  touch_screen_controller.LogControllerInfo();
+// How often the power governor samples the battery.
+constexpr auto kPowerGovernorPeriod = std::chrono::seconds(10);
+
+kudzu::PowerGovernor s_power_governor;
+// Set from the work queue and read by the display thread.
+std::atomic<uint32_t> s_min_frame_period_us = 0;
 
-  if (io_expander.Probe() == pw::OkStatus()) {
-    io_expander.LogControllerInfo();
+kudzu::icm42670p::Device::OutputDataRate ImuRateForHz(uint16_t hz) {
+  using Rate = kudzu::icm42670p::Device::OutputDataRate;
+  if (hz >= 400) {
+    return Rate::k400Hz;
+  }
+  if (hz >= 200) {
+    return Rate::k200Hz;
   }
+  if (hz >= 100) {
+    return Rate::k100Hz;
+  }
+  // Slower than this and the FIFO's 16-bit timestamps can wrap unseen.
+  return Rate::k50Hz;
+}
 
-  if (fuel_guage.Probe() == pw::OkStatus()) {
-    fuel_guage.LogControllerInfo();
+void ApplyPowerProfile(const kudzu::PowerProfile& profile) {
+  s_min_frame_period_us = profile.min_frame_period_us;
+#if BACKLIGHT_GPIO != -1
+  // SetBacklight() has already set up the PWM slice.
+  pwm_set_gpio_level(BACKLIGHT_GPIO, profile.backlight);
+#endif
+  // Takes effect at the batch IMU's next read, which restarts the FIFO.
+  s_batch_imu.SetOutputDataRate(ImuRateForHz(profile.imu_rate_hz));
+}
+
+void RunPowerGovernor() {
+  auto battery = fuel_guage.Read();
+  if (!battery.ok()) {
+    // Keep the current level rather than treat a missed read as mains power.
+    return;
+  }
+  kudzu::PowerInputs inputs;
+  inputs.battery = kudzu::PowerInputs::Battery{
+      .millivolts = battery->millivolts,
+      .percent = battery->percent(),
+      .charge_rate = battery->charge_rate,
+  };
+  if (std::optional<kudzu::FrameTelemetry> frame =
+          kudzu::GetTelemetryStore().frame()) {
+    inputs.frame_p95_us = frame->p95_us;
   }
+  if (s_power_governor.Update(inputs)) {
+    PW_LOG_INFO("Power level %s at %u%%, %u mV",
+                kudzu::PowerLevelName(s_power_governor.level()),
+                static_cast<unsigned>(battery->percent()),
+                static_cast<unsigned>(battery->millivolts));
+    ApplyPowerProfile(s_power_governor.profile());
+  }
+}
+
+void UpdatePowerGovernor(pw::chrono::SystemClock::time_point expired_deadline);
+
+pw::chrono::SystemTimer s_power_governor_timer(UpdatePowerGovernor);
+
+void UpdatePowerGovernor(pw::chrono::SystemClock::time_point expired_deadline) {
+  // Reading the fuel gauge waits on the bus, so it doesn't belong in the
+  // timer's callback.
+  pw::system::GetWorkQueue().PushWork(RunPowerGovernor).IgnoreError();
+  s_power_governor_timer.InvokeAt(expired_deadline + kPowerGovernorPeriod);
+}
 
-  if (imu.Probe() == pw::OkStatus()) {
-    imu.LogControllerInfo();
+// Runs when a frame goes over its budget, so it may take a moment to walk
+// the task list. Reads every task, then keeps the first ones that fit.
+size_t ReadOverrunTasks(pw::span<kudzu::OverrunTask> tasks) {
+  static std::array<TaskStatus_t, kudzu::kMaxFreeRtosTasks> status;
+  const size_t count = std::min<size_t>(
+      uxTaskGetSystemState(status.data(), status.size(), nullptr),
+      tasks.size());
+  for (size_t i = 0; i < count; i++) {
+    kudzu::OverrunTask& task = tasks[i];
+    std::strncpy(task.name.data(), status[i].pcTaskName, task.name.size() - 1);
+    task.name.back() = '\0';
+    task.state = static_cast<uint8_t>(status[i].eCurrentState);
+    task.priority = static_cast<uint8_t>(status[i].uxCurrentPriority);
+    task.stack_high_water_bytes = static_cast<uint16_t>(
+        status[i].usStackHighWaterMark * sizeof(StackType_t));
   }
+  return count;
+}
 
-  return pw::OkStatus();
+void ReadI2cCounts(
+    pw::span<uint32_t, kudzu::FrameOverrun::kMaxI2cBuses> counts) {
+  counts[0] = i2c0_bus.total_transactions();
+  counts[1] = i2c1_bus.total_transactions();
 }
 
-// static
-Status Common::Init() {
+void I2cSchedulerTask(void*) { i2c0_scheduler.Run(); }
+
+void StartI2cScheduler() {
+  // Above the threads which queue transactions, so a queued touch read
+  // starts as soon as the bus is free.
+  static constexpr auto options =
+      pw::thread::freertos::Options()
+          .set_name("I2cSchedulerThread")
+          .set_static_context(i2c_scheduler_thread_context)
+          .set_priority(static_cast<UBaseType_t>(tskIDLE_PRIORITY + 2));
+  pw::thread::DetachedThread(options, I2cSchedulerTask);
+}
+
+// The SDK has one GPIO interrupt callback per core, shared by every pin.
+void GpioInterrupt(uint gpio, uint32_t /*events*/) {
+  if (gpio == kIoExpanderInterruptPin) {
+    s_buttons.HandleInterrupt();
+  } else if (gpio == kTouchInterruptPin) {
+    s_touchscreen.HandleInterrupt();
+  } else if (gpio == kImuInterruptPin) {
+    s_batch_imu.HandleInterrupt();
+  }
+}
+
+void ButtonTask(void*) { s_buttons.RunInterruptHandler(); }
+
+void StartButtonInterrupts() {
+  gpio_pull_up(kIoExpanderInterruptPin);
+  gpio_set_irq_enabled_with_callback(
+      kIoExpanderInterruptPin, GPIO_IRQ_EDGE_FALL, true, GpioInterrupt);
+
+  // Above the app threads, so events are timestamped as they happen.
+  static constexpr auto options =
+      pw::thread::freertos::Options()
+          .set_name("ButtonThread")
+          .set_static_context(button_thread_context)
+          .set_priority(static_cast<UBaseType_t>(tskIDLE_PRIORITY + 2));
+  pw::thread::DetachedThread(options, ButtonTask);
+}
+
+void TouchInterruptTask(void*) { s_touchscreen.RunInterruptHandler(); }
+
+void StartTouchInterrupts() {
+  gpio_pull_up(kTouchInterruptPin);
+  // The SDK keeps the callback set by StartButtonInterrupts().
+  gpio_set_irq_enabled(kTouchInterruptPin, GPIO_IRQ_EDGE_FALL, true);
+
+  static constexpr auto options =
+      pw::thread::freertos::Options()
+          .set_name("TouchInterruptThread")
+          .set_static_context(touch_interrupt_thread_context)
+          .set_priority(static_cast<UBaseType_t>(tskIDLE_PRIORITY + 2));
+  pw::thread::DetachedThread(options, TouchInterruptTask);
+}
+
+void StartImuInterrupts() {
+  // INT2 stays low until s_batch_imu.Init() enables the FIFO, so the first
+  // watermark can't be missed. The SDK keeps the callback set by
+  // StartButtonInterrupts().
+  gpio_set_irq_enabled(kImuInterruptPin, GPIO_IRQ_EDGE_RISE, true);
+}
+
+void DeviceHealthTask(void*) { kudzu::GetDeviceHealthMonitor().Run(); }
+
+void StartDeviceHealthMonitor() {
+  kudzu::DeviceHealthMonitor& monitor = kudzu::GetDeviceHealthMonitor();
+  monitor
+      .AddDevice(
+          "ft6236",
+          [] { return touch_screen_controller.Probe(); },
+          [] { touch_screen_controller.LogControllerInfo(); })
+      .IgnoreError();
+  monitor
+      .AddDevice(
+          "pi4ioe5v6416",
+          [] { return io_expander.Probe(); },
+          [] { io_expander.LogControllerInfo(); })
+      .IgnoreError();
+  monitor
+      .AddDevice(
+          "max17048",
+          [] { return fuel_guage.Probe(); },
+          [] { fuel_guage.LogControllerInfo(); })
+      .IgnoreError();
+  monitor
+      .AddDevice(
+          "icm42670p",
+          [] { return imu.Probe(); },
+          [] { imu.LogControllerInfo(); })
+      .IgnoreError();
+
+  static constexpr auto options =
+      pw::thread::freertos::Options()
+          .set_name("DeviceHealthThread")
+          .set_static_context(device_health_thread_context)
+          .set_priority(static_cast<UBaseType_t>(tskIDLE_PRIORITY + 1));
+  pw::thread::DetachedThread(options, DeviceHealthTask);
+}
+
+// Replaces the default touch calibration with the one saved in flash, if any.
+void LoadTouchCalibration() {
+  const auto* stored = reinterpret_cast<const std::byte*>(
+      XIP_BASE + kTouchCalibrationFlashOffset);
+  pw::Result<kudzu::TouchCalibration> calibration =
+      kudzu::TouchCalibration::Decode(
+          pw::span(stored, kudzu::TouchCalibration::kEncodedSize));
+  if (calibration.ok()) {
+    s_touchscreen.SetCalibration(*calibration);
+    PW_LOG_INFO("Using the saved touch calibration");
+  } else if (calibration.status().IsDataLoss()) {
+    PW_LOG_WARN("Saved touch calibration is corrupt; using the default");
+  }
+}
+
+// Bring up everything except the display controller and pixel pusher.
+void InitPeripherals() {
 #if OVERCLOCK_250
   // Overvolt for a stable 250MHz on some RP2040s
   vreg_set_voltage(VREG_VOLTAGE_1_20);
@@ -322,36 +654,50 @@ Status Common::Init() {
   s_display_tear_effect_pin.Enable();
 #endif
 
-  i2c0_bus.Enable();
-  i2c1_bus.Enable();
+  i2c0_initiator.Enable();
+  i2c1_initiator.Enable();
+  StartI2cScheduler();
+  kudzu::SetI2cProfiler(0, &i2c0_bus);
+  kudzu::SetI2cProfiler(1, &i2c1_bus);
+  kudzu::GetOverrunLog().SetI2cCountReader(ReadI2cCounts);
+  s_i2c_stats_timer.InvokeAfter(kI2cStatsLogPeriod);
 
   s_io_reset_n.Enable();
   // Disable reset pin - normal operation.
   s_io_reset_n.SetStateInactive();
   s_io_interrupt_n.Enable();
+  s_touch_interrupt_n.Enable();
+  s_imu_interrupt.Enable();
 
   // IMU FSYNC not used yet
   s_imu_fsync.Enable();
 
-  touch_screen_controller.Enable();
-  if (touch_screen_controller.Probe() == pw::OkStatus()) {
-    touch_screen_controller.LogControllerInfo();
+  // Probes and register dumps wait on the bus, so they're left to the device
+  // health thread rather than done here or between frames.
+  LoadTouchCalibration();
+  // The touch controller is held in reset until the IO expander is enabled.
+  if (!io_expander.Enable().ok()) {
+    PW_LOG_ERROR("Failed to enable the IO expander");
   }
-
-  io_expander.Enable();
-  if (io_expander.Probe() == pw::OkStatus()) {
-    io_expander.LogControllerInfo();
+  StartButtonInterrupts();
+  pw::this_thread::sleep_for(kTouchStartupDelay);
+  if (!touch_screen_controller.Enable().ok()) {
+    PW_LOG_ERROR("Failed to enable the FT6236");
   }
-
+  StartTouchInterrupts();
   fuel_guage.Enable();
-  if (fuel_guage.Probe() == pw::OkStatus()) {
-    fuel_guage.LogControllerInfo();
-  }
-
-  imu.Enable();
-  if (imu.Probe() == pw::OkStatus()) {
-    imu.LogControllerInfo();
+  kudzu::GetTelemetryStore().SetBatteryReader(ReadBattery);
+  kudzu::GetOverrunLog().SetTaskReader(ReadOverrunTasks);
+  StartImuInterrupts();
+  // Enables the IMU and streams it into the FIFO for GetBatchImu(). GetImu()
+  // reads the data registers, which keep updating.
+  if (!s_batch_imu.Init().ok()) {
+    PW_LOG_ERROR("Failed to start the IMU FIFO");
   }
+  // Profiles set the IMU's rate, so the governor waits for the FIFO to be
+  // running.
+  s_power_governor_timer.InvokeAfter(kPowerGovernorPeriod);
+  StartDeviceHealthMonitor();
 
 #if BACKLIGHT_GPIO != -1
   SetBacklight(0xffff);  // Full brightness.
@@ -365,11 +711,26 @@ Status Common::Init() {
 #endif
   gpio_set_function(SPI_CLOCK_GPIO, GPIO_FUNC_SPI);
   gpio_set_function(SPI_MOSI_GPIO, GPIO_FUNC_SPI);
+}
+
+}  // namespace
+
+Status Common::EndOfFrameCallback() {
+  // Only reads the device health thread's cached results.
+  if (!kudzu::GetDeviceHealthMonitor().AllHealthy()) {
+    return Status::Unavailable();
+  }
+  return pw::OkStatus();
+}
+
+// static
+Status Common::Init() {
+  InitPeripherals();
 
 #if USE_PIO
   // Init the display before the pixel pusher.
   s_display_driver.Init();
-  auto result = s_pixel_pusher.Init(s_fb_pool);
+  auto result = s_pixel_pusher.Init(GetFramebufferPool());
   s_pixel_pusher.SetPixelDouble(true);
   return result;
 #else
@@ -377,27 +738,70 @@ Status Common::Init() {
 #endif
 }
 
+// static
+Status Common::InitTextMode() {
+  InitPeripherals();
+  // Text mode writes rows to the controller directly, so the pixel pusher and
+  // its framebuffers are never set up.
+  return s_display_driver.Init();
+}
+
 // static
 pw::display::Display& Common::GetDisplay() {
-  static Display s_display(s_display_driver, kDisplaySize, s_fb_pool);
+  static Display s_display(
+      s_display_driver, kDisplaySize, GetFramebufferPool());
   return s_display;
 }
 
-pw::touchscreen::Touchscreen& Common::GetTouchscreen() {
-  static Touchscreen s_touchscreen = Touchscreen(&touch_screen_controller);
-  return s_touchscreen;
+// static
+kudzu::TextModeDisplay& Common::GetTextModeDisplay() {
+  static kudzu::DisplayDriverScanlineWriter s_scanline_writer(
+      s_display_driver);
+  static kudzu::TextModeDisplayBuffer<kTextModeColumns, kTextModeRows>
+      s_text_mode(s_scanline_writer, pw::draw::GetFont6x8());
+  return s_text_mode;
 }
 
-kudzu::Buttons& Common::GetButtons() {
-  static Buttons s_buttons = Buttons(&io_expander);
-  return s_buttons;
-}
+pw::touchscreen::Touchscreen& Common::GetTouchscreen() { return s_touchscreen; }
+
+kudzu::Buttons& Common::GetButtons() { return s_buttons; }
 
 kudzu::imu::PollingImu& Common::GetImu() {
   static kudzu::imu::PollingImuICM42670P s_imu(&imu);
   return s_imu;
 }
 
+kudzu::imu::BatchImu& Common::GetBatchImu() { return s_batch_imu; }
+
+const kudzu::TimingClock& Common::GetTimingClock() { return kTimingClock; }
+
+// static
+Status Common::SaveTouchCalibration(
+    const kudzu::TouchCalibration& calibration) {
+  s_touchscreen.SetCalibration(calibration);
+
+  // Flash is programmed a page at a time.
+  std::array<std::byte, FLASH_PAGE_SIZE> page;
+  page.fill(std::byte{0xff});
+  calibration.Encode(
+      pw::span(page).first<kudzu::TouchCalibration::kEncodedSize>());
+
+  // Nothing may run from flash while it's written, so this stalls the whole
+  // chip, interrupts included, for the tens of milliseconds an erase takes.
+  const uint32_t interrupts = save_and_disable_interrupts();
+  flash_range_erase(kTouchCalibrationFlashOffset, FLASH_SECTOR_SIZE);
+  flash_range_program(kTouchCalibrationFlashOffset,
+                      reinterpret_cast<const uint8_t*>(page.data()),
+                      page.size());
+  restore_interrupts(interrupts);
+  return pw::OkStatus();
+}
+
+pw::chrono::SystemClock::duration Common::MinFramePeriod() {
+  return pw::chrono::SystemClock::for_at_least(
+      std::chrono::microseconds(s_min_frame_period_us.load()));
+}
+
 const pw::thread::Options& Common::DisplayDrawThreadOptions() {
   static constexpr auto options =
       pw::thread::freertos::Options()
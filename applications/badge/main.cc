@@ -11,7 +11,11 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <optional>
+#include <string_view>
 
 #include "pw_banner46x10.h"
 
@@ -19,17 +23,25 @@
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
 #include "app_common/common.h"
+#include "fonts/sans_12.h"
 #include "graphics/surface.hpp"
 #include "heart_8x8.h"
 #include "hello_my_name_is65x42.h"
 #include "kudzu_buttons/buttons.h"
+#include "kudzu_imu/fusion.h"
+#include "kudzu_imu/imu.h"
 #include "kudzu_isometric_text_sprite.h"
+#include "libkudzu/aa_font.h"
 #include "libkudzu/framecounter.h"
+#include "libkudzu/gestures.h"
 #include "libkudzu/random.h"
+#include "libkudzu/text_layout.h"
+#include "libkudzu/timing_scope.h"
 #include "name_tag.h"
 #include "pw_assert/assert.h"
 #include "pw_assert/check.h"
 #include "pw_banner46x10.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_color/color.h"
 #include "pw_color/colors_endesga32.h"
 #include "pw_color/colors_pico8.h"
@@ -38,12 +50,17 @@
 #include "pw_draw/font6x8.h"
 #include "pw_framebuffer/framebuffer.h"
 #include "pw_geometry/vector2.h"
+#include "pw_geometry/vector3.h"
 #include "pw_log/log.h"
 #include "pw_logo5x7.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_string/string_builder.h"
 #include "pw_sys_io/sys_io.h"
 #include "pw_system/target_hooks.h"
 #include "pw_thread/detached_thread.h"
+#include "pw_thread/sleep.h"
+#include "pw_touchscreen/touch_filter.h"
 #include "pw_touchscreen/touchscreen.h"
 
 using kudzu::Buttons;
@@ -65,6 +82,18 @@ float angle = 0;
 bool show_nametag = false;
 bool show_background = false;
 
+// Degrees of tilt per pixel the KUDZU wave grows by.
+constexpr float kTiltDegreesPerPixel = 6.0f;
+
+// Frames slower than this log which of their phases took the time, and are
+// kept in the overrun log.
+constexpr auto kFrameBudget = std::chrono::milliseconds(33);
+
+// Mode switch button label colors: magenta on black, and white on the name
+// tag's purple.
+constexpr kudzu::CoverageRamp kHelloLabelRamp(0xf81f, 0x0000);
+constexpr kudzu::CoverageRamp kKudzuLabelRamp(0xffff, 0x481f);
+
 // Draw the a waving text banner.
 // Returns the bottom Y coordinate of the bottommost pixel set.
 void DrawTextBanner(Framebuffer& framebuffer) {
@@ -170,14 +199,15 @@ void DrawKudzu(Framebuffer& framebuffer,
 }
 
 void DrawGreeting(Framebuffer& framebuffer, blit::Surface& screen) {
-  std::string text = "Nice to meet you\n Made with * by";
-  auto text_size = screen.measure_text(text, blit::minimal_font, true);
+  // Measured once on the first frame and replayed after that.
+  static const kudzu::TextLayout greeting(
+      screen, "Nice to meet you\n Made with * by", blit::minimal_font);
+  auto text_size = greeting.size();
   blit::Rect text_rect(blit::Point((screen.bounds.w / 2) - (text_size.w / 2),
                                    (screen.bounds.h * .8) - (text_size.h / 2)),
                        text_size);
   screen.pen = blit::Pen(0xFF, 0xFF, 0xFF);
-  screen.text(
-      text, blit::minimal_font, text_rect, true, blit::TextAlign::top_left);
+  greeting.Draw(screen, blit::Point(text_rect.x, text_rect.y));
 
   pw::draw::DrawSprite(framebuffer,
                        text_rect.x + text_rect.w - 29,
@@ -219,6 +249,16 @@ void DrawNametag(Framebuffer& framebuffer, blit::Surface& screen) {
       framebuffer, tag_position.x, tag_position.y, &name_tag_sprite_sheet, 1);
 }
 
+// Draw an anti-aliased label in the top right corner of the screen.
+void DrawButtonLabel(Framebuffer& framebuffer,
+                     std::string_view label,
+                     const kudzu::CoverageRamp& ramp) {
+  const auto& font = kudzu::fonts::kSans12;
+  const int x = framebuffer.size().width -
+                kudzu::MeasureAaString(label, font).width - 2;
+  kudzu::DrawAaString(label, {x, 0}, ramp, font, framebuffer);
+}
+
 void DrawBackgroundColors(Framebuffer& framebuffer) {
   static color_rgb565_t base_color = 0;
   static uint16_t magic = 27;
@@ -232,11 +272,28 @@ void DrawBackgroundColors(Framebuffer& framebuffer) {
   base_color += 0x0021;
 }
 
+// Feeds whatever the IMU has buffered since the last frame into `filter`,
+// without waiting for more.
+void UpdateOrientation(kudzu::imu::BatchImu& imu,
+                       kudzu::imu::OrientationFilter& filter) {
+  // About a frame's worth at 400 Hz with room to spare.
+  static std::array<kudzu::imu::TimestampedImuSample, 32> samples;
+  pw::Result<pw::span<kudzu::imu::TimestampedImuSample>> batch =
+      imu.ReadBatch(samples, pw::chrono::SystemClock::duration::zero());
+  if (batch.ok()) {
+    filter.Update(*batch, imu.full_scale());
+  }
+}
+
 void MainTask(void*) {
-  kudzu::FrameCounter frame_counter = kudzu::FrameCounter();
+  static kudzu::FrameCounter frame_counter(Common::GetTimingClock());
 
   PW_CHECK_OK(Common::Init());
 
+  static kudzu::FrameTimeline timeline(Common::GetTimingClock());
+  timeline.set_budget(kFrameBudget);
+  frame_counter.SetOverrunBudget(kFrameBudget);
+
   Display& display = Common::GetDisplay();
   Framebuffer framebuffer = display.GetFramebuffer();
   PW_ASSERT(framebuffer.is_valid());
@@ -252,8 +309,16 @@ void MainTask(void*) {
 
   Touchscreen& touchscreen = Common::GetTouchscreen();
   pw::touchscreen::TouchEvent last_touch_event;
+  const kudzu::TimingClock& timing_clock = Common::GetTimingClock();
+  static kudzu::GestureRecognizer gestures(timing_clock);
+  static pw::touchscreen::TouchFilter touch_filter(timing_clock);
+  // How long the last frame took from its start to reaching the panel, in
+  // timing clock ticks, as a guess at how long this one will.
+  uint32_t present_delay = 0;
 
   Buttons& kudzu_buttons = Common::GetButtons();
+  kudzu::imu::BatchImu& imu = Common::GetBatchImu();
+  static kudzu::imu::OrientationFilter orientation;
 
   float x_scale_offset = 0.0;
   float y_scale_offset = 0.0;
@@ -261,106 +326,172 @@ void MainTask(void*) {
   const float y_scale_increment = 0.7;
   // The display loop.
   while (1) {
+    const pw::chrono::SystemClock::time_point frame_start =
+        pw::chrono::SystemClock::now();
+    const uint32_t frame_start_ticks = timing_clock.now();
     frame_counter.StartFrame();
+    timeline.StartFrame();
 
     angle += angle_step;
     if (angle >= twopi) {
       angle = 0;
     }
 
-    pw::touchscreen::TouchEvent touch_event = touchscreen.GetTouchPoint();
-
-    framebuffer = display.GetFramebuffer();
-    PW_ASSERT(framebuffer.is_valid());
-    screen.data = (uint8_t*)framebuffer.data();
-
-    // Draw Phase
-    // Clear the screen
-    screen.pen = blit::Pen(0, 0, 0);
-    screen.clear();
-
-    // Mode switch button
-    blit::Size button_size(48, 36);
-    blit::Point button_position(screen.bounds.w - button_size.w, 0);
-    blit::Rect mode_button_rect(button_position, button_size);
-
-    kudzu_buttons.Update();
-    if (kudzu_buttons.Pressed(kudzu::button::a)) {
-      show_nametag = !show_nametag;
-    }
-    if (kudzu_buttons.Pressed(kudzu::button::b)) {
-      show_background = !show_background;
-    }
-    if (kudzu_buttons.Pressed(kudzu::button::start)) {
-      x_scale_offset = 0;
-      y_scale_offset = 0;
+    pw::touchscreen::TouchEvent touch_event;
+    {
+      kudzu::TimingScope scope(timeline, "touch");
+      touch_event = touch_filter.Filter(touchscreen.GetTouchPoint());
+      gestures.Update(touchscreen.GetContacts(), frame_start_ticks);
     }
-    if (kudzu_buttons.Held(kudzu::button::left)) {
-      y_scale_offset += y_scale_increment;
-    } else if (kudzu_buttons.Held(kudzu::button::right)) {
-      y_scale_offset -= y_scale_increment;
+
+    {
+      kudzu::TimingScope scope(timeline, "imu");
+      UpdateOrientation(imu, orientation);
     }
-    if (kudzu_buttons.Held(kudzu::button::up)) {
-      x_scale_offset += x_scale_increment;
-    } else if (kudzu_buttons.Held(kudzu::button::down)) {
-      x_scale_offset -= x_scale_increment;
+
+    {
+      kudzu::TimingScope scope(timeline, "acquire");
+      framebuffer = display.GetFramebuffer();
+      PW_ASSERT(framebuffer.is_valid());
     }
+    frame_counter.EndAcquire();
+    screen.data = (uint8_t*)framebuffer.data();
 
-    if (show_nametag) {
-      DrawNametag(framebuffer, screen);
-      // Draw button
-      screen.pen = blit::Pen(255, 255, 255);
-      screen.text("kudzu!",
-                  blit::minimal_font,
-                  mode_button_rect,
-                  true,
-                  blit::TextAlign::top_right);
-    } else {
-      if (show_background) {
-        DrawBackgroundColors(framebuffer);
+    // Draw Phase
+    {
+      kudzu::TimingScope draw_scope(timeline, "draw");
+      // Clear the screen
+      {
+        kudzu::TimingScope scope(timeline, "clear");
+        screen.pen = blit::Pen(0, 0, 0);
+        screen.clear();
       }
-      DrawKudzu(framebuffer, x_scale_offset, y_scale_offset);
-      DrawGreeting(framebuffer, screen);
-
-      // Draw button
-      screen.pen = blit::Pen(255, 0, 255);
-      screen.text("hello!",
-                  blit::minimal_font,
-                  mode_button_rect,
-                  true,
-                  blit::TextAlign::top_right);
-    }
 
-    if (touch_event.type == pw::touchscreen::TouchEventType::Start ||
-        touch_event.type == pw::touchscreen::TouchEventType::Drag) {
-      pw::draw::DrawCircle(framebuffer,
-                           touch_event.point.x,
-                           touch_event.point.y,
-                           18,
-                           kColorsPico8Rgb565[pw::color::kColorBlue],
-                           false);
-    }
-    if (last_touch_event.type == pw::touchscreen::TouchEventType::Drag &&
-        touch_event.type == pw::touchscreen::TouchEventType::Stop) {
-      PW_LOG_DEBUG("Touch Stop at: %d, %d",
-                   last_touch_event.point.x,
-                   last_touch_event.point.y);
-      if (mode_button_rect.contains(blit::Point(last_touch_event.point.x,
-                                                last_touch_event.point.y))) {
+      // Mode switch button
+      blit::Size button_size(48, 36);
+      blit::Point button_position(screen.bounds.w - button_size.w, 0);
+      blit::Rect mode_button_rect(button_position, button_size);
+
+      {
+        kudzu::TimingScope scope(timeline, "buttons");
+        kudzu_buttons.Update();
+      }
+      if (kudzu_buttons.Pressed(kudzu::button::a)) {
         show_nametag = !show_nametag;
       }
-    }
+      if (kudzu_buttons.Pressed(kudzu::button::b)) {
+        show_background = !show_background;
+      }
+      if (kudzu_buttons.Pressed(kudzu::button::start)) {
+        x_scale_offset = 0;
+        y_scale_offset = 0;
+      }
+      if (kudzu_buttons.Held(kudzu::button::left)) {
+        y_scale_offset += y_scale_increment;
+      } else if (kudzu_buttons.Held(kudzu::button::right)) {
+        y_scale_offset -= y_scale_increment;
+      }
+      // Swipe sideways or tap the mode button to switch screens, and double
+      // tap anywhere else to switch the background. The button takes taps
+      // rather than raw touches, so a swipe which ends on it only switches
+      // once.
+      while (std::optional<kudzu::GestureEvent> gesture = gestures.Pop()) {
+        PW_LOG_DEBUG("Gesture: %s at %d, %d",
+                     kudzu::GestureTypeName(gesture->type),
+                     gesture->point.x,
+                     gesture->point.y);
+        const bool on_mode_button = mode_button_rect.contains(
+            blit::Point(gesture->point.x, gesture->point.y));
+        if (gesture->type == kudzu::GestureType::kSwipe &&
+            (gesture->direction == kudzu::SwipeDirection::kLeft ||
+             gesture->direction == kudzu::SwipeDirection::kRight)) {
+          show_nametag = !show_nametag;
+        } else if ((gesture->type == kudzu::GestureType::kTap ||
+                    gesture->type == kudzu::GestureType::kDoubleTap) &&
+                   on_mode_button) {
+          show_nametag = !show_nametag;
+        } else if (gesture->type == kudzu::GestureType::kDoubleTap) {
+          show_background = !show_background;
+        }
+      }
+      if (kudzu_buttons.Held(kudzu::button::up)) {
+        x_scale_offset += x_scale_increment;
+      } else if (kudzu_buttons.Held(kudzu::button::down)) {
+        x_scale_offset -= x_scale_increment;
+      }
+
+      if (show_nametag) {
+        {
+          kudzu::TimingScope scope(timeline, "nametag");
+          DrawNametag(framebuffer, screen);
+        }
+        // Draw button
+        kudzu::TimingScope scope(timeline, "label");
+        DrawButtonLabel(framebuffer, "kudzu!", kKudzuLabelRamp);
+      } else {
+        if (show_background) {
+          kudzu::TimingScope scope(timeline, "background");
+          DrawBackgroundColors(framebuffer);
+        }
+        {
+          kudzu::TimingScope scope(timeline, "kudzu");
+          // Tilting the badge stretches the wave, as the d-pad does.
+          const kudzu::imu::Tilt tilt = orientation.tilt();
+          const float roll = static_cast<float>(tilt.roll >> 16);
+          const float pitch = static_cast<float>(tilt.pitch >> 16);
+          DrawKudzu(framebuffer,
+                    x_scale_offset + roll / kTiltDegreesPerPixel,
+                    y_scale_offset + pitch / kTiltDegreesPerPixel);
+        }
+        {
+          kudzu::TimingScope scope(timeline, "greeting");
+          DrawGreeting(framebuffer, screen);
+        }
+
+        // Draw button
+        kudzu::TimingScope scope(timeline, "label");
+        DrawButtonLabel(framebuffer, "hello!", kHelloLabelRamp);
+      }
 
-    last_touch_event = touch_event;
+      if (touch_event.type == pw::touchscreen::TouchEventType::Start ||
+          touch_event.type == pw::touchscreen::TouchEventType::Drag) {
+        // Draw where the finger will be when the frame is seen, not where it
+        // was read.
+        const pw::geometry::Vector3<int> predicted =
+            touch_filter.Predict(frame_start_ticks + present_delay);
+        pw::draw::DrawCircle(framebuffer,
+                             predicted.x,
+                             predicted.y,
+                             18,
+                             kColorsPico8Rgb565[pw::color::kColorBlue],
+                             false);
+      }
+      if (last_touch_event.type == pw::touchscreen::TouchEventType::Drag &&
+          touch_event.type == pw::touchscreen::TouchEventType::Stop) {
+        PW_LOG_DEBUG("Touch Stop at: %d, %d",
+                     last_touch_event.point.x,
+                     last_touch_event.point.y);
+      }
+
+      last_touch_event = touch_event;
+    }
 
     // Update timers
     frame_counter.EndDraw();
 
-    display.ReleaseFramebuffer(std::move(framebuffer));
+    {
+      kudzu::TimingScope scope(timeline, "flush");
+      display.ReleaseFramebuffer(std::move(framebuffer));
+    }
     frame_counter.EndFlush();
+    timeline.EndFrame();
+    present_delay = timing_clock.now() - frame_start_ticks;
 
     // Every second make a log message.
     frame_counter.LogTiming();
+
+    // Sleep out the rest of the frame when the board is saving power.
+    pw::this_thread::sleep_until(frame_start + Common::MinFramePeriod());
   }
 }
 
@@ -15,7 +15,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
 
 #include "libkudzu/random.h"
 #include "pw_assert/check.h"
@@ -61,7 +60,7 @@ void Game::OnFrame(pw::framebuffer::Framebuffer& framebuffer) {
   bool ate_fruit = false;
   auto current_time = pw::chrono::SystemClock::now();
   if (current_time > last_advance_time_ + time_per_advance_) {
-    std::lock_guard lock(lock_);
+    kudzu::trace::LockGuard lock(lock_, kLockName);
     snake_.Advance(fruit_, ate_fruit, crashed);
     last_advance_time_ = current_time;
   }
@@ -92,7 +91,7 @@ void Game::Draw(pw::framebuffer::Framebuffer& framebuffer) {
                      /*filled=*/true);
 
   // Draw Snake.
-  std::lock_guard lock(lock_);
+  kudzu::trace::LockGuard lock(lock_, kLockName);
   snake_.Draw([&framebuffer](const Block& block) {
     pw::draw::DrawRect(framebuffer,
                        kPixelBoxRatio * block.x,
@@ -105,7 +104,7 @@ void Game::Draw(pw::framebuffer::Framebuffer& framebuffer) {
 }
 
 void Game::SetNextFruitCoordinates() {
-  std::lock_guard lock(lock_);
+  kudzu::trace::LockGuard lock(lock_, kLockName);
   do {
     fruit_.x = GetRandomInteger(screen_width_);
     fruit_.y = GetRandomInteger(screen_height_);
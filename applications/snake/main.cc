@@ -11,6 +11,7 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <chrono>
 #include <cstdint>
 
 #define PW_LOG_MODULE_NAME "SnakeGame"
@@ -20,9 +21,11 @@
 #include "graphics/surface.hpp"
 #include "libkudzu/framecounter.h"
 #include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_display/display.h"
 #include "pw_framebuffer/framebuffer.h"
 #include "pw_log/log.h"
+#include "pw_result/result.h"
 #include "pw_system/target_hooks.h"
 #include "pw_system/work_queue.h"
 #include "pw_thread/detached_thread.h"
@@ -33,9 +36,13 @@
 
 namespace {
 
-class PollingTouchButtonsThread : public pw::thread::ThreadCore {
+// Long enough that an idle touchscreen costs nothing, since the thread only
+// loops to wait again.
+constexpr auto kTouchWaitTimeout = std::chrono::seconds(1);
+
+class TouchButtonsThread : public pw::thread::ThreadCore {
  public:
-  PollingTouchButtonsThread(
+  TouchButtonsThread(
       pw::touchscreen::Touchscreen& touchscreen,
       pw::touchscreen::DirectionButtonListener& button_listener,
       int32_t display_width,
@@ -45,8 +52,12 @@ class PollingTouchButtonsThread : public pw::thread::ThreadCore {
 
   void Run() override {
     while (true) {
-      pw::touchscreen::TouchEvent touch_event = touchscreen_.GetTouchPoint();
-      buttons_.OnTouchEvent(touch_event);
+      pw::Result<pw::touchscreen::TouchEvent> touch_event =
+          touchscreen_.WaitForTouchEvent(
+              pw::chrono::SystemClock::for_at_least(kTouchWaitTimeout));
+      if (touch_event.ok()) {
+        buttons_.OnTouchEvent(*touch_event);
+      }
     }
   }
 
@@ -74,7 +85,7 @@ void MainTask(void*) {
   display.ReleaseFramebuffer(std::move(framebuffer));
 
   snake::Game game(display_width, display_height);
-  PollingTouchButtonsThread touch_buttons_thread{
+  TouchButtonsThread touch_buttons_thread{
       Common::GetTouchscreen(), game, display_width, display_height};
   pw::thread::DetachedThread(Common::TouchscreenThreadOptions(),
                              touch_buttons_thread);
@@ -82,13 +93,14 @@ void MainTask(void*) {
   game.Start();
 
   // Display and app loop.
-  kudzu::FrameCounter frame_counter = kudzu::FrameCounter();
+  static kudzu::FrameCounter frame_counter(Common::GetTimingClock());
   while (true) {
     frame_counter.StartFrame();
 
     // Get frame buffer.
     framebuffer = display.GetFramebuffer();
     PW_CHECK(framebuffer.is_valid());
+    frame_counter.EndAcquire();
     screen.data = static_cast<uint8_t*>(framebuffer.data());
     // Clear the screen
     screen.pen = blit::Pen(0, 0, 0);
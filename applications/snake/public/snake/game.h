@@ -14,8 +14,8 @@
 #pragma once
 
 #include <cstddef>
-#include <mutex>
 
+#include "libkudzu/trace.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_color/colors_pico8.h"
 #include "pw_framebuffer/framebuffer.h"
@@ -38,7 +38,7 @@ class Game : public pw::touchscreen::DirectionButtonListener {
     if (!pressed) {
       return;
     }
-    std::lock_guard lock(lock_);
+    kudzu::trace::LockGuard lock(lock_, kLockName);
     snake_.ChangeDirection(Snake::Direction::kUp);
   }
 
@@ -46,7 +46,7 @@ class Game : public pw::touchscreen::DirectionButtonListener {
     if (!pressed) {
       return;
     }
-    std::lock_guard lock(lock_);
+    kudzu::trace::LockGuard lock(lock_, kLockName);
     snake_.ChangeDirection(Snake::Direction::kDown);
   }
 
@@ -54,7 +54,7 @@ class Game : public pw::touchscreen::DirectionButtonListener {
     if (!pressed) {
       return;
     }
-    std::lock_guard lock(lock_);
+    kudzu::trace::LockGuard lock(lock_, kLockName);
     snake_.ChangeDirection(Snake::Direction::kLeft);
   }
 
@@ -62,7 +62,7 @@ class Game : public pw::touchscreen::DirectionButtonListener {
     if (!pressed) {
       return;
     }
-    std::lock_guard lock(lock_);
+    kudzu::trace::LockGuard lock(lock_, kLockName);
     snake_.ChangeDirection(Snake::Direction::kRight);
   }
 
@@ -72,6 +72,8 @@ class Game : public pw::touchscreen::DirectionButtonListener {
  private:
   static constexpr size_t kMaxSnakeSize = 100;
   static constexpr uint16_t kPixelBoxRatio = 2;
+  // Waits for lock_ are traced under this name.
+  static constexpr const char* kLockName = "snake::Game::lock_";
 
   // Draws the game objects.
   void Draw(pw::framebuffer::Framebuffer& framebuffer) PW_LOCKS_EXCLUDED(lock_);
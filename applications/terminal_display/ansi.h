@@ -14,21 +14,65 @@
 
 #pragma once
 
-#include <cctype>
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "pw_containers/vector.h"
+#include "pw_span/span.h"
 
+// Decodes a stream of text containing ANSI escape sequences. Plain text is
+// passed to EmitChars() and recognized control sequences are translated into
+// calls to the virtual color, cursor and erase hooks below.
+//
+// Supported CSI sequences:
+//   SGR (m): 0, 30-37, 39, 40-47, 49, 90-97, 100-107, 38;5;n, 48;5;n,
+//            38;2;r;g;b and 48;2;r;g;b.
+//   Cursor:  A (up), B (down), C (forward), D (back), E (next line),
+//            F (previous line), G (column), H and f (position).
+//   Erase:   J (erase in display), K (erase in line).
+//
+// Anything else is consumed and ignored. Sequences with more than
+// kMaxParams parameters have the extra parameters dropped.
 class AnsiDecoder {
  public:
-  AnsiDecoder()
-      : state_(State::kNormal), cur_val_(0), params_(), buffered_chars_() {}
+  // The region cleared by the erase-in-line and erase-in-display commands.
+  enum class EraseMode {
+    kToEnd = 0,
+    kToStart = 1,
+    kAll = 2,
+  };
+
+  AnsiDecoder() : state_(State::kNormal), cur_val_(0), params_() {}
+  virtual ~AnsiDecoder() = default;
+
+  // Decode a block of characters. Runs of plain text between escape sequences
+  // are passed to EmitChars() as a single span rather than character by
+  // character.
+  void ProcessChars(pw::span<const char> chars) {
+    const char* pos = chars.data();
+    const char* const end = pos + chars.size();
+    while (pos < end) {
+      if (state_ == State::kNormal) {
+        const void* esc = std::memchr(pos, kEscapeChar, end - pos);
+        const char* run_end = esc != nullptr ? static_cast<const char*>(esc)
+                                             : end;
+        if (run_end != pos) {
+          EmitChars(pw::span<const char>(pos, run_end - pos));
+          pos = run_end;
+          continue;
+        }
+      }
+      ProcessChar(*pos++);
+    }
+  }
 
+  // Decode a single character.
   void ProcessChar(char c) {
     switch (state_) {
       case State::kNormal:
         if (c == kEscapeChar) {
-          buffered_chars_.push_back(c);
           state_ = State::kEscape;
         } else {
           EmitChar(c);
@@ -36,40 +80,70 @@ class AnsiDecoder {
         break;
 
       case State::kEscape:
-        buffered_chars_.push_back(c);
         if (c == kCsiChar) {
+          StartCsi();
           state_ = State::kCsi;
         } else {
-          Error();
+          Error(c);
         }
         break;
 
       case State::kCsi:
-        buffered_chars_.push_back(c);
-
-        if (std::isdigit(c)) {
-          cur_val_ *= 10;
-          cur_val_ += static_cast<int>(c - '0');
+        if (c >= '0' && c <= '9') {
+          // Saturate rather than overflow on absurdly long numbers.
+          cur_val_ = std::min(cur_val_ * 10 + static_cast<int>(c - '0'),
+                              kMaxParamValue);
         } else if (c == ';') {
           PushParam();
-        } else {
+        } else if (c >= 0x3c && c <= 0x3f) {
+          // Private parameter prefix ('<', '=', '>' or '?'). Consume the
+          // sequence but don't act on it.
+          private_sequence_ = true;
+        } else if (c >= 0x20 && c <= 0x2f) {
+          // Intermediate bytes are not used by any supported command.
+          private_sequence_ = true;
+        } else if (c >= 0x40 && c <= 0x7e) {
           PushParam();
-          HandleCsiCommand(c);
+          if (!private_sequence_) {
+            HandleCsiCommand(c);
+          }
+          state_ = State::kNormal;
+        } else {
+          // Control characters abort the sequence.
           state_ = State::kNormal;
         }
-
         break;
     }
   }
 
  protected:
-  virtual void SetFgColor(uint8_t r, uint8_t g, uint8_t b) {}
-  virtual void SetBgColor(uint8_t r, uint8_t g, uint8_t b) {}
-  virtual void EmitChar(char c) {}
+  virtual void SetFgColor(uint8_t /*r*/, uint8_t /*g*/, uint8_t /*b*/) {}
+  virtual void SetBgColor(uint8_t /*r*/, uint8_t /*g*/, uint8_t /*b*/) {}
+  virtual void EmitChar(char /*c*/) {}
+
+  // Emit a run of plain text. The default implementation forwards each
+  // character to EmitChar().
+  virtual void EmitChars(pw::span<const char> chars) {
+    for (char c : chars) {
+      EmitChar(c);
+    }
+  }
+
+  // Move the cursor relative to its current position. Positive values move
+  // right and down.
+  virtual void MoveCursor(int /*dx*/, int /*dy*/) {}
+  // Move the cursor to a zero-based column in the current row.
+  virtual void SetCursorColumn(int /*column*/) {}
+  // Move the cursor to a zero-based row and column.
+  virtual void SetCursorPosition(int /*row*/, int /*column*/) {}
+  virtual void EraseInLine(EraseMode /*mode*/) {}
+  virtual void EraseInDisplay(EraseMode /*mode*/) {}
 
  private:
   static constexpr char kEscapeChar = '\e';
   static constexpr char kCsiChar = '[';
+  static constexpr size_t kMaxParams = 16;
+  static constexpr int kMaxParamValue = 9999;
 
   enum State {
     kNormal,
@@ -79,24 +153,95 @@ class AnsiDecoder {
 
   State state_;
   int cur_val_;
-  pw::Vector<int, 10> params_;
-  pw::Vector<char, 10> buffered_chars_;
+  bool private_sequence_ = false;
+  pw::Vector<int, kMaxParams> params_;
+
+  void StartCsi() {
+    params_.clear();
+    cur_val_ = 0;
+    private_sequence_ = false;
+  }
 
   void PushParam() {
-    params_.push_back(cur_val_);
+    if (!params_.full()) {
+      params_.push_back(cur_val_);
+    }
     cur_val_ = 0;
   }
 
+  // Return the parameter at index, or default_value if it was omitted or zero.
+  int ParamOr(size_t index, int default_value) const {
+    if (index >= params_.size() || params_[index] == 0) {
+      return default_value;
+    }
+    return params_[index];
+  }
+
   void HandleCsiCommand(char c) {
     switch (c) {
       case 'm':
-        for (auto param : params_) {
-          HandleSetColor(param);
+        HandleSgr();
+        break;
+      case 'A':
+        MoveCursor(0, -ParamOr(0, 1));
+        break;
+      case 'B':
+        MoveCursor(0, ParamOr(0, 1));
+        break;
+      case 'C':
+        MoveCursor(ParamOr(0, 1), 0);
+        break;
+      case 'D':
+        MoveCursor(-ParamOr(0, 1), 0);
+        break;
+      case 'E':
+        MoveCursor(0, ParamOr(0, 1));
+        SetCursorColumn(0);
+        break;
+      case 'F':
+        MoveCursor(0, -ParamOr(0, 1));
+        SetCursorColumn(0);
+        break;
+      case 'G':
+        SetCursorColumn(ParamOr(0, 1) - 1);
+        break;
+      case 'H':
+      case 'f':
+        SetCursorPosition(ParamOr(0, 1) - 1, ParamOr(1, 1) - 1);
+        break;
+      case 'J': {
+        EraseMode mode;
+        if (ToEraseMode(params_[0], mode)) {
+          EraseInDisplay(mode);
+        }
+        break;
+      }
+      case 'K': {
+        EraseMode mode;
+        if (ToEraseMode(params_[0], mode)) {
+          EraseInLine(mode);
         }
         break;
+      }
     }
+  }
 
-    params_.clear();
+  // Convert an erase command parameter to an EraseMode. Returns false if the
+  // value is not a known mode.
+  static bool ToEraseMode(int val, EraseMode& mode) {
+    switch (val) {
+      case 0:
+        mode = EraseMode::kToEnd;
+        return true;
+      case 1:
+        mode = EraseMode::kToStart;
+        return true;
+      case 2:
+      case 3:  // Also clear scrollback, which there is none of.
+        mode = EraseMode::kAll;
+        return true;
+    }
+    return false;
   }
 
   struct Color {
@@ -127,16 +272,89 @@ class AnsiDecoder {
       {.r = 255, .g = 255, .b = 255},  // White
   };
 
-  void HandleSetColor(int val) {
-    if (val < 0) {
-      return;
+  static constexpr Color kDefaultFgColor = kNormalColors[7];
+  static constexpr Color kDefaultBgColor = kNormalColors[0];
+
+  // Intensity steps of the 6x6x6 color cube in the xterm 256 color palette.
+  static constexpr uint8_t kCubeLevels[6] = {0, 95, 135, 175, 215, 255};
+
+  // Convert an xterm 256 color palette index into a color.
+  static Color PaletteColor(int index) {
+    if (index < 8) {
+      return kNormalColors[index];
     }
+    if (index < 16) {
+      return kBrightColors[index - 8];
+    }
+    if (index < 232) {
+      index -= 16;
+      return {.r = kCubeLevels[index / 36],
+              .g = kCubeLevels[(index / 6) % 6],
+              .b = kCubeLevels[index % 6]};
+    }
+    const uint8_t gray = static_cast<uint8_t>(8 + (index - 232) * 10);
+    return {.r = gray, .g = gray, .b = gray};
+  }
+
+  static uint8_t ClampChannel(int val) {
+    return static_cast<uint8_t>(val > 255 ? 255 : val);
+  }
 
+  void SetColor(bool foreground, Color color) {
+    if (foreground) {
+      SetFgColor(color.r, color.g, color.b);
+    } else {
+      SetBgColor(color.r, color.g, color.b);
+    }
+  }
+
+  // Handle an extended color (38 or 48) starting at params_[i]. Returns the
+  // number of parameters consumed.
+  size_t HandleExtendedColor(size_t i, bool foreground) {
+    const size_t remaining = params_.size() - i;
+    if (remaining >= 3 && params_[i + 1] == 5) {
+      if (params_[i + 2] <= 255) {
+        SetColor(foreground, PaletteColor(params_[i + 2]));
+      }
+      return 3;
+    }
+    if (remaining >= 5 && params_[i + 1] == 2) {
+      SetColor(foreground,
+               {.r = ClampChannel(params_[i + 2]),
+                .g = ClampChannel(params_[i + 3]),
+                .b = ClampChannel(params_[i + 4])});
+      return 5;
+    }
+    // Malformed; ignore the rest of the sequence.
+    return remaining;
+  }
+
+  void HandleSgr() {
+    size_t i = 0;
+    while (i < params_.size()) {
+      const int val = params_[i];
+      if (val == 38 || val == 48) {
+        i += HandleExtendedColor(i, val == 38);
+      } else {
+        HandleSetColor(val);
+        i++;
+      }
+    }
+  }
+
+  void HandleSetColor(int val) {
     if (val == 0) {
-      auto fg_color = kNormalColors[7];
-      auto bg_color = kNormalColors[0];
-      SetBgColor(bg_color.r, bg_color.g, bg_color.b);
-      SetFgColor(fg_color.r, fg_color.g, fg_color.b);
+      SetColor(/*foreground=*/false, kDefaultBgColor);
+      SetColor(/*foreground=*/true, kDefaultFgColor);
+      return;
+    }
+    if (val == 39) {
+      SetColor(/*foreground=*/true, kDefaultFgColor);
+      return;
+    }
+    if (val == 49) {
+      SetColor(/*foreground=*/false, kDefaultBgColor);
+      return;
     }
 
     auto color_index = val % 10;
@@ -147,39 +365,37 @@ class AnsiDecoder {
     }
 
     switch (color_loc) {
-      case 3: {
-        auto color = kNormalColors[color_index];
-        SetFgColor(color.r, color.g, color.b);
+      case 3:
+        SetColor(/*foreground=*/true, kNormalColors[color_index]);
         break;
-      }
 
-      case 4: {
-        auto color = kNormalColors[color_index];
-        SetBgColor(color.r, color.g, color.b);
+      case 4:
+        SetColor(/*foreground=*/false, kNormalColors[color_index]);
         break;
-      }
 
-      case 9: {
-        auto color = kBrightColors[color_index];
-        SetFgColor(color.r, color.g, color.b);
+      case 9:
+        SetColor(/*foreground=*/true, kBrightColors[color_index]);
         break;
-      }
 
-      case 10: {
-        auto color = kBrightColors[color_index];
-        SetBgColor(color.r, color.g, color.b);
+      case 10:
+        SetColor(/*foreground=*/false, kBrightColors[color_index]);
         break;
-      }
 
       default:
         break;
     }
   }
 
-  void Error() {
-    for (auto c : buffered_chars_) {
+  // Called when an escape character is followed by anything other than a CSI
+  // introducer. The characters are emitted as plain text.
+  void Error(char c) {
+    state_ = State::kNormal;
+    EmitChar(kEscapeChar);
+    if (c == kEscapeChar) {
+      // The second escape may start a valid sequence.
+      state_ = State::kEscape;
+    } else {
       EmitChar(c);
     }
-    buffered_chars_.clear();
   }
 };
@@ -0,0 +1,126 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures AnsiDecoder throughput in MB/s for both the per-character and the
+// bulk input paths. Results are logged once at startup; build it with the
+// host_device_simulator toolchain to get desktop numbers.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+#define PW_LOG_MODULE_NAME "AnsiBench"
+
+#include "ansi.h"
+#include "app_common/common.h"
+#include "pw_log/log.h"
+#include "pw_span/span.h"
+#include "pw_system/target_hooks.h"
+#include "pw_thread/detached_thread.h"
+
+namespace {
+
+constexpr size_t kInputBytes = 64 * 1024;
+constexpr int kIterations = 32;
+
+// A decoder which does the minimum amount of work per callback so the
+// benchmark measures the decoder itself.
+class CountingDecoder : public AnsiDecoder {
+ public:
+  uint32_t chars() const { return chars_; }
+
+ protected:
+  void SetFgColor(uint8_t r, uint8_t g, uint8_t b) override { color_ ^= r; }
+  void SetBgColor(uint8_t r, uint8_t g, uint8_t b) override { color_ ^= b; }
+  void EmitChar(char c) override { chars_ += static_cast<uint8_t>(c) != 0; }
+  void EmitChars(pw::span<const char> chars) override {
+    chars_ += chars.size();
+  }
+
+ private:
+  uint32_t chars_ = 0;
+  uint8_t color_ = 0;
+};
+
+// Log-like text: a colored level prefix followed by a plain message.
+char s_input[kInputBytes];
+
+void FillInput() {
+  constexpr std::string_view kLines[] = {
+      "\e[31mERR\e[0m  There was an error on our last operation\n",
+      "\e[33mWRN\e[0m  Looks like something is amiss; consider investigating\n",
+      "\e[32mINF\e[0m  The operation went as expected\n",
+      "\e[38;5;244mDBG\e[0m  Debug output\n",
+      "\e[38;2;255;128;0mINF\e[0m  \e[2KTruecolor with an erase\n",
+  };
+  size_t pos = 0;
+  size_t line = 0;
+  while (pos < kInputBytes) {
+    for (char c : kLines[line % std::size(kLines)]) {
+      if (pos == kInputBytes) {
+        break;
+      }
+      s_input[pos++] = c;
+    }
+    line++;
+  }
+}
+
+float MegabytesPerSecond(std::chrono::steady_clock::duration elapsed) {
+  const float seconds =
+      std::chrono::duration_cast<std::chrono::duration<float>>(elapsed)
+          .count();
+  const float megabytes =
+      static_cast<float>(kInputBytes) * kIterations / (1024.0f * 1024.0f);
+  return seconds > 0 ? megabytes / seconds : 0;
+}
+
+void BenchmarkTask(void*) {
+  FillInput();
+
+  CountingDecoder per_char_decoder;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    for (char c : s_input) {
+      per_char_decoder.ProcessChar(c);
+    }
+  }
+  const auto per_char_elapsed = std::chrono::steady_clock::now() - start;
+
+  CountingDecoder bulk_decoder;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    bulk_decoder.ProcessChars(s_input);
+  }
+  const auto bulk_elapsed = std::chrono::steady_clock::now() - start;
+
+  PW_LOG_INFO("ProcessChar:  %d MB/s (%u chars)",
+              static_cast<int>(MegabytesPerSecond(per_char_elapsed)),
+              static_cast<unsigned>(per_char_decoder.chars()));
+  PW_LOG_INFO("ProcessChars: %d MB/s (%u chars)",
+              static_cast<int>(MegabytesPerSecond(bulk_elapsed)),
+              static_cast<unsigned>(bulk_decoder.chars()));
+}
+
+}  // namespace
+
+namespace pw::system {
+
+void UserAppInit() {
+  pw::thread::DetachedThread(Common::DisplayDrawThreadOptions(), BenchmarkTask);
+}
+
+}  // namespace pw::system
@@ -0,0 +1,198 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "ansi.h"
+
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_span/span.h"
+
+namespace {
+
+struct Rgb {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+
+  bool operator==(const Rgb& other) const {
+    return r == other.r && g == other.g && b == other.b;
+  }
+};
+
+// Records every callback made by the decoder.
+class RecordingDecoder : public AnsiDecoder {
+ public:
+  void Process(std::string_view text) {
+    ProcessChars(pw::span<const char>(text.data(), text.size()));
+  }
+
+  std::string text;
+  int emit_chars_calls = 0;
+  Rgb fg;
+  Rgb bg;
+  int dx = 0;
+  int dy = 0;
+  int row = -1;
+  int column = -1;
+  int erase_line_calls = 0;
+  int erase_display_calls = 0;
+  EraseMode last_erase_mode = EraseMode::kToEnd;
+
+ protected:
+  void SetFgColor(uint8_t r, uint8_t g, uint8_t b) override { fg = {r, g, b}; }
+  void SetBgColor(uint8_t r, uint8_t g, uint8_t b) override { bg = {r, g, b}; }
+  void EmitChar(char c) override { text.push_back(c); }
+  void EmitChars(pw::span<const char> chars) override {
+    emit_chars_calls++;
+    text.append(chars.data(), chars.size());
+  }
+  void MoveCursor(int x, int y) override {
+    dx += x;
+    dy += y;
+  }
+  void SetCursorColumn(int col) override { column = col; }
+  void SetCursorPosition(int r, int col) override {
+    row = r;
+    column = col;
+  }
+  void EraseInLine(EraseMode mode) override {
+    erase_line_calls++;
+    last_erase_mode = mode;
+  }
+  void EraseInDisplay(EraseMode mode) override {
+    erase_display_calls++;
+    last_erase_mode = mode;
+  }
+};
+
+TEST(AnsiDecoderTest, PlainTextEmittedAsOneRun) {
+  RecordingDecoder decoder;
+  decoder.Process("Hello, world!");
+  EXPECT_EQ("Hello, world!", decoder.text);
+  EXPECT_EQ(1, decoder.emit_chars_calls);
+}
+
+TEST(AnsiDecoderTest, RunsSplitAroundEscapes) {
+  RecordingDecoder decoder;
+  decoder.Process("abc\e[31mdef\e[0mghi");
+  EXPECT_EQ("abcdefghi", decoder.text);
+  EXPECT_EQ(3, decoder.emit_chars_calls);
+  EXPECT_EQ((Rgb{0, 0, 0}), decoder.bg);
+  EXPECT_EQ((Rgb{170, 170, 170}), decoder.fg);
+}
+
+TEST(AnsiDecoderTest, SequenceSplitAcrossCalls) {
+  RecordingDecoder decoder;
+  decoder.Process("a\e[9");
+  decoder.Process("1mb");
+  EXPECT_EQ("ab", decoder.text);
+  EXPECT_EQ((Rgb{255, 85, 85}), decoder.fg);
+}
+
+TEST(AnsiDecoderTest, BasicColors) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[32;104m");
+  EXPECT_EQ((Rgb{0, 170, 0}), decoder.fg);
+  EXPECT_EQ((Rgb{85, 85, 255}), decoder.bg);
+}
+
+TEST(AnsiDecoderTest, Palette256Colors) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[38;5;9m");
+  EXPECT_EQ((Rgb{255, 85, 85}), decoder.fg);
+
+  // Color cube: 16 + 36 * 5 + 6 * 0 + 1 = 197.
+  decoder.Process("\e[48;5;197m");
+  EXPECT_EQ((Rgb{255, 0, 95}), decoder.bg);
+
+  // Grayscale ramp.
+  decoder.Process("\e[38;5;255m");
+  EXPECT_EQ((Rgb{238, 238, 238}), decoder.fg);
+}
+
+TEST(AnsiDecoderTest, TrueColor) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[38;2;1;2;3;48;2;250;251;252m");
+  EXPECT_EQ((Rgb{1, 2, 3}), decoder.fg);
+  EXPECT_EQ((Rgb{250, 251, 252}), decoder.bg);
+}
+
+TEST(AnsiDecoderTest, CursorMovement) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[A\e[3B\e[5C\e[2D");
+  EXPECT_EQ(3, decoder.dx);
+  EXPECT_EQ(2, decoder.dy);
+
+  decoder.Process("\e[4;7H");
+  EXPECT_EQ(3, decoder.row);
+  EXPECT_EQ(6, decoder.column);
+
+  decoder.Process("\e[H");
+  EXPECT_EQ(0, decoder.row);
+  EXPECT_EQ(0, decoder.column);
+
+  decoder.Process("\e[12G");
+  EXPECT_EQ(11, decoder.column);
+}
+
+TEST(AnsiDecoderTest, Erase) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[K");
+  EXPECT_EQ(1, decoder.erase_line_calls);
+  EXPECT_EQ(AnsiDecoder::EraseMode::kToEnd, decoder.last_erase_mode);
+
+  decoder.Process("\e[2J");
+  EXPECT_EQ(1, decoder.erase_display_calls);
+  EXPECT_EQ(AnsiDecoder::EraseMode::kAll, decoder.last_erase_mode);
+
+  decoder.Process("\e[1K");
+  EXPECT_EQ(2, decoder.erase_line_calls);
+  EXPECT_EQ(AnsiDecoder::EraseMode::kToStart, decoder.last_erase_mode);
+}
+
+TEST(AnsiDecoderTest, LongSequenceDoesNotOverflow) {
+  RecordingDecoder decoder;
+  std::string sequence = "\e[";
+  for (int i = 0; i < 100; i++) {
+    sequence += "31;";
+  }
+  sequence += "99999999999999999999m";
+  decoder.Process(sequence);
+  decoder.Process("ok");
+  EXPECT_EQ("ok", decoder.text);
+  EXPECT_EQ((Rgb{170, 0, 0}), decoder.fg);
+}
+
+TEST(AnsiDecoderTest, ParametersSaturate) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[123456G");
+  EXPECT_EQ(9998, decoder.column);
+}
+
+TEST(AnsiDecoderTest, PrivateSequencesIgnored) {
+  RecordingDecoder decoder;
+  decoder.Process("\e[?25lA\e[?25h");
+  EXPECT_EQ("A", decoder.text);
+  EXPECT_EQ(0, decoder.erase_line_calls);
+}
+
+TEST(AnsiDecoderTest, InvalidEscapeEmitted) {
+  RecordingDecoder decoder;
+  decoder.Process("\eXabc");
+  EXPECT_EQ("\eXabc", decoder.text);
+}
+
+}  // namespace
@@ -24,6 +24,8 @@
 #include "ansi.h"
 #include "app_common/common.h"
 #include "libkudzu/framecounter.h"
+#include "libkudzu/log_queue.h"
+#include "libkudzu/log_tee.h"
 #include "pw_assert/assert.h"
 #include "pw_assert/check.h"
 #include "pw_color/color.h"
@@ -37,9 +39,8 @@
 #include "pw_geometry/vector2.h"
 #include "pw_geometry/vector3.h"
 #include "pw_log/log.h"
-#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+#include "pw_span/span.h"
 #include "pw_string/string_builder.h"
-#include "pw_sys_io/sys_io.h"
 #include "pw_system/target_hooks.h"
 #include "pw_thread/detached_thread.h"
 #include "pw_touchscreen/touchscreen.h"
@@ -73,6 +74,52 @@ class DemoDecoder : public AnsiDecoder {
   void EmitChar(char c) override {
     log_text_buffer_.DrawCharacter(TextBuffer::Char{c, fg_color_, bg_color_});
   }
+  void EmitChars(pw::span<const char> chars) override {
+    const color_rgb565_t fg_color = fg_color_;
+    const color_rgb565_t bg_color = bg_color_;
+    for (char c : chars) {
+      log_text_buffer_.DrawCharacter(TextBuffer::Char{c, fg_color, bg_color});
+    }
+  }
+  void MoveCursor(int dx, int dy) override {
+    Vector2<int> cursor = log_text_buffer_.GetCursor();
+    log_text_buffer_.SetCursor({cursor.x + dx, cursor.y + dy});
+  }
+  void SetCursorColumn(int column) override {
+    log_text_buffer_.SetCursor({column, log_text_buffer_.GetCursor().y});
+  }
+  void SetCursorPosition(int row, int column) override {
+    log_text_buffer_.SetCursor({column, row});
+  }
+  void EraseInLine(EraseMode mode) override {
+    const Vector2<int> cursor = log_text_buffer_.GetCursor();
+    switch (mode) {
+      case EraseMode::kToEnd:
+        log_text_buffer_.ClearRange(cursor, {0, cursor.y + 1});
+        break;
+      case EraseMode::kToStart:
+        log_text_buffer_.ClearRange({0, cursor.y}, {cursor.x + 1, cursor.y});
+        break;
+      case EraseMode::kAll:
+        log_text_buffer_.ClearRange({0, cursor.y}, {0, cursor.y + 1});
+        break;
+    }
+  }
+  void EraseInDisplay(EraseMode mode) override {
+    const Vector2<int> cursor = log_text_buffer_.GetCursor();
+    const Size<int> size = log_text_buffer_.GetSize();
+    switch (mode) {
+      case EraseMode::kToEnd:
+        log_text_buffer_.ClearRange(cursor, {0, size.height});
+        break;
+      case EraseMode::kToStart:
+        log_text_buffer_.ClearRange({0, 0}, {cursor.x + 1, cursor.y});
+        break;
+      case EraseMode::kAll:
+        log_text_buffer_.Clear();
+        break;
+    }
+  }
 
  private:
   color_rgb565_t fg_color_ = kWhite;
@@ -101,6 +148,12 @@ constexpr int kButtonWidth = 108;
 constexpr Vector2<int> kButtonTL = {320 - kButtonWidth, 0};
 constexpr Size<int> kButtonSize = {kButtonWidth, 12};
 
+// Formatted log lines waiting to be decoded into s_log_text_buffer. Filled by
+// LogCallback on whichever thread logged and drained by the draw thread.
+constexpr size_t kLogQueueLines = 32;
+constexpr size_t kLogQueueLineLength = 128;
+kudzu::LogQueue<kLogQueueLines, kLogQueueLineLength> s_log_queue;
+
 TextBuffer s_log_text_buffer;
 DemoDecoder s_demo_decoder(s_log_text_buffer);
 Button g_button(kButtonLabel, kButtonTL, kButtonSize);
@@ -176,15 +229,34 @@ Vector2<int> DrawColorFontSheet(Vector2<int> tl,
   return max_extents;
 }
 
-// The logging callback used to capture log messages sent to pw_log.
-void LogCallback(std::string_view log) {
-  for (auto c : log) {
-    s_demo_decoder.ProcessChar(c);
-  }
+// Receives every pw_log message through the log tee. This may run on any
+// thread, so it only copies the line into s_log_queue and never touches the
+// text buffer or waits on the draw thread. The log backend still sends the
+// message out as usual.
+void LogCallback(std::string_view log) { s_log_queue.Push(log); }
+
+void DecodeLine(std::string_view line) {
+  s_demo_decoder.ProcessChars(pw::span<const char>(line.data(), line.size()));
   s_demo_decoder.ProcessChar('\n');
+}
 
-  pw::sys_io::WriteLine(log).IgnoreError();
-};
+// Decode queued log lines into the text buffer. Called once per frame from the
+// draw thread.
+void DrainLogQueue() {
+  s_log_queue.Drain(DecodeLine);
+
+  // Written straight to the text buffer, since logging it would only queue
+  // another line behind the ones which didn't fit.
+  static uint32_t last_dropped_lines = 0;
+  const uint32_t dropped_lines = s_log_queue.dropped_lines();
+  if (dropped_lines != last_dropped_lines) {
+    pw::StringBuffer<64> notice;
+    notice.Format("\e[33mWRN\e[0m Log queue full, %u lines dropped",
+                  static_cast<unsigned>(dropped_lines - last_dropped_lines));
+    DecodeLine(notice.view());
+    last_dropped_lines = dropped_lines;
+  }
+}
 
 // Draw the Pigweed sprite and artwork at the top of the display.
 // Returns the bottom Y coordinate drawn.
@@ -391,10 +463,10 @@ void CreateDemoLogMessages() {
 }
 
 void MainTask(void*) {
-  kudzu::FrameCounter frame_counter = kudzu::FrameCounter();
+  static kudzu::FrameCounter frame_counter(Common::GetTimingClock());
 
-  // TODO(tonymd): Is there a way to hook this up outside of log_basic?
-  // pw::log_basic::SetOutput(LogCallback);
+  // LogCallback only enqueues, so it is safe to install for every thread.
+  kudzu::SetLogTeeOutput(LogCallback);
 
   PW_CHECK_OK(Common::Init());
 
@@ -416,7 +488,9 @@ void MainTask(void*) {
 
     framebuffer = display.GetFramebuffer();
     PW_ASSERT(framebuffer.is_valid());
+    frame_counter.EndAcquire();
     pw::draw::Fill(framebuffer, kBlack);
+    DrainLogQueue();
     DrawFrame(framebuffer);
 
     // Update timers
@@ -14,6 +14,8 @@
 
 #include "text_buffer.h"
 
+#include <algorithm>
+
 using pw::color::color_rgb565_t;
 using pw::geometry::Vector2;
 
@@ -66,6 +68,30 @@ void TextBuffer::DrawCharacter(const Char& ch) {
   cursor_.x++;
 }
 
+void TextBuffer::SetCursor(Vector2<int> loc) {
+  cursor_.x = std::clamp(loc.x, 0, kMaxColIdx);
+  cursor_.y = std::clamp(loc.y, 0, kMaxRowIdx);
+}
+
+void TextBuffer::ClearRange(Vector2<int> start, Vector2<int> end) {
+  constexpr int kNumChars = kNumCharsWide * kNumRows;
+  const int start_idx =
+      std::clamp(start.y * static_cast<int>(kNumCharsWide) + start.x,
+                 0,
+                 kNumChars);
+  const int end_idx = std::clamp(
+      end.y * static_cast<int>(kNumCharsWide) + end.x, 0, kNumChars);
+  for (int i = start_idx; i < end_idx; i++) {
+    text_rows_[i / kNumCharsWide].chars[i % kNumCharsWide].Reset();
+  }
+}
+
+void TextBuffer::Clear() {
+  for (TextRow& row : text_rows_) {
+    row.Clear();
+  }
+}
+
 void TextBuffer::ScrollUp() {
   for (size_t r = 0; r < kMaxRowIdx; r++) {
     text_rows_[r] = text_rows_[r + 1];
@@ -69,6 +69,22 @@ class TextBuffer {
   // Return the character at the specified location.
   pw::Result<Char> GetChar(pw::geometry::Vector2<int> loc) const;
 
+  // Return the current cursor location.
+  pw::geometry::Vector2<int> GetCursor() const { return cursor_; }
+
+  // Move the cursor to the specified location. Locations outside of the buffer
+  // are clamped to the nearest edge.
+  void SetCursor(pw::geometry::Vector2<int> loc);
+
+  // Reset the characters from start (inclusive) to end (exclusive), in reading
+  // order, to the cleared default state. Locations are clamped to the buffer
+  // and the cursor is not moved.
+  void ClearRange(pw::geometry::Vector2<int> start,
+                  pw::geometry::Vector2<int> end);
+
+  // Reset all characters to the cleared default state.
+  void Clear();
+
  private:
   void ScrollUp();
   void InsertNewline();
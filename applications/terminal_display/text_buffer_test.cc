@@ -124,3 +124,49 @@ TEST(TextBufferTest, Scroll) {
   EXPECT_EQ(kIndigo, ch->foreground_color);
   EXPECT_EQ(kDarkGreen, ch->background_color);
 }
+
+TEST(TextBufferTest, SetCursorClamps) {
+  TextBuffer buffer;
+  buffer.SetCursor({3, 2});
+  EXPECT_EQ(3, buffer.GetCursor().x);
+  EXPECT_EQ(2, buffer.GetCursor().y);
+
+  buffer.SetCursor({-5, 1000});
+  EXPECT_EQ(0, buffer.GetCursor().x);
+  EXPECT_EQ(static_cast<int>(kNumRows) - 1, buffer.GetCursor().y);
+}
+
+TEST(TextBufferTest, ClearRange) {
+  TextBuffer buffer;
+  for (size_t i = 0; i < kNumCharsWide * 2; i++) {
+    buffer.DrawCharacter({'A', kIndigo, kDarkGreen});
+    if (i == kNumCharsWide - 1) {
+      buffer.DrawCharacter({'\n', kIndigo, kDarkGreen});
+    }
+  }
+
+  // Clear from the middle of row 0 up to (not including) column 2 of row 1.
+  buffer.ClearRange({4, 0}, {2, 1});
+
+  auto ch = buffer.GetChar({3, 0});
+  ASSERT_TRUE(ch.ok());
+  EXPECT_EQ('A', ch->ch);
+
+  ch = buffer.GetChar({4, 0});
+  ASSERT_TRUE(ch.ok());
+  EXPECT_EQ('\0', ch->ch);
+  EXPECT_EQ(kWhiteColor, ch->foreground_color);
+
+  ch = buffer.GetChar({1, 1});
+  ASSERT_TRUE(ch.ok());
+  EXPECT_EQ('\0', ch->ch);
+
+  ch = buffer.GetChar({2, 1});
+  ASSERT_TRUE(ch.ok());
+  EXPECT_EQ('A', ch->ch);
+
+  buffer.Clear();
+  ch = buffer.GetChar({2, 1});
+  ASSERT_TRUE(ch.ok());
+  EXPECT_EQ('\0', ch->ch);
+}
@@ -0,0 +1,254 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// A log console which uses the app_common text mode display instead of a
+// framebuffer. Only the character grid is kept in RAM, and each frame only the
+// characters which changed are drawn to the panel.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
+
+#include "ansi.h"
+#include "app_common/common.h"
+#include "libkudzu/framecounter.h"
+#include "libkudzu/log_queue.h"
+#include "libkudzu/log_tee.h"
+#include "libkudzu/text_mode.h"
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_color/color.h"
+#include "pw_color/colors_pico8.h"
+#include "pw_geometry/size.h"
+#include "pw_log/log.h"
+#include "pw_span/span.h"
+#include "pw_string/string_builder.h"
+#include "pw_sys_io/sys_io.h"
+#include "pw_system/target_hooks.h"
+#include "pw_thread/detached_thread.h"
+#include "pw_thread/sleep.h"
+
+using kudzu::TextCell;
+using kudzu::TextModeDisplay;
+using pw::color::color_rgb565_t;
+using pw::color::kColorsPico8Rgb565;
+using pw::geometry::Size;
+
+namespace {
+
+constexpr color_rgb565_t kBlack = 0U;
+constexpr color_rgb565_t kWhite = 0xffff;
+
+// The title and a rule beneath it. The log scrolls below them.
+constexpr int kHeaderRows = 2;
+
+// Text mode has no vsync to pace it, so only look for new lines this often.
+constexpr auto kFramePeriod = std::chrono::milliseconds(16);
+
+// Decodes ANSI text straight into the rows of a TextModeDisplay below the
+// header, scrolling them up when a line is added at the bottom.
+class TextModeDecoder : public AnsiDecoder {
+ public:
+  TextModeDecoder(TextModeDisplay& display, int first_row)
+      : display_(display), first_row_(first_row), row_(first_row) {}
+
+ protected:
+  void SetFgColor(uint8_t r, uint8_t g, uint8_t b) override {
+    fg_color_ = pw::color::ColorRgba(r, g, b).ToRgb565();
+  }
+  void SetBgColor(uint8_t r, uint8_t g, uint8_t b) override {
+    bg_color_ = pw::color::ColorRgba(r, g, b).ToRgb565();
+  }
+  void EmitChar(char c) override {
+    if (c == '\n') {
+      NewLine();
+      return;
+    }
+    if (c == '\r') {
+      column_ = 0;
+      return;
+    }
+    // Lines longer than the display are cut off rather than wrapped.
+    display_.SetCell({column_, row_}, {c, fg_color_, bg_color_});
+    column_ = std::min(column_ + 1, columns());
+  }
+  void MoveCursor(int dx, int dy) override {
+    SetCursorPosition(row_ - first_row_ + dy, column_ + dx);
+  }
+  void SetCursorColumn(int column) override {
+    column_ = std::clamp(column, 0, columns() - 1);
+  }
+  void SetCursorPosition(int row, int column) override {
+    row_ = std::clamp(row + first_row_, first_row_, rows() - 1);
+    SetCursorColumn(column);
+  }
+  void EraseInLine(EraseMode mode) override {
+    switch (mode) {
+      case EraseMode::kToEnd:
+        Erase(row_, column_, columns());
+        break;
+      case EraseMode::kToStart:
+        Erase(row_, 0, column_ + 1);
+        break;
+      case EraseMode::kAll:
+        Erase(row_, 0, columns());
+        break;
+    }
+  }
+  void EraseInDisplay(EraseMode mode) override {
+    switch (mode) {
+      case EraseMode::kToEnd:
+        Erase(row_, column_, columns());
+        display_.FillRows(row_ + 1, rows(), Blank());
+        break;
+      case EraseMode::kToStart:
+        display_.FillRows(first_row_, row_, Blank());
+        Erase(row_, 0, column_ + 1);
+        break;
+      case EraseMode::kAll:
+        display_.FillRows(first_row_, rows(), Blank());
+        break;
+    }
+  }
+
+ private:
+  int columns() const { return display_.GetSize().width; }
+  int rows() const { return display_.GetSize().height; }
+  TextCell Blank() const { return {' ', fg_color_, bg_color_}; }
+
+  void Erase(int row, int begin, int end) {
+    for (int x = begin; x < end; x++) {
+      display_.SetCell({x, row}, Blank());
+    }
+  }
+
+  void NewLine() {
+    column_ = 0;
+    if (row_ + 1 < rows()) {
+      row_++;
+    } else {
+      display_.ScrollUp(first_row_, rows(), TextCell{});
+    }
+  }
+
+  TextModeDisplay& display_;
+  const int first_row_;
+  int row_;
+  int column_ = 0;
+  color_rgb565_t fg_color_ = kWhite;
+  color_rgb565_t bg_color_ = kBlack;
+};
+
+constexpr size_t kLogQueueLines = 32;
+constexpr size_t kLogQueueLineLength = 128;
+kudzu::LogQueue<kLogQueueLines, kLogQueueLineLength> s_log_queue;
+
+// Receives every pw_log message through the log tee. Like the framebuffer
+// terminal it only enqueues, so it is safe to call from any thread. The log
+// backend still sends the message out as usual.
+void QueueLogLine(std::string_view line) { s_log_queue.Push(line); }
+
+// Shows a line on the terminal and writes it out, for lines which don't come
+// from pw_log.
+void LogCallback(std::string_view log) {
+  QueueLogLine(log);
+
+  pw::sys_io::WriteLine(log).IgnoreError();
+}
+
+void DecodeLine(TextModeDecoder& decoder, std::string_view line) {
+  decoder.ProcessChars(pw::span<const char>(line.data(), line.size()));
+  decoder.ProcessChar('\n');
+}
+
+void DrainLogQueue(TextModeDecoder& decoder) {
+  s_log_queue.Drain(
+      [&decoder](std::string_view line) { DecodeLine(decoder, line); });
+
+  // Written straight to the display, since logging it would only queue
+  // another line behind the ones which didn't fit.
+  static uint32_t last_dropped_lines = 0;
+  const uint32_t dropped_lines = s_log_queue.dropped_lines();
+  if (dropped_lines != last_dropped_lines) {
+    pw::StringBuffer<64> notice;
+    notice.Format("\e[33mWRN\e[0m Log queue full, %u lines dropped",
+                  static_cast<unsigned>(dropped_lines - last_dropped_lines));
+    DecodeLine(decoder, notice.view());
+    last_dropped_lines = dropped_lines;
+  }
+}
+
+void DrawHeader(TextModeDisplay& display) {
+  const color_rgb565_t title_fg = kColorsPico8Rgb565[pw::color::kColorOrange];
+  const color_rgb565_t title_bg = kColorsPico8Rgb565[pw::color::kColorDarkBlue];
+  const color_rgb565_t rule_fg = kColorsPico8Rgb565[pw::color::kColorBlue];
+  display.FillRows(0, 1, {' ', title_fg, title_bg});
+  display.Print({1, 0}, "Pigweed Kudzu Terminal", title_fg, title_bg);
+  display.FillRows(1, 2, {'-', rule_fg, kBlack});
+}
+
+void CreateDemoLogMessages() {
+  LogCallback("\e[41;97mCRT\e[0m An irrecoverable error has occurred!");
+  LogCallback("\e[31mERR\e[0m There was an error on our last operation");
+  LogCallback(
+      "\e[33mWRN\e[0m Looks like something is amiss; consider investigating");
+  LogCallback("\e[32mINF\e[0m The operation went as expected");
+  LogCallback("\e[38;5;244mDBG\e[0m Debug output");
+}
+
+void MainTask(void*) {
+  static kudzu::FrameCounter frame_counter(Common::GetTimingClock());
+
+  kudzu::SetLogTeeOutput(QueueLogLine);
+
+  PW_CHECK_OK(Common::InitTextMode());
+
+  TextModeDisplay& display = Common::GetTextModeDisplay();
+  const Size<int> grid_size = display.GetSize();
+  PW_LOG_INFO(
+      "Text mode: %dx%d characters", grid_size.width, grid_size.height);
+
+  TextModeDecoder decoder(display, kHeaderRows);
+  DrawHeader(display);
+  CreateDemoLogMessages();
+
+  while (1) {
+    frame_counter.StartFrame();
+
+    DrainLogQueue(decoder);
+    frame_counter.EndDraw();
+
+    // Cells which fail to draw stay dirty and are retried next frame.
+    display.Update().IgnoreError();
+    frame_counter.EndFlush();
+
+    frame_counter.LogTiming();
+    pw::this_thread::sleep_for(
+        pw::chrono::SystemClock::for_at_least(kFramePeriod));
+  }
+}
+
+}  // namespace
+
+namespace pw::system {
+
+void UserAppInit() {
+  PW_LOG_INFO("UserAppInit");
+  pw::thread::DetachedThread(Common::DisplayDrawThreadOptions(), MainTask);
+}
+
+}  // namespace pw::system
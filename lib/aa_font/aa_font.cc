@@ -0,0 +1,166 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/aa_font.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace kudzu {
+namespace {
+
+using pw::color::color_rgb565_t;
+using pw::framebuffer::Framebuffer;
+using pw::geometry::Size;
+using pw::geometry::Vector2;
+
+// Visible part of a glyph after clipping to the framebuffer, in glyph
+// coordinates.
+struct Clip {
+  int x_start;
+  int x_end;
+  int y_start;
+  int y_end;
+};
+
+// Blend one glyph into the framebuffer. Templated on the bit depth so the
+// unpacking shifts are constants in the inner loop.
+template <int kBitsPerPixel>
+void BlitGlyph(const AaGlyph& glyph,
+               const uint8_t* atlas,
+               Vector2<int> origin,
+               const Clip& clip,
+               const CoverageRamp& ramp,
+               uint16_t* pixels,
+               size_t row_pixels) {
+  constexpr int kPixelsPerByte = 8 / kBitsPerPixel;
+  constexpr int kMask = (1 << kBitsPerPixel) - 1;
+  // Spreads a coverage value over the ramp's 0-15 range.
+  constexpr int kScale = 15 / kMask;
+
+  const size_t row_bytes =
+      (glyph.width + kPixelsPerByte - 1) / static_cast<size_t>(kPixelsPerByte);
+  const uint8_t* src_row = atlas + glyph.offset + clip.y_start * row_bytes;
+  uint16_t* dst_row = pixels + (origin.y + clip.y_start) * row_pixels +
+                      origin.x;
+
+  for (int y = clip.y_start; y < clip.y_end; y++) {
+    for (int x = clip.x_start; x < clip.x_end; x++) {
+      const uint8_t byte = src_row[x / kPixelsPerByte];
+      const int shift = 8 - kBitsPerPixel * (x % kPixelsPerByte + 1);
+      const int coverage = (byte >> shift) & kMask;
+      if (coverage != 0) {
+        dst_row[x] = ramp[coverage * kScale];
+      }
+    }
+    src_row += row_bytes;
+    dst_row += row_pixels;
+  }
+}
+
+}  // namespace
+
+int AaFont::Kerning(char left, char right) const {
+  if (kerning.empty()) {
+    return 0;
+  }
+  auto it = std::lower_bound(
+      kerning.begin(),
+      kerning.end(),
+      AaKerningPair{left, right, 0},
+      [](const AaKerningPair& a, const AaKerningPair& b) {
+        return a.left != b.left ? a.left < b.left : a.right < b.right;
+      });
+  if (it == kerning.end() || it->left != left || it->right != right) {
+    return 0;
+  }
+  return it->adjust;
+}
+
+Size<int> MeasureAaString(std::string_view text, const AaFont& font) {
+  int width = 0;
+  char previous = '\0';
+  for (char c : text) {
+    const AaGlyph* glyph = font.Glyph(c);
+    if (glyph == nullptr) {
+      continue;
+    }
+    if (previous != '\0') {
+      width += font.Kerning(previous, c);
+    }
+    width += glyph->advance;
+    previous = c;
+  }
+  return {width, font.line_height};
+}
+
+Size<int> DrawAaString(std::string_view text,
+                       Vector2<int> top_left,
+                       const CoverageRamp& ramp,
+                       const AaFont& font,
+                       Framebuffer& framebuffer) {
+  uint16_t* pixels = static_cast<uint16_t*>(framebuffer.data());
+  const size_t row_pixels = framebuffer.row_bytes() / sizeof(color_rgb565_t);
+  const int fb_width = framebuffer.size().width;
+  const int fb_height = framebuffer.size().height;
+
+  int pen_x = top_left.x;
+  char previous = '\0';
+  for (char c : text) {
+    const AaGlyph* glyph = font.Glyph(c);
+    if (glyph == nullptr) {
+      continue;
+    }
+    if (previous != '\0') {
+      pen_x += font.Kerning(previous, c);
+    }
+    previous = c;
+
+    const Vector2<int> origin = {pen_x + glyph->x_offset,
+                                 top_left.y + glyph->y_offset};
+    pen_x += glyph->advance;
+
+    const Clip clip = {
+        .x_start = std::max(0, -origin.x),
+        .x_end = std::min<int>(glyph->width, fb_width - origin.x),
+        .y_start = std::max(0, -origin.y),
+        .y_end = std::min<int>(glyph->height, fb_height - origin.y),
+    };
+    if (clip.x_start >= clip.x_end || clip.y_start >= clip.y_end) {
+      continue;
+    }
+
+    if (font.bits_per_pixel == 4) {
+      BlitGlyph<4>(*glyph,
+                   font.atlas.data(),
+                   origin,
+                   clip,
+                   ramp,
+                   pixels,
+                   row_pixels);
+    } else {
+      BlitGlyph<2>(*glyph,
+                   font.atlas.data(),
+                   origin,
+                   clip,
+                   ramp,
+                   pixels,
+                   row_pixels);
+    }
+  }
+  return {pen_x - top_left.x, font.line_height};
+}
+
+}  // namespace kudzu
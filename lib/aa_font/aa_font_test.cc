@@ -0,0 +1,134 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/aa_font.h"
+
+#include <array>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_framebuffer/framebuffer.h"
+
+namespace kudzu {
+namespace {
+
+using pw::color::color_rgb565_t;
+using pw::framebuffer::Framebuffer;
+using pw::framebuffer::PixelFormat;
+
+constexpr color_rgb565_t kWhite = 0xffff;
+constexpr color_rgb565_t kBlack = 0x0000;
+constexpr color_rgb565_t kUntouched = 0x1234;
+
+// 'A' is a 2x2 block with coverage 15, 8 in the top row and 4, 0 in the
+// bottom row. 'B' has no pixels and is only used for measuring.
+constexpr uint8_t kAtlas[] = {0xf8, 0x40};
+constexpr AaGlyph kGlyphs[] = {
+    {.offset = 0,
+     .width = 2,
+     .height = 2,
+     .x_offset = 1,
+     .y_offset = 1,
+     .advance = 4},
+    {.offset = 0,
+     .width = 0,
+     .height = 0,
+     .x_offset = 0,
+     .y_offset = 0,
+     .advance = 3},
+};
+constexpr AaKerningPair kKerning[] = {{'A', 'A', -1}, {'A', 'B', 2}};
+constexpr AaFont kFont = {
+    .bits_per_pixel = 4,
+    .line_height = 5,
+    .ascent = 4,
+    .first_char = 'A',
+    .last_char = 'B',
+    .glyphs = kGlyphs,
+    .atlas = kAtlas,
+    .kerning = kKerning,
+};
+
+TEST(CoverageRampTest, EndsAtBackgroundAndForeground) {
+  constexpr CoverageRamp ramp(kWhite, kBlack);
+  EXPECT_EQ(kBlack, ramp[0]);
+  EXPECT_EQ(kWhite, ramp[15]);
+  EXPECT_EQ(kBlack, ramp.background());
+  EXPECT_EQ(kWhite, ramp.foreground());
+}
+
+TEST(CoverageRampTest, BlendsEachChannel) {
+  // Pure red over pure blue.
+  constexpr CoverageRamp ramp(0xf800, 0x001f);
+  const color_rgb565_t half = ramp[8];
+  EXPECT_EQ(17, half >> 11);
+  EXPECT_EQ(0, (half >> 5) & 0x3f);
+  EXPECT_EQ(14, half & 0x1f);
+}
+
+TEST(AaFontTest, Kerning) {
+  EXPECT_EQ(-1, kFont.Kerning('A', 'A'));
+  EXPECT_EQ(2, kFont.Kerning('A', 'B'));
+  EXPECT_EQ(0, kFont.Kerning('B', 'A'));
+}
+
+TEST(AaFontTest, MeasureAppliesKerningAndSkipsMissingGlyphs) {
+  // 4 - 1 + 4 + 2 + 3; 'z' is not in the font.
+  auto size = MeasureAaString("AAzB", kFont);
+  EXPECT_EQ(12, size.width);
+  EXPECT_EQ(5, size.height);
+}
+
+TEST(AaFontTest, DrawBlendsCoverage) {
+  std::array<color_rgb565_t, 8 * 4> pixels;
+  pixels.fill(kUntouched);
+  Framebuffer framebuffer(
+      pixels.data(), PixelFormat::RGB565, {8, 4}, 8 * sizeof(uint16_t));
+  const CoverageRamp ramp(kWhite, kBlack);
+
+  auto size = DrawAaString("A", {0, 0}, ramp, kFont, framebuffer);
+  EXPECT_EQ(4, size.width);
+
+  EXPECT_EQ(kUntouched, pixels[0 * 8 + 1]);
+  EXPECT_EQ(kWhite, pixels[1 * 8 + 1]);
+  EXPECT_EQ(ramp[8], pixels[1 * 8 + 2]);
+  EXPECT_EQ(ramp[4], pixels[2 * 8 + 1]);
+  // Zero coverage leaves the framebuffer alone.
+  EXPECT_EQ(kUntouched, pixels[2 * 8 + 2]);
+}
+
+TEST(AaFontTest, DrawClipsToFramebuffer) {
+  std::array<color_rgb565_t, 4 * 4> pixels;
+  pixels.fill(kUntouched);
+  Framebuffer framebuffer(
+      pixels.data(), PixelFormat::RGB565, {4, 4}, 4 * sizeof(uint16_t));
+  const CoverageRamp ramp(kWhite, kBlack);
+
+  // Only the uncovered corner of the glyph is on screen.
+  DrawAaString("A", {-2, -2}, ramp, kFont, framebuffer);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    EXPECT_EQ(kUntouched, pixels[i]) << i;
+  }
+
+  DrawAaString("A", {-2, -1}, ramp, kFont, framebuffer);
+  EXPECT_EQ(ramp[8], pixels[0]);
+  EXPECT_EQ(kUntouched, pixels[4]);
+
+  // Only the fully covered corner is on screen.
+  DrawAaString("A", {2, 2}, ramp, kFont, framebuffer);
+  EXPECT_EQ(kWhite, pixels[15]);
+}
+
+}  // namespace
+}  // namespace kudzu
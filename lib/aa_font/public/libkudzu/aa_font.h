@@ -0,0 +1,141 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pw_color/color.h"
+#include "pw_framebuffer/framebuffer.h"
+#include "pw_geometry/size.h"
+#include "pw_geometry/vector2.h"
+#include "pw_span/span.h"
+
+namespace kudzu {
+
+/// Placement of one glyph's coverage bitmap within an `AaFont` atlas.
+struct AaGlyph {
+  // Byte offset of the first row in the atlas. Each row starts on a byte
+  // boundary with the leftmost pixel in the most significant bits.
+  uint32_t offset;
+  uint8_t width;
+  uint8_t height;
+  // Position of the bitmap's top left corner relative to the pen position,
+  // which is at the top of the line.
+  int8_t x_offset;
+  int8_t y_offset;
+  // Distance to move the pen after drawing this glyph.
+  uint8_t advance;
+};
+
+/// An adjustment to the advance between two adjacent characters.
+struct AaKerningPair {
+  char left;
+  char right;
+  int8_t adjust;
+};
+
+/// A proportional font with 2 or 4 bits of anti-aliasing coverage per pixel.
+///
+/// Fonts are generated at build time from a TrueType font by the
+/// `kudzu_aa_font` GN template in `//lib/aa_font/aa_font.gni`.
+struct AaFont {
+  uint8_t bits_per_pixel;
+  // Distance between the tops of consecutive lines.
+  uint8_t line_height;
+  // Distance from the top of the line to the baseline.
+  uint8_t ascent;
+  char first_char;
+  char last_char;
+  pw::span<const AaGlyph> glyphs;
+  pw::span<const uint8_t> atlas;
+  // Sorted by left then right character.
+  pw::span<const AaKerningPair> kerning;
+
+  /// Returns the glyph for `c` or nullptr if the font doesn't contain it.
+  const AaGlyph* Glyph(char c) const {
+    if (c < first_char || c > last_char) {
+      return nullptr;
+    }
+    return &glyphs[static_cast<size_t>(c - first_char)];
+  }
+
+  /// Returns the kerning adjustment to apply between `left` and `right`.
+  int Kerning(char left, char right) const;
+};
+
+/// The 16 colors between a background and a foreground color, indexed by
+/// coverage. Building one costs a few divisions; drawing with it costs none, so
+/// build one per color pair outside of the draw loop.
+class CoverageRamp {
+ public:
+  static constexpr size_t kSize = 16;
+
+  constexpr CoverageRamp(pw::color::color_rgb565_t foreground,
+                         pw::color::color_rgb565_t background)
+      : colors_() {
+    const int fg_r = (foreground >> 11) & 0x1f;
+    const int fg_g = (foreground >> 5) & 0x3f;
+    const int fg_b = foreground & 0x1f;
+    const int bg_r = (background >> 11) & 0x1f;
+    const int bg_g = (background >> 5) & 0x3f;
+    const int bg_b = background & 0x1f;
+    constexpr int kMax = kSize - 1;
+    for (int i = 0; i < static_cast<int>(kSize); i++) {
+      const int r = (fg_r * i + bg_r * (kMax - i) + kMax / 2) / kMax;
+      const int g = (fg_g * i + bg_g * (kMax - i) + kMax / 2) / kMax;
+      const int b = (fg_b * i + bg_b * (kMax - i) + kMax / 2) / kMax;
+      colors_[i] = static_cast<pw::color::color_rgb565_t>((r << 11) |
+                                                          (g << 5) | b);
+    }
+  }
+
+  /// The color for a 4-bit coverage value.
+  constexpr pw::color::color_rgb565_t operator[](size_t coverage) const {
+    return colors_[coverage];
+  }
+
+  constexpr pw::color::color_rgb565_t foreground() const {
+    return colors_[kSize - 1];
+  }
+  constexpr pw::color::color_rgb565_t background() const { return colors_[0]; }
+
+ private:
+  std::array<pw::color::color_rgb565_t, kSize> colors_;
+};
+
+/// Width and height in pixels of `text` drawn in `font`. Newlines are not
+/// handled.
+pw::geometry::Size<int> MeasureAaString(std::string_view text,
+                                        const AaFont& font);
+
+/// Draw a single line of `text` with the top left corner of the line at
+/// `top_left`, clipped to the framebuffer, which must be RGB565.
+///
+/// Pixels with no coverage are left untouched, and partly covered pixels are
+/// blended towards the ramp's background color rather than the pixels already
+/// in the framebuffer. Fill the area behind the text with the ramp's background
+/// color first for the smoothest result.
+///
+/// Returns the size of the drawn text, as `MeasureAaString()` would.
+pw::geometry::Size<int> DrawAaString(std::string_view text,
+                                     pw::geometry::Vector2<int> top_left,
+                                     const CoverageRamp& ramp,
+                                     const AaFont& font,
+                                     pw::framebuffer::Framebuffer& framebuffer);
+
+}  // namespace kudzu
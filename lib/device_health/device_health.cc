@@ -0,0 +1,125 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/device_health.h"
+
+#define PW_LOG_MODULE_NAME "DeviceHealth"
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_thread/sleep.h"
+
+namespace kudzu {
+namespace {
+
+// Enough doublings to reach any sensible backoff without overflowing.
+constexpr uint32_t kMaxBackoffDoublings = 16;
+
+}  // namespace
+
+pw::Status DeviceHealthMonitor::AddDevice(const char* name,
+                                          Probe probe,
+                                          LogInfo log_info) {
+  std::lock_guard lock(lock_);
+  if (num_devices_ == kMaxDevices) {
+    return pw::Status::ResourceExhausted();
+  }
+  devices_[num_devices_] = {probe, log_info, {}};
+  health_[num_devices_] = {name, DeviceHealthState::kUnknown, std::nullopt, 0};
+  num_devices_++;
+  return pw::OkStatus();
+}
+
+pw::chrono::SystemClock::time_point DeviceHealthMonitor::Poll(
+    pw::chrono::SystemClock::time_point now) {
+  size_t num_devices;
+  {
+    std::lock_guard lock(lock_);
+    num_devices = num_devices_;
+  }
+
+  auto next_due = now + max_backoff_;
+  for (size_t i = 0; i < num_devices; i++) {
+    Device& device = devices_[i];
+    if (device.next_probe > now) {
+      next_due = std::min(next_due, device.next_probe);
+      continue;
+    }
+
+    // Probe without the lock, so readers never wait on the bus.
+    const bool answered = device.probe().ok();
+
+    bool came_back = false;
+    {
+      std::lock_guard lock(lock_);
+      DeviceHealth& health = health_[i];
+      if (answered) {
+        came_back = health.state != DeviceHealthState::kHealthy;
+        health.state = DeviceHealthState::kHealthy;
+        health.last_seen = now;
+        health.consecutive_failures = 0;
+        device.next_probe = now + period_;
+      } else {
+        if (health.state == DeviceHealthState::kHealthy) {
+          PW_LOG_WARN("%s stopped answering", health.name);
+        }
+        health.state = DeviceHealthState::kMissing;
+        health.consecutive_failures++;
+        const uint32_t doublings =
+            std::min(health.consecutive_failures, kMaxBackoffDoublings);
+        device.next_probe = now + std::min(period_ * (1u << doublings),
+                                           max_backoff_);
+      }
+    }
+    if (came_back && device.log_info != nullptr) {
+      device.log_info();
+    }
+    next_due = std::min(next_due, device.next_probe);
+  }
+  return next_due;
+}
+
+void DeviceHealthMonitor::Run() {
+  while (true) {
+    pw::this_thread::sleep_until(Poll(pw::chrono::SystemClock::now()));
+  }
+}
+
+size_t DeviceHealthMonitor::Read(pw::span<DeviceHealth> health) const {
+  std::lock_guard lock(lock_);
+  const size_t count = std::min(num_devices_, health.size());
+  std::copy_n(health_.begin(), count, health.begin());
+  return count;
+}
+
+bool DeviceHealthMonitor::AllHealthy() const {
+  std::lock_guard lock(lock_);
+  return std::all_of(
+      health_.begin(),
+      health_.begin() + num_devices_,
+      [](const DeviceHealth& health) {
+        return health.state == DeviceHealthState::kHealthy;
+      });
+}
+
+DeviceHealthMonitor& GetDeviceHealthMonitor() {
+  static DeviceHealthMonitor monitor;
+  return monitor;
+}
+
+}  // namespace kudzu
@@ -0,0 +1,161 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/device_health.h"
+
+#include <array>
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_status/status.h"
+
+namespace kudzu {
+namespace {
+
+using pw::chrono::SystemClock;
+using std::chrono::seconds;
+
+constexpr SystemClock::duration kPeriod = SystemClock::for_at_least(seconds(1));
+constexpr SystemClock::duration kMaxBackoff =
+    SystemClock::for_at_least(seconds(8));
+
+// The probes are plain function pointers, so the fakes keep their state here.
+bool s_answers = true;
+int s_probes = 0;
+int s_logs = 0;
+
+pw::Status FakeProbe() {
+  s_probes++;
+  return s_answers ? pw::OkStatus() : pw::Status::Unavailable();
+}
+
+void FakeLogInfo() { s_logs++; }
+
+pw::Status MissingProbe() { return pw::Status::Unavailable(); }
+
+class DeviceHealthMonitorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    s_answers = true;
+    s_probes = 0;
+    s_logs = 0;
+  }
+
+  DeviceHealth ReadOne() {
+    std::array<DeviceHealth, 1> health;
+    EXPECT_EQ(monitor_.Read(health), 1u);
+    return health[0];
+  }
+
+  const SystemClock::time_point start_ = SystemClock::time_point(seconds(10));
+  DeviceHealthMonitor monitor_{kPeriod, kMaxBackoff};
+};
+
+TEST_F(DeviceHealthMonitorTest, UnprobedDeviceIsUnknown) {
+  ASSERT_EQ(monitor_.AddDevice("fake", FakeProbe, FakeLogInfo),
+            pw::OkStatus());
+
+  DeviceHealth health = ReadOne();
+  EXPECT_STREQ(health.name, "fake");
+  EXPECT_EQ(health.state, DeviceHealthState::kUnknown);
+  EXPECT_FALSE(health.last_seen.has_value());
+  EXPECT_FALSE(monitor_.AllHealthy());
+  EXPECT_EQ(s_probes, 0);
+}
+
+TEST_F(DeviceHealthMonitorTest, HealthyDeviceIsProbedOncePerPeriod) {
+  ASSERT_EQ(monitor_.AddDevice("fake", FakeProbe, FakeLogInfo),
+            pw::OkStatus());
+
+  EXPECT_EQ(monitor_.Poll(start_), start_ + kPeriod);
+  EXPECT_EQ(s_probes, 1);
+  EXPECT_TRUE(monitor_.AllHealthy());
+  DeviceHealth health = ReadOne();
+  EXPECT_EQ(health.state, DeviceHealthState::kHealthy);
+  EXPECT_EQ(health.last_seen, start_);
+
+  // Not due yet.
+  EXPECT_EQ(monitor_.Poll(start_ + kPeriod / 2), start_ + kPeriod);
+  EXPECT_EQ(s_probes, 1);
+
+  EXPECT_EQ(monitor_.Poll(start_ + kPeriod), start_ + 2 * kPeriod);
+  EXPECT_EQ(s_probes, 2);
+  EXPECT_EQ(ReadOne().last_seen, start_ + kPeriod);
+}
+
+TEST_F(DeviceHealthMonitorTest, MissingDeviceBacksOffExponentially) {
+  ASSERT_EQ(monitor_.AddDevice("fake", FakeProbe, FakeLogInfo),
+            pw::OkStatus());
+  s_answers = false;
+
+  SystemClock::time_point now = start_;
+  for (SystemClock::duration delay :
+       {2 * kPeriod, 4 * kPeriod, kMaxBackoff, kMaxBackoff}) {
+    const SystemClock::time_point next = monitor_.Poll(now);
+    EXPECT_EQ(next - now, delay);
+    now = next;
+  }
+
+  DeviceHealth health = ReadOne();
+  EXPECT_EQ(health.state, DeviceHealthState::kMissing);
+  EXPECT_EQ(health.consecutive_failures, 4u);
+  EXPECT_FALSE(health.last_seen.has_value());
+  EXPECT_FALSE(monitor_.AllHealthy());
+}
+
+TEST_F(DeviceHealthMonitorTest, LogsInfoOnlyWhenDeviceAppears) {
+  ASSERT_EQ(monitor_.AddDevice("fake", FakeProbe, FakeLogInfo),
+            pw::OkStatus());
+
+  monitor_.Poll(start_);
+  monitor_.Poll(start_ + kPeriod);
+  EXPECT_EQ(s_logs, 1);
+
+  s_answers = false;
+  const SystemClock::time_point retry = monitor_.Poll(start_ + 2 * kPeriod);
+  EXPECT_EQ(ReadOne().last_seen, start_ + kPeriod);
+
+  s_answers = true;
+  monitor_.Poll(retry);
+  EXPECT_EQ(s_logs, 2);
+  DeviceHealth health = ReadOne();
+  EXPECT_EQ(health.state, DeviceHealthState::kHealthy);
+  EXPECT_EQ(health.consecutive_failures, 0u);
+}
+
+TEST_F(DeviceHealthMonitorTest, ReturnsEarliestDueDevice) {
+  ASSERT_EQ(monitor_.AddDevice("missing", MissingProbe, nullptr),
+            pw::OkStatus());
+  ASSERT_EQ(monitor_.AddDevice("fake", FakeProbe, nullptr), pw::OkStatus());
+
+  EXPECT_EQ(monitor_.Poll(start_), start_ + kPeriod);
+  EXPECT_FALSE(monitor_.AllHealthy());
+
+  std::array<DeviceHealth, DeviceHealthMonitor::kMaxDevices> health;
+  ASSERT_EQ(monitor_.Read(health), 2u);
+  EXPECT_EQ(health[0].state, DeviceHealthState::kMissing);
+  EXPECT_EQ(health[1].state, DeviceHealthState::kHealthy);
+}
+
+TEST_F(DeviceHealthMonitorTest, RejectsDevicesPastCapacity) {
+  for (size_t i = 0; i < DeviceHealthMonitor::kMaxDevices; i++) {
+    ASSERT_EQ(monitor_.AddDevice("fake", FakeProbe, nullptr), pw::OkStatus());
+  }
+  EXPECT_EQ(monitor_.AddDevice("fake", FakeProbe, nullptr),
+            pw::Status::ResourceExhausted());
+}
+
+}  // namespace
+}  // namespace kudzu
@@ -0,0 +1,113 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace kudzu {
+
+enum class DeviceHealthState : uint8_t {
+  // Not probed yet.
+  kUnknown,
+  // Answered its last probe.
+  kHealthy,
+  // Failed its last probe.
+  kMissing,
+};
+
+/// A device's health as of its last probe.
+struct DeviceHealth {
+  const char* name;
+  DeviceHealthState state;
+  // When the device last answered a probe, if it ever has.
+  std::optional<pw::chrono::SystemClock::time_point> last_seen;
+  // Probes failed in a row.
+  uint32_t consecutive_failures;
+};
+
+/// Probes a fixed set of devices from its own thread and caches their health,
+/// so nothing on the frame path waits out a probe's bus timeout.
+///
+/// Healthy devices are probed once a `period`. Each failure in a row doubles
+/// the time to the next probe, up to `max_backoff`, so a missing device costs
+/// little bus time. A device's registers are logged when it first answers
+/// and whenever it comes back.
+class DeviceHealthMonitor {
+ public:
+  static constexpr size_t kMaxDevices = 6;
+  static constexpr auto kDefaultPeriod = std::chrono::seconds(5);
+  static constexpr auto kDefaultMaxBackoff = std::chrono::seconds(60);
+
+  using Probe = pw::Status (*)();
+  using LogInfo = void (*)();
+
+  DeviceHealthMonitor(
+      pw::chrono::SystemClock::duration period =
+          pw::chrono::SystemClock::for_at_least(kDefaultPeriod),
+      pw::chrono::SystemClock::duration max_backoff =
+          pw::chrono::SystemClock::for_at_least(kDefaultMaxBackoff))
+      : period_(period), max_backoff_(max_backoff) {}
+
+  /// Adds a device, which is first probed on the next `Poll()`. `name` must
+  /// have static storage and `log_info` may be null. Add every device before
+  /// starting `Run()`. Returns RESOURCE_EXHAUSTED past kMaxDevices.
+  pw::Status AddDevice(const char* name, Probe probe, LogInfo log_info);
+
+  /// Probes the devices which are due at `now` and returns when the next one
+  /// is due. Only call this from one thread.
+  pw::chrono::SystemClock::time_point Poll(
+      pw::chrono::SystemClock::time_point now);
+
+  /// Polls forever, sleeping until each probe is due.
+  void Run();
+
+  /// Copies each device's cached health to `health` and returns the number
+  /// copied. This never touches the bus.
+  size_t Read(pw::span<DeviceHealth> health) const;
+
+  /// Returns true if every device answered its last probe.
+  bool AllHealthy() const;
+
+ private:
+  struct Device {
+    Probe probe;
+    LogInfo log_info;
+    // Only touched by the polling thread.
+    pw::chrono::SystemClock::time_point next_probe;
+  };
+
+  const pw::chrono::SystemClock::duration period_;
+  const pw::chrono::SystemClock::duration max_backoff_;
+  std::array<Device, kMaxDevices> devices_;
+
+  mutable pw::sync::Mutex lock_;
+  std::array<DeviceHealth, kMaxDevices> health_ PW_GUARDED_BY(lock_);
+  size_t num_devices_ PW_GUARDED_BY(lock_) = 0;
+};
+
+/// The monitor the board registers its devices with.
+DeviceHealthMonitor& GetDeviceHealthMonitor();
+
+}  // namespace kudzu
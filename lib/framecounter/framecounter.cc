@@ -19,74 +19,155 @@
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 #define PW_LOG_MODULE_NAME "FrameCounter"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
-#include <cstring>
 
+#include "libkudzu/histogram.h"
+#include "libkudzu/overrun_log.h"
+#include "libkudzu/telemetry.h"
+#include "libkudzu/trace.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_log/log.h"
-#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
-
-using namespace std::chrono_literals;
 
 namespace kudzu {
+namespace {
+
+// `end_us` is the end of the phase on the trace clock.
+void TracePhase(trace::Sink& sink,
+                const char* name,
+                int64_t end_us,
+                uint32_t duration_us) {
+  sink.Complete("frame", name, end_us - duration_us, duration_us);
+}
+
+void LogPercentiles(const char* name, const LogHistogram& histogram) {
+  PW_LOG_INFO("%s us p50:%u p95:%u p99:%u max:%u",
+              name,
+              static_cast<unsigned>(histogram.Percentile(50)),
+              static_cast<unsigned>(histogram.Percentile(95)),
+              static_cast<unsigned>(histogram.Percentile(99)),
+              static_cast<unsigned>(histogram.max()));
+}
+
+}  // namespace
 
-FrameCounter::FrameCounter() {
-  second_counter_start = pw::chrono::SystemClock::now();
+FrameCounter::FrameCounter(const TimingClock& timing_clock)
+    : clock(timing_clock) {
+  second_counter_start = clock.now();
+  frame_start = second_counter_start;
+  acquire_end = second_counter_start;
+  draw_end = second_counter_start;
+  frame_end = second_counter_start;
+  last_frame_duration = std::chrono::microseconds(0);
   frame_count = 0;
   frames_per_second = 0;
-  draw_times.SetBuffer(draw_buffer);
-  flush_times.SetBuffer(flush_buffer);
+  overrun_budget_us = 0;
+  overrun_count = 0;
+  frame_start_i2c_counts = {};
+}
+
+void FrameCounter::SetOverrunBudget(pw::chrono::SystemClock::duration budget) {
+  overrun_budget_us =
+      std::chrono::round<std::chrono::microseconds>(budget).count();
 }
 
 void FrameCounter::StartFrame() {
-  frame_start = pw::chrono::SystemClock::now();
+  if (overrun_budget_us != 0) {
+    GetOverrunLog().ReadI2cCounts(frame_start_i2c_counts);
+  }
+  frame_start = clock.now();
+  acquire_end = frame_start;
+}
+
+void FrameCounter::EndAcquire() {
+  acquire_end = clock.now();
 }
 
 void FrameCounter::EndDraw() {
-  draw_end = pw::chrono::SystemClock::now();
-  auto draw_duration = draw_end - frame_start;
-  uint32_t elapsed_millis =
-      std::chrono::round<std::chrono::microseconds>(draw_duration).count();
-  draw_times.PushBack(
-      pw::as_bytes(pw::span{std::addressof(elapsed_millis), 1}));
+  draw_end = clock.now();
+  acquire_times.Record(ElapsedMicros(frame_start, acquire_end));
+  draw_times.Record(ElapsedMicros(acquire_end, draw_end));
 }
 
 void FrameCounter::EndFlush() {
-  frame_end = pw::chrono::SystemClock::now();
-  last_frame_duration = frame_end - frame_start;
-  auto flush_duration = frame_end - draw_end;
+  frame_end = clock.now();
+  const uint32_t frame_us = ElapsedMicros(frame_start, frame_end);
+  last_frame_duration = std::chrono::microseconds(frame_us);
   frame_count++;
-  uint32_t elapsed_millis =
-      std::chrono::round<std::chrono::microseconds>(flush_duration).count();
-  flush_times.PushBack(
-      pw::as_bytes(pw::span{std::addressof(elapsed_millis), 1}));
+  flush_times.Record(ElapsedMicros(draw_end, frame_end));
+  frame_times.Record(frame_us);
+  if (trace::Sink* sink = trace::GetSink()) {
+    // Place the phases on the trace clock by working back from now.
+    const int64_t end_us = trace::NowMicros();
+    const int64_t draw_end_us = end_us - ElapsedMicros(draw_end, frame_end);
+    const int64_t acquire_end_us =
+        draw_end_us - ElapsedMicros(acquire_end, draw_end);
+    TracePhase(*sink,
+               "acquire",
+               acquire_end_us,
+               ElapsedMicros(frame_start, acquire_end));
+    TracePhase(
+        *sink, "draw", draw_end_us, ElapsedMicros(acquire_end, draw_end));
+    TracePhase(*sink, "flush", end_us, ElapsedMicros(draw_end, frame_end));
+  }
+  if (overrun_budget_us != 0 && frame_us > overrun_budget_us) {
+    RecordOverrun();
+  }
 }
 
-void FrameCounter::LogTiming() {
-  if (frame_end - second_counter_start >
-      pw::chrono::SystemClock::for_at_least(1000ms)) {
-    frames_per_second = frame_count;
-    frame_count = 0;
-    PW_LOG_INFO("FPS:%d, Draw:%dus, Flush:%dus",
-                frames_per_second,
-                (int)CalcAverageUint32Value(draw_times),
-                (int)CalcAverageUint32Value(flush_times));
-    second_counter_start = pw::chrono::SystemClock::now();
+void FrameCounter::RecordOverrun() {
+  overrun_count++;
+
+  FrameOverrun overrun = {};
+  // The timing clock wraps, so uptime comes from the system clock.
+  overrun.uptime_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          pw::chrono::SystemClock::now().time_since_epoch())
+                          .count();
+  overrun.budget_us = overrun_budget_us;
+  overrun.acquire_us = ElapsedMicros(frame_start, acquire_end);
+  overrun.draw_us = ElapsedMicros(acquire_end, draw_end);
+  overrun.flush_us = ElapsedMicros(draw_end, frame_end);
+  overrun.frame_us = ElapsedMicros(frame_start, frame_end);
+
+  std::array<uint32_t, FrameOverrun::kMaxI2cBuses> i2c_counts;
+  GetOverrunLog().ReadI2cCounts(i2c_counts);
+  for (size_t i = 0; i < i2c_counts.size(); i++) {
+    overrun.i2c_transactions[i] = static_cast<uint16_t>(
+        std::min<uint32_t>(i2c_counts[i] - frame_start_i2c_counts[i], 0xffff));
   }
+
+  GetOverrunLog().Record(overrun);
 }
 
-uint32_t CalcAverageUint32Value(
-    pw::ring_buffer::PrefixedEntryRingBuffer& ring_buffer) {
-  uint64_t sum = 0;
-  uint32_t count = 0;
-  for (const auto& entry_info : ring_buffer) {
-    PW_ASSERT(entry_info.buffer.size() == sizeof(uint32_t));
-    uint32_t val;
-    std::memcpy(&val, entry_info.buffer.data(), sizeof(val));
-    sum += val;
-    count++;
+void FrameCounter::LogTiming() {
+  if (frame_end - second_counter_start > clock.ticks_per_second) {
+    frames_per_second = frame_count;
+    frame_count = 0;
+    PW_LOG_INFO("FPS:%d", frames_per_second);
+    if (overrun_count > 0) {
+      PW_LOG_WARN("%u frames over the %u us budget",
+                  static_cast<unsigned>(overrun_count),
+                  static_cast<unsigned>(overrun_budget_us));
+      overrun_count = 0;
+    }
+    LogPercentiles("Acquire", acquire_times);
+    LogPercentiles("Draw", draw_times);
+    LogPercentiles("Flush", flush_times);
+    LogPercentiles("Frame", frame_times);
+    GetTelemetryStore().PublishFrame({
+        .frames_per_second = static_cast<uint32_t>(frames_per_second),
+        .p50_us = frame_times.Percentile(50),
+        .p95_us = frame_times.Percentile(95),
+        .p99_us = frame_times.Percentile(99),
+        .max_us = frame_times.max(),
+    });
+    acquire_times.Reset();
+    draw_times.Reset();
+    flush_times.Reset();
+    frame_times.Reset();
+    second_counter_start = clock.now();
   }
-  return count == 0 ? 0 : sum / count;
 }
 
 }  // namespace kudzu
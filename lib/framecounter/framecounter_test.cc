@@ -0,0 +1,107 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/framecounter.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "libkudzu/overrun_log.h"
+#include "libkudzu/telemetry.h"
+#include "libkudzu/timing_scope.h"
+
+namespace {
+
+using kudzu::FrameCounter;
+using kudzu::FrameOverrun;
+using kudzu::TimingClock;
+using std::chrono::microseconds;
+
+// A clock which only moves when a test advances it, ticking at 2 MHz.
+uint32_t fake_ticks = 0;
+uint32_t FakeNow() { return fake_ticks; }
+constexpr TimingClock kFakeClock = {FakeNow, 2'000'000};
+
+class FrameCounterTest : public ::testing::Test {
+ protected:
+  // Start close to wrapping to check that differences survive it.
+  void SetUp() override {
+    fake_ticks = 0xffff'fff0;
+    kudzu::GetOverrunLog().Clear();
+  }
+
+  // Runs one frame with the given phase lengths in microseconds.
+  void RunFrame(FrameCounter& counter,
+                uint32_t acquire_us,
+                uint32_t draw_us,
+                uint32_t flush_us) {
+    counter.StartFrame();
+    fake_ticks += acquire_us * 2;
+    counter.EndAcquire();
+    fake_ticks += draw_us * 2;
+    counter.EndDraw();
+    fake_ticks += flush_us * 2;
+    counter.EndFlush();
+  }
+};
+
+TEST_F(FrameCounterTest, TimesPhasesFinerThanTheSystemClock) {
+  FrameCounter counter(kFakeClock);
+  RunFrame(counter, 150, 2'500, 40);
+
+  EXPECT_EQ(counter.AcquireTimes().max(), 150u);
+  EXPECT_EQ(counter.DrawTimes().max(), 2'500u);
+  EXPECT_EQ(counter.FlushTimes().max(), 40u);
+  EXPECT_EQ(counter.FrameTimes().max(), 2'690u);
+  EXPECT_EQ(counter.LastFrameDuration(), microseconds(2'690));
+}
+
+TEST_F(FrameCounterTest, RecordsOverrunsByTimingClock) {
+  FrameCounter counter(kFakeClock);
+  counter.SetOverrunBudget(std::chrono::milliseconds(5));
+  RunFrame(counter, 100, 4'000, 800);
+  RunFrame(counter, 100, 5'000, 800);
+
+  std::array<FrameOverrun, kudzu::OverrunLog::kCapacity> overruns;
+  ASSERT_EQ(kudzu::GetOverrunLog().Read(overruns), 1u);
+  EXPECT_EQ(overruns[0].budget_us, 5'000u);
+  EXPECT_EQ(overruns[0].acquire_us, 100u);
+  EXPECT_EQ(overruns[0].draw_us, 5'000u);
+  EXPECT_EQ(overruns[0].flush_us, 800u);
+  EXPECT_EQ(overruns[0].frame_us, 5'900u);
+}
+
+TEST_F(FrameCounterTest, PublishesOncePerTimingClockSecond) {
+  FrameCounter counter(kFakeClock);
+  for (int i = 0; i < 60; i++) {
+    RunFrame(counter, 0, 16'000, 600);
+    counter.LogTiming();
+  }
+  // 60 frames of 16.6 ms is just under a second.
+  RunFrame(counter, 0, 16'000, 600);
+  counter.LogTiming();
+
+  std::optional<kudzu::FrameTelemetry> frame =
+      kudzu::GetTelemetryStore().frame();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->frames_per_second, 61u);
+  EXPECT_EQ(frame->max_us, 16'600u);
+  EXPECT_GE(frame->p95_us, 16'600u);
+  EXPECT_EQ(counter.FrameTimes().count(), 0u);
+}
+
+}  // namespace
@@ -0,0 +1,118 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/histogram.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using kudzu::BasicLogHistogram;
+using kudzu::LogHistogram;
+
+TEST(LogHistogramTest, EmptyReportsZero) {
+  LogHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.max(), 0u);
+  EXPECT_EQ(histogram.Percentile(50), 0u);
+  EXPECT_EQ(histogram.Percentile(100), 0u);
+}
+
+TEST(LogHistogramTest, BucketsCoverEveryValueInOrder) {
+  EXPECT_EQ(LogHistogram::BucketIndex(0), 0u);
+  EXPECT_EQ(LogHistogram::BucketIndex(std::numeric_limits<uint32_t>::max()),
+            LogHistogram::kNumBuckets - 1);
+  EXPECT_EQ(LogHistogram::BucketUpperBound(LogHistogram::kNumBuckets - 1),
+            std::numeric_limits<uint32_t>::max());
+  for (size_t i = 0; i + 1 < LogHistogram::kNumBuckets; i++) {
+    const uint32_t upper = LogHistogram::BucketUpperBound(i);
+    EXPECT_EQ(LogHistogram::BucketIndex(upper), i);
+    EXPECT_EQ(LogHistogram::BucketIndex(upper + 1), i + 1);
+  }
+}
+
+TEST(LogHistogramTest, SmallValuesAreExact) {
+  LogHistogram histogram;
+  for (uint32_t value = 1; value <= 4; value++) {
+    histogram.Record(value);
+  }
+  EXPECT_EQ(histogram.Percentile(25), 1u);
+  EXPECT_EQ(histogram.Percentile(50), 2u);
+  EXPECT_EQ(histogram.Percentile(75), 3u);
+  EXPECT_EQ(histogram.Percentile(100), 4u);
+}
+
+TEST(LogHistogramTest, PercentilesAreWithinOneBucket) {
+  LogHistogram histogram;
+  for (uint32_t value = 1; value <= 1000; value++) {
+    histogram.Record(value * 100);
+  }
+  EXPECT_EQ(histogram.count(), 1000u);
+  EXPECT_EQ(histogram.max(), 100000u);
+  for (uint32_t percent : {50u, 95u, 99u}) {
+    const uint32_t expected = percent * 1000;
+    const uint32_t actual = histogram.Percentile(percent);
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual, expected + expected / 8);
+  }
+  EXPECT_EQ(histogram.Percentile(100), 100000u);
+}
+
+TEST(LogHistogramTest, TailIsNotHiddenByTheAverage) {
+  LogHistogram histogram;
+  for (int i = 0; i < 98; i++) {
+    histogram.Record(16000);
+  }
+  histogram.Record(50000);
+  histogram.Record(70000);
+  EXPECT_LT(histogram.Percentile(50), 18000u);
+  EXPECT_LT(histogram.Percentile(95), 18000u);
+  EXPECT_GE(histogram.Percentile(99), 50000u);
+  EXPECT_EQ(histogram.max(), 70000u);
+}
+
+TEST(LogHistogramTest, ResetClearsSamples) {
+  LogHistogram histogram;
+  histogram.Record(1234);
+  histogram.Reset();
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.max(), 0u);
+  EXPECT_EQ(histogram.Percentile(99), 0u);
+  histogram.Record(7);
+  EXPECT_EQ(histogram.Percentile(50), 7u);
+}
+
+TEST(LogHistogramTest, NarrowRangeSharesTheTopBucket) {
+  using Histogram = BasicLogHistogram<16>;
+  static_assert(Histogram::kNumBuckets == 112);
+  EXPECT_EQ(Histogram::BucketIndex(0xffff), Histogram::kNumBuckets - 1);
+  EXPECT_EQ(Histogram::BucketIndex(0x10000), Histogram::kNumBuckets - 1);
+  EXPECT_EQ(Histogram::BucketIndex(0xffff'ffff), Histogram::kNumBuckets - 1);
+
+  Histogram histogram;
+  for (int i = 0; i < 90; i++) {
+    histogram.Record(1000);
+  }
+  for (int i = 0; i < 10; i++) {
+    histogram.Record(200000);
+  }
+  EXPECT_LT(histogram.Percentile(50), 1125u);
+  EXPECT_EQ(histogram.Percentile(95), 200000u);
+  EXPECT_EQ(histogram.max(), 200000u);
+}
+
+}  // namespace
@@ -0,0 +1,184 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/overrun_log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "pw_preprocessor/compiler.h"
+#include "pw_span/span.h"
+
+namespace kudzu {
+namespace {
+
+constexpr uint32_t kMagic = 0x4b4f5652;  // "KOVR"
+
+// Folds `value` into an FNV-1a hash, least significant byte first.
+template <typename T>
+void Hash(uint32_t& hash, T value) {
+  for (size_t i = 0; i < sizeof(T); i++) {
+    hash = (hash ^ static_cast<uint8_t>(value >> (8 * i))) * 16777619u;
+  }
+}
+
+// FNV-1a over every field before the checksum. The fields are hashed one at
+// a time because copying a FrameOverrun doesn't preserve its padding.
+uint32_t Checksum(const FrameOverrun& overrun) {
+  uint32_t hash = 2166136261u;
+  Hash(hash, overrun.sequence);
+  Hash(hash, overrun.boot);
+  Hash(hash, overrun.uptime_ms);
+  Hash(hash, overrun.budget_us);
+  Hash(hash, overrun.acquire_us);
+  Hash(hash, overrun.draw_us);
+  Hash(hash, overrun.flush_us);
+  Hash(hash, overrun.frame_us);
+  for (uint16_t count : overrun.i2c_transactions) {
+    Hash(hash, count);
+  }
+  Hash(hash, overrun.task_count);
+  for (const OverrunTask& task : overrun.tasks) {
+    for (char c : task.name) {
+      Hash(hash, static_cast<uint8_t>(c));
+    }
+    Hash(hash, task.state);
+    Hash(hash, task.priority);
+    Hash(hash, task.stack_high_water_bytes);
+  }
+  return hash;
+}
+
+bool IsValid(const FrameOverrun& overrun) {
+  return overrun.sequence != 0 && overrun.checksum == Checksum(overrun) &&
+         overrun.task_count <= FrameOverrun::kMaxTasks;
+}
+
+}  // namespace
+
+OverrunLog::OverrunLog(Storage& storage) : storage_(storage) {
+  std::lock_guard lock(lock_);
+  if (storage_.magic != kMagic || storage_.size != sizeof(Storage) ||
+      storage_.next_sequence == 0) {
+    Reset();
+    storage_.boot_count = 0;
+  }
+  storage_.boot_count++;
+}
+
+void OverrunLog::SetI2cCountReader(I2cCountReader reader) {
+  std::lock_guard lock(lock_);
+  i2c_count_reader_ = reader;
+}
+
+void OverrunLog::SetTaskReader(TaskReader reader) {
+  std::lock_guard lock(lock_);
+  task_reader_ = reader;
+}
+
+void OverrunLog::ReadI2cCounts(
+    pw::span<uint32_t, FrameOverrun::kMaxI2cBuses> counts) const {
+  I2cCountReader reader;
+  {
+    std::lock_guard lock(lock_);
+    reader = i2c_count_reader_;
+  }
+  std::fill(counts.begin(), counts.end(), 0);
+  if (reader != nullptr) {
+    reader(counts);
+  }
+}
+
+void OverrunLog::Record(const FrameOverrun& overrun) {
+  TaskReader reader;
+  {
+    std::lock_guard lock(lock_);
+    reader = task_reader_;
+  }
+  // Read the tasks outside of the lock, as the reader may suspend the
+  // scheduler for a while.
+  FrameOverrun entry = overrun;
+  entry.task_count = 0;
+  entry.tasks = {};
+  if (reader != nullptr) {
+    entry.task_count = static_cast<uint8_t>(
+        std::min(reader(entry.tasks), FrameOverrun::kMaxTasks));
+  }
+
+  std::lock_guard lock(lock_);
+  entry.sequence = storage_.next_sequence;
+  entry.boot = storage_.boot_count;
+  entry.checksum = Checksum(entry);
+  storage_.entries[(entry.sequence - 1) % kCapacity] = entry;
+  storage_.next_sequence++;
+  if (storage_.next_sequence == 0) {
+    // Sequence zero marks an empty slot, so start over rather than wrap.
+    Reset();
+  }
+}
+
+size_t OverrunLog::Read(pw::span<FrameOverrun> overruns) const {
+  size_t count = 0;
+  {
+    std::lock_guard lock(lock_);
+    for (const FrameOverrun& entry : storage_.entries) {
+      if (count < overruns.size() && IsValid(entry)) {
+        overruns[count++] = entry;
+      }
+    }
+  }
+  std::sort(overruns.begin(),
+            overruns.begin() + count,
+            [](const FrameOverrun& a, const FrameOverrun& b) {
+              return a.sequence < b.sequence;
+            });
+  return count;
+}
+
+void OverrunLog::Clear() {
+  std::lock_guard lock(lock_);
+  Reset();
+}
+
+uint32_t OverrunLog::boot_count() const {
+  std::lock_guard lock(lock_);
+  return storage_.boot_count;
+}
+
+void OverrunLog::Reset() {
+  storage_.magic = kMagic;
+  storage_.size = sizeof(Storage);
+  storage_.next_sequence = 1;
+  for (FrameOverrun& entry : storage_.entries) {
+    entry.sequence = 0;
+  }
+}
+
+namespace {
+
+#ifdef KUDZU_OVERRUN_LOG_SECTION
+PW_PLACE_IN_SECTION(KUDZU_OVERRUN_LOG_SECTION)
+#endif
+OverrunLog::Storage s_overrun_log_storage;
+
+}  // namespace
+
+OverrunLog& GetOverrunLog() {
+  static OverrunLog log(s_overrun_log_storage);
+  return log;
+}
+
+}  // namespace kudzu
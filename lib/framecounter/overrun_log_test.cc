@@ -0,0 +1,156 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/overrun_log.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_span/span.h"
+
+namespace {
+
+using kudzu::FrameOverrun;
+using kudzu::OverrunLog;
+using kudzu::OverrunTask;
+
+FrameOverrun MakeOverrun(uint32_t frame_us) {
+  FrameOverrun overrun = {};
+  overrun.budget_us = 33'000;
+  overrun.frame_us = frame_us;
+  return overrun;
+}
+
+size_t ReadTwoTasks(pw::span<OverrunTask> tasks) {
+  std::strcpy(tasks[0].name.data(), "Draw");
+  tasks[0].state = 0;
+  std::strcpy(tasks[1].name.data(), "IDLE");
+  tasks[1].state = 1;
+  return 2;
+}
+
+class OverrunLogTest : public ::testing::Test {
+ protected:
+  // Storage which hasn't been touched since power on holds garbage.
+  void SetUp() override { std::memset(&storage_, 0xa5, sizeof(storage_)); }
+
+  OverrunLog::Storage storage_;
+  std::array<FrameOverrun, OverrunLog::kCapacity> read_;
+};
+
+TEST_F(OverrunLogTest, StartsEmptyOnGarbage) {
+  OverrunLog log(storage_);
+  EXPECT_EQ(log.Read(read_), 0u);
+  EXPECT_EQ(log.boot_count(), 1u);
+}
+
+TEST_F(OverrunLogTest, ReadsOldestFirst) {
+  OverrunLog log(storage_);
+  log.Record(MakeOverrun(40'000));
+  log.Record(MakeOverrun(50'000));
+
+  ASSERT_EQ(log.Read(read_), 2u);
+  EXPECT_EQ(read_[0].frame_us, 40'000u);
+  EXPECT_EQ(read_[0].sequence, 1u);
+  EXPECT_EQ(read_[1].frame_us, 50'000u);
+  EXPECT_EQ(read_[1].sequence, 2u);
+}
+
+TEST_F(OverrunLogTest, KeepsNewestWhenFull) {
+  OverrunLog log(storage_);
+  for (uint32_t i = 0; i < OverrunLog::kCapacity + 3; i++) {
+    log.Record(MakeOverrun(i));
+  }
+
+  ASSERT_EQ(log.Read(read_), OverrunLog::kCapacity);
+  for (uint32_t i = 0; i < OverrunLog::kCapacity; i++) {
+    EXPECT_EQ(read_[i].frame_us, i + 3);
+  }
+}
+
+TEST_F(OverrunLogTest, SurvivesReset) {
+  {
+    OverrunLog log(storage_);
+    log.Record(MakeOverrun(40'000));
+  }
+
+  OverrunLog log(storage_);
+  EXPECT_EQ(log.boot_count(), 2u);
+  log.Record(MakeOverrun(50'000));
+  ASSERT_EQ(log.Read(read_), 2u);
+  EXPECT_EQ(read_[0].boot, 1u);
+  EXPECT_EQ(read_[1].boot, 2u);
+  EXPECT_EQ(read_[1].sequence, 2u);
+}
+
+TEST_F(OverrunLogTest, DropsTornEntries) {
+  OverrunLog log(storage_);
+  log.Record(MakeOverrun(40'000));
+  log.Record(MakeOverrun(50'000));
+  storage_.entries[0].draw_us++;
+
+  ASSERT_EQ(log.Read(read_), 1u);
+  EXPECT_EQ(read_[0].frame_us, 50'000u);
+}
+
+TEST_F(OverrunLogTest, IgnoresPadding) {
+  OverrunLog log(storage_);
+  log.Record(MakeOverrun(40'000));
+  // The byte after task_count is padding, which copies needn't preserve.
+  auto* bytes = reinterpret_cast<uint8_t*>(&storage_.entries[0]);
+  bytes[offsetof(FrameOverrun, task_count) + 1] ^= 0xff;
+
+  ASSERT_EQ(log.Read(read_), 1u);
+  EXPECT_EQ(read_[0].frame_us, 40'000u);
+}
+
+TEST_F(OverrunLogTest, ClearKeepsBootCount) {
+  {
+    OverrunLog log(storage_);
+  }
+  OverrunLog log(storage_);
+  log.Record(MakeOverrun(40'000));
+  log.Clear();
+
+  EXPECT_EQ(log.Read(read_), 0u);
+  EXPECT_EQ(log.boot_count(), 2u);
+}
+
+TEST_F(OverrunLogTest, RecordsTasksAndI2cCounts) {
+  OverrunLog log(storage_);
+  std::array<uint32_t, FrameOverrun::kMaxI2cBuses> counts;
+  log.ReadI2cCounts(counts);
+  EXPECT_EQ(counts[0], 0u);
+
+  log.SetTaskReader(ReadTwoTasks);
+  log.SetI2cCountReader(
+      [](pw::span<uint32_t, FrameOverrun::kMaxI2cBuses> bus_counts) {
+        bus_counts[0] = 12;
+      });
+  log.ReadI2cCounts(counts);
+  EXPECT_EQ(counts[0], 12u);
+
+  log.Record(MakeOverrun(40'000));
+  ASSERT_EQ(log.Read(read_), 1u);
+  ASSERT_EQ(read_[0].task_count, 2u);
+  EXPECT_EQ(std::string_view(read_[0].tasks[0].name.data()), "Draw");
+  EXPECT_EQ(std::string_view(read_[0].tasks[1].name.data()), "IDLE");
+  EXPECT_EQ(read_[0].tasks[1].state, 1u);
+}
+
+}  // namespace
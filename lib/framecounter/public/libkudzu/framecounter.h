@@ -16,47 +16,88 @@
 
 #include <stdint.h>
 
+#include <array>
+
+#include "libkudzu/histogram.h"
+#include "libkudzu/overrun_log.h"
+#include "libkudzu/timing_scope.h"
 #include "pw_chrono/system_clock.h"
-#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
 
 namespace kudzu {
 
+/// Measures the phases of a display loop and logs frames per second and
+/// percentiles of each phase's duration once a second.
+///
+/// Call `StartFrame()` at the top of the loop, `EndAcquire()` once a
+/// framebuffer has been acquired, `EndDraw()` once drawing is done and
+/// `EndFlush()` once the framebuffer has been released. Loops which don't wait
+/// for a framebuffer may skip `EndAcquire()`.
+///
+/// Phases are timed with `timing_clock`, usually `Common::GetTimingClock()`, since
+/// the system clock is too coarse to tell most phases apart from zero.
+///
+/// With a budget set, frames which go over it are also recorded in the
+/// overrun log, which survives a soft reset.
 class FrameCounter {
  public:
-  FrameCounter();
+  explicit FrameCounter(const TimingClock& timing_clock);
 
   void StartFrame();
+  void EndAcquire();
   void EndDraw();
   void EndFlush();
   void LogTiming();
-  inline pw::chrono::SystemClock::duration LastFrameDuration() {
+
+  /// Records each frame which takes longer than `budget` in `GetOverrunLog()`.
+  /// A zero budget, the default, records nothing.
+  void SetOverrunBudget(pw::chrono::SystemClock::duration budget);
+
+  inline std::chrono::microseconds LastFrameDuration() {
     return last_frame_duration;
   }
   inline std::chrono::milliseconds LastFrameMilliseconds() {
     return std::chrono::round<std::chrono::milliseconds>(last_frame_duration);
   }
+  // Frames counted in the last full second, as of the last `LogTiming()`.
+  inline int FramesPerSecond() const { return frames_per_second; }
+
+  // Phase durations in microseconds for the frames since the last log.
+  const LogHistogram& AcquireTimes() const { return acquire_times; }
+  const LogHistogram& DrawTimes() const { return draw_times; }
+  const LogHistogram& FlushTimes() const { return flush_times; }
+  const LogHistogram& FrameTimes() const { return frame_times; }
 
  private:
-  pw::chrono::SystemClock::time_point second_counter_start;
-  // Start of a single frame / start of the draw phase.
-  pw::chrono::SystemClock::time_point frame_start;
+  const TimingClock& clock;
+  // The points below are readings of `clock`.
+  uint32_t second_counter_start;
+  // Start of a single frame / start of waiting for a framebuffer.
+  uint32_t frame_start;
+  // Framebuffer acquired / start of the draw phase.
+  uint32_t acquire_end;
   // End of the draw phase / start of the flush phase.
-  pw::chrono::SystemClock::time_point draw_end;
+  uint32_t draw_end;
   // End of the flush phase and end of the frame.
-  pw::chrono::SystemClock::time_point frame_end;
+  uint32_t frame_end;
   // Duration of frame_start to frame_end.
-  pw::chrono::SystemClock::duration last_frame_duration;
+  std::chrono::microseconds last_frame_duration;
   uint32_t frame_count;
   int frames_per_second;
-  std::byte draw_buffer[30 * sizeof(uint32_t)];
-  std::byte flush_buffer[30 * sizeof(uint32_t)];
-  pw::ring_buffer::PrefixedEntryRingBuffer draw_times;
-  pw::ring_buffer::PrefixedEntryRingBuffer flush_times;
-};
+  LogHistogram acquire_times;
+  LogHistogram draw_times;
+  LogHistogram flush_times;
+  LogHistogram frame_times;
+  // Zero when overruns aren't recorded.
+  uint32_t overrun_budget_us;
+  // Overruns since the last log.
+  uint32_t overrun_count;
+  // Each I2C bus's transaction count at the start of the frame.
+  std::array<uint32_t, FrameOverrun::kMaxI2cBuses> frame_start_i2c_counts;
 
-/// Given a ring buffer full of uint32_t values, return the average value or
-/// zero if empty (or iteration error).
-uint32_t CalcAverageUint32Value(
-    pw::ring_buffer::PrefixedEntryRingBuffer& ring_buffer);
+  uint32_t ElapsedMicros(uint32_t start, uint32_t end) const {
+    return clock.ToMicroseconds(end - start);
+  }
+  void RecordOverrun();
+};
 
 }  // namespace kudzu
@@ -0,0 +1,126 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace kudzu {
+
+/// A histogram of uint32_t samples, such as durations in microseconds, with
+/// fixed log-scale buckets.
+///
+/// Each power of two is split into 8 equal buckets, so a percentile is never
+/// off by more than 12.5% of its value, and values below 8 are exact.
+/// `Record()` is O(1) and never allocates; percentile queries walk the
+/// buckets.
+///
+/// Only values below 2^`kValueBits` get their own buckets; larger ones share
+/// the top bucket, so their percentiles read as `max()`. Narrowing the range
+/// saves 16 bytes per bit.
+template <int kValueBits = 32>
+class BasicLogHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  static constexpr size_t kNumBuckets =
+      (kValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  static_assert(kValueBits > kSubBucketBits && kValueBits <= 32);
+
+  void Record(uint32_t value) {
+    uint16_t& bucket = buckets_[BucketIndex(value)];
+    if (bucket < std::numeric_limits<uint16_t>::max()) {
+      bucket++;
+    }
+    count_++;
+    if (value > max_) {
+      max_ = value;
+    }
+  }
+
+  void Reset() {
+    buckets_.fill(0);
+    count_ = 0;
+    max_ = 0;
+  }
+
+  /// Number of samples recorded since the last reset.
+  uint32_t count() const { return count_; }
+
+  /// Largest sample recorded since the last reset, or zero if there are none.
+  uint32_t max() const { return max_; }
+
+  /// Returns the smallest value which at least `percent` of the samples are
+  /// less than or equal to, rounded up to the top of its bucket but never
+  /// above `max()`. Returns zero if there are no samples.
+  uint32_t Percentile(uint32_t percent) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    // The rank of the sample to find, rounded up and counting from one.
+    const uint64_t rank =
+        std::max<uint64_t>((uint64_t{count_} * percent + 99) / 100, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i + 1 < kNumBuckets; i++) {
+      seen += buckets_[i];
+      if (seen >= rank) {
+        return std::min(BucketUpperBound(i), max_);
+      }
+    }
+    // The top bucket, or a bucket saturated.
+    return max_;
+  }
+
+  /// Index of the bucket holding `value`.
+  static constexpr size_t BucketIndex(uint32_t value) {
+    if (value < kSubBuckets) {
+      return value;
+    }
+    if (kValueBits < 32 && (uint64_t{value} >> kValueBits) != 0) {
+      return kNumBuckets - 1;
+    }
+    const int msb = 31 - __builtin_clz(value);
+    const int shift = msb - kSubBucketBits;
+    const size_t sub_bucket = (value >> shift) & (kSubBuckets - 1);
+    return static_cast<size_t>(shift + 1) * kSubBuckets + sub_bucket;
+  }
+
+  /// Largest value which falls in bucket `index`, not counting the values
+  /// past the range which share the top bucket.
+  static constexpr uint32_t BucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+      return static_cast<uint32_t>(index);
+    }
+    const int shift = static_cast<int>(index / kSubBuckets) - 1;
+    const uint64_t lower = uint64_t{kSubBuckets + index % kSubBuckets}
+                           << shift;
+    return static_cast<uint32_t>(lower + (uint64_t{1} << shift) - 1);
+  }
+
+ private:
+  // Counts saturate rather than wrap; reset the histogram periodically.
+  std::array<uint16_t, kNumBuckets> buckets_ = {};
+  uint32_t count_ = 0;
+  uint32_t max_ = 0;
+};
+
+/// A histogram covering every uint32_t value.
+using LogHistogram = BasicLogHistogram<>;
+
+}  // namespace kudzu
@@ -0,0 +1,129 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_span/span.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace kudzu {
+
+/// A task's state at the end of a frame which went over its budget.
+struct OverrunTask {
+  static constexpr size_t kMaxNameLength = 11;
+
+  // Null terminated, and truncated if longer than kMaxNameLength.
+  std::array<char, kMaxNameLength + 1> name;
+  // The scheduler's state for the task, e.g. FreeRTOS's eTaskState.
+  uint8_t state;
+  uint8_t priority;
+  uint16_t stack_high_water_bytes;
+};
+
+/// What was going on during a frame which went over its budget.
+///
+/// This is kept in memory which isn't cleared on reset, so it must stay
+/// trivially constructible: no constructors or default member initializers.
+struct FrameOverrun {
+  static constexpr size_t kMaxI2cBuses = 2;
+  static constexpr size_t kMaxTasks = 10;
+
+  // Counts up from one across resets. Zero marks an empty slot.
+  uint32_t sequence;
+  // The OverrunLog's boot count when this was recorded.
+  uint32_t boot;
+  uint32_t uptime_ms;
+  uint32_t budget_us;
+  uint32_t acquire_us;
+  uint32_t draw_us;
+  uint32_t flush_us;
+  uint32_t frame_us;
+  // Transactions on each I2C bus during the frame, saturating.
+  std::array<uint16_t, kMaxI2cBuses> i2c_transactions;
+  uint8_t task_count;
+  std::array<OverrunTask, kMaxTasks> tasks;
+  // Checks the fields above, so an entry torn by a reset is dropped.
+  uint32_t checksum;
+};
+
+/// A small ring of the most recent frame overruns which survives a soft
+/// reset, so hitches can be read back over RPC after the fact.
+///
+/// The log doesn't own its storage. Place the storage in a linker section
+/// which isn't zeroed at startup and the log picks up where the previous
+/// boot left off; storage holding anything else, e.g. after power on, is
+/// cleared.
+///
+/// Task states and I2C transaction counts come from readers the board
+/// registers, as they are specific to its scheduler and buses.
+class OverrunLog {
+ public:
+  static constexpr size_t kCapacity = 8;
+
+  struct Storage {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t boot_count;
+    uint32_t next_sequence;
+    std::array<FrameOverrun, kCapacity> entries;
+  };
+
+  /// Writes each bus's total transaction count since boot to `counts`.
+  using I2cCountReader =
+      void (*)(pw::span<uint32_t, FrameOverrun::kMaxI2cBuses> counts);
+  /// Writes up to `tasks.size()` tasks and returns the number written.
+  using TaskReader = size_t (*)(pw::span<OverrunTask> tasks);
+
+  explicit OverrunLog(Storage& storage);
+
+  void SetI2cCountReader(I2cCountReader reader);
+  void SetTaskReader(TaskReader reader);
+
+  /// Reads each bus's transaction count since boot, or zeros without a
+  /// reader. This is cheap enough to call every frame.
+  void ReadI2cCounts(
+      pw::span<uint32_t, FrameOverrun::kMaxI2cBuses> counts) const;
+
+  /// Stores `overrun`'s timings and I2C counts along with the current task
+  /// states, replacing the oldest entry if the log is full.
+  void Record(const FrameOverrun& overrun);
+
+  /// Copies the stored overruns to `overruns`, oldest first, and returns the
+  /// number copied.
+  size_t Read(pw::span<FrameOverrun> overruns) const;
+
+  void Clear();
+
+  /// Number of boots the storage has been kept across, starting from one.
+  uint32_t boot_count() const;
+
+ private:
+  // Empties the log, keeping the boot count.
+  void Reset() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable pw::sync::Mutex lock_;
+  Storage& storage_ PW_GUARDED_BY(lock_);
+  I2cCountReader i2c_count_reader_ PW_GUARDED_BY(lock_) = nullptr;
+  TaskReader task_reader_ PW_GUARDED_BY(lock_) = nullptr;
+};
+
+/// The log shared by the app's FrameCounter and the RPC service.
+OverrunLog& GetOverrunLog();
+
+}  // namespace kudzu
@@ -0,0 +1,135 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_span/span.h"
+
+namespace kudzu {
+
+/// A free running counter which is much finer than the system clock, used to
+/// time sections of a frame. The count wraps, so only differences between
+/// readings taken less than one wrap apart are meaningful.
+struct TimingClock {
+  uint32_t (*now)();
+  uint32_t ticks_per_second;
+
+  uint32_t ToMicroseconds(uint32_t ticks) const {
+    return static_cast<uint32_t>(uint64_t{ticks} * 1'000'000 /
+                                 ticks_per_second);
+  }
+};
+
+/// Records the named, nested `TimingScope`s of a single frame into a fixed
+/// size buffer. When a frame takes longer than the budget the scopes are
+/// logged as an indented tree, at most once a second.
+///
+/// Not thread safe; use it from the thread which draws the frames.
+class FrameTimeline {
+ public:
+  static constexpr size_t kMaxEvents = 32;
+
+  struct Event {
+    // The scope's name, which has static storage.
+    const char* name;
+    // Ticks from the start of the frame to the start of the scope.
+    uint32_t start;
+    // Ticks spent in the scope, or zero while it is still open.
+    uint32_t duration;
+    // Number of scopes this one is nested in.
+    uint8_t depth;
+  };
+
+  explicit FrameTimeline(const TimingClock& clock) : clock_(clock) {}
+
+  /// Frames which take longer than `budget` are logged. Zero, the default,
+  /// never logs.
+  void set_budget(std::chrono::microseconds budget) {
+    budget_us_ = static_cast<uint32_t>(budget.count());
+  }
+
+  /// Discard the previous frame's events and start timing a new frame.
+  void StartFrame();
+
+  /// Finish timing the frame and log it if it was over budget.
+  void EndFrame();
+
+  /// Log the events of the last frame.
+  void LogFrame() const;
+
+  /// Scopes of the current frame, or the last frame once it has ended, in the
+  /// order they were entered.
+  pw::span<const Event> events() const {
+    return pw::span(events_.data(), num_events_);
+  }
+
+  /// Scopes which were left out of the current frame because the buffer was
+  /// full.
+  uint32_t dropped_events() const { return dropped_events_; }
+
+  /// Ticks from `StartFrame()` to `EndFrame()`.
+  uint32_t frame_ticks() const { return frame_ticks_; }
+
+  const TimingClock& clock() const { return clock_; }
+
+  // Used by TimingScope. BeginScope returns the event index to pass to
+  // EndScope, or -1 if the event was dropped.
+  int BeginScope(const char* name);
+  void EndScope(int index);
+
+ private:
+  const TimingClock& clock_;
+  uint32_t budget_us_ = 0;
+  uint32_t frame_start_ = 0;
+  uint32_t frame_ticks_ = 0;
+  uint32_t last_report_ = 0;
+  bool reported_ = false;
+  uint8_t depth_ = 0;
+  size_t num_events_ = 0;
+  uint32_t dropped_events_ = 0;
+  std::array<Event, kMaxEvents> events_;
+};
+
+/// Times the enclosing block as a named event in a `FrameTimeline`. Scopes may
+/// be nested, and are shown nested when the frame is logged.
+///
+/// @code
+///   {
+///     kudzu::TimingScope scope(timeline, "background");
+///     DrawBackground(framebuffer);
+///   }
+/// @endcode
+class TimingScope {
+ public:
+  /// `name` must be a string literal, which is all that is stored.
+  template <size_t kLength>
+  TimingScope(FrameTimeline& timeline, const char (&name)[kLength])
+      : timeline_(timeline), index_(timeline.BeginScope(name)) {}
+
+  ~TimingScope() { timeline_.EndScope(index_); }
+
+  TimingScope(const TimingScope&) = delete;
+  TimingScope& operator=(const TimingScope&) = delete;
+
+ private:
+  FrameTimeline& timeline_;
+  const int index_;
+};
+
+}  // namespace kudzu
@@ -0,0 +1,96 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/timing_scope.h"
+
+#define PW_LOG_MODULE_NAME "FrameTimeline"
+
+#include <cstdint>
+
+#include "libkudzu/trace.h"
+#include "pw_log/log.h"
+
+namespace kudzu {
+
+void FrameTimeline::StartFrame() {
+  num_events_ = 0;
+  dropped_events_ = 0;
+  depth_ = 0;
+  frame_ticks_ = 0;
+  frame_start_ = clock_.now();
+}
+
+void FrameTimeline::EndFrame() {
+  const uint32_t now = clock_.now();
+  frame_ticks_ = now - frame_start_;
+  if (trace::Sink* sink = trace::GetSink()) {
+    const int64_t frame_start_us =
+        trace::NowMicros() - clock_.ToMicroseconds(frame_ticks_);
+    for (const Event& event : events()) {
+      sink->Complete("scope",
+                     event.name,
+                     frame_start_us + clock_.ToMicroseconds(event.start),
+                     clock_.ToMicroseconds(event.duration));
+    }
+  }
+  if (budget_us_ == 0 || clock_.ToMicroseconds(frame_ticks_) <= budget_us_) {
+    return;
+  }
+  // Over budget frames tend to come in runs; only log one a second.
+  if (reported_ && now - last_report_ < clock_.ticks_per_second) {
+    return;
+  }
+  reported_ = true;
+  last_report_ = now;
+  PW_LOG_WARN("Frame took %uus, over the %uus budget",
+              static_cast<unsigned>(clock_.ToMicroseconds(frame_ticks_)),
+              static_cast<unsigned>(budget_us_));
+  LogFrame();
+}
+
+void FrameTimeline::LogFrame() const {
+  for (const Event& event : events()) {
+    PW_LOG_INFO("%*s%s: %uus at %uus",
+                event.depth * 2,
+                "",
+                event.name,
+                static_cast<unsigned>(clock_.ToMicroseconds(event.duration)),
+                static_cast<unsigned>(clock_.ToMicroseconds(event.start)));
+  }
+  if (dropped_events_ > 0) {
+    PW_LOG_INFO("%u more scopes didn't fit",
+                static_cast<unsigned>(dropped_events_));
+  }
+}
+
+int FrameTimeline::BeginScope(const char* name) {
+  const uint8_t depth = depth_++;
+  if (num_events_ == kMaxEvents) {
+    dropped_events_++;
+    return -1;
+  }
+  events_[num_events_] = {name, clock_.now() - frame_start_, 0, depth};
+  return static_cast<int>(num_events_++);
+}
+
+void FrameTimeline::EndScope(int index) {
+  depth_--;
+  if (index < 0) {
+    return;
+  }
+  Event& event = events_[index];
+  event.duration = clock_.now() - frame_start_ - event.start;
+}
+
+}  // namespace kudzu
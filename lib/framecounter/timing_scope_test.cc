@@ -0,0 +1,136 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/timing_scope.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using kudzu::FrameTimeline;
+using kudzu::TimingClock;
+using kudzu::TimingScope;
+
+// A clock which only moves when a test advances it, ticking at 2 MHz.
+uint32_t fake_ticks = 0;
+uint32_t FakeNow() { return fake_ticks; }
+constexpr TimingClock kFakeClock = {FakeNow, 2'000'000};
+
+class FrameTimelineTest : public ::testing::Test {
+ protected:
+  // Start close to wrapping to check that differences survive it.
+  void SetUp() override { fake_ticks = 0xffff'fff0; }
+
+  FrameTimeline timeline_{kFakeClock};
+};
+
+TEST_F(FrameTimelineTest, ConvertsTicksToMicroseconds) {
+  EXPECT_EQ(kFakeClock.ToMicroseconds(0), 0u);
+  EXPECT_EQ(kFakeClock.ToMicroseconds(2'000'000), 1'000'000u);
+  EXPECT_EQ(kFakeClock.ToMicroseconds(0xffff'ffff), 2'147'483'647u);
+}
+
+TEST_F(FrameTimelineTest, RecordsNestedScopesInOrder) {
+  timeline_.StartFrame();
+  fake_ticks += 10;
+  {
+    TimingScope input(timeline_, "input");
+    fake_ticks += 20;
+  }
+  {
+    TimingScope draw(timeline_, "draw");
+    fake_ticks += 5;
+    {
+      TimingScope background(timeline_, "background");
+      fake_ticks += 100;
+    }
+    fake_ticks += 1;
+  }
+  fake_ticks += 4;
+  timeline_.EndFrame();
+
+  EXPECT_EQ(timeline_.frame_ticks(), 140u);
+  ASSERT_EQ(timeline_.events().size(), 3u);
+
+  const FrameTimeline::Event& input = timeline_.events()[0];
+  EXPECT_EQ(std::string_view(input.name), "input");
+  EXPECT_EQ(input.start, 10u);
+  EXPECT_EQ(input.duration, 20u);
+  EXPECT_EQ(input.depth, 0u);
+
+  const FrameTimeline::Event& draw = timeline_.events()[1];
+  EXPECT_EQ(std::string_view(draw.name), "draw");
+  EXPECT_EQ(draw.start, 30u);
+  EXPECT_EQ(draw.duration, 106u);
+  EXPECT_EQ(draw.depth, 0u);
+
+  const FrameTimeline::Event& background = timeline_.events()[2];
+  EXPECT_EQ(std::string_view(background.name), "background");
+  EXPECT_EQ(background.start, 35u);
+  EXPECT_EQ(background.duration, 100u);
+  EXPECT_EQ(background.depth, 1u);
+}
+
+TEST_F(FrameTimelineTest, StartFrameClearsEvents) {
+  timeline_.StartFrame();
+  { TimingScope scope(timeline_, "first"); }
+  timeline_.EndFrame();
+  ASSERT_EQ(timeline_.events().size(), 1u);
+
+  timeline_.StartFrame();
+  EXPECT_TRUE(timeline_.events().empty());
+  { TimingScope scope(timeline_, "second"); }
+  timeline_.EndFrame();
+  ASSERT_EQ(timeline_.events().size(), 1u);
+  EXPECT_EQ(std::string_view(timeline_.events()[0].name), "second");
+}
+
+TEST_F(FrameTimelineTest, DropsScopesBeyondCapacity) {
+  timeline_.StartFrame();
+  for (size_t i = 0; i < FrameTimeline::kMaxEvents + 3; i++) {
+    TimingScope scope(timeline_, "scope");
+  }
+  {
+    // Scopes are dropped until the next frame starts.
+    TimingScope outer(timeline_, "outer");
+    EXPECT_EQ(timeline_.dropped_events(), 4u);
+  }
+  timeline_.EndFrame();
+  EXPECT_EQ(timeline_.events().size(), FrameTimeline::kMaxEvents);
+  EXPECT_EQ(timeline_.dropped_events(), 4u);
+
+  timeline_.StartFrame();
+  EXPECT_EQ(timeline_.dropped_events(), 0u);
+}
+
+TEST_F(FrameTimelineTest, OverBudgetFramesAreHandled) {
+  using namespace std::chrono_literals;
+  timeline_.set_budget(10ms);
+  for (int i = 0; i < 3; i++) {
+    timeline_.StartFrame();
+    {
+      TimingScope scope(timeline_, "slow");
+      fake_ticks += 2 * 30'000;
+    }
+    timeline_.EndFrame();
+    EXPECT_EQ(kFakeClock.ToMicroseconds(timeline_.frame_ticks()), 30'000u);
+    ASSERT_EQ(timeline_.events().size(), 1u);
+  }
+}
+
+}  // namespace
@@ -17,6 +17,7 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
 #define PW_LOG_MODULE_NAME "ft6236"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
@@ -40,12 +41,19 @@ enum Ft62xxRegister : uint8_t {
   kThreshhold = 0x80,
   kPointrate = 0x88,
   kChipid = 0xA3,
+  // 0=INT held low while touched, 1=INT pulsed per report.
+  kInterruptMode = 0xA4,
   kFirmvers = 0xA6,
   kVendid = 0xA8,
 };
 
 constexpr pw::i2c::Address kAddress = pw::i2c::Address::SevenBit<0x38>();
 
+constexpr kudzu::RegisterCache::Layout kConfigLayout = {
+    .first_address = Ft62xxRegister::kThreshhold,
+    .size = Ft62xxRegister::kVendid - Ft62xxRegister::kThreshhold + 1,
+};
+
 }  // namespace
 
 Device::Device(pw::i2c::Initiator& initiator)
@@ -53,26 +61,33 @@ Device::Device(pw::i2c::Initiator& initiator)
       device_(initiator,
               kAddress,
               endian::little,
-              pw::i2c::RegisterAddressSize::k1Byte) {}
+              pw::i2c::RegisterAddressSize::k1Byte),
+      config_(initiator, kAddress, kConfigLayout) {}
 Device::~Device() = default;
 
 Status Device::Enable() {
-  Result<std::byte> vendor_id_result = device_.ReadRegister(
-      Ft62xxRegister::kVendid, pw::chrono::SystemClock::for_at_least(10ms));
-  if (vendor_id_result.value_or(std::byte{0}) != std::byte{0x11}) {
+  std::lock_guard lock(lock_);
+  // Read the settings along with the vendor ID, so setting ones which
+  // already match is free.
+  if (!config_.Load().ok() ||
+      config_.Get(Ft62xxRegister::kVendid).value_or(0) != 0x11) {
     return Status::NotFound();
   }
 
-  SetThreshhold(128);
-
-  return OkStatus();
+  config_.Set(Ft62xxRegister::kThreshhold, 128);
+  return config_.Flush();
 }
 
 Status Device::SetThreshhold(uint8_t threshhold) {
-  PW_TRY(device_.WriteRegister(Ft62xxRegister::kThreshhold,
-                               std::byte{threshhold},
-                               pw::chrono::SystemClock::for_at_least(10ms)));
-  return OkStatus();
+  std::lock_guard lock(lock_);
+  config_.Set(Ft62xxRegister::kThreshhold, threshhold);
+  return config_.Flush();
+}
+
+Status Device::EnableTriggerMode() {
+  std::lock_guard lock(lock_);
+  config_.Set(Ft62xxRegister::kInterruptMode, 0x01);
+  return config_.Flush();
 }
 
 Status Device::Probe() {
@@ -88,26 +103,21 @@ Status Device::Probe() {
 }
 
 void Device::LogControllerInfo() {
-  Result<std::byte> result = device_.ReadRegister(
-      Ft62xxRegister::kVendid, pw::chrono::SystemClock::for_at_least(10ms));
-  PW_LOG_DEBUG("Vend ID: 0x%x", (uint8_t)result.value_or(std::byte{0}));
-
-  result = device_.ReadRegister(Ft62xxRegister::kChipid,
-                                pw::chrono::SystemClock::for_at_least(10ms));
+  std::lock_guard lock(lock_);
+  // One read covers every register logged here.
+  if (!config_.Load().ok()) {
+    PW_LOG_DEBUG("FT6236 register read failed");
+    return;
+  }
+  PW_LOG_DEBUG("Vend ID: 0x%x", config_.Get(Ft62xxRegister::kVendid).value());
   PW_LOG_DEBUG("Chip ID: 0x%x (0x36==FT6236)",
-               (uint8_t)result.value_or(std::byte{0}));
-
-  result = device_.ReadRegister(Ft62xxRegister::kFirmvers,
-                                pw::chrono::SystemClock::for_at_least(10ms));
-  PW_LOG_DEBUG("Firmware Version: %u", (uint8_t)result.value_or(std::byte{0}));
-
-  result = device_.ReadRegister(Ft62xxRegister::kPointrate,
-                                pw::chrono::SystemClock::for_at_least(10ms));
-  PW_LOG_DEBUG("Point Rate Hz: %u", (uint8_t)result.value_or(std::byte{0}));
-
-  result = device_.ReadRegister(Ft62xxRegister::kThreshhold,
-                                pw::chrono::SystemClock::for_at_least(10ms));
-  PW_LOG_DEBUG("Threshhold: %u", (uint8_t)result.value_or(std::byte{0}));
+               config_.Get(Ft62xxRegister::kChipid).value());
+  PW_LOG_DEBUG("Firmware Version: %u",
+               config_.Get(Ft62xxRegister::kFirmvers).value());
+  PW_LOG_DEBUG("Point Rate Hz: %u",
+               config_.Get(Ft62xxRegister::kPointrate).value());
+  PW_LOG_DEBUG("Threshhold: %u",
+               config_.Get(Ft62xxRegister::kThreshhold).value());
 }
 
 void Device::LogTouchInfo() {
@@ -137,8 +147,11 @@ Result<bool> Device::ReadData() {
   PW_TRY(device_.ReadRegisters(
       0, rx_buffer, pw::chrono::SystemClock::for_at_least(10ms)));
 
-  // Number of touches (0, 1 or 2) is at 0x02.
-  touch_count_ = ReadInOrder<uint8_t>(endian::big, &rx_buffer[0x02]);
+  // Number of touches (0, 1 or 2) is at 0x02. Anything more is a bad read.
+  touch_count_ = ReadInOrder<uint8_t>(endian::big, &rx_buffer[0x02]) & 0x0F;
+  if (touch_count_ > touches_.size()) {
+    touch_count_ = 0;
+  }
 
   // Return false if no new touches are present.
   if (touch_count_ == 0) {
@@ -149,6 +162,8 @@ Result<bool> Device::ReadData() {
   touches_[0].x = ReadInOrder<uint16_t>(endian::big, &rx_buffer[0x03]) & 0xFFF;
   // Read Touch #1 Y coordinate high (0x05) and low (0x06) registers.
   touches_[0].y = ReadInOrder<uint16_t>(endian::big, &rx_buffer[0x05]) & 0xFFF;
+  // The touch ID is in the top of the Y high register.
+  touches_[0].id = ReadInOrder<uint8_t>(endian::big, &rx_buffer[0x05]) >> 4;
 
   // Read Touch #1 Misc data
   touches_[0].weight = ReadInOrder<uint8_t>(endian::big, &rx_buffer[0x07]);
@@ -158,6 +173,7 @@ Result<bool> Device::ReadData() {
   touches_[1].x = ReadInOrder<uint16_t>(endian::big, &rx_buffer[0x09]) & 0xFFF;
   // Read Touch #2 Y coordinate high (0x0B) and low (0x0C) registers.
   touches_[1].y = ReadInOrder<uint16_t>(endian::big, &rx_buffer[0x0B]) & 0xFFF;
+  touches_[1].id = ReadInOrder<uint8_t>(endian::big, &rx_buffer[0x0B]) >> 4;
 
   // Read Touch #2 Misc data
   touches_[1].weight = ReadInOrder<uint8_t>(endian::big, &rx_buffer[0x0D]);
@@ -16,10 +16,13 @@
 #include <array>
 #include <cstdint>
 
+#include "libkudzu/register_cache.h"
 #include "pw_i2c/address.h"
 #include "pw_i2c/initiator.h"
 #include "pw_i2c/register_device.h"
 #include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
 
 namespace pw::ft6236 {
 
@@ -33,6 +36,8 @@ struct Touch {
   uint8_t weight;
   // Touch area value
   uint8_t area;
+  // Stays the same for as long as the finger is down.
+  uint8_t id;
 };
 
 class Device {
@@ -49,6 +54,9 @@ class Device {
   // Log the last read touch data.
   void LogTouchInfo();
 
+  // Pulse the INT pin once for each new touch report, rather than holding it
+  // low for as long as the screen is touched.
+  Status EnableTriggerMode();
   // Set the touch detection threshold value.
   Status SetThreshhold(uint8_t threshhold);
   // Read touch data from the FT6236 and store locally.
@@ -65,6 +73,10 @@ class Device {
  private:
   pw::i2c::Initiator& initiator_;
   pw::i2c::RegisterDevice device_;
+  // The touch thread and the health check both use the settings.
+  pw::sync::Mutex lock_;
+  // THRESHHOLD through VENDID, which hold the settings and IDs.
+  kudzu::RegisterCache config_ PW_GUARDED_BY(lock_);
 
   std::array<Touch, 2> touches_;
   uint8_t touch_count_;
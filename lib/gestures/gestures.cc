@@ -0,0 +1,392 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/gestures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace kudzu {
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+float Hypot(float x, float y) { return std::sqrt(x * x + y * y); }
+
+pw::geometry::Vector2<int> Round(float x, float y) {
+  return {static_cast<int>(std::lround(x)), static_cast<int>(std::lround(y))};
+}
+
+float Seconds(std::chrono::microseconds duration) {
+  return std::chrono::duration<float>(duration).count();
+}
+
+// Returns whichever of two timing clock readings is later.
+uint32_t Later(uint32_t a, uint32_t b) {
+  return static_cast<int32_t>(a - b) > 0 ? a : b;
+}
+
+// Returns `degrees` turned by whole turns into (-180, 180].
+float WrapDegrees(float degrees) {
+  while (degrees > 180) {
+    degrees -= 360;
+  }
+  while (degrees <= -180) {
+    degrees += 360;
+  }
+  return degrees;
+}
+
+}  // namespace
+
+const char* GestureTypeName(GestureType type) {
+  switch (type) {
+    case GestureType::kTap:
+      return "tap";
+    case GestureType::kDoubleTap:
+      return "double tap";
+    case GestureType::kLongPress:
+      return "long press";
+    case GestureType::kSwipe:
+      return "swipe";
+    case GestureType::kPinch:
+      return "pinch";
+    case GestureType::kRotate:
+      return "rotate";
+  }
+  return "unknown";
+}
+
+void GestureRecognizer::Update(const pw::touchscreen::TouchContacts& contacts,
+                               uint32_t now) {
+  const bool moved = UpdateTracks(contacts);
+
+  switch (mode_) {
+    case Mode::kIdle:
+      if (down_count_ == 1) {
+        StartOneFinger();
+      } else if (down_count_ == 2) {
+        FlushPendingTap();
+        first_ = 0;
+        StartTwoFingers();
+      }
+      break;
+    case Mode::kOneFinger:
+      if (down_count_ == 2) {
+        // Keep the finger which landed first as the first.
+        FlushPendingTap();
+        StartTwoFingers();
+      } else if (!first().down) {
+        EndOneFinger();
+        mode_ = Mode::kIdle;
+        // Another finger landed between reads as this one lifted.
+        if (down_count_ == 1) {
+          StartOneFinger();
+        }
+      } else {
+        UpdateOneFinger(now);
+      }
+      break;
+    case Mode::kTwoFingers:
+      if (down_count_ == 2) {
+        UpdateTwoFingers(moved);
+      } else {
+        EndTwoFingers();
+        mode_ = down_count_ == 0 ? Mode::kIdle : Mode::kDone;
+      }
+      break;
+    case Mode::kDone:
+      if (down_count_ == 0) {
+        mode_ = Mode::kIdle;
+      }
+      break;
+  }
+
+  if (pending_tap_.has_value() &&
+      Elapsed(pending_tap_->timing_ticks, now) > config_.double_tap_window) {
+    FlushPendingTap();
+  }
+}
+
+std::optional<GestureEvent> GestureRecognizer::Pop() {
+  if (events_.empty()) {
+    return std::nullopt;
+  }
+  GestureEvent event = events_.front();
+  events_.pop();
+  return event;
+}
+
+void GestureRecognizer::Reset() {
+  tracks_ = {};
+  down_count_ = 0;
+  first_ = 0;
+  mode_ = Mode::kIdle;
+  moved_ = false;
+  pinching_ = false;
+  rotating_ = false;
+  pending_tap_.reset();
+}
+
+bool GestureRecognizer::UpdateTracks(
+    const pw::touchscreen::TouchContacts& contacts) {
+  std::array<bool, pw::touchscreen::kMaxTouchContacts> seen = {};
+  bool moved = false;
+
+  const size_t count =
+      std::min(contacts.count, pw::touchscreen::kMaxTouchContacts);
+  for (size_t i = 0; i < count; i++) {
+    const pw::touchscreen::TouchContact& contact = contacts.contacts[i];
+    size_t index = contact.id % pw::touchscreen::kMaxTouchContacts;
+    // Two contacts with one ID is a bad read; keep them apart anyway.
+    if (seen[index]) {
+      index = 1 - index;
+    }
+    seen[index] = true;
+
+    Track& track = tracks_[index];
+    const Point point = {static_cast<float>(contact.point.x),
+                         static_cast<float>(contact.point.y)};
+    if (!track.down) {
+      track = {
+          .down = true,
+          .start = point,
+          .position = point,
+          .start_time = contacts.timing_ticks,
+          .last_time = contacts.timing_ticks,
+      };
+      moved = true;
+      continue;
+    }
+    // Polling faster than the controller reports sees the same read again.
+    if (static_cast<int32_t>(contacts.timing_ticks - track.last_time) <= 0) {
+      continue;
+    }
+    const float dt = Seconds(Elapsed(track.last_time, contacts.timing_ticks));
+    const float alpha = config_.velocity_smoothing;
+    track.velocity.x +=
+        alpha * ((point.x - track.position.x) / dt - track.velocity.x);
+    track.velocity.y +=
+        alpha * ((point.y - track.position.y) / dt - track.velocity.y);
+    track.position = point;
+    track.last_time = contacts.timing_ticks;
+    moved = true;
+  }
+
+  down_count_ = 0;
+  for (size_t i = 0; i < tracks_.size(); i++) {
+    // A lifted finger keeps its last position and velocity for the gesture
+    // it ends.
+    tracks_[i].down = seen[i];
+    if (seen[i]) {
+      down_count_++;
+    }
+  }
+  return moved;
+}
+
+void GestureRecognizer::StartOneFinger() {
+  first_ = tracks_[0].down ? 0 : 1;
+  moved_ = false;
+  mode_ = Mode::kOneFinger;
+
+  // A second tap this far from the first can't make a double tap.
+  if (pending_tap_.has_value()) {
+    const Point start = first().start;
+    if (Hypot(start.x - pending_tap_->point.x,
+              start.y - pending_tap_->point.y) > config_.double_tap_slop) {
+      FlushPendingTap();
+    }
+  }
+}
+
+void GestureRecognizer::UpdateOneFinger(uint32_t now) {
+  const Track& track = first();
+  if (!moved_ && Hypot(track.position.x - track.start.x,
+                       track.position.y - track.start.y) > config_.tap_slop) {
+    moved_ = true;
+    FlushPendingTap();
+  }
+  if (!moved_ && Elapsed(track.start_time, now) >= config_.long_press) {
+    FlushPendingTap();
+    Push({
+        .type = GestureType::kLongPress,
+        .point = Round(track.start.x, track.start.y),
+        .timing_ticks = now,
+    });
+    mode_ = Mode::kDone;
+  }
+}
+
+void GestureRecognizer::EndOneFinger() {
+  const Track& track = first();
+  const float dx = track.position.x - track.start.x;
+  const float dy = track.position.y - track.start.y;
+  const float distance = Hypot(dx, dy);
+
+  if (!moved_ && distance <= config_.tap_slop) {
+    // Held past the long press without an update to notice it.
+    if (Elapsed(track.start_time, track.last_time) >= config_.long_press) {
+      FlushPendingTap();
+      Push({
+          .type = GestureType::kLongPress,
+          .point = Round(track.start.x, track.start.y),
+          .timing_ticks = track.last_time,
+      });
+      return;
+    }
+
+    const GestureEvent tap = {
+        .type = GestureType::kTap,
+        .point = Round(track.position.x, track.position.y),
+        .timing_ticks = track.last_time,
+    };
+    if (pending_tap_.has_value() &&
+        Elapsed(pending_tap_->timing_ticks, track.start_time) <=
+            config_.double_tap_window) {
+      GestureEvent double_tap = tap;
+      double_tap.type = GestureType::kDoubleTap;
+      pending_tap_.reset();
+      Push(double_tap);
+    } else {
+      FlushPendingTap();
+      pending_tap_ = tap;
+    }
+    return;
+  }
+
+  FlushPendingTap();
+  const float speed = Hypot(track.velocity.x, track.velocity.y);
+  if (distance < config_.swipe_min_distance ||
+      speed < config_.swipe_min_velocity) {
+    return;
+  }
+  SwipeDirection direction;
+  if (std::abs(dx) >= std::abs(dy)) {
+    direction = dx < 0 ? SwipeDirection::kLeft : SwipeDirection::kRight;
+  } else {
+    direction = dy < 0 ? SwipeDirection::kUp : SwipeDirection::kDown;
+  }
+  Push({
+      .type = GestureType::kSwipe,
+      .point = Round(track.position.x, track.position.y),
+      .velocity = {track.velocity.x, track.velocity.y},
+      .direction = direction,
+      .timing_ticks = track.last_time,
+  });
+}
+
+void GestureRecognizer::StartTwoFingers() {
+  mode_ = Mode::kTwoFingers;
+  start_distance_ = Distance();
+  start_angle_ = Angle();
+  pinching_ = false;
+  rotating_ = false;
+}
+
+void GestureRecognizer::UpdateTwoFingers(bool moved) {
+  if (!moved) {
+    return;
+  }
+  GestureEvent event = TwoFingerEvent();
+
+  if (!pinching_ && std::abs(event.scale - 1) > config_.pinch_threshold) {
+    pinching_ = true;
+    event.type = GestureType::kPinch;
+    event.phase = GesturePhase::kStart;
+    Push(event);
+  } else if (pinching_) {
+    event.type = GestureType::kPinch;
+    event.phase = GesturePhase::kMove;
+    Push(event);
+  }
+
+  if (!rotating_ &&
+      std::abs(event.rotation_degrees) > config_.rotate_threshold_degrees) {
+    rotating_ = true;
+    event.type = GestureType::kRotate;
+    event.phase = GesturePhase::kStart;
+    Push(event);
+  } else if (rotating_) {
+    event.type = GestureType::kRotate;
+    event.phase = GesturePhase::kMove;
+    Push(event);
+  }
+}
+
+void GestureRecognizer::EndTwoFingers() {
+  GestureEvent event = TwoFingerEvent();
+  event.phase = GesturePhase::kEnd;
+  if (pinching_) {
+    event.type = GestureType::kPinch;
+    Push(event);
+  }
+  if (rotating_) {
+    event.type = GestureType::kRotate;
+    Push(event);
+  }
+  pinching_ = false;
+  rotating_ = false;
+}
+
+GestureEvent GestureRecognizer::TwoFingerEvent() const {
+  const Track& a = first();
+  const Track& b = second();
+  return {
+      .type = GestureType::kPinch,
+      .point = Round((a.position.x + b.position.x) / 2,
+                     (a.position.y + b.position.y) / 2),
+      .scale = start_distance_ > 0 ? Distance() / start_distance_ : 1,
+      .rotation_degrees = WrapDegrees(Angle() - start_angle_),
+      .timing_ticks = Later(a.last_time, b.last_time),
+  };
+}
+
+void GestureRecognizer::FlushPendingTap() {
+  if (pending_tap_.has_value()) {
+    Push(*pending_tap_);
+    pending_tap_.reset();
+  }
+}
+
+void GestureRecognizer::Push(const GestureEvent& event) {
+  if (events_.full()) {
+    events_.pop();
+  }
+  events_.push(event);
+}
+
+float GestureRecognizer::Distance() const {
+  return Hypot(second().position.x - first().position.x,
+               second().position.y - first().position.y);
+}
+
+std::chrono::microseconds GestureRecognizer::Elapsed(uint32_t start,
+                                                    uint32_t end) const {
+  const int32_t ticks = static_cast<int32_t>(end - start);
+  if (ticks <= 0) {
+    return std::chrono::microseconds(0);
+  }
+  return std::chrono::microseconds(
+      clock_.ToMicroseconds(static_cast<uint32_t>(ticks)));
+}
+
+float GestureRecognizer::Angle() const {
+  return std::atan2(second().position.y - first().position.y,
+                    second().position.x - first().position.x) *
+         180 / kPi;
+}
+
+}  // namespace kudzu
@@ -0,0 +1,236 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/gestures.h"
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "libkudzu/timing_scope.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_touchscreen/touchscreen.h"
+
+namespace kudzu {
+namespace {
+
+using pw::touchscreen::TouchContacts;
+
+// A 1 MHz clock which only moves when a test advances it.
+uint32_t fake_ticks = 0;
+uint32_t FakeNow() { return fake_ticks; }
+constexpr TimingClock kFakeClock = {FakeNow, 1'000'000};
+
+// Feeds the recognizer one read per call, each 10 ms after the last.
+class GestureTest : public ::testing::Test {
+ protected:
+  // Start close to wrapping to check that differences survive it.
+  void SetUp() override { fake_ticks = 0xffff'0000; }
+
+  // Reads `points` without moving time on.
+  void Read(std::initializer_list<std::pair<int, int>> points) {
+    TouchContacts contacts = {.time = system_time_, .timing_ticks = fake_ticks};
+    uint8_t id = 0;
+    for (const auto& [x, y] : points) {
+      contacts.contacts[contacts.count++] = {.id = id++, .point = {x, y}};
+    }
+    recognizer_.Update(contacts, fake_ticks);
+  }
+
+  void Touch(std::initializer_list<std::pair<int, int>> points) {
+    Read(points);
+    Advance(10);
+  }
+
+  void Lift() { Touch({}); }
+
+  // Moves both the timing clock and the system clock on.
+  void Advance(int ms) {
+    fake_ticks += ms * 1000;
+    system_time_ += pw::chrono::SystemClock::for_at_least(
+        std::chrono::milliseconds(ms));
+  }
+
+  // Lets the double tap window close with nothing touching.
+  void Settle() {
+    Advance(400);
+    Lift();
+  }
+
+  std::optional<GestureEvent> Pop() { return recognizer_.Pop(); }
+
+  GestureRecognizer recognizer_{kFakeClock};
+  pw::chrono::SystemClock::time_point system_time_ = {};
+};
+
+TEST_F(GestureTest, TapWaitsForDoubleTapWindow) {
+  Touch({{50, 60}});
+  Touch({{52, 61}});
+  Lift();
+  EXPECT_FALSE(Pop().has_value());
+
+  Settle();
+  std::optional<GestureEvent> event = Pop();
+  ASSERT_TRUE(event.has_value());
+  EXPECT_EQ(event->type, GestureType::kTap);
+  EXPECT_EQ(event->phase, GesturePhase::kEnd);
+  EXPECT_EQ(event->point.x, 52);
+  EXPECT_EQ(event->point.y, 61);
+  EXPECT_FALSE(Pop().has_value());
+}
+
+TEST_F(GestureTest, DoubleTapReplacesTap) {
+  Touch({{50, 60}});
+  Lift();
+  Advance(100);
+  Touch({{55, 62}});
+  Lift();
+
+  std::optional<GestureEvent> event = Pop();
+  ASSERT_TRUE(event.has_value());
+  EXPECT_EQ(event->type, GestureType::kDoubleTap);
+
+  Settle();
+  EXPECT_FALSE(Pop().has_value());
+}
+
+TEST_F(GestureTest, DistantTapsStaySeparate) {
+  Touch({{10, 10}});
+  Lift();
+  Touch({{100, 100}});
+  Lift();
+  Settle();
+
+  std::optional<GestureEvent> first = Pop();
+  std::optional<GestureEvent> second = Pop();
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(first->type, GestureType::kTap);
+  EXPECT_EQ(first->point.x, 10);
+  EXPECT_EQ(second->type, GestureType::kTap);
+  EXPECT_EQ(second->point.x, 100);
+}
+
+TEST_F(GestureTest, LongPressFiresWhileHeld) {
+  for (int i = 0; i < 60; i++) {
+    Touch({{80, 40}});
+  }
+  std::optional<GestureEvent> event = Pop();
+  ASSERT_TRUE(event.has_value());
+  EXPECT_EQ(event->type, GestureType::kLongPress);
+  EXPECT_EQ(event->point.x, 80);
+
+  // Lifting afterwards doesn't also tap.
+  Lift();
+  Settle();
+  EXPECT_FALSE(Pop().has_value());
+}
+
+TEST_F(GestureTest, FastDragSwipes) {
+  for (int x = 20; x <= 120; x += 10) {
+    Touch({{x, 50}});
+  }
+  Lift();
+
+  std::optional<GestureEvent> event = Pop();
+  ASSERT_TRUE(event.has_value());
+  EXPECT_EQ(event->type, GestureType::kSwipe);
+  EXPECT_EQ(event->direction, SwipeDirection::kRight);
+  // 10 pixels every 10 ms.
+  EXPECT_NEAR(event->velocity.x, 1000, 1);
+  EXPECT_NEAR(event->velocity.y, 0, 1);
+}
+
+TEST_F(GestureTest, ReadsWithinOneSystemClockTickStillCount) {
+  // The controller reports every 4 ms, faster than a 10 ms system clock
+  // ticks, so the reads share a system clock time but not timing ticks.
+  for (int x = 20; x <= 120; x += 4) {
+    Read({{x, 50}});
+    fake_ticks += 4'000;
+  }
+  Lift();
+
+  std::optional<GestureEvent> event = Pop();
+  ASSERT_TRUE(event.has_value());
+  EXPECT_EQ(event->type, GestureType::kSwipe);
+  EXPECT_EQ(event->point.x, 120);
+  EXPECT_NEAR(event->velocity.x, 1000, 1);
+}
+
+TEST_F(GestureTest, SlowDragDoesNotSwipe) {
+  for (int y = 100; y >= 40; y -= 1) {
+    Touch({{50, y}});
+  }
+  Lift();
+  Settle();
+  EXPECT_FALSE(Pop().has_value());
+}
+
+TEST_F(GestureTest, SpreadingFingersPinch) {
+  Touch({{50, 50}, {70, 50}});
+  Touch({{45, 50}, {75, 50}});
+  Touch({{40, 50}, {80, 50}});
+  Lift();
+
+  std::optional<GestureEvent> start = Pop();
+  ASSERT_TRUE(start.has_value());
+  EXPECT_EQ(start->type, GestureType::kPinch);
+  EXPECT_EQ(start->phase, GesturePhase::kStart);
+  EXPECT_FLOAT_EQ(start->scale, 1.5f);
+  EXPECT_EQ(start->point.x, 60);
+
+  std::optional<GestureEvent> move = Pop();
+  ASSERT_TRUE(move.has_value());
+  EXPECT_EQ(move->phase, GesturePhase::kMove);
+  EXPECT_FLOAT_EQ(move->scale, 2);
+
+  std::optional<GestureEvent> end = Pop();
+  ASSERT_TRUE(end.has_value());
+  EXPECT_EQ(end->type, GestureType::kPinch);
+  EXPECT_EQ(end->phase, GesturePhase::kEnd);
+  EXPECT_FALSE(Pop().has_value());
+}
+
+TEST_F(GestureTest, TurningFingersRotate) {
+  Touch({{50, 50}, {70, 50}});
+  // A quarter turn clockwise on screen about the first finger.
+  Touch({{50, 50}, {50, 70}});
+  Lift();
+
+  std::optional<GestureEvent> start = Pop();
+  ASSERT_TRUE(start.has_value());
+  EXPECT_EQ(start->type, GestureType::kRotate);
+  EXPECT_EQ(start->phase, GesturePhase::kStart);
+  EXPECT_NEAR(start->rotation_degrees, 90, 0.01);
+
+  std::optional<GestureEvent> end = Pop();
+  ASSERT_TRUE(end.has_value());
+  EXPECT_EQ(end->type, GestureType::kRotate);
+  EXPECT_EQ(end->phase, GesturePhase::kEnd);
+  EXPECT_FALSE(Pop().has_value());
+}
+
+TEST_F(GestureTest, SecondFingerCancelsTap) {
+  Touch({{50, 50}});
+  Touch({{50, 50}, {60, 50}});
+  Lift();
+  Settle();
+  EXPECT_FALSE(Pop().has_value());
+}
+
+}  // namespace
+}  // namespace kudzu
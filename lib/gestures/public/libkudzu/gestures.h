@@ -0,0 +1,205 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "libkudzu/timing_scope.h"
+#include "pw_containers/inline_queue.h"
+#include "pw_geometry/vector2.h"
+#include "pw_touchscreen/touchscreen.h"
+
+namespace kudzu {
+
+enum class GestureType : uint8_t {
+  kTap,
+  kDoubleTap,
+  kLongPress,
+  kSwipe,
+  kPinch,
+  kRotate,
+};
+
+const char* GestureTypeName(GestureType type);
+
+/// Pinch and rotate run over many frames and report each phase. The other
+/// gestures are over when they're reported, so they only report `kEnd`.
+enum class GesturePhase : uint8_t {
+  kStart,
+  kMove,
+  kEnd,
+};
+
+enum class SwipeDirection : uint8_t {
+  kNone,
+  kLeft,
+  kRight,
+  kUp,
+  kDown,
+};
+
+struct GestureEvent {
+  GestureType type;
+  GesturePhase phase = GesturePhase::kEnd;
+  /// Where a one finger gesture happened, or the point between the fingers
+  /// for pinch and rotate.
+  pw::geometry::Vector2<int> point = {0, 0};
+  /// Swipe velocity in pixels per second.
+  pw::geometry::Vector2<float> velocity = {0, 0};
+  SwipeDirection direction = SwipeDirection::kNone;
+  /// Distance between the fingers over the distance when they went down.
+  float scale = 1;
+  /// Turn since the fingers went down, clockwise on screen.
+  float rotation_degrees = 0;
+  /// When the touch that completed it was read, or when the long press
+  /// timer ran out, in ticks of the recognizer's clock.
+  uint32_t timing_ticks = 0;
+};
+
+/// Turns touch contacts into gestures.
+///
+/// Feed it the contacts once per frame with `Update()`, then drain what it
+/// recognized with `Pop()`. Each contact is tracked by its ID along with a
+/// smoothed velocity, so up to two fingers can be told apart as they move.
+///
+/// Times come from the contacts' `timing_ticks`, so `clock` must be the one
+/// the touchscreen stamps them with. The system clock is too coarse to time
+/// touches: the controller can report twice within one of its ticks.
+///
+/// A tap is held back until the double tap window closes, so a double tap
+/// never also reports the first tap. A one finger touch ends as at most one
+/// of tap, long press or swipe; once a second finger lands it can only pinch
+/// and rotate. Nothing more is recognized until every finger lifts.
+///
+/// Uses no heap; events past the queue's capacity drop the oldest. Not thread
+/// safe; update and pop from one thread.
+class GestureRecognizer {
+ public:
+  struct Config {
+    /// How far a finger can drift, in pixels, and still count as held still.
+    float tap_slop = 10;
+    /// How long a finger must be held still for a long press.
+    std::chrono::microseconds long_press = std::chrono::milliseconds(500);
+    /// How soon after a tap, and how close to it, a second tap must land.
+    std::chrono::microseconds double_tap_window =
+        std::chrono::milliseconds(300);
+    float double_tap_slop = 30;
+    /// How far and how fast a finger must be moving when it lifts to swipe.
+    float swipe_min_distance = 30;
+    float swipe_min_velocity = 200;
+    /// How far the scale must move from 1 before a pinch starts.
+    float pinch_threshold = 0.1f;
+    /// How far the fingers must turn, in degrees, before a rotate starts.
+    float rotate_threshold_degrees = 15;
+    /// Weight of each new sample in the smoothed velocity, from 0 to 1.
+    float velocity_smoothing = 0.5f;
+  };
+
+  static constexpr size_t kEventQueueCapacity = 8;
+
+  explicit GestureRecognizer(const TimingClock& clock)
+      : GestureRecognizer(clock, Config()) {}
+  GestureRecognizer(const TimingClock& clock, const Config& config)
+      : clock_(clock), config_(config) {}
+
+  /// Takes the contacts on the screen now. `now`, a reading of the clock,
+  /// drives the long press and double tap timers, so call this every frame
+  /// even if nothing changed.
+  void Update(const pw::touchscreen::TouchContacts& contacts, uint32_t now);
+
+  /// Returns the oldest recognized gesture, if any.
+  std::optional<GestureEvent> Pop();
+
+  /// Forgets every finger and pending tap, as if the screen was untouched.
+  void Reset();
+
+ private:
+  struct Point {
+    float x;
+    float y;
+  };
+
+  struct Track {
+    bool down = false;
+    Point start = {0, 0};
+    Point position = {0, 0};
+    // Pixels per second.
+    Point velocity = {0, 0};
+    // Timing clock ticks.
+    uint32_t start_time = 0;
+    uint32_t last_time = 0;
+  };
+
+  enum class Mode : uint8_t {
+    // No fingers down.
+    kIdle,
+    // One finger down, which might still tap, long press or swipe.
+    kOneFinger,
+    // Two fingers down, which might pinch or rotate.
+    kTwoFingers,
+    // The touch was recognized or abandoned; waiting for every finger to
+    // lift.
+    kDone,
+  };
+
+  // Returns whether any finger landed or moved.
+  bool UpdateTracks(const pw::touchscreen::TouchContacts& contacts);
+  void StartOneFinger();
+  void UpdateOneFinger(uint32_t now);
+  void EndOneFinger();
+  void StartTwoFingers();
+  void UpdateTwoFingers(bool moved);
+  void EndTwoFingers();
+  GestureEvent TwoFingerEvent() const;
+  void FlushPendingTap();
+  void Push(const GestureEvent& event);
+
+  // The tracked fingers, with the one which landed first in `first()`.
+  const Track& first() const { return tracks_[first_]; }
+  const Track& second() const { return tracks_[1 - first_]; }
+  float Distance() const;
+  float Angle() const;
+  // Time from `start` to `end`, two clock readings, or zero if `end` comes
+  // first.
+  std::chrono::microseconds Elapsed(uint32_t start, uint32_t end) const;
+
+  const TimingClock& clock_;
+  Config config_;
+  std::array<Track, pw::touchscreen::kMaxTouchContacts> tracks_ = {};
+  size_t down_count_ = 0;
+  // Index in `tracks_` of the one finger, or of the first of two.
+  size_t first_ = 0;
+  Mode mode_ = Mode::kIdle;
+
+  // The one finger has strayed past the tap slop.
+  bool moved_ = false;
+
+  // Distance and angle between two fingers when they went down.
+  float start_distance_ = 0;
+  float start_angle_ = 0;
+  bool pinching_ = false;
+  bool rotating_ = false;
+
+  // A tap waiting to see whether a second one makes it a double tap.
+  std::optional<GestureEvent> pending_tap_;
+
+  pw::InlineQueue<GestureEvent, kEventQueueCapacity> events_;
+};
+
+}  // namespace kudzu
@@ -0,0 +1,171 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/profiling_initiator.h"
+
+#define PW_LOG_MODULE_NAME "I2C"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "pw_log/log.h"
+
+namespace kudzu {
+namespace {
+
+std::array<std::atomic<ProfilingInitiator*>, kMaxI2cProfilers> s_profilers;
+
+}  // namespace
+
+ProfilingInitiator::ProfilingInitiator(const char* name,
+                                       pw::i2c::Initiator& initiator,
+                                       const TimingClock& clock)
+    : name_(name),
+      initiator_(initiator),
+      clock_(clock),
+      window_start_(pw::chrono::SystemClock::now()) {}
+
+uint32_t ProfilingInitiator::total_transactions() const {
+  std::lock_guard lock(lock_);
+  return total_transactions_;
+}
+
+size_t ProfilingInitiator::ReadStats(pw::span<I2cDeviceStats> stats) const {
+  std::lock_guard lock(lock_);
+  const size_t count = std::min(num_devices_, stats.size());
+  std::copy_n(devices_.begin(), count, stats.begin());
+  return count;
+}
+
+pw::chrono::SystemClock::duration ProfilingInitiator::window() const {
+  std::lock_guard lock(lock_);
+  return pw::chrono::SystemClock::now() - window_start_;
+}
+
+uint32_t ProfilingInitiator::untracked_transactions() const {
+  std::lock_guard lock(lock_);
+  return untracked_transactions_;
+}
+
+void ProfilingInitiator::ResetStats() {
+  std::lock_guard lock(lock_);
+  num_devices_ = 0;
+  untracked_transactions_ = 0;
+  window_start_ = pw::chrono::SystemClock::now();
+}
+
+void ProfilingInitiator::LogStats() const {
+  std::lock_guard lock(lock_);
+  const uint64_t window_us = std::max<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          pw::chrono::SystemClock::now() - window_start_)
+          .count(),
+      1);
+  for (size_t i = 0; i < num_devices_; i++) {
+    const I2cDeviceStats& device = devices_[i];
+    const uint64_t busy_permille = device.busy_us * 1000 / window_us;
+    PW_LOG_INFO(
+        "%s 0x%02x: %u tx %u/%u B w/r, us p50:%u p99:%u max:%u, busy %u.%u%%",
+        name_,
+        static_cast<unsigned>(device.address),
+        static_cast<unsigned>(device.transactions),
+        static_cast<unsigned>(device.bytes_written),
+        static_cast<unsigned>(device.bytes_read),
+        static_cast<unsigned>(device.latency_us.Percentile(50)),
+        static_cast<unsigned>(device.latency_us.Percentile(99)),
+        static_cast<unsigned>(device.latency_us.max()),
+        static_cast<unsigned>(busy_permille / 10),
+        static_cast<unsigned>(busy_permille % 10));
+    if (device.nacks + device.timeouts + device.errors > 0) {
+      PW_LOG_WARN("%s 0x%02x: %u NACKs, %u timeouts, %u other errors",
+                  name_,
+                  static_cast<unsigned>(device.address),
+                  static_cast<unsigned>(device.nacks),
+                  static_cast<unsigned>(device.timeouts),
+                  static_cast<unsigned>(device.errors));
+    }
+  }
+  if (untracked_transactions_ > 0) {
+    PW_LOG_INFO("%s: %u transactions to other devices",
+                name_,
+                static_cast<unsigned>(untracked_transactions_));
+  }
+}
+
+pw::Status ProfilingInitiator::DoWriteReadFor(
+    pw::i2c::Address device_address,
+    pw::ConstByteSpan tx_buffer,
+    pw::ByteSpan rx_buffer,
+    pw::chrono::SystemClock::duration timeout) {
+  const uint32_t start = clock_.now();
+  const pw::Status status =
+      initiator_.WriteReadFor(device_address, tx_buffer, rx_buffer, timeout);
+  const uint32_t latency_us = clock_.ToMicroseconds(clock_.now() - start);
+
+  std::lock_guard lock(lock_);
+  total_transactions_++;
+  I2cDeviceStats* device = FindDevice(device_address.GetTenBit());
+  if (device == nullptr) {
+    untracked_transactions_++;
+    return status;
+  }
+  device->transactions++;
+  device->busy_us += latency_us;
+  device->latency_us.Record(latency_us);
+  if (status.ok()) {
+    device->bytes_written += tx_buffer.size();
+    device->bytes_read += rx_buffer.size();
+  } else if (status.IsUnavailable()) {
+    device->nacks++;
+  } else if (status.IsDeadlineExceeded()) {
+    device->timeouts++;
+  } else {
+    device->errors++;
+  }
+  return status;
+}
+
+I2cDeviceStats* ProfilingInitiator::FindDevice(uint16_t address) {
+  for (size_t i = 0; i < num_devices_; i++) {
+    if (devices_[i].address == address) {
+      return &devices_[i];
+    }
+  }
+  if (num_devices_ == kMaxDevices) {
+    return nullptr;
+  }
+  I2cDeviceStats& device = devices_[num_devices_++];
+  device = {};
+  device.address = address;
+  return &device;
+}
+
+void SetI2cProfiler(size_t bus, ProfilingInitiator* profiler) {
+  if (bus < s_profilers.size()) {
+    s_profilers[bus].store(profiler);
+  }
+}
+
+ProfilingInitiator* GetI2cProfiler(size_t bus) {
+  if (bus >= s_profilers.size()) {
+    return nullptr;
+  }
+  return s_profilers[bus].load();
+}
+
+}  // namespace kudzu
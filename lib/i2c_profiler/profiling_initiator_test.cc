@@ -0,0 +1,135 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/profiling_initiator.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_status/status.h"
+
+namespace {
+
+using kudzu::I2cDeviceStats;
+using kudzu::ProfilingInitiator;
+using kudzu::TimingClock;
+
+constexpr auto kTimeout = std::chrono::milliseconds(10);
+constexpr pw::i2c::Address kTouch = pw::i2c::Address::SevenBit<0x38>();
+constexpr pw::i2c::Address kImu = pw::i2c::Address::SevenBit<0x68>();
+
+// A clock which only moves when a transaction takes time, ticking at 1 MHz.
+uint32_t fake_ticks = 0;
+uint32_t FakeNow() { return fake_ticks; }
+constexpr TimingClock kFakeClock = {FakeNow, 1'000'000};
+
+// Takes `latency_us` on the fake clock and returns `status`.
+class FakeInitiator : public pw::i2c::Initiator {
+ public:
+  pw::Status status = pw::OkStatus();
+  uint32_t latency_us = 100;
+
+ private:
+  pw::Status DoWriteReadFor(pw::i2c::Address,
+                            pw::ConstByteSpan,
+                            pw::ByteSpan,
+                            pw::chrono::SystemClock::duration) override {
+    fake_ticks += latency_us;
+    return status;
+  }
+};
+
+class ProfilingInitiatorTest : public ::testing::Test {
+ protected:
+  size_t ReadStats() { return profiler_.ReadStats(stats_); }
+
+  FakeInitiator bus_;
+  ProfilingInitiator profiler_{"i2c0", bus_, kFakeClock};
+  std::array<I2cDeviceStats, ProfilingInitiator::kMaxDevices> stats_;
+  std::array<std::byte, 2> tx_ = {};
+  std::array<std::byte, 6> rx_ = {};
+};
+
+TEST_F(ProfilingInitiatorTest, CountsTransactionsAndBytesPerDevice) {
+  EXPECT_EQ(profiler_.WriteReadFor(kTouch, tx_, rx_, kTimeout),
+            pw::OkStatus());
+  EXPECT_EQ(profiler_.WriteFor(kTouch, tx_, kTimeout), pw::OkStatus());
+  EXPECT_EQ(profiler_.ReadFor(kImu, rx_, kTimeout), pw::OkStatus());
+
+  ASSERT_EQ(ReadStats(), 2u);
+  EXPECT_EQ(stats_[0].address, 0x38);
+  EXPECT_EQ(stats_[0].transactions, 2u);
+  EXPECT_EQ(stats_[0].bytes_written, 4u);
+  EXPECT_EQ(stats_[0].bytes_read, 6u);
+  EXPECT_EQ(stats_[1].address, 0x68);
+  EXPECT_EQ(stats_[1].transactions, 1u);
+  EXPECT_EQ(stats_[1].bytes_read, 6u);
+  EXPECT_EQ(profiler_.total_transactions(), 3u);
+}
+
+TEST_F(ProfilingInitiatorTest, RecordsLatency) {
+  bus_.latency_us = 200;
+  profiler_.WriteFor(kTouch, tx_, kTimeout).IgnoreError();
+  bus_.latency_us = 5000;
+  profiler_.WriteFor(kTouch, tx_, kTimeout).IgnoreError();
+
+  ASSERT_EQ(ReadStats(), 1u);
+  EXPECT_EQ(stats_[0].busy_us, 5200u);
+  EXPECT_EQ(stats_[0].latency_us.count(), 2u);
+  EXPECT_GE(stats_[0].latency_us.Percentile(50), 200u);
+  EXPECT_LT(stats_[0].latency_us.Percentile(50), 225u);
+  EXPECT_EQ(stats_[0].latency_us.max(), 5000u);
+}
+
+TEST_F(ProfilingInitiatorTest, ClassifiesFailures) {
+  bus_.status = pw::Status::Unavailable();
+  EXPECT_EQ(profiler_.ReadFor(kTouch, rx_, kTimeout),
+            pw::Status::Unavailable());
+  bus_.status = pw::Status::DeadlineExceeded();
+  profiler_.ReadFor(kTouch, rx_, kTimeout).IgnoreError();
+  bus_.status = pw::Status::Unknown();
+  profiler_.ReadFor(kTouch, rx_, kTimeout).IgnoreError();
+
+  ASSERT_EQ(ReadStats(), 1u);
+  EXPECT_EQ(stats_[0].transactions, 3u);
+  EXPECT_EQ(stats_[0].nacks, 1u);
+  EXPECT_EQ(stats_[0].timeouts, 1u);
+  EXPECT_EQ(stats_[0].errors, 1u);
+  EXPECT_EQ(stats_[0].bytes_read, 0u);
+}
+
+TEST_F(ProfilingInitiatorTest, CountsDevicesPastTheLimitAsUntracked) {
+  for (uint16_t address = 0x10; address < 0x10 + 6; address++) {
+    profiler_.WriteFor(pw::i2c::Address(address), tx_, kTimeout)
+        .IgnoreError();
+  }
+  EXPECT_EQ(ReadStats(), ProfilingInitiator::kMaxDevices);
+  EXPECT_EQ(profiler_.untracked_transactions(), 2u);
+  EXPECT_EQ(profiler_.total_transactions(), 6u);
+}
+
+TEST_F(ProfilingInitiatorTest, ResetKeepsTotal) {
+  profiler_.WriteFor(kTouch, tx_, kTimeout).IgnoreError();
+  profiler_.ResetStats();
+  EXPECT_EQ(ReadStats(), 0u);
+  EXPECT_EQ(profiler_.total_transactions(), 1u);
+}
+
+}  // namespace
@@ -0,0 +1,122 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "libkudzu/histogram.h"
+#include "libkudzu/timing_scope.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace kudzu {
+
+/// Traffic to one device address since the stats were last reset.
+struct I2cDeviceStats {
+  // Latencies past 65 ms only show up in the histogram's max.
+  using LatencyHistogram = BasicLogHistogram<16>;
+
+  uint16_t address;
+  uint32_t transactions;
+  uint32_t bytes_written;
+  uint32_t bytes_read;
+  // Transactions the device didn't acknowledge.
+  uint32_t nacks;
+  // Transactions which couldn't get the bus in time.
+  uint32_t timeouts;
+  // Transactions which failed any other way.
+  uint32_t errors;
+  // Total time spent in transactions.
+  uint64_t busy_us;
+  LatencyHistogram latency_us;
+};
+
+/// Wraps another initiator and records each device's transactions, bytes,
+/// failures and latency.
+///
+/// Latency is timed around the wrapped call, so it includes waiting for other
+/// threads' transactions on a shared bus. That makes contention show up as a
+/// latency tail on every device but the one holding the bus.
+class ProfilingInitiator final : public pw::i2c::Initiator {
+ public:
+  static constexpr size_t kMaxDevices = 4;
+
+  /// `name` must have static storage. `clock` times each transaction.
+  ProfilingInitiator(const char* name,
+                     pw::i2c::Initiator& initiator,
+                     const TimingClock& clock);
+
+  const char* name() const { return name_; }
+
+  /// Transactions since boot, which ResetStats() leaves alone. This is cheap
+  /// enough to read every frame.
+  uint32_t total_transactions() const;
+
+  /// Copies the stats of each device seen since the last reset to `stats`
+  /// and returns the number copied.
+  size_t ReadStats(pw::span<I2cDeviceStats> stats) const;
+
+  /// Time since the stats were last reset.
+  pw::chrono::SystemClock::duration window() const;
+
+  /// Transactions since the last reset to addresses which didn't fit in
+  /// kMaxDevices.
+  uint32_t untracked_transactions() const;
+
+  void ResetStats();
+
+  /// Logs each device's stats without resetting them.
+  void LogStats() const;
+
+ private:
+  pw::Status DoWriteReadFor(pw::i2c::Address device_address,
+                            pw::ConstByteSpan tx_buffer,
+                            pw::ByteSpan rx_buffer,
+                            pw::chrono::SystemClock::duration timeout) override;
+
+  // Returns nullptr once kMaxDevices addresses have been seen.
+  I2cDeviceStats* FindDevice(uint16_t address)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const char* const name_;
+  pw::i2c::Initiator& initiator_;
+  const TimingClock& clock_;
+
+  mutable pw::sync::Mutex lock_;
+  std::array<I2cDeviceStats, kMaxDevices> devices_ PW_GUARDED_BY(lock_);
+  size_t num_devices_ PW_GUARDED_BY(lock_) = 0;
+  uint32_t untracked_transactions_ PW_GUARDED_BY(lock_) = 0;
+  uint32_t total_transactions_ PW_GUARDED_BY(lock_) = 0;
+  pw::chrono::SystemClock::time_point window_start_ PW_GUARDED_BY(lock_);
+};
+
+inline constexpr size_t kMaxI2cProfilers = 2;
+
+/// Registers the profiler for bus number `bus`, so the RPC service and
+/// overrun log can find it. Pass nullptr to unregister.
+void SetI2cProfiler(size_t bus, ProfilingInitiator* profiler);
+
+/// Returns the profiler for bus number `bus`, or nullptr if there is none.
+ProfilingInitiator* GetI2cProfiler(size_t bus);
+
+}  // namespace kudzu
@@ -0,0 +1,144 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/i2c_scheduler.h"
+
+#include <mutex>
+
+namespace kudzu {
+
+pw::Status I2cScheduler::Submit(I2cPriority priority,
+                                I2cTransaction& transaction) {
+  {
+    std::lock_guard lock(lock_);
+    if (transaction.queued_) {
+      return pw::Status::FailedPrecondition();
+    }
+    Queue& queue = queues_[static_cast<size_t>(priority)];
+    transaction.next_ = nullptr;
+    transaction.queued_ = true;
+    if (queue.tail == nullptr) {
+      queue.head = &transaction;
+    } else {
+      queue.tail->next_ = &transaction;
+    }
+    queue.tail = &transaction;
+  }
+  pending_.release();
+  return pw::OkStatus();
+}
+
+bool I2cScheduler::Cancel(I2cTransaction& transaction) {
+  std::lock_guard lock(lock_);
+  if (!transaction.queued_) {
+    return false;
+  }
+  for (Queue& queue : queues_) {
+    I2cTransaction* previous = nullptr;
+    for (I2cTransaction* entry = queue.head; entry != nullptr;
+         entry = entry->next_) {
+      if (entry != &transaction) {
+        previous = entry;
+        continue;
+      }
+      if (previous == nullptr) {
+        queue.head = entry->next_;
+      } else {
+        previous->next_ = entry->next_;
+      }
+      if (queue.tail == entry) {
+        queue.tail = previous;
+      }
+      transaction.next_ = nullptr;
+      transaction.queued_ = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool I2cScheduler::RunOne() {
+  I2cTransaction* transaction = nullptr;
+  {
+    std::lock_guard lock(lock_);
+    for (Queue& queue : queues_) {
+      if (queue.head != nullptr) {
+        transaction = queue.head;
+        queue.head = transaction->next_;
+        if (queue.head == nullptr) {
+          queue.tail = nullptr;
+        }
+        transaction->next_ = nullptr;
+        transaction->queued_ = false;
+        break;
+      }
+    }
+  }
+  if (transaction == nullptr) {
+    return false;
+  }
+
+  pw::Status status = pw::Status::DeadlineExceeded();
+  const pw::chrono::SystemClock::time_point now =
+      pw::chrono::SystemClock::now();
+  if (now < transaction->deadline_) {
+    status = initiator_.WriteReadFor(transaction->address_,
+                                     transaction->tx_buffer_,
+                                     transaction->rx_buffer_,
+                                     transaction->deadline_ - now);
+  }
+  // The callback may let the owner free the transaction, so it goes last.
+  transaction->on_done_(status);
+  return true;
+}
+
+void I2cScheduler::Run() {
+  while (true) {
+    pending_.acquire();
+    RunOne();
+  }
+}
+
+pw::Status ScheduledInitiator::DoWriteReadFor(
+    pw::i2c::Address device_address,
+    pw::ConstByteSpan tx_buffer,
+    pw::ByteSpan rx_buffer,
+    pw::chrono::SystemClock::duration timeout) {
+  const auto deadline = pw::chrono::SystemClock::TimePointAfterAtLeast(timeout);
+  std::lock_guard lock(lock_);
+  // Captures only `this`, so the callback fits in a pw::Function without
+  // allocating. Releasing done_ is the scheduler's last access.
+  transaction_.emplace(device_address,
+                       tx_buffer,
+                       rx_buffer,
+                       deadline,
+                       [this](pw::Status status) {
+                         result_ = status;
+                         done_.release();
+                       });
+  const pw::Status status = scheduler_.Submit(priority_, *transaction_);
+  if (!status.ok()) {
+    return status;
+  }
+  if (!done_.try_acquire_until(deadline)) {
+    if (scheduler_.Cancel(*transaction_)) {
+      return pw::Status::DeadlineExceeded();
+    }
+    // Already on the bus, where the initiator enforces the deadline.
+    done_.acquire();
+  }
+  return result_;
+}
+
+}  // namespace kudzu
@@ -0,0 +1,213 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/i2c_scheduler.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_status/status.h"
+
+namespace kudzu {
+namespace {
+
+using pw::chrono::SystemClock;
+using std::chrono::milliseconds;
+
+constexpr auto kTimeout = SystemClock::for_at_least(milliseconds(10));
+
+// Records the order devices were addressed in and fills reads with the
+// device's address.
+class FakeInitiator final : public pw::i2c::Initiator {
+ public:
+  std::array<uint16_t, 8> addresses = {};
+  size_t count = 0;
+  pw::Status status;
+
+ private:
+  pw::Status DoWriteReadFor(pw::i2c::Address device_address,
+                            pw::ConstByteSpan,
+                            pw::ByteSpan rx_buffer,
+                            SystemClock::duration) override {
+    addresses[count++] = device_address.GetSevenBit();
+    for (std::byte& b : rx_buffer) {
+      b = std::byte{device_address.GetSevenBit()};
+    }
+    return status;
+  }
+};
+
+// Counts completions and keeps the last result.
+struct Result {
+  int calls = 0;
+  pw::Status status = pw::Status::Unknown();
+};
+
+I2cTransaction MakeTransaction(uint16_t address,
+                               pw::ByteSpan rx,
+                               Result& result) {
+  return I2cTransaction(pw::i2c::Address(address),
+                        {},
+                        rx,
+                        SystemClock::TimePointAfterAtLeast(kTimeout),
+                        [&result](pw::Status status) {
+                          result.calls++;
+                          result.status = status;
+                        });
+}
+
+TEST(I2cScheduler, RunsHighestPriorityFirst) {
+  FakeInitiator initiator;
+  I2cScheduler scheduler(initiator);
+  Result low_result, normal_result, high_result;
+  I2cTransaction low = MakeTransaction(0x36, {}, low_result);
+  I2cTransaction normal = MakeTransaction(0x68, {}, normal_result);
+  I2cTransaction high = MakeTransaction(0x38, {}, high_result);
+
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kLow, low), pw::OkStatus());
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kNormal, normal), pw::OkStatus());
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kHigh, high), pw::OkStatus());
+
+  EXPECT_TRUE(scheduler.RunOne());
+  EXPECT_TRUE(scheduler.RunOne());
+  EXPECT_TRUE(scheduler.RunOne());
+  EXPECT_FALSE(scheduler.RunOne());
+
+  ASSERT_EQ(initiator.count, 3u);
+  EXPECT_EQ(initiator.addresses[0], 0x38);
+  EXPECT_EQ(initiator.addresses[1], 0x68);
+  EXPECT_EQ(initiator.addresses[2], 0x36);
+  EXPECT_EQ(low_result.calls, 1);
+  EXPECT_EQ(normal_result.calls, 1);
+  EXPECT_EQ(high_result.calls, 1);
+}
+
+TEST(I2cScheduler, RunsSamePriorityInOrder) {
+  FakeInitiator initiator;
+  I2cScheduler scheduler(initiator);
+  Result first_result, second_result;
+  I2cTransaction first = MakeTransaction(0x10, {}, first_result);
+  I2cTransaction second = MakeTransaction(0x20, {}, second_result);
+
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kNormal, first), pw::OkStatus());
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kNormal, second), pw::OkStatus());
+  while (scheduler.RunOne()) {
+  }
+
+  ASSERT_EQ(initiator.count, 2u);
+  EXPECT_EQ(initiator.addresses[0], 0x10);
+  EXPECT_EQ(initiator.addresses[1], 0x20);
+}
+
+TEST(I2cScheduler, CallsBackWithResult) {
+  FakeInitiator initiator;
+  initiator.status = pw::Status::Unavailable();
+  I2cScheduler scheduler(initiator);
+  std::array<std::byte, 2> rx = {};
+  Result result;
+  I2cTransaction transaction = MakeTransaction(0x38, rx, result);
+
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kHigh, transaction), pw::OkStatus());
+  EXPECT_EQ(result.calls, 0);
+  ASSERT_TRUE(scheduler.RunOne());
+
+  EXPECT_EQ(result.calls, 1);
+  EXPECT_EQ(result.status, pw::Status::Unavailable());
+  EXPECT_EQ(rx[0], std::byte{0x38});
+  EXPECT_EQ(rx[1], std::byte{0x38});
+}
+
+TEST(I2cScheduler, RejectsTransactionAlreadyQueued) {
+  FakeInitiator initiator;
+  I2cScheduler scheduler(initiator);
+  Result result;
+  I2cTransaction transaction = MakeTransaction(0x38, {}, result);
+
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kHigh, transaction), pw::OkStatus());
+  EXPECT_EQ(scheduler.Submit(I2cPriority::kLow, transaction),
+            pw::Status::FailedPrecondition());
+  EXPECT_TRUE(scheduler.RunOne());
+  EXPECT_FALSE(scheduler.RunOne());
+
+  // Once done it may be submitted again.
+  EXPECT_EQ(scheduler.Submit(I2cPriority::kLow, transaction), pw::OkStatus());
+}
+
+TEST(I2cScheduler, CancelledTransactionNeverRuns) {
+  FakeInitiator initiator;
+  I2cScheduler scheduler(initiator);
+  Result first_result, middle_result, last_result;
+  I2cTransaction first = MakeTransaction(0x10, {}, first_result);
+  I2cTransaction middle = MakeTransaction(0x20, {}, middle_result);
+  I2cTransaction last = MakeTransaction(0x30, {}, last_result);
+
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kLow, first), pw::OkStatus());
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kLow, middle), pw::OkStatus());
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kLow, last), pw::OkStatus());
+  EXPECT_TRUE(scheduler.Cancel(middle));
+  EXPECT_FALSE(scheduler.Cancel(middle));
+  EXPECT_TRUE(scheduler.Cancel(last));
+
+  // The queue's tail moved back, so new transactions still land at the end.
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kLow, last), pw::OkStatus());
+  while (scheduler.RunOne()) {
+  }
+
+  ASSERT_EQ(initiator.count, 2u);
+  EXPECT_EQ(initiator.addresses[0], 0x10);
+  EXPECT_EQ(initiator.addresses[1], 0x30);
+  EXPECT_EQ(middle_result.calls, 0);
+}
+
+TEST(I2cScheduler, ExpiredTransactionSkipsBus) {
+  FakeInitiator initiator;
+  I2cScheduler scheduler(initiator);
+  Result result;
+  I2cTransaction transaction(pw::i2c::Address(0x38),
+                             {},
+                             {},
+                             SystemClock::now(),
+                             [&result](pw::Status status) {
+                               result.calls++;
+                               result.status = status;
+                             });
+
+  ASSERT_EQ(scheduler.Submit(I2cPriority::kHigh, transaction), pw::OkStatus());
+  ASSERT_TRUE(scheduler.RunOne());
+  EXPECT_EQ(result.calls, 1);
+  EXPECT_EQ(result.status, pw::Status::DeadlineExceeded());
+  EXPECT_EQ(initiator.count, 0u);
+}
+
+TEST(ScheduledInitiator, TimesOutWhileQueued) {
+  FakeInitiator initiator;
+  // Nothing runs the scheduler, so the transaction never leaves the queue.
+  I2cScheduler scheduler(initiator);
+  ScheduledInitiator scheduled(scheduler, I2cPriority::kLow);
+
+  std::array<std::byte, 1> rx = {};
+  EXPECT_EQ(scheduled.ReadFor(pw::i2c::Address(0x36), rx, kTimeout),
+            pw::Status::DeadlineExceeded());
+  EXPECT_FALSE(scheduler.RunOne());
+  EXPECT_EQ(initiator.count, 0u);
+}
+
+}  // namespace
+}  // namespace kudzu
@@ -0,0 +1,162 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_function/function.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/timed_thread_notification.h"
+
+namespace kudzu {
+
+/// Queued transactions run highest priority first, and in the order they
+/// were submitted within a priority.
+enum class I2cPriority : uint8_t {
+  kHigh,
+  kNormal,
+  kLow,
+};
+
+inline constexpr size_t kNumI2cPriorities = 3;
+
+/// A write followed by a read, queued on an I2cScheduler. The caller owns the
+/// transaction and its buffers until `on_done` has run.
+///
+/// A transaction which hasn't started by `deadline` fails with
+/// DEADLINE_EXCEEDED without touching the bus. One which starts in time gets
+/// whatever is left until the deadline for the transfer.
+class I2cTransaction {
+ public:
+  /// Runs on the scheduler's thread with the transaction's result, so it
+  /// should return quickly.
+  using Callback = pw::Function<void(pw::Status)>;
+
+  I2cTransaction(pw::i2c::Address address,
+                 pw::ConstByteSpan tx_buffer,
+                 pw::ByteSpan rx_buffer,
+                 pw::chrono::SystemClock::time_point deadline,
+                 Callback&& on_done)
+      : address_(address),
+        tx_buffer_(tx_buffer),
+        rx_buffer_(rx_buffer),
+        deadline_(deadline),
+        on_done_(std::move(on_done)) {}
+
+  I2cTransaction(const I2cTransaction&) = delete;
+  I2cTransaction& operator=(const I2cTransaction&) = delete;
+
+ private:
+  friend class I2cScheduler;
+
+  const pw::i2c::Address address_;
+  const pw::ConstByteSpan tx_buffer_;
+  const pw::ByteSpan rx_buffer_;
+  const pw::chrono::SystemClock::time_point deadline_;
+  Callback on_done_;
+
+  // Guarded by the scheduler's lock while queued.
+  I2cTransaction* next_ = nullptr;
+  bool queued_ = false;
+};
+
+/// Runs one bus's transactions from a single thread, highest priority first,
+/// so a latency-sensitive read never waits behind a queue of slow ones.
+///
+/// Threads submit transactions without blocking and are called back once
+/// each one is done. Drivers written against pw::i2c::Initiator can share
+/// the scheduler through a ScheduledInitiator.
+class I2cScheduler {
+ public:
+  /// Transactions run on `initiator`, which nothing else should use.
+  explicit I2cScheduler(pw::i2c::Initiator& initiator)
+      : initiator_(initiator) {}
+
+  /// Queues `transaction` behind the others of the same priority. Returns
+  /// FAILED_PRECONDITION if it is already queued. Don't call this from an
+  /// interrupt.
+  pw::Status Submit(I2cPriority priority, I2cTransaction& transaction);
+
+  /// Removes `transaction` from its queue without running it. Returns false
+  /// if it isn't queued, either because it has already started or because it
+  /// was never submitted.
+  bool Cancel(I2cTransaction& transaction);
+
+  /// Runs the highest priority queued transaction and calls it back. Returns
+  /// false if nothing was queued.
+  bool RunOne();
+
+  /// Runs transactions as they're submitted, forever.
+  void Run();
+
+ private:
+  struct Queue {
+    I2cTransaction* head = nullptr;
+    I2cTransaction* tail = nullptr;
+  };
+
+  pw::i2c::Initiator& initiator_;
+  pw::sync::Mutex lock_;
+  std::array<Queue, kNumI2cPriorities> queues_ PW_GUARDED_BY(lock_);
+  // Released once per submitted transaction. Cancelled transactions leave a
+  // stray release behind, which only costs an empty RunOne().
+  pw::sync::CountingSemaphore pending_;
+};
+
+/// Lets a driver written against pw::i2c::Initiator share an I2cScheduler
+/// at a fixed priority. Each call blocks its thread until the transaction
+/// is done.
+///
+/// One deadline covers queueing and the transfer together. A transaction
+/// which is still queued when it passes is cancelled and fails with
+/// DEADLINE_EXCEEDED; one which has started is waited for.
+///
+/// Calls through one initiator run one at a time. The transaction and the
+/// notification the scheduler signals are kept here rather than on the
+/// caller's stack, so the scheduler never touches memory which the woken
+/// caller has already released.
+class ScheduledInitiator final : public pw::i2c::Initiator {
+ public:
+  ScheduledInitiator(I2cScheduler& scheduler, I2cPriority priority)
+      : scheduler_(scheduler), priority_(priority) {}
+
+ private:
+  pw::Status DoWriteReadFor(pw::i2c::Address device_address,
+                            pw::ConstByteSpan tx_buffer,
+                            pw::ByteSpan rx_buffer,
+                            pw::chrono::SystemClock::duration timeout) override;
+
+  I2cScheduler& scheduler_;
+  const I2cPriority priority_;
+
+  pw::sync::Mutex lock_;
+  std::optional<I2cTransaction> transaction_ PW_GUARDED_BY(lock_);
+  pw::sync::TimedThreadNotification done_;
+  // Written by the scheduler's thread before it releases done_.
+  pw::Status result_;
+};
+
+}  // namespace kudzu
@@ -14,19 +14,27 @@
 
 #include "icm42670p/device.h"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
 #define PW_LOG_MODULE_NAME "icm42670p"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
+#include "icm42670p/fifo.h"
 #include "pw_bytes/bit.h"
+#include "pw_bytes/endian.h"
+#include "pw_bytes/span.h"
 #include "pw_i2c/address.h"
 #include "pw_i2c/register_device.h"
 #include "pw_log/log.h"
 #include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
+#include "pw_status/try.h"
 
 using ::pw::Status;
 using namespace std::chrono_literals;
@@ -35,20 +43,62 @@ namespace kudzu::icm42670p {
 
 enum Icm42670pRegister : uint8_t {
   kWhoAmI = 0x75,
+  kSignalPathReset = 0x02,
+  kIntConfig = 0x06,
   kPwrMgmt0 = 0x1f,
   kGyroConfig0 = 0x20,
   kAccelConfig0 = 0x21,
   kAccelDataX1 = 0x0b,
   kGyroDataX1 = 0x11,
+  kFifoConfig1 = 0x28,
+  kFifoConfig2 = 0x29,
+  kFifoConfig3 = 0x2a,
+  kIntSource3 = 0x2e,
+  kIntfConfig0 = 0x35,
+  kFifoCountH = 0x3d,
+  kFifoData = 0x3f,
+  kBlkSelW = 0x79,
+  kMaddrW = 0x7a,
+  kMW = 0x7b,
 };
 
-constexpr int16_t GYRO_UI_FS_SEL = 1000;
-constexpr float ACCEL_UI_FS_SEL = 8.0f;
+// Registers in the MREG1 bank, reached through kBlkSelW, kMaddrW and kMW.
+enum Icm42670pMreg1Register : uint8_t {
+  kFifoConfig5 = 0x01,
+};
+
+// ACCEL_UI_FS_SEL of ±8g and GYRO_UI_FS_SEL of ±1000 dps, as in
+// Device::kFullScale.
+constexpr uint8_t kAccelFullScale8g = 0b0010'0000;
+constexpr uint8_t kGyroFullScale1000Dps = 0b0010'0000;
+
+// SIGNAL_PATH_RESET bits.
+constexpr uint8_t kFifoFlush = 1 << 2;
+// INT_CONFIG: INT2 pulsed, push-pull and active high.
+constexpr uint8_t kInt2PulsedPushPullActiveHigh = 0b0001'1000;
+// INT_SOURCE3 bits.
+constexpr uint8_t kFifoThresholdInt2Enable = 1 << 2;
+// INTF_CONFIG0: count FIFO records rather than bytes, with big-endian counts
+// and sensor data.
+constexpr uint8_t kFifoCountRecordsBigEndian = 0b0111'0000;
+// FIFO_CONFIG1 bits. Clearing both selects stream mode.
+constexpr uint8_t kFifoBypass = 1 << 0;
+// FIFO_CONFIG5: accelerometer, gyroscope and timestamp packets, with the
+// watermark interrupt repeating for as long as the FIFO is over it.
+constexpr uint8_t kFifoAccelGyroTimestampWatermarkRepeat = 0b0010'0111;
+
+// PWR_MGMT0: accelerometer and gyroscope in low noise mode.
+constexpr uint8_t kAccelGyroLowNoise = 0x0f;
 
 namespace {
 
 constexpr pw::i2c::Address kAddress = pw::i2c::Address::SevenBit<0x68>();
 
+constexpr kudzu::RegisterCache::Layout kConfigLayout = {
+    .first_address = Icm42670pRegister::kIntConfig,
+    .size = Icm42670pRegister::kIntfConfig0 - Icm42670pRegister::kIntConfig + 1,
+};
+
 void ImuReadReg(pw::i2c::RegisterDevice& device,
                 uint8_t addr,
                 const char* name) {
@@ -62,6 +112,17 @@ void ImuReadReg(pw::i2c::RegisterDevice& device,
   }
 }
 
+void LogCachedReg(const kudzu::RegisterCache& cache,
+                  uint8_t addr,
+                  const char* name) {
+  pw::Result<uint8_t> data = cache.Get(addr);
+  if (data.ok()) {
+    PW_LOG_INFO("%s: %02x", name, *data);
+  } else {
+    PW_LOG_INFO("failed to read %s", name);
+  }
+}
+
 void ImuReadReg16(pw::i2c::RegisterDevice& device,
                   uint8_t addr,
                   const char* name) {
@@ -75,45 +136,22 @@ void ImuReadReg16(pw::i2c::RegisterDevice& device,
   }
 }
 
-pw::Result<kudzu::imu::ImuSample> ReadData(pw::i2c::RegisterDevice& device) {
+pw::Result<kudzu::imu::RawImuSample> ReadData(
+    pw::i2c::RegisterDevice& device) {
   // TODO: asadmemon - Check the status register before reading the values.
 
-  uint8_t data[12];
-  device.ReadRegisters8(Icm42670pRegister::kAccelDataX1,
-                        pw::span(data, 12),
-                        pw::chrono::SystemClock::for_at_least(10ms));
-
-  uint16_t accel_x =
-      pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &data[0]);
-  uint16_t accel_y =
-      pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &data[2]);
-  uint16_t accel_z =
-      pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &data[4]);
-
-  uint16_t gyro_x = pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &data[6]);
-  uint16_t gyro_y = pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &data[8]);
-  uint16_t gyro_z =
-      pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &data[10]);
-
-  float f_accel_x =
-      static_cast<float>((int16_t)accel_x) * ACCEL_UI_FS_SEL / INT16_MAX;
-  float f_accel_y =
-      static_cast<float>((int16_t)accel_y) * ACCEL_UI_FS_SEL / INT16_MAX;
-  float f_accel_z =
-      static_cast<float>((int16_t)accel_z) * ACCEL_UI_FS_SEL / INT16_MAX;
-
-  int16_t f_gyro_x =
-      static_cast<int16_t>((int16_t)gyro_x) * GYRO_UI_FS_SEL / INT16_MAX;
-  int16_t f_gyro_y =
-      static_cast<int16_t>((int16_t)gyro_y) * GYRO_UI_FS_SEL / INT16_MAX;
-  int16_t f_gyro_z =
-      static_cast<int16_t>((int16_t)gyro_z) * GYRO_UI_FS_SEL / INT16_MAX;
-
-  kudzu::imu::ImuSample sample = {
-      {f_accel_x, f_accel_y, f_accel_z},
-      {f_gyro_x, f_gyro_y, f_gyro_z},
+  std::array<std::byte, 12> data;
+  PW_TRY(device.ReadRegisters(Icm42670pRegister::kAccelDataX1,
+                              data,
+                              pw::chrono::SystemClock::for_at_least(10ms)));
+
+  const auto read_axis = [&data](size_t offset) {
+    return pw::bytes::ReadInOrder<int16_t>(pw::endian::big, &data[offset]);
+  };
+  return kudzu::imu::RawImuSample{
+      {read_axis(0), read_axis(2), read_axis(4)},
+      {read_axis(6), read_axis(8), read_axis(10)},
   };
-  return sample;
 }
 
 }  // namespace
@@ -123,11 +161,13 @@ Device::Device(pw::i2c::Initiator& initiator)
       device_(initiator,
               kAddress,
               pw::endian::little,
-              pw::i2c::RegisterAddressSize::k1Byte) {}
+              pw::i2c::RegisterAddressSize::k1Byte),
+      config_(initiator, kAddress, kConfigLayout) {}
 
 pw::Status Device::Enable() {
-  device_.WriteRegister8(
-      0x1f, 0x0f, pw::chrono::SystemClock::for_at_least(10ms));
+  std::lock_guard lock(lock_);
+  // The IMU may have been reset, so write everything.
+  config_.Invalidate();
 
   /*
   +----------------+-----------------------------------+
@@ -160,9 +200,7 @@ pw::Status Device::Enable() {
   +----------------+-----------------------------------+
   */
   uint8_t new_accel_config = 0b00101000;
-  device_.WriteRegister8(Icm42670pRegister::kAccelConfig0,
-                         new_accel_config,
-                         pw::chrono::SystemClock::for_at_least(10ms));
+  config_.Set(Icm42670pRegister::kAccelConfig0, new_accel_config);
 
   /*
   +--------------+------------------------+
@@ -192,11 +230,13 @@ pw::Status Device::Enable() {
   +--------------+------------------------+
   */
   uint8_t new_gyro_config = 0b00101000;
-  device_.WriteRegister8(Icm42670pRegister::kGyroConfig0,
-                         new_gyro_config,
-                         pw::chrono::SystemClock::for_at_least(10ms));
+  config_.Set(Icm42670pRegister::kGyroConfig0, new_gyro_config);
+  PW_TRY(config_.Flush());
 
-  return pw::OkStatus();
+  // Turn the sensors on last. PWR_MGMT0 sits just below the configuration
+  // registers, so one flush would write it first.
+  config_.Set(Icm42670pRegister::kPwrMgmt0, kAccelGyroLowNoise);
+  return config_.Flush();
 }
 
 Status Device::Probe() {
@@ -212,17 +252,106 @@ Status Device::Probe() {
 }
 
 void Device::LogControllerInfo() {
-  device_.WriteRegister8(
-      0x1f, 0x0f, pw::chrono::SystemClock::for_at_least(10ms));
+  std::lock_guard lock(lock_);
+  // Read back what the IMU actually holds, since it may have just come back
+  // from a reset.
+  if (!config_.Load().ok()) {
+    PW_LOG_INFO("failed to read configuration");
+  }
 
   ImuReadReg(device_, Icm42670pRegister::kWhoAmI, "WHO_AM_I");
-  ImuReadReg(device_, Icm42670pRegister::kPwrMgmt0, "PWR_MGMT0");
-  ImuReadReg(device_, Icm42670pRegister::kGyroConfig0, "GYRO_CONFIG0");
-  ImuReadReg(device_, Icm42670pRegister::kAccelConfig0, "ACCEL_CONFIG0");
+  LogCachedReg(config_, Icm42670pRegister::kPwrMgmt0, "PWR_MGMT0");
+  LogCachedReg(config_, Icm42670pRegister::kGyroConfig0, "GYRO_CONFIG0");
+  LogCachedReg(config_, Icm42670pRegister::kAccelConfig0, "ACCEL_CONFIG0");
 }
 
-pw::Result<kudzu::imu::ImuSample> Device::ReadValues() {
+pw::Result<kudzu::imu::RawImuSample> Device::ReadValues() {
   return ReadData(device_);
 }
 
+Status Device::WriteMreg1(uint8_t address, uint8_t value) {
+  constexpr auto kTimeout = pw::chrono::SystemClock::for_at_least(10ms);
+  PW_TRY(device_.WriteRegister8(Icm42670pRegister::kBlkSelW, 0, kTimeout));
+  PW_TRY(device_.WriteRegister8(Icm42670pRegister::kMaddrW, address, kTimeout));
+  PW_TRY(device_.WriteRegister8(Icm42670pRegister::kMW, value, kTimeout));
+  // The datasheet asks for 10 us before the next register access, which the
+  // next I2C transaction takes anyway at 400 kHz.
+  return pw::OkStatus();
+}
+
+Status Device::EnableFifo(OutputDataRate rate, uint16_t watermark) {
+  if (watermark == 0 || watermark > kFifoCapacity) {
+    return Status::InvalidArgument();
+  }
+  const uint8_t odr = static_cast<uint8_t>(rate);
+  std::lock_guard lock(lock_);
+
+  // Registers which already hold the right value aren't written again, so
+  // changing the rate only touches the ODR fields and the FIFO mode.
+  config_.Set(Icm42670pRegister::kAccelConfig0, kAccelFullScale8g | odr);
+  config_.Set(Icm42670pRegister::kGyroConfig0, kGyroFullScale1000Dps | odr);
+  // Hold the FIFO in bypass while it's configured.
+  config_.Set(Icm42670pRegister::kFifoConfig1, kFifoBypass);
+  config_.Set(Icm42670pRegister::kIntfConfig0, kFifoCountRecordsBigEndian);
+  PW_TRY(config_.Flush());
+
+  PW_TRY(WriteMreg1(Icm42670pMreg1Register::kFifoConfig5,
+                    kFifoAccelGyroTimestampWatermarkRepeat));
+  config_.Set(Icm42670pRegister::kFifoConfig2, watermark & 0xff);
+  config_.Set(Icm42670pRegister::kFifoConfig3, (watermark >> 8) & 0x0f);
+  config_.Set(Icm42670pRegister::kIntConfig, kInt2PulsedPushPullActiveHigh);
+  config_.Set(Icm42670pRegister::kIntSource3, kFifoThresholdInt2Enable);
+  PW_TRY(config_.Flush());
+
+  config_.Set(Icm42670pRegister::kFifoConfig1, 0);
+  PW_TRY(config_.Flush());
+  return FlushFifo();
+}
+
+Status Device::FlushFifo() {
+  return device_.WriteRegister8(Icm42670pRegister::kSignalPathReset,
+                                kFifoFlush,
+                                pw::chrono::SystemClock::for_at_least(10ms));
+}
+
+pw::Result<uint16_t> Device::ReadFifoCount() {
+  std::array<std::byte, 2> count;
+  PW_TRY(device_.ReadRegisters(Icm42670pRegister::kFifoCountH,
+                               count,
+                               pw::chrono::SystemClock::for_at_least(10ms)));
+  return pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, count.data());
+}
+
+pw::Result<pw::span<FifoPacket>> Device::ReadFifo(
+    pw::span<FifoPacket> packets) {
+  const size_t count = std::min(packets.size(), kMaxFifoBurst);
+  if (count == 0) {
+    return packets.first(0);
+  }
+  // FIFO_DATA doesn't auto-increment, so one long read drains `count`
+  // packets.
+  pw::ByteSpan buffer =
+      pw::span(fifo_buffer_).first(count * kFifoPacketSize);
+  PW_TRY(device_.ReadRegisters(Icm42670pRegister::kFifoData,
+                               buffer,
+                               pw::chrono::SystemClock::for_at_least(10ms)));
+
+  size_t parsed = 0;
+  for (; parsed < count; parsed++) {
+    pw::Result<FifoPacket> packet = ParseFifoPacket(
+        buffer.subspan(parsed * kFifoPacketSize, kFifoPacketSize));
+    if (packet.status().IsUnavailable()) {
+      break;
+    }
+    if (!packet.ok()) {
+      // Packets can't be resynchronized once one is misread.
+      PW_LOG_WARN("Bad FIFO packet, flushing");
+      FlushFifo().IgnoreError();
+      return packet.status();
+    }
+    packets[parsed] = *packet;
+  }
+  return packets.first(parsed);
+}
+
 }  // namespace kudzu::icm42670p
@@ -0,0 +1,76 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "icm42670p/fifo.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kudzu_imu/imu.h"
+#include "pw_bytes/endian.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace kudzu::icm42670p {
+namespace {
+
+// FIFO header bits.
+constexpr uint8_t kHeaderEmpty = 1 << 7;
+constexpr uint8_t kHeaderAccel = 1 << 6;
+constexpr uint8_t kHeaderGyro = 1 << 5;
+constexpr uint8_t kHeader20Bit = 1 << 4;
+constexpr uint8_t kHeaderTimestampMask = 0b11 << 2;
+constexpr uint8_t kHeaderTimestamp = 0b10 << 2;
+// Bits 1:0 flag ODR changes, which don't affect the layout.
+constexpr uint8_t kHeaderFormatMask = kHeaderEmpty | kHeaderAccel |
+                                      kHeaderGyro | kHeader20Bit |
+                                      kHeaderTimestampMask;
+constexpr uint8_t kHeaderAccelGyroTimestamp =
+    kHeaderAccel | kHeaderGyro | kHeaderTimestamp;
+
+kudzu::imu::RawAxes ReadAxes(pw::ConstByteSpan packet, size_t offset) {
+  return {
+      pw::bytes::ReadInOrder<int16_t>(pw::endian::big, &packet[offset]),
+      pw::bytes::ReadInOrder<int16_t>(pw::endian::big, &packet[offset + 2]),
+      pw::bytes::ReadInOrder<int16_t>(pw::endian::big, &packet[offset + 4]),
+  };
+}
+
+}  // namespace
+
+pw::Result<FifoPacket> ParseFifoPacket(pw::ConstByteSpan packet) {
+  if (packet.size() < kFifoPacketSize) {
+    return pw::Status::InvalidArgument();
+  }
+  const uint8_t header = static_cast<uint8_t>(packet[0]);
+  if ((header & kHeaderEmpty) != 0) {
+    return pw::Status::Unavailable();
+  }
+  if ((header & kHeaderFormatMask) != kHeaderAccelGyroTimestamp) {
+    return pw::Status::DataLoss();
+  }
+
+  FifoPacket result;
+  result.raw.accelerometer = ReadAxes(packet, 1);
+  result.raw.gyroscope = ReadAxes(packet, 7);
+  // The FIFO holds temperature at 0.5 degrees per LSB around 25 degrees.
+  result.temperature =
+      static_cast<int8_t>(static_cast<int8_t>(packet[13]) / 2 + 25);
+  result.timestamp =
+      pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, &packet[14]);
+  return result;
+}
+
+}  // namespace kudzu::icm42670p
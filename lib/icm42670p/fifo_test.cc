@@ -0,0 +1,89 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "icm42670p/fifo.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_status/status.h"
+
+namespace kudzu::icm42670p {
+namespace {
+
+using Packet = std::array<std::byte, kFifoPacketSize>;
+
+constexpr Packet MakePacket(std::array<uint8_t, kFifoPacketSize> bytes) {
+  Packet packet = {};
+  for (size_t i = 0; i < bytes.size(); i++) {
+    packet[i] = static_cast<std::byte>(bytes[i]);
+  }
+  return packet;
+}
+
+// Accel (1, -2, 0x7fff), gyro (0x4000, -0x4000, 0), 10 degrees and a
+// timestamp of 0xabcd.
+constexpr Packet kAccelGyroTimestamp = MakePacket({
+    0x68,  // Header: accel, gyro and timestamp.
+    0x00, 0x01, 0xff, 0xfe, 0x7f, 0xff,
+    0x40, 0x00, 0xc0, 0x00, 0x00, 0x00,
+    0xe2,  // -30 / 2 + 25
+    0xab, 0xcd,
+});
+
+TEST(FifoTest, ParsesAccelGyroTimestampPacket) {
+  pw::Result<FifoPacket> packet = ParseFifoPacket(kAccelGyroTimestamp);
+  ASSERT_TRUE(packet.ok());
+  EXPECT_EQ(packet->raw.accelerometer.x, 1);
+  EXPECT_EQ(packet->raw.accelerometer.y, -2);
+  EXPECT_EQ(packet->raw.accelerometer.z, INT16_MAX);
+  EXPECT_EQ(packet->raw.gyroscope.x, 0x4000);
+  EXPECT_EQ(packet->raw.gyroscope.y, -0x4000);
+  EXPECT_EQ(packet->raw.gyroscope.z, 0);
+  EXPECT_EQ(packet->temperature, 10);
+  EXPECT_EQ(packet->timestamp, 0xabcd);
+}
+
+TEST(FifoTest, IgnoresOdrChangeBits) {
+  Packet bytes = kAccelGyroTimestamp;
+  bytes[0] = std::byte{0x6b};
+  EXPECT_TRUE(ParseFifoPacket(bytes).ok());
+}
+
+TEST(FifoTest, EmptyPacketIsUnavailable) {
+  Packet bytes = kAccelGyroTimestamp;
+  bytes[0] = std::byte{0x80};
+  EXPECT_EQ(ParseFifoPacket(bytes).status(), pw::Status::Unavailable());
+}
+
+TEST(FifoTest, OtherFormatsAreDataLoss) {
+  Packet bytes = kAccelGyroTimestamp;
+  // Accel only.
+  bytes[0] = std::byte{0x48};
+  EXPECT_EQ(ParseFifoPacket(bytes).status(), pw::Status::DataLoss());
+  // No timestamp.
+  bytes[0] = std::byte{0x60};
+  EXPECT_EQ(ParseFifoPacket(bytes).status(), pw::Status::DataLoss());
+}
+
+TEST(FifoTest, ShortPacketIsInvalid) {
+  EXPECT_EQ(
+      ParseFifoPacket(pw::span(kAccelGyroTimestamp).first(15)).status(),
+      pw::Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace kudzu::icm42670p
@@ -14,29 +14,82 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
+#include "icm42670p/fifo.h"
 #include "kudzu_imu/imu.h"
+#include "libkudzu/register_cache.h"
+#include "pw_bytes/span.h"
 #include "pw_i2c/address.h"
 #include "pw_i2c/initiator.h"
 #include "pw_i2c/register_device.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
 
 namespace kudzu::icm42670p {
 
 class Device {
  public:
+  // ACCEL_ODR and GYRO_ODR field values. Slower rates aren't offered because
+  // FIFO timestamps wrap every 65.536 ms.
+  enum class OutputDataRate : uint8_t {
+    k1600Hz = 0b0101,
+    k800Hz = 0b0110,
+    k400Hz = 0b0111,
+    k200Hz = 0b1000,
+    k100Hz = 0b1001,
+    k50Hz = 0b1010,
+    k25Hz = 0b1011,
+  };
+
+  // Most packets ReadFifo() reads in one transaction.
+  static constexpr size_t kMaxFifoBurst = 32;
+  // Packets the 2.25 KB FIFO holds, rounded down.
+  static constexpr uint16_t kFifoCapacity = 128;
+  // Ranges set by Enable() and EnableFifo().
+  static constexpr kudzu::imu::ImuFullScale kFullScale = {.accel_g = 8,
+                                                          .gyro_dps = 1000};
+
   Device(pw::i2c::Initiator& initiator);
   ~Device() = default;
 
   pw::Status Enable();
   pw::Status Probe();
   void LogControllerInfo();
-  pw::Result<kudzu::imu::ImuSample> ReadValues();
+  // Reads the latest sample at kFullScale.
+  pw::Result<kudzu::imu::RawImuSample> ReadValues();
+
+  // Runs both sensors at `rate` and streams accelerometer, gyroscope and
+  // timestamp packets into the FIFO, discarding anything already there. INT2
+  // pulses high each time a packet arrives while the FIFO holds at least
+  // `watermark` packets. Call after Enable().
+  pw::Status EnableFifo(OutputDataRate rate, uint16_t watermark);
+
+  // Discards every packet in the FIFO.
+  pw::Status FlushFifo();
+
+  // Returns the number of packets in the FIFO.
+  pw::Result<uint16_t> ReadFifoCount();
+
+  // Reads up to `packets.size()` packets, at most kMaxFifoBurst, in one
+  // transaction and returns the ones parsed, oldest first. Ask for no more
+  // than ReadFifoCount() returned; reading stops at the first empty packet.
+  pw::Result<pw::span<FifoPacket>> ReadFifo(pw::span<FifoPacket> packets);
 
  private:
+  pw::Status WriteMreg1(uint8_t address, uint8_t value);
+
   pw::i2c::Initiator& initiator_;
   pw::i2c::RegisterDevice device_;
+  // The IMU reader and the health check both use the configuration.
+  pw::sync::Mutex lock_;
+  // INT_CONFIG through INTF_CONFIG0, which hold the sensor and FIFO setup.
+  kudzu::RegisterCache config_ PW_GUARDED_BY(lock_);
+  std::array<std::byte, kMaxFifoBurst * kFifoPacketSize> fifo_buffer_;
 };
 
 }  // namespace kudzu::icm42670p
@@ -0,0 +1,43 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kudzu_imu/imu.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+
+namespace kudzu::icm42670p {
+
+// One FIFO packet with accelerometer, gyroscope and timestamp fields, which is
+// the only format Device::EnableFifo() configures.
+struct FifoPacket {
+  // At Device::kFullScale.
+  kudzu::imu::RawImuSample raw;
+  // Degrees Celsius.
+  int8_t temperature;
+  // Microseconds on the sensor's clock. Wraps every 65.536 ms.
+  uint16_t timestamp;
+};
+
+inline constexpr size_t kFifoPacketSize = 16;
+
+// Parses a big-endian FIFO packet. Returns UNAVAILABLE if the packet marks
+// the FIFO as empty and DATA_LOSS if it isn't an accelerometer, gyroscope and
+// timestamp packet.
+pw::Result<FifoPacket> ParseFifoPacket(pw::ConstByteSpan packet);
+
+}  // namespace kudzu::icm42670p
@@ -26,6 +26,7 @@ namespace kudzu {
 
 pw::Status Buttons::Update() {
   // Get the new button bits.
+  num_events_ = 0;
   pw::Result<std::bitset<kButtonCount>> update_result = DoUpdate();
   if (!update_result.ok()) {
     return update_result.status();
@@ -0,0 +1,80 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_buttons/event_queue.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "kudzu_buttons/buttons.h"
+#include "pw_chrono/system_clock.h"
+
+namespace kudzu {
+namespace {
+
+ButtonEvent MakeEvent(int64_t ticks, button::ButtonName button, bool pressed) {
+  return {pw::chrono::SystemClock::time_point(
+                  pw::chrono::SystemClock::duration(ticks)),
+          static_cast<uint32_t>(ticks),
+          button,
+          pressed};
+}
+
+TEST(ButtonEventQueue, PopsInPushOrder) {
+  ButtonEventQueue<4> queue;
+  ASSERT_TRUE(queue.Push(MakeEvent(1, button::a, true)));
+  ASSERT_TRUE(queue.Push(MakeEvent(2, button::a, false)));
+
+  ButtonEvent event;
+  ASSERT_TRUE(queue.Pop(event));
+  EXPECT_EQ(event.time.time_since_epoch().count(), 1);
+  EXPECT_EQ(event.button, button::a);
+  EXPECT_TRUE(event.pressed);
+  ASSERT_TRUE(queue.Pop(event));
+  EXPECT_EQ(event.time.time_since_epoch().count(), 2);
+  EXPECT_FALSE(event.pressed);
+  EXPECT_FALSE(queue.Pop(event));
+}
+
+TEST(ButtonEventQueue, DropsEventsWhenFull) {
+  ButtonEventQueue<2> queue;
+  EXPECT_TRUE(queue.Push(MakeEvent(1, button::up, true)));
+  EXPECT_TRUE(queue.Push(MakeEvent(2, button::down, true)));
+  EXPECT_FALSE(queue.Push(MakeEvent(3, button::left, true)));
+
+  ButtonEvent event;
+  ASSERT_TRUE(queue.Pop(event));
+  EXPECT_EQ(event.button, button::up);
+  EXPECT_TRUE(queue.Push(MakeEvent(4, button::right, true)));
+  ASSERT_TRUE(queue.Pop(event));
+  EXPECT_EQ(event.button, button::down);
+  ASSERT_TRUE(queue.Pop(event));
+  EXPECT_EQ(event.button, button::right);
+  EXPECT_FALSE(queue.Pop(event));
+}
+
+TEST(ButtonEventQueue, WrapsAround) {
+  ButtonEventQueue<4> queue;
+  ButtonEvent event;
+  for (int64_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(queue.Push(MakeEvent(i, button::b, i % 2 == 0)));
+    ASSERT_TRUE(queue.Pop(event));
+    EXPECT_EQ(event.time.time_since_epoch().count(), i);
+  }
+  EXPECT_FALSE(queue.Pop(event));
+}
+
+}  // namespace
+}  // namespace kudzu
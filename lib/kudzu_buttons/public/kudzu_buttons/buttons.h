@@ -13,12 +13,15 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <bitset>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 #include "pw_chrono/system_clock.h"
 #include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
 
 namespace kudzu::button {
@@ -40,6 +43,16 @@ namespace kudzu {
 
 constexpr int kButtonCount = 8;
 
+/// A button changing state, timestamped when the change was noticed.
+struct ButtonEvent {
+  pw::chrono::SystemClock::time_point time;
+  // The board's TimingClock at the same moment, which is much finer than the
+  // system clock, or zero if the backend has none.
+  uint32_t timing_ticks;
+  button::ButtonName button;
+  bool pressed;
+};
+
 class Buttons {
  public:
   virtual ~Buttons() = default;
@@ -84,13 +97,33 @@ class Buttons {
     return button_hold_duration_[button_name];
   }
 
+  /// The changes the last Update() picked up, oldest first, with the time
+  /// each one happened. Unlike Pressed() and Released(), this catches taps
+  /// which start and end between updates. Backends which poll report none.
+  pw::span<const ButtonEvent> Events() const {
+    return pw::span(events_.data(), num_events_);
+  }
+
+ protected:
+  /// Backends which timestamp changes as they happen call this from
+  /// DoUpdate() for each change since the last update.
+  void AddEvent(const ButtonEvent& event) {
+    if (num_events_ < events_.size()) {
+      events_[num_events_++] = event;
+    }
+  }
+
  private:
+  static constexpr size_t kMaxEventsPerUpdate = 16;
+
   pw::chrono::SystemClock::time_point update_time_previous_;
   pw::chrono::SystemClock::time_point update_time_;
   std::bitset<kButtonCount> button_bits_;
   std::bitset<kButtonCount> button_bits_previous_;
   std::array<pw::chrono::SystemClock::duration, kButtonCount>
       button_hold_duration_;
+  std::array<ButtonEvent, kMaxEventsPerUpdate> events_;
+  size_t num_events_ = 0;
 };
 
 }  // namespace kudzu
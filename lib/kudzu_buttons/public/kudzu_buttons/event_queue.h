@@ -0,0 +1,67 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "kudzu_buttons/buttons.h"
+
+namespace kudzu {
+
+/// Passes ButtonEvents from one thread to another without locking, so the
+/// thread which notices changes never waits on the one drawing frames.
+///
+/// Only one thread may push and only one may pop. The indices are only ever
+/// loaded and stored, never read-modify-written, so this is lock-free on
+/// cores without atomic instructions such as the Cortex-M0+.
+template <size_t kCapacity>
+class ButtonEventQueue {
+ public:
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "The capacity must be a power of two");
+
+  /// Returns false, dropping `event`, if the queue is full.
+  bool Push(const ButtonEvent& event) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    events_[tail % kCapacity] = event;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Returns false if the queue is empty.
+  bool Pop(ButtonEvent& event) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    event = events_[head % kCapacity];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  std::array<ButtonEvent, kCapacity> events_;
+  // Free-running counts of events popped and pushed, which may wrap.
+  std::atomic<uint32_t> head_ = 0;
+  std::atomic<uint32_t> tail_ = 0;
+};
+
+}  // namespace kudzu
@@ -14,19 +14,30 @@
 
 #include "kudzu_buttons/buttons.h"
 
+#include <atomic>
 #include <bitset>
+#include <chrono>
 
 #define PW_LOG_MODULE_NAME "kudzu_buttons_pi4ioe5v6416"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_INFO
 
 #include "kudzu_buttons_pi4ioe5v6416/buttons.h"
 #include "pi4ioe5v6416/device.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_log/log.h"
+#include "pw_thread/sleep.h"
 
 namespace kudzu {
+namespace {
 
-ButtonsPI4IOE5V6416::ButtonsPI4IOE5V6416(pw::pi4ioe5v6416::Device* controller)
-    : controller_(controller) {}
+constexpr auto kReadRetryDelay =
+    pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(50));
+
+}  // namespace
+
+ButtonsPI4IOE5V6416::ButtonsPI4IOE5V6416(pw::pi4ioe5v6416::Device* controller,
+                                         const TimingClock* timing_clock)
+    : controller_(controller), timing_clock_(timing_clock) {}
 
 pw::Status ButtonsPI4IOE5V6416::Init() {
   controller_->Enable();
@@ -34,6 +45,66 @@ pw::Status ButtonsPI4IOE5V6416::Init() {
 }
 
 pw::Result<std::bitset<kButtonCount>> ButtonsPI4IOE5V6416::DoUpdate() {
+  if (!interrupt_driven_.load(std::memory_order_acquire)) {
+    return ReadButtons();
+  }
+  ButtonEvent event;
+  while (events_.Pop(event)) {
+    current_[event.button] = event.pressed;
+    AddEvent(event);
+  }
+  return current_;
+}
+
+void ButtonsPI4IOE5V6416::HandleInterrupt() {
+  // Only the first interrupt since the handler last ran sets the time, so
+  // the handler never reads it while it is being written.
+  if (!interrupt_pending_.load(std::memory_order_relaxed)) {
+    interrupt_time_ = pw::chrono::SystemClock::now();
+    interrupt_timing_ticks_ = ReadTimingClock();
+    interrupt_pending_.store(true, std::memory_order_release);
+  }
+  interrupt_.release();
+}
+
+void ButtonsPI4IOE5V6416::RunInterruptHandler() {
+  if (!controller_->EnablePort0Interrupts(0xff).ok()) {
+    PW_LOG_ERROR("Failed to enable button interrupts; polling instead");
+    return;
+  }
+  // Reading the port releases an INT line which was already low, and queues
+  // presses for buttons which were already held, since DoUpdate() starts
+  // from all released.
+  interrupt_driven_.store(true, std::memory_order_release);
+  pw::Result<std::bitset<kButtonCount>> buttons = ReadButtons();
+  if (buttons.ok()) {
+    QueueChanges(*buttons, pw::chrono::SystemClock::now(), ReadTimingClock());
+  }
+
+  while (true) {
+    interrupt_.acquire();
+    if (!interrupt_pending_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    const pw::chrono::SystemClock::time_point time = interrupt_time_;
+    const uint32_t timing_ticks = interrupt_timing_ticks_;
+    interrupt_pending_.store(false, std::memory_order_relaxed);
+
+    buttons = ReadButtons();
+    if (!buttons.ok()) {
+      // The INT line stays low until the port is read, and there won't be
+      // another falling edge until then, so keep trying.
+      PW_LOG_WARN("Button read failed: %s", buttons.status().str());
+      pw::this_thread::sleep_for(kReadRetryDelay);
+      interrupt_pending_.store(true, std::memory_order_relaxed);
+      interrupt_.release();
+      continue;
+    }
+    QueueChanges(*buttons, time, timing_ticks);
+  }
+}
+
+pw::Result<std::bitset<kButtonCount>> ButtonsPI4IOE5V6416::ReadButtons() {
   pw::Result<uint8_t> result = controller_->ReadPort0();
   if (!result.ok()) {
     return result.status();
@@ -46,4 +117,27 @@ pw::Result<std::bitset<kButtonCount>> ButtonsPI4IOE5V6416::DoUpdate() {
   return new_bits;
 }
 
+uint32_t ButtonsPI4IOE5V6416::ReadTimingClock() const {
+  return timing_clock_ == nullptr ? 0 : timing_clock_->now();
+}
+
+void ButtonsPI4IOE5V6416::QueueChanges(
+    std::bitset<kButtonCount> buttons,
+    pw::chrono::SystemClock::time_point time,
+    uint32_t timing_ticks) {
+  const std::bitset<kButtonCount> changed = buttons ^ latched_;
+  for (int i = 0; i < kButtonCount; i++) {
+    if (!changed[i]) {
+      continue;
+    }
+    if (!events_.Push(
+            {time, timing_ticks, kudzu::button::ButtonName(i), buttons[i]})) {
+      PW_LOG_WARN("Button event queue full; dropped an event");
+      // Leave the bit unlatched so the change is queued with the next one.
+      buttons[i] = latched_[i];
+    }
+  }
+  latched_ = buttons;
+}
+
 }  // namespace kudzu
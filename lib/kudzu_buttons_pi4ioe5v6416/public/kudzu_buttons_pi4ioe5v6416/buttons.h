@@ -13,20 +13,68 @@
 // the License.
 #pragma once
 
+#include <atomic>
+#include <bitset>
+
 #include "kudzu_buttons/buttons.h"
+#include "kudzu_buttons/event_queue.h"
+#include "libkudzu/timing_scope.h"
 #include "pi4ioe5v6416/device.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
+#include "pw_sync/thread_notification.h"
 
 namespace kudzu {
 
+/// Buttons on the IO expander's port 0.
+///
+/// Until `RunInterruptHandler()` starts, `DoUpdate()` reads the port over I2C
+/// on every update. After that the expander's INT line drives everything: the
+/// handler reads the port only when a button changes and queues a
+/// timestamped event per change, which `DoUpdate()` drains without touching
+/// the bus.
 class ButtonsPI4IOE5V6416 : public Buttons {
  public:
-  ButtonsPI4IOE5V6416(pw::pi4ioe5v6416::Device* controller);
+  /// Events are also stamped with `timing_clock` if it isn't null.
+  ButtonsPI4IOE5V6416(pw::pi4ioe5v6416::Device* controller,
+                      const TimingClock* timing_clock = nullptr);
   pw::Status Init() override;
   pw::Result<std::bitset<kButtonCount>> DoUpdate() override;
 
+  /// Call from the interrupt for the INT line's falling edge.
+  void HandleInterrupt();
+
+  /// Enables the expander's button interrupts, then reads the buttons each
+  /// time `HandleInterrupt()` runs, forever. Run this on its own thread once
+  /// the INT line's interrupt is enabled.
+  void RunInterruptHandler();
+
  private:
+  static constexpr size_t kEventQueueCapacity = 32;
+
+  pw::Result<std::bitset<kButtonCount>> ReadButtons();
+  uint32_t ReadTimingClock() const;
+  void QueueChanges(std::bitset<kButtonCount> buttons,
+                    pw::chrono::SystemClock::time_point time,
+                    uint32_t timing_ticks);
+
   pw::pi4ioe5v6416::Device* controller_;
+  const TimingClock* const timing_clock_;
+
+  // Set by the interrupt and cleared by the handler once it has taken
+  // the times, so the first of a burst of interrupts sets them.
+  std::atomic<bool> interrupt_pending_ = false;
+  pw::chrono::SystemClock::time_point interrupt_time_;
+  uint32_t interrupt_timing_ticks_ = 0;
+  pw::sync::ThreadNotification interrupt_;
+
+  std::atomic<bool> interrupt_driven_ = false;
+  ButtonEventQueue<kEventQueueCapacity> events_;
+  // Only touched by the handler.
+  std::bitset<kButtonCount> latched_;
+  // Only touched by DoUpdate().
+  std::bitset<kButtonCount> current_;
 };
 
 }  // namespace kudzu
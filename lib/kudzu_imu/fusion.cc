@@ -0,0 +1,225 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_imu/fusion.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "kudzu_imu/imu.h"
+#include "pw_span/span.h"
+
+namespace kudzu::imu {
+namespace {
+
+// Everything here stays in integers: the RP2040 has no FPU, but multiplies
+// 32 x 32 bits quickly and divides 32 bits in hardware.
+
+constexpr int kQ = kQuaternionFractionalBits;
+constexpr int32_t kOne = int32_t{1} << kQ;
+
+// pi / 180 in Q32.
+constexpr int64_t kRadiansPerDegreeQ32 = 74'961'321;
+// 2^48 / 10^6, to turn microseconds into Q32 seconds with a multiply.
+constexpr int64_t kSecondsPerMicrosecondQ48 = 281'474'977;
+
+// Keeps the integral feedback, in Q2.30 radians per second, from winding up.
+constexpr int64_t kMaxIntegral = kOne;
+
+// Quaternion norms squared closer to one than this are left alone.
+constexpr int64_t kNormTolerance = int64_t{1} << (kQ - 20);
+
+// Q16.16 degrees.
+constexpr int64_t k45Degrees = int64_t{45} << 16;
+constexpr int32_t k90Degrees = int32_t{90} << 16;
+constexpr int32_t k180Degrees = int32_t{180} << 16;
+// atan(r) ~= 45r + r(1 - r)(kAtanA + kAtanB * r) degrees for r in [0, 1],
+// within 0.09 degrees.
+constexpr int64_t kAtanA = 918'838;
+constexpr int64_t kAtanB = 248'952;
+
+int32_t Mul(int32_t a, int32_t b) {
+  return static_cast<int32_t>((int64_t{a} * b) >> kQ);
+}
+
+uint32_t Sqrt(uint32_t value) {
+  uint32_t root = 0;
+  for (uint32_t bit = uint32_t{1} << 30; bit != 0; bit >>= 2) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+  }
+  return root;
+}
+
+// Returns atan2(y, x) in Q16.16 degrees. |x| and |y| must be at most 1 << 16.
+int32_t Atan2(int32_t y, int32_t x) {
+  if (x == 0 && y == 0) {
+    return 0;
+  }
+  const uint32_t abs_x = static_cast<uint32_t>(x < 0 ? -x : x);
+  const uint32_t abs_y = static_cast<uint32_t>(y < 0 ? -y : y);
+  // The smaller over the larger in Q15, so the approximation only has to
+  // cover the first octant.
+  const bool steep = abs_y > abs_x;
+  const int64_t r = steep ? (abs_x << 15) / abs_y : (abs_y << 15) / abs_x;
+  const int64_t r_one_minus_r = (r * ((int64_t{1} << 15) - r)) >> 15;
+  int32_t angle = static_cast<int32_t>(
+      ((k45Degrees * r) >> 15) +
+      ((r_one_minus_r * (kAtanA + ((kAtanB * r) >> 15))) >> 15));
+  if (steep) {
+    angle = k90Degrees - angle;
+  }
+  if (x < 0) {
+    angle = k180Degrees - angle;
+  }
+  return y < 0 ? -angle : angle;
+}
+
+// The world's z axis in the sensor frame, in Q2.30.
+FixedAxes Up(const Quaternion& q) {
+  return {
+      2 * (Mul(q.x, q.z) - Mul(q.w, q.y)),
+      2 * (Mul(q.w, q.x) + Mul(q.y, q.z)),
+      Mul(q.w, q.w) - Mul(q.x, q.x) - Mul(q.y, q.y) + Mul(q.z, q.z),
+  };
+}
+
+int32_t ToRadians(int32_t degrees) {
+  return static_cast<int32_t>((degrees * kRadiansPerDegreeQ32) >> 32);
+}
+
+void Normalize(Quaternion& q) {
+  // Newton's method for 1 / sqrt(norm^2) from an estimate of one. Each step
+  // squares the error, and a sample's rotation barely moves the norm, so one
+  // step is almost always enough.
+  for (int i = 0; i < 4; i++) {
+    const int64_t norm2 = (int64_t{q.w} * q.w + int64_t{q.x} * q.x +
+                           int64_t{q.y} * q.y + int64_t{q.z} * q.z) >>
+                          kQ;
+    if (norm2 > kOne - kNormTolerance && norm2 < kOne + kNormTolerance) {
+      return;
+    }
+    const int32_t scale = static_cast<int32_t>((3 * int64_t{kOne} - norm2) / 2);
+    q = {Mul(q.w, scale), Mul(q.x, scale), Mul(q.y, scale), Mul(q.z, scale)};
+  }
+}
+
+}  // namespace
+
+void OrientationFilter::Reset() {
+  orientation_ = {kOne, 0, 0, 0};
+  integral_ = {};
+  last_timestamp_us_.reset();
+}
+
+void OrientationFilter::Update(const FixedImuSample& sample, uint32_t dt_us) {
+  const int64_t dt = int64_t{std::min(dt_us, kMaxStepMicroseconds)} *
+                     kSecondsPerMicrosecondQ48 >> 16;  // Q32 seconds.
+
+  // Q16.16 radians per second.
+  std::array<int32_t, 3> rate = {
+      ToRadians(sample.gyroscope.x),
+      ToRadians(sample.gyroscope.y),
+      ToRadians(sample.gyroscope.z),
+  };
+
+  // Q5.11 g, so the squares of up to 16 g sum within 32 bits.
+  const int32_t ax = sample.accelerometer.x >> 5;
+  const int32_t ay = sample.accelerometer.y >> 5;
+  const int32_t az = sample.accelerometer.z >> 5;
+  const uint32_t magnitude = Sqrt(static_cast<uint32_t>(ax * ax) +
+                                  static_cast<uint32_t>(ay * ay) +
+                                  static_cast<uint32_t>(az * az));
+  if (magnitude != 0) {
+    // The measured up direction as a unit vector in Q2.30.
+    const uint32_t inverse = (uint32_t{1} << 31) / magnitude;
+    const int32_t ux = static_cast<int32_t>((int64_t{ax} * inverse) >> 1);
+    const int32_t uy = static_cast<int32_t>((int64_t{ay} * inverse) >> 1);
+    const int32_t uz = static_cast<int32_t>((int64_t{az} * inverse) >> 1);
+
+    // The cross product with the estimated up direction is the rotation
+    // which would line them up, in Q2.30.
+    const FixedAxes v = Up(orientation_);
+    const std::array<int32_t, 3> error = {
+        Mul(uy, v.z) - Mul(uz, v.y),
+        Mul(uz, v.x) - Mul(ux, v.z),
+        Mul(ux, v.y) - Mul(uy, v.x),
+    };
+    for (size_t axis = 0; axis < 3; axis++) {
+      // The Q16.16 gains keep the errors' Q2.30.
+      if (gains_.ki != 0) {
+        const int64_t step = ((int64_t{gains_.ki} * error[axis]) >> 16) * dt;
+        integral_[axis] = static_cast<int32_t>(
+            std::clamp<int64_t>(integral_[axis] + (step >> 32),
+                                -kMaxIntegral,
+                                kMaxIntegral));
+      }
+      const int64_t correction =
+          ((int64_t{gains_.kp} * error[axis]) >> 16) + integral_[axis];
+      rate[axis] += static_cast<int32_t>(correction >> (kQ - 16));
+    }
+  }
+
+  // Half the angle turned about each axis in Q2.30 radians: Q16 * Q32 is
+  // Q48, and one more bit halves it.
+  const int32_t hx = static_cast<int32_t>((rate[0] * dt) >> (48 - kQ + 1));
+  const int32_t hy = static_cast<int32_t>((rate[1] * dt) >> (48 - kQ + 1));
+  const int32_t hz = static_cast<int32_t>((rate[2] * dt) >> (48 - kQ + 1));
+
+  const Quaternion q = orientation_;
+  orientation_ = {
+      q.w - Mul(q.x, hx) - Mul(q.y, hy) - Mul(q.z, hz),
+      q.x + Mul(q.w, hx) + Mul(q.y, hz) - Mul(q.z, hy),
+      q.y + Mul(q.w, hy) - Mul(q.x, hz) + Mul(q.z, hx),
+      q.z + Mul(q.w, hz) + Mul(q.x, hy) - Mul(q.y, hx),
+  };
+  Normalize(orientation_);
+}
+
+void OrientationFilter::Update(pw::span<const TimestampedImuSample> samples,
+                               ImuFullScale full_scale) {
+  for (const TimestampedImuSample& sample : samples) {
+    if (last_timestamp_us_.has_value()) {
+      const uint64_t dt_us = sample.timestamp_us - *last_timestamp_us_;
+      Update(ToFixed(sample.sample, full_scale),
+             static_cast<uint32_t>(
+                 std::min<uint64_t>(dt_us, kMaxStepMicroseconds)));
+    }
+    last_timestamp_us_ = sample.timestamp_us;
+  }
+}
+
+FixedAxes OrientationFilter::gravity() const {
+  const FixedAxes up = Up(orientation_);
+  return {up.x >> (kQ - 16), up.y >> (kQ - 16), up.z >> (kQ - 16)};
+}
+
+Tilt OrientationFilter::tilt() const {
+  // Q15 keeps Atan2()'s arguments and the sum of squares in range.
+  const FixedAxes up = Up(orientation_);
+  const int32_t x = up.x >> (kQ - 15);
+  const int32_t y = up.y >> (kQ - 15);
+  const int32_t z = up.z >> (kQ - 15);
+  const int32_t yz = static_cast<int32_t>(
+      Sqrt(static_cast<uint32_t>(y * y) + static_cast<uint32_t>(z * z)));
+  return {Atan2(y, z), Atan2(-x, yz)};
+}
+
+}  // namespace kudzu::imu
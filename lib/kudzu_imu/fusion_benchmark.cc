@@ -0,0 +1,128 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures OrientationFilter::Update() on synthetic motion traces at the
+// IMU's fastest FIFO rate. The budget is 20 us per update on the RP2040.
+// Results are logged once at startup; build it with the
+// host_device_simulator toolchain to get desktop numbers.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#define PW_LOG_MODULE_NAME "FusionBench"
+
+#include "app_common/common.h"
+#include "kudzu_imu/fusion.h"
+#include "kudzu_imu/imu.h"
+#include "libkudzu/timing_scope.h"
+#include "pw_log/log.h"
+#include "pw_system/target_hooks.h"
+#include "pw_thread/detached_thread.h"
+
+namespace {
+
+using kudzu::imu::FixedImuSample;
+using kudzu::imu::OrientationFilter;
+
+constexpr size_t kTraceSamples = 1024;
+constexpr uint32_t kPeriodUs = 625;  // 1.6 kHz
+constexpr int kIterations = 8;
+constexpr uint32_t kBudgetNs = 20'000;
+
+constexpr float kPi = 3.14159265f;
+
+enum class Motion {
+  // Lying still, tilted 30 degrees.
+  kStill,
+  // Lying flat, turning at 360 dps.
+  kSpin,
+  // Rolling over once per trace, about 560 dps, while being shaken.
+  kTumble,
+};
+
+FixedImuSample s_trace[kTraceSamples];
+
+int32_t Fixed(float value) {
+  return static_cast<int32_t>(value * (1 << kudzu::imu::kFixedFractionalBits));
+}
+
+// Floats are fine here since filling the trace isn't timed.
+void FillTrace(Motion motion) {
+  for (size_t i = 0; i < kTraceSamples; i++) {
+    const float t = static_cast<float>(i * kPeriodUs) / 1e6f;
+    float roll = kPi / 6;
+    float roll_rate = 0;
+    float yaw_rate = 0;
+    float shake = 0;
+    switch (motion) {
+      case Motion::kStill:
+        break;
+      case Motion::kSpin:
+        roll = 0;
+        yaw_rate = 360;
+        break;
+      case Motion::kTumble:
+        // A whole turn, so the trace repeats smoothly.
+        roll_rate = 360e6f / (kTraceSamples * kPeriodUs);
+        roll = roll_rate * t * kPi / 180;
+        shake = 0.3f * std::sin(2 * kPi * 7 * t);
+        break;
+    }
+    s_trace[i] = {
+        {Fixed(shake), Fixed(std::sin(roll)), Fixed(std::cos(roll) + shake)},
+        {Fixed(roll_rate), 0, Fixed(yaw_rate)},
+    };
+  }
+}
+
+void RunTrace(const char* name, Motion motion) {
+  FillTrace(motion);
+  const kudzu::TimingClock& clock = Common::GetTimingClock();
+
+  OrientationFilter filter;
+  const uint32_t start = clock.now();
+  for (int i = 0; i < kIterations; i++) {
+    for (const FixedImuSample& sample : s_trace) {
+      filter.Update(sample, kPeriodUs);
+    }
+  }
+  const uint32_t elapsed_us = clock.ToMicroseconds(clock.now() - start);
+
+  const uint32_t ns_per_update = static_cast<uint32_t>(
+      uint64_t{elapsed_us} * 1000 / (kIterations * kTraceSamples));
+  const kudzu::imu::Tilt tilt = filter.tilt();
+  PW_LOG_INFO("%-6s %5u ns per update (%s budget), roll %d, pitch %d",
+              name,
+              static_cast<unsigned>(ns_per_update),
+              ns_per_update <= kBudgetNs ? "within" : "OVER",
+              static_cast<int>(tilt.roll >> 16),
+              static_cast<int>(tilt.pitch >> 16));
+}
+
+void BenchmarkTask(void*) {
+  RunTrace("still", Motion::kStill);
+  RunTrace("spin", Motion::kSpin);
+  RunTrace("tumble", Motion::kTumble);
+}
+
+}  // namespace
+
+namespace pw::system {
+
+void UserAppInit() {
+  pw::thread::DetachedThread(Common::DisplayDrawThreadOptions(), BenchmarkTask);
+}
+
+}  // namespace pw::system
@@ -0,0 +1,138 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_imu/fusion.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "kudzu_imu/imu.h"
+
+namespace kudzu::imu {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint32_t kPeriodUs = 2500;  // 400 Hz
+
+int32_t Fixed(double value) {
+  return static_cast<int32_t>(std::lround(value * (1 << kFixedFractionalBits)));
+}
+
+double Degrees(int32_t fixed) {
+  return static_cast<double>(fixed) / (1 << kFixedFractionalBits);
+}
+
+double Unit(int32_t quaternion_part) {
+  return static_cast<double>(quaternion_part) /
+         (int32_t{1} << kQuaternionFractionalBits);
+}
+
+// A still sensor which reads `up` on its accelerometer, in g.
+FixedImuSample Still(double x, double y, double z) {
+  return {{Fixed(x), Fixed(y), Fixed(z)}, {0, 0, 0}};
+}
+
+void Hold(OrientationFilter& filter,
+          const FixedImuSample& sample,
+          double seconds) {
+  const int steps = static_cast<int>(seconds * 1e6 / kPeriodUs);
+  for (int i = 0; i < steps; i++) {
+    filter.Update(sample, kPeriodUs);
+  }
+}
+
+TEST(OrientationFilterTest, FlatAndStillStaysLevel) {
+  OrientationFilter filter;
+  Hold(filter, Still(0, 0, 1), 1);
+  EXPECT_NEAR(Unit(filter.orientation().w), 1.0, 1e-6);
+  EXPECT_EQ(filter.gravity().x, 0);
+  EXPECT_EQ(filter.gravity().y, 0);
+  EXPECT_NEAR(Degrees(filter.gravity().z), 1.0, 1e-4);
+  EXPECT_EQ(filter.tilt().roll, 0);
+  EXPECT_EQ(filter.tilt().pitch, 0);
+}
+
+TEST(OrientationFilterTest, ConvergesToRoll) {
+  OrientationFilter filter;
+  const double angle = 30 * kPi / 180;
+  Hold(filter, Still(0, std::sin(angle), std::cos(angle)), 10);
+  EXPECT_NEAR(Degrees(filter.tilt().roll), 30, 0.2);
+  EXPECT_NEAR(Degrees(filter.tilt().pitch), 0, 0.2);
+  EXPECT_NEAR(Degrees(filter.gravity().y), 0.5, 0.005);
+}
+
+TEST(OrientationFilterTest, ConvergesToPitch) {
+  OrientationFilter filter;
+  const double angle = -50 * kPi / 180;
+  Hold(filter, Still(-std::sin(angle), 0, std::cos(angle)), 10);
+  EXPECT_NEAR(Degrees(filter.tilt().roll), 0, 0.2);
+  EXPECT_NEAR(Degrees(filter.tilt().pitch), -50, 0.2);
+}
+
+TEST(OrientationFilterTest, UpsideDownRollsHalfway) {
+  OrientationFilter filter;
+  const double angle = 150 * kPi / 180;
+  Hold(filter, Still(0, std::sin(angle), std::cos(angle)), 20);
+  EXPECT_NEAR(Degrees(filter.tilt().roll), 150, 0.2);
+}
+
+TEST(OrientationFilterTest, IntegratesYawRate) {
+  OrientationFilter filter;
+  FixedImuSample sample = Still(0, 0, 1);
+  sample.gyroscope.z = Fixed(90);
+  Hold(filter, sample, 1);
+  // Turned 90 degrees about z.
+  EXPECT_NEAR(Unit(filter.orientation().w), std::sqrt(0.5), 1e-3);
+  EXPECT_NEAR(Unit(filter.orientation().z), std::sqrt(0.5), 1e-3);
+  EXPECT_EQ(filter.tilt().roll, 0);
+}
+
+TEST(OrientationFilterTest, IntegralCancelsGyroBias) {
+  FixedImuSample sample = Still(0, 0, 1);
+  sample.gyroscope.x = Fixed(2);
+
+  // Proportional feedback alone leaves an error of bias / kp.
+  OrientationFilter proportional;
+  Hold(proportional, sample, 20);
+  EXPECT_NEAR(Degrees(proportional.tilt().roll), 2, 0.1);
+
+  OrientationFilter integral({.kp = 1 << 16, .ki = 1 << 14});
+  Hold(integral, sample, 60);
+  EXPECT_NEAR(Degrees(integral.tilt().roll), 0, 0.1);
+}
+
+TEST(OrientationFilterTest, BatchUsesTimestamps) {
+  constexpr ImuFullScale kFullScale = {.accel_g = 8, .gyro_dps = 1000};
+  // 125 dps for 180 steps of 4 ms is 90 degrees.
+  std::array<TimestampedImuSample, 181> samples;
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = {1'000'000 + i * 4000, {{0, 0, 4096}, {0, 0, 4096}}};
+  }
+  OrientationFilter filter;
+  filter.Update(pw::span(samples).first(100), kFullScale);
+  filter.Update(pw::span(samples).subspan(100), kFullScale);
+  EXPECT_NEAR(Unit(filter.orientation().w), std::sqrt(0.5), 1e-3);
+  EXPECT_NEAR(Unit(filter.orientation().z), std::sqrt(0.5), 1e-3);
+
+  filter.Reset();
+  EXPECT_NEAR(Unit(filter.orientation().w), 1.0, 1e-9);
+  // The first sample after a reset doesn't turn the filter.
+  filter.Update(pw::span(samples).subspan(10, 1), kFullScale);
+  EXPECT_NEAR(Unit(filter.orientation().w), 1.0, 1e-9);
+}
+
+}  // namespace
+}  // namespace kudzu::imu
@@ -0,0 +1,81 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_imu/imu.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace kudzu::imu {
+namespace {
+
+constexpr ImuFullScale kFullScale = {.accel_g = 8, .gyro_dps = 1000};
+constexpr int32_t kOne = int32_t{1} << kFixedFractionalBits;
+
+class FakeImu : public PollingImu {
+ public:
+  pw::Status Init() override { return pw::OkStatus(); }
+  bool IsAvailable() override { return true; }
+  ImuFullScale full_scale() const override { return kFullScale; }
+  pw::Result<RawImuSample> ReadRaw() override { return sample; }
+
+  pw::Result<RawImuSample> sample = pw::Status::Unavailable();
+};
+
+TEST(ImuTest, ToFixedScalesToFullScale) {
+  constexpr FixedImuSample fixed = ToFixed(
+      {.accelerometer = {4096, -32768, 0}, .gyroscope = {-32768, 16384, 1}},
+      kFullScale);
+  static_assert(fixed.accelerometer.x == kOne);
+  EXPECT_EQ(fixed.accelerometer.y, -8 * kOne);
+  EXPECT_EQ(fixed.accelerometer.z, 0);
+  EXPECT_EQ(fixed.gyroscope.x, -1000 * kOne);
+  EXPECT_EQ(fixed.gyroscope.y, 500 * kOne);
+  // One LSB is 1000/32768 dps, which Q16.16 holds exactly.
+  EXPECT_EQ(fixed.gyroscope.z, 2000);
+}
+
+TEST(ImuTest, ToFloatMatchesToFixed) {
+  const RawImuSample raw = {.accelerometer = {4096, -2048, 32767},
+                            .gyroscope = {328, -656, 32767}};
+  const ImuSample sample = ToFloat(raw, kFullScale);
+  EXPECT_FLOAT_EQ(sample.accelerometer.x, 1.0f);
+  EXPECT_FLOAT_EQ(sample.accelerometer.y, -0.5f);
+  EXPECT_NEAR(sample.accelerometer.z, 8.0f, 0.001f);
+  // Whole dps, truncated toward zero.
+  EXPECT_EQ(sample.gyroscope.x, 10);
+  EXPECT_EQ(sample.gyroscope.y, -20);
+  EXPECT_EQ(sample.gyroscope.z, 999);
+}
+
+TEST(ImuTest, ReadersConvertRawSample) {
+  FakeImu imu;
+  EXPECT_EQ(imu.ReadFixed().status(), pw::Status::Unavailable());
+  EXPECT_EQ(imu.ReadData().status(), pw::Status::Unavailable());
+
+  imu.sample = RawImuSample{.accelerometer = {0, 0, 4096},
+                            .gyroscope = {0, 0, 0}};
+  pw::Result<FixedImuSample> fixed = imu.ReadFixed();
+  ASSERT_TRUE(fixed.ok());
+  EXPECT_EQ(fixed->accelerometer.z, kOne);
+  pw::Result<ImuSample> sample = imu.ReadData();
+  ASSERT_TRUE(sample.ok());
+  EXPECT_FLOAT_EQ(sample->accelerometer.z, 1.0f);
+}
+
+}  // namespace
+}  // namespace kudzu::imu
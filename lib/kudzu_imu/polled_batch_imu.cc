@@ -0,0 +1,61 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_imu/polled_batch_imu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_thread/sleep.h"
+
+namespace kudzu::imu {
+
+pw::Status PolledBatchImu::Init() {
+  next_sample_ = pw::chrono::SystemClock::now();
+  return imu_.Init();
+}
+
+pw::Result<pw::span<TimestampedImuSample>> PolledBatchImu::ReadBatch(
+    pw::span<TimestampedImuSample> samples,
+    pw::chrono::SystemClock::duration timeout) {
+  const auto deadline = pw::chrono::SystemClock::TimePointAfterAtLeast(timeout);
+  size_t count = 0;
+  while (count < samples.size()) {
+    // Don't try to catch up on samples missed between batches.
+    next_sample_ = std::max(next_sample_, pw::chrono::SystemClock::now());
+    if (next_sample_ > deadline) {
+      break;
+    }
+    pw::this_thread::sleep_until(next_sample_);
+    pw::Result<RawImuSample> sample = imu_.ReadRaw();
+    if (sample.ok()) {
+      samples[count++] = {
+          static_cast<uint64_t>(
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                  next_sample_.time_since_epoch())
+                  .count()),
+          *sample,
+      };
+    }
+    next_sample_ += period_;
+  }
+  if (count == 0) {
+    return pw::Status::DeadlineExceeded();
+  }
+  return samples.first(count);
+}
+
+}  // namespace kudzu::imu
@@ -0,0 +1,90 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "kudzu_imu/imu.h"
+#include "pw_span/span.h"
+
+namespace kudzu::imu {
+
+// Number of fractional bits in Quaternion values.
+inline constexpr int kQuaternionFractionalBits = 30;
+
+// Unit quaternion rotating the sensor frame into a world frame whose z axis
+// points up. Signed Q2.30: 1 << kQuaternionFractionalBits is 1.0.
+struct Quaternion {
+  int32_t w, x, y, z;
+};
+
+// Q16.16 degrees. Roll turns about the sensor's x axis and pitch about its y
+// axis; both are zero when the sensor lies flat, face up.
+struct Tilt {
+  int32_t roll;
+  int32_t pitch;
+};
+
+// Mahony orientation filter in fixed point, so it's cheap enough to run at
+// the IMU's sample rate on the RP2040. The gyroscope is integrated and the
+// accelerometer pulls the estimate back towards gravity. There's no
+// magnetometer, so heading drifts.
+//
+// Not thread safe.
+class OrientationFilter {
+ public:
+  // Feedback from the accelerometer error, in Q16.16 per second.
+  struct Gains {
+    int32_t kp;
+    int32_t ki;
+  };
+
+  static constexpr Gains kDefaultGains = {.kp = 1 << 16, .ki = 0};
+
+  // Longer gaps between samples are treated as this long.
+  static constexpr uint32_t kMaxStepMicroseconds = 50'000;
+
+  explicit OrientationFilter(Gains gains = kDefaultGains) : gains_(gains) {}
+
+  // Forgets the orientation and the last sample's time.
+  void Reset();
+
+  // Advances the estimate by a sample taken `dt_us` after the previous one.
+  void Update(const FixedImuSample& sample, uint32_t dt_us);
+
+  // Advances the estimate by a batch from a BatchImu, timed by the samples'
+  // timestamps. The first sample after a reset only sets the start time.
+  void Update(pw::span<const TimestampedImuSample> samples,
+              ImuFullScale full_scale);
+
+  const Quaternion& orientation() const { return orientation_; }
+
+  // Gravity as a still accelerometer would read it, in Q16.16 g: (0, 0, 1)
+  // when the sensor lies flat, face up.
+  FixedAxes gravity() const;
+
+  Tilt tilt() const;
+
+ private:
+  const Gains gains_;
+  Quaternion orientation_ = {1 << kQuaternionFractionalBits, 0, 0, 0};
+  // Integral feedback in Q2.30 radians per second, which is fine enough for
+  // the small steps the integral gain takes.
+  std::array<int32_t, 3> integral_ = {};
+  std::optional<uint64_t> last_timestamp_us_;
+};
+
+}  // namespace kudzu::imu
@@ -15,11 +15,42 @@
 
 #include <cstdint>
 
+#include "pw_chrono/system_clock.h"
 #include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
 
 namespace kudzu::imu {
 
+// Full scale ranges. A raw reading of +/-32768 stands for +/-the range.
+struct ImuFullScale {
+  uint16_t accel_g;
+  uint16_t gyro_dps;
+};
+
+struct RawAxes {
+  int16_t x, y, z;
+};
+
+// Readings as the sensor reports them, scaled by the IMU's ImuFullScale.
+struct RawImuSample {
+  RawAxes accelerometer;
+  RawAxes gyroscope;
+};
+
+// Number of fractional bits in FixedAxes values.
+inline constexpr int kFixedFractionalBits = 16;
+
+// Signed Q16.16 values: 1 << kFixedFractionalBits is 1.0.
+struct FixedAxes {
+  int32_t x, y, z;
+};
+
+struct FixedImuSample {
+  FixedAxes accelerometer;  // g / axis
+  FixedAxes gyroscope;      // dps / axis
+};
+
 struct AccelerometerData {
   float x, y, z;  // g / axis
 };
@@ -33,6 +64,36 @@ struct ImuSample {
   GyroscopeData gyroscope;
 };
 
+// Scales a raw sample to Q16.16 without floating point. Ranges up to
+// 16384 g or dps fit.
+constexpr FixedImuSample ToFixed(const RawImuSample& raw,
+                                 ImuFullScale full_scale) {
+  // raw / 2^15 * range in Q16.16 is raw * range * 2, which fits in 32 bits.
+  constexpr auto scale = [](const RawAxes& axes, uint16_t range) {
+    const int32_t factor = int32_t{range} << (kFixedFractionalBits - 15);
+    return FixedAxes{axes.x * factor, axes.y * factor, axes.z * factor};
+  };
+  return {
+      scale(raw.accelerometer, full_scale.accel_g),
+      scale(raw.gyroscope, full_scale.gyro_dps),
+  };
+}
+
+// Converts a raw sample to float g and whole dps. This uses soft-float on
+// the RP2040, so prefer ToFixed() for anything done per sample.
+inline ImuSample ToFloat(const RawImuSample& raw, ImuFullScale full_scale) {
+  const float g_per_lsb = static_cast<float>(full_scale.accel_g) / 32768.0f;
+  const auto dps = [&](int16_t value) {
+    return static_cast<int16_t>(int32_t{value} * full_scale.gyro_dps / 32768);
+  };
+  return {
+      {raw.accelerometer.x * g_per_lsb,
+       raw.accelerometer.y * g_per_lsb,
+       raw.accelerometer.z * g_per_lsb},
+      {dps(raw.gyroscope.x), dps(raw.gyroscope.y), dps(raw.gyroscope.z)},
+  };
+}
+
 // Abstract base class for Polling IMU
 class PollingImu {
  public:
@@ -44,9 +105,56 @@ class PollingImu {
   // Return true if the controller is ready.
   virtual bool IsAvailable() = 0;
 
+  // Full scale ranges of the samples ReadRaw() returns.
+  virtual ImuFullScale full_scale() const = 0;
+
   // Retrieve IMU data. The concrete implementation would typically communicate
   // with the actual IMU hardware to get this data.
-  virtual pw::Result<ImuSample> ReadData() = 0;
+  virtual pw::Result<RawImuSample> ReadRaw() = 0;
+
+  pw::Result<FixedImuSample> ReadFixed() {
+    pw::Result<RawImuSample> raw = ReadRaw();
+    if (!raw.ok()) {
+      return raw.status();
+    }
+    return ToFixed(*raw, full_scale());
+  }
+
+  // Convenience for code which isn't time critical. See ToFloat().
+  pw::Result<ImuSample> ReadData() {
+    pw::Result<RawImuSample> raw = ReadRaw();
+    if (!raw.ok()) {
+      return raw.status();
+    }
+    return ToFloat(*raw, full_scale());
+  }
+};
+
+struct TimestampedImuSample {
+  // When the sample was taken, in microseconds on the IMU's clock from an
+  // arbitrary start. Only differences between samples are meaningful.
+  uint64_t timestamp_us;
+  RawImuSample sample;
+};
+
+// Abstract base class for IMUs which buffer samples and hand them over in
+// batches, so fast sampling doesn't cost a bus transaction per sample.
+class BatchImu {
+ public:
+  virtual ~BatchImu() = default;
+
+  // Initialize the IMU controller and start buffering samples.
+  virtual pw::Status Init() = 0;
+
+  // Full scale ranges of the samples ReadBatch() returns.
+  virtual ImuFullScale full_scale() const = 0;
+
+  // Wait up to `timeout` for a batch of samples, then copy as many buffered
+  // samples as fit to `samples`, oldest first, and return the part filled.
+  // Returns DEADLINE_EXCEEDED if no samples arrived in time.
+  virtual pw::Result<pw::span<TimestampedImuSample>> ReadBatch(
+      pw::span<TimestampedImuSample> samples,
+      pw::chrono::SystemClock::duration timeout) = 0;
 };
 
 }  // namespace kudzu::imu
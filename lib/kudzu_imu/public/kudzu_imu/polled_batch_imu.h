@@ -0,0 +1,47 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include "kudzu_imu/imu.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+namespace kudzu::imu {
+
+// Presents a PollingImu as a BatchImu by reading it once per `period`, for
+// IMUs without a FIFO such as the host simulator's. Samples are timestamped
+// with the system clock.
+class PolledBatchImu : public BatchImu {
+ public:
+  PolledBatchImu(PollingImu& imu, pw::chrono::SystemClock::duration period)
+      : imu_(imu), period_(period) {}
+
+  pw::Status Init() override;
+  ImuFullScale full_scale() const override { return imu_.full_scale(); }
+
+  // Polls until `samples` is full or `timeout` has passed.
+  pw::Result<pw::span<TimestampedImuSample>> ReadBatch(
+      pw::span<TimestampedImuSample> samples,
+      pw::chrono::SystemClock::duration timeout) override;
+
+ private:
+  PollingImu& imu_;
+  const pw::chrono::SystemClock::duration period_;
+  pw::chrono::SystemClock::time_point next_sample_;
+};
+
+}  // namespace kudzu::imu
@@ -16,14 +16,19 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstddef>
+#include <cstdint>
 
 #define PW_LOG_MODULE_NAME "kudzu_imu_icm42670p"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
 #include "icm42670p/device.h"
+#include "icm42670p/fifo.h"
 #include "kudzu_imu_icm42670p/imu.h"
 #include "pw_log/log.h"
+#include "pw_status/try.h"
 
 namespace kudzu::imu {
 
@@ -39,8 +44,8 @@ pw::Status PollingImuICM42670P::Init() {
 
 bool PollingImuICM42670P::IsAvailable() { return true; }
 
-pw::Result<ImuSample> PollingImuICM42670P::ReadData() {
-  pw::Result<ImuSample> data = imu_controller_->ReadValues();
+pw::Result<RawImuSample> PollingImuICM42670P::ReadRaw() {
+  pw::Result<RawImuSample> data = imu_controller_->ReadValues();
 
   if (data.ok()) {
     last_data = data.value();
@@ -48,4 +53,54 @@ pw::Result<ImuSample> PollingImuICM42670P::ReadData() {
   return data;
 }
 
+BatchImuICM42670P::BatchImuICM42670P(
+    kudzu::icm42670p::Device* imu_controller,
+    kudzu::icm42670p::Device::OutputDataRate rate,
+    uint16_t watermark)
+    : imu_controller_(imu_controller),
+      rate_(rate),
+      enabled_rate_(rate),
+      watermark_(watermark) {}
+
+pw::Status BatchImuICM42670P::Init() {
+  PW_TRY(imu_controller_->Enable());
+  enabled_rate_ = rate_;
+  return imu_controller_->EnableFifo(enabled_rate_, watermark_);
+}
+
+pw::Result<pw::span<TimestampedImuSample>> BatchImuICM42670P::ReadBatch(
+    pw::span<TimestampedImuSample> samples,
+    pw::chrono::SystemClock::duration timeout) {
+  if (const auto rate = rate_.load(); rate != enabled_rate_) {
+    PW_TRY(imu_controller_->EnableFifo(rate, watermark_));
+    enabled_rate_ = rate;
+  }
+
+  // Below the watermark there may still be a few samples to hand over, so
+  // check the FIFO either way.
+  watermark_reached_.try_acquire_for(timeout);
+
+  PW_TRY_ASSIGN(const uint16_t count, imu_controller_->ReadFifoCount());
+  if (count == 0) {
+    return pw::Status::DeadlineExceeded();
+  }
+  const size_t to_read =
+      std::min({static_cast<size_t>(count), samples.size(), packets_.size()});
+  PW_TRY_ASSIGN(pw::span<kudzu::icm42670p::FifoPacket> packets,
+                imu_controller_->ReadFifo(pw::span(packets_).first(to_read)));
+
+  for (size_t i = 0; i < packets.size(); i++) {
+    // Wraps every 65.536 ms, which is longer than the slowest sample period.
+    const uint16_t elapsed =
+        static_cast<uint16_t>(packets[i].timestamp - last_timestamp_);
+    timestamp_us_ += elapsed;
+    last_timestamp_ = packets[i].timestamp;
+    samples[i] = {timestamp_us_, packets[i].raw};
+  }
+  if (packets.empty()) {
+    return pw::Status::DeadlineExceeded();
+  }
+  return samples.first(packets.size());
+}
+
 }  // namespace kudzu::imu
@@ -13,8 +13,18 @@
 // the License.
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "icm42670p/device.h"
+#include "icm42670p/fifo.h"
 #include "kudzu_imu/imu.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
+#include "pw_sync/timed_thread_notification.h"
 
 namespace kudzu::imu {
 
@@ -24,12 +34,58 @@ class PollingImuICM42670P : public PollingImu {
 
   pw::Status Init() override;
   bool IsAvailable() override;
-  pw::Result<ImuSample> ReadData() override;
+  ImuFullScale full_scale() const override {
+    return kudzu::icm42670p::Device::kFullScale;
+  }
+  pw::Result<RawImuSample> ReadRaw() override;
+
+  RawImuSample last_data;
+
+ private:
+  kudzu::icm42670p::Device* imu_controller_;
+};
+
+// Reads batches of samples from the ICM-42670-P's FIFO, woken by its
+// watermark interrupt on INT2.
+class BatchImuICM42670P : public BatchImu {
+ public:
+  BatchImuICM42670P(kudzu::icm42670p::Device* imu_controller,
+                    kudzu::icm42670p::Device::OutputDataRate rate,
+                    uint16_t watermark);
+
+  pw::Status Init() override;
+  ImuFullScale full_scale() const override {
+    return kudzu::icm42670p::Device::kFullScale;
+  }
+
+  // Reads every buffered packet that fits, up to Device::kMaxFifoBurst, once
+  // the FIFO reaches the watermark or `timeout` passes.
+  pw::Result<pw::span<TimestampedImuSample>> ReadBatch(
+      pw::span<TimestampedImuSample> samples,
+      pw::chrono::SystemClock::duration timeout) override;
+
+  // Call from the INT2 rising edge interrupt. Safe to call from an ISR.
+  void HandleInterrupt() { watermark_reached_.release(); }
 
-  ImuSample last_data;
+  // Changes the output data rate from any thread. The reader applies it at
+  // its next ReadBatch(), which flushes the FIFO.
+  void SetOutputDataRate(kudzu::icm42670p::Device::OutputDataRate rate) {
+    rate_ = rate;
+  }
 
  private:
   kudzu::icm42670p::Device* imu_controller_;
+  std::atomic<kudzu::icm42670p::Device::OutputDataRate> rate_;
+  // The rate the FIFO was last enabled at. Only touched by the reader.
+  kudzu::icm42670p::Device::OutputDataRate enabled_rate_;
+  const uint16_t watermark_;
+  pw::sync::TimedThreadNotification watermark_reached_;
+  std::array<kudzu::icm42670p::FifoPacket,
+             kudzu::icm42670p::Device::kMaxFifoBurst>
+      packets_;
+  // The sensor's 16-bit timestamps, extended past their wrap.
+  uint64_t timestamp_us_ = 0;
+  uint16_t last_timestamp_ = 0;
 };
 
 }  // namespace kudzu::imu
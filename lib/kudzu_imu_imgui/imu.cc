@@ -22,6 +22,7 @@
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
 #include "kudzu_imu_imgui/imu.h"
+#include "libkudzu/trace.h"
 #include "pw_log/log.h"
 
 namespace kudzu::imu {
@@ -32,9 +33,12 @@ pw::Status PollingImuImGui::Init() { return pw::Status::Unimplemented(); }
 
 bool PollingImuImGui::IsAvailable() { return true; }
 
-pw::Result<ImuSample> PollingImuImGui::ReadData() {
-  ImuSample data = {.accelerometer = {1.0f, 2.0f, 3.0f},
-                    .gyroscope = {10, 20, 30}};
+pw::Result<RawImuSample> PollingImuImGui::ReadRaw() {
+  // Traced as the I2C read it stands in for on the device.
+  kudzu::trace::Scope scope("bus", "i2c0 icm42670p sample");
+  // 1, 2 and 3 g and 10, 20 and 30 dps at full_scale().
+  RawImuSample data = {.accelerometer = {4096, 8192, 12288},
+                       .gyroscope = {328, 656, 984}};
 
   last_data = data;
   return data;
@@ -24,9 +24,10 @@ class PollingImuImGui : public PollingImu {
 
   pw::Status Init() override;
   bool IsAvailable() override;
-  pw::Result<ImuSample> ReadData() override;
+  ImuFullScale full_scale() const override { return {8, 1000}; }
+  pw::Result<RawImuSample> ReadRaw() override;
 
-  ImuSample last_data;
+  RawImuSample last_data;
 };
 
 }  // namespace kudzu::imu
@@ -0,0 +1,64 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "kudzu_imu/imu.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+
+namespace kudzu::imu {
+
+// A recorded or generated run of IMU samples. Timestamps must not go
+// backwards.
+struct ImuTrace {
+  ImuFullScale full_scale;
+  pw::span<const TimestampedImuSample> samples;
+};
+
+// Parses a CSV trace into `buffer`. Each line holds
+//
+//   timestamp_us,accel_x,accel_y,accel_z,gyro_x,gyro_y,gyro_z
+//
+// with acceleration in g and rotation in dps, which are scaled to raw
+// readings at `full_scale`. Blank lines and lines starting with '#' or a
+// letter, such as a header, are skipped.
+//
+// Returns RESOURCE_EXHAUSTED if `buffer` is too small and DATA_LOSS if a line
+// can't be parsed or goes back in time.
+pw::Result<ImuTrace> ParseImuTraceCsv(std::string_view csv,
+                                      ImuFullScale full_scale,
+                                      pw::span<TimestampedImuSample> buffer);
+
+// Binary traces are little-endian: the magic "KIMU", the uint16 accel_g and
+// gyro_dps full scale, then a record per sample of its uint64 timestamp_us
+// and six int16 raw readings, accelerometer first.
+inline constexpr size_t kImuTraceHeaderSize = 8;
+inline constexpr size_t kImuTraceRecordSize = 20;
+
+// Parses a binary trace into `buffer`. Returns RESOURCE_EXHAUSTED if `buffer`
+// is too small and DATA_LOSS if `data` isn't a whole binary trace.
+pw::Result<ImuTrace> ParseImuTraceBinary(pw::ConstByteSpan data,
+                                         pw::span<TimestampedImuSample> buffer);
+
+// Writes `trace` in the binary format and returns the part of `buffer` used.
+// Returns RESOURCE_EXHAUSTED if `buffer` is too small.
+pw::Result<pw::ConstByteSpan> WriteImuTraceBinary(const ImuTrace& trace,
+                                                  pw::ByteSpan buffer);
+
+}  // namespace kudzu::imu
@@ -0,0 +1,96 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "kudzu_imu/imu.h"
+#include "kudzu_imu_trace/trace.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_random/xor_shift.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+namespace kudzu::imu {
+
+// Replays an ImuTrace as both a PollingImu and a BatchImu, so motion-driven
+// code can run on the host with known input. The trace loops, and timestamps
+// carry on increasing from one pass to the next.
+//
+// Batches behave like the ICM-42670-P's FIFO: ReadBatch() waits for
+// `watermark` samples, and once more than `fifo_capacity` samples go unread
+// the oldest are dropped. ReadRaw() returns the latest sample, like reading
+// the data registers.
+//
+// Not thread safe.
+class TraceImu : public PollingImu, public BatchImu {
+ public:
+  struct Options {
+    // How many times faster than recorded to play. Zero doesn't pace the
+    // trace at all: each read gets the next samples straight away, which
+    // makes runs repeatable.
+    uint32_t speedup = 1;
+    // Raw LSBs added to every reading.
+    RawAxes accel_bias = {0, 0, 0};
+    RawAxes gyro_bias = {0, 0, 0};
+    // Standard deviation of roughly Gaussian noise, in raw LSBs.
+    uint16_t accel_noise = 0;
+    uint16_t gyro_noise = 0;
+    uint64_t seed = 1;
+    uint16_t watermark = 8;
+    uint16_t fifo_capacity = 128;
+  };
+
+  // `trace` must outlive the TraceImu.
+  TraceImu(const ImuTrace& trace, const Options& options);
+
+  // Starts playback from the beginning of the trace. Returns
+  // FAILED_PRECONDITION if the trace is empty.
+  pw::Status Init() override;
+
+  bool IsAvailable() override { return started_; }
+
+  ImuFullScale full_scale() const override { return trace_.full_scale; }
+
+  pw::Result<RawImuSample> ReadRaw() override;
+
+  pw::Result<pw::span<TimestampedImuSample>> ReadBatch(
+      pw::span<TimestampedImuSample> samples,
+      pw::chrono::SystemClock::duration timeout) override;
+
+  // Samples dropped because the simulated FIFO was full.
+  uint64_t dropped_samples() const { return dropped_; }
+
+ private:
+  // Samples are numbered from the start of playback, across passes.
+  uint64_t TraceMicroseconds(uint64_t index) const;
+  uint64_t DueSamples(pw::chrono::SystemClock::time_point now) const;
+  pw::chrono::SystemClock::time_point DueTime(uint64_t index) const;
+  TimestampedImuSample Sample(uint64_t index);
+  RawAxes Perturb(const RawAxes& axes, const RawAxes& bias, uint16_t noise);
+
+  const ImuTrace trace_;
+  const Options options_;
+  // One pass, including a sample period after the last sample.
+  uint64_t pass_us_ = 1;
+  pw::random::XorShiftStarRng64 rng_;
+  bool started_ = false;
+  pw::chrono::SystemClock::time_point start_;
+  // The next sample ReadBatch() returns, or ReadRaw() when unpaced.
+  uint64_t next_ = 0;
+  uint64_t dropped_ = 0;
+};
+
+}  // namespace kudzu::imu
@@ -0,0 +1,186 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_imu_trace/trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#define PW_LOG_MODULE_NAME "kudzu_imu_trace"
+
+#include "kudzu_imu/imu.h"
+#include "pw_bytes/endian.h"
+#include "pw_bytes/span.h"
+#include "pw_log/log.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+namespace kudzu::imu {
+namespace {
+
+constexpr std::array<std::byte, 4> kMagic = {
+    std::byte{'K'}, std::byte{'I'}, std::byte{'M'}, std::byte{'U'}};
+constexpr size_t kCsvColumns = 7;
+
+// Parses the number at the start of `text` and advances past it and the
+// comma after it.
+bool ParseField(std::string_view& text, double& value) {
+  const size_t end = std::min(text.find(','), text.size());
+  // strtod() needs a terminated string.
+  std::array<char, 32> field = {};
+  if (end == 0 || end >= field.size()) {
+    return false;
+  }
+  std::copy_n(text.data(), end, field.data());
+  char* parsed_end = nullptr;
+  value = std::strtod(field.data(), &parsed_end);
+  if (parsed_end != field.data() + end) {
+    return false;
+  }
+  text.remove_prefix(std::min(end + 1, text.size()));
+  return true;
+}
+
+int16_t ToRaw(double value, uint16_t full_scale) {
+  const double raw = std::round(value / full_scale * 32768);
+  return static_cast<int16_t>(std::clamp(raw, -32768.0, 32767.0));
+}
+
+}  // namespace
+
+pw::Result<ImuTrace> ParseImuTraceCsv(std::string_view csv,
+                                      ImuFullScale full_scale,
+                                      pw::span<TimestampedImuSample> buffer) {
+  size_t count = 0;
+  size_t line_number = 0;
+  while (!csv.empty()) {
+    const size_t line_end = std::min(csv.find('\n'), csv.size());
+    std::string_view line = csv.substr(0, line_end);
+    csv.remove_prefix(std::min(line_end + 1, csv.size()));
+    line_number++;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (line.empty() || line[0] == '#' ||
+        std::isalpha(static_cast<unsigned char>(line[0]))) {
+      continue;
+    }
+
+    std::array<double, kCsvColumns> fields;
+    bool parsed = true;
+    for (double& field : fields) {
+      parsed = parsed && ParseField(line, field);
+    }
+    if (!parsed || !line.empty() || fields[0] < 0) {
+      PW_LOG_WARN("Can't parse IMU trace line %u",
+                  static_cast<unsigned>(line_number));
+      return pw::Status::DataLoss();
+    }
+    if (count == buffer.size()) {
+      return pw::Status::ResourceExhausted();
+    }
+    TimestampedImuSample& sample = buffer[count];
+    sample.timestamp_us = static_cast<uint64_t>(fields[0]);
+    if (count > 0 && sample.timestamp_us < buffer[count - 1].timestamp_us) {
+      PW_LOG_WARN("IMU trace line %u goes back in time",
+                  static_cast<unsigned>(line_number));
+      return pw::Status::DataLoss();
+    }
+    sample.sample = {
+        {ToRaw(fields[1], full_scale.accel_g),
+         ToRaw(fields[2], full_scale.accel_g),
+         ToRaw(fields[3], full_scale.accel_g)},
+        {ToRaw(fields[4], full_scale.gyro_dps),
+         ToRaw(fields[5], full_scale.gyro_dps),
+         ToRaw(fields[6], full_scale.gyro_dps)},
+    };
+    count++;
+  }
+  return ImuTrace{full_scale, buffer.first(count)};
+}
+
+pw::Result<ImuTrace> ParseImuTraceBinary(
+    pw::ConstByteSpan data, pw::span<TimestampedImuSample> buffer) {
+  if (data.size() < kImuTraceHeaderSize ||
+      !std::equal(kMagic.begin(), kMagic.end(), data.begin()) ||
+      (data.size() - kImuTraceHeaderSize) % kImuTraceRecordSize != 0) {
+    return pw::Status::DataLoss();
+  }
+  const auto read_int16 = [&data](size_t offset) {
+    return pw::bytes::ReadInOrder<int16_t>(pw::endian::little, &data[offset]);
+  };
+  const ImuFullScale full_scale = {
+      pw::bytes::ReadInOrder<uint16_t>(pw::endian::little, &data[4]),
+      pw::bytes::ReadInOrder<uint16_t>(pw::endian::little, &data[6]),
+  };
+
+  const size_t count =
+      (data.size() - kImuTraceHeaderSize) / kImuTraceRecordSize;
+  if (count > buffer.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  for (size_t i = 0; i < count; i++) {
+    const size_t offset = kImuTraceHeaderSize + i * kImuTraceRecordSize;
+    buffer[i] = {
+        pw::bytes::ReadInOrder<uint64_t>(pw::endian::little, &data[offset]),
+        {{read_int16(offset + 8), read_int16(offset + 10),
+          read_int16(offset + 12)},
+         {read_int16(offset + 14), read_int16(offset + 16),
+          read_int16(offset + 18)}},
+    };
+    if (i > 0 && buffer[i].timestamp_us < buffer[i - 1].timestamp_us) {
+      return pw::Status::DataLoss();
+    }
+  }
+  return ImuTrace{full_scale, buffer.first(count)};
+}
+
+pw::Result<pw::ConstByteSpan> WriteImuTraceBinary(const ImuTrace& trace,
+                                                  pw::ByteSpan buffer) {
+  const size_t size =
+      kImuTraceHeaderSize + trace.samples.size() * kImuTraceRecordSize;
+  if (size > buffer.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  std::copy(kMagic.begin(), kMagic.end(), buffer.begin());
+  pw::bytes::CopyInOrder(
+      pw::endian::little, trace.full_scale.accel_g, &buffer[4]);
+  pw::bytes::CopyInOrder(
+      pw::endian::little, trace.full_scale.gyro_dps, &buffer[6]);
+
+  size_t offset = kImuTraceHeaderSize;
+  const auto write_axes = [&](const RawAxes& axes) {
+    for (int16_t value : {axes.x, axes.y, axes.z}) {
+      pw::bytes::CopyInOrder(pw::endian::little, value, &buffer[offset]);
+      offset += sizeof(value);
+    }
+  };
+  for (const TimestampedImuSample& sample : trace.samples) {
+    pw::bytes::CopyInOrder(
+        pw::endian::little, sample.timestamp_us, &buffer[offset]);
+    offset += sizeof(sample.timestamp_us);
+    write_axes(sample.sample.accelerometer);
+    write_axes(sample.sample.gyroscope);
+  }
+  return pw::ConstByteSpan(buffer.first(size));
+}
+
+}  // namespace kudzu::imu
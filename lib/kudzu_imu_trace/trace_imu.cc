@@ -0,0 +1,164 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "kudzu_imu_trace/trace_imu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "kudzu_imu/imu.h"
+#include "kudzu_imu_trace/trace.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_thread/sleep.h"
+
+namespace kudzu::imu {
+
+using pw::chrono::SystemClock;
+
+TraceImu::TraceImu(const ImuTrace& trace, const Options& options)
+    : trace_(trace), options_(options), rng_(options.seed) {
+  const size_t count = trace.samples.size();
+  if (count >= 2) {
+    const uint64_t span_us =
+        trace.samples.back().timestamp_us - trace.samples.front().timestamp_us;
+    pass_us_ = std::max<uint64_t>(span_us + span_us / (count - 1), 1);
+  }
+}
+
+pw::Status TraceImu::Init() {
+  if (trace_.samples.empty()) {
+    return pw::Status::FailedPrecondition();
+  }
+  start_ = SystemClock::now();
+  next_ = 0;
+  dropped_ = 0;
+  started_ = true;
+  return pw::OkStatus();
+}
+
+uint64_t TraceImu::TraceMicroseconds(uint64_t index) const {
+  const size_t count = trace_.samples.size();
+  return trace_.samples[index % count].timestamp_us -
+         trace_.samples.front().timestamp_us + index / count * pass_us_;
+}
+
+uint64_t TraceImu::DueSamples(SystemClock::time_point now) const {
+  const uint64_t elapsed_us =
+      static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(now - start_)
+              .count()) *
+      options_.speedup;
+  const uint64_t passes = elapsed_us / pass_us_;
+  const uint64_t into_pass =
+      elapsed_us % pass_us_ + trace_.samples.front().timestamp_us;
+  const auto due = std::upper_bound(
+      trace_.samples.begin(),
+      trace_.samples.end(),
+      into_pass,
+      [](uint64_t time, const TimestampedImuSample& sample) {
+        return time < sample.timestamp_us;
+      });
+  return passes * trace_.samples.size() +
+         static_cast<uint64_t>(due - trace_.samples.begin());
+}
+
+SystemClock::time_point TraceImu::DueTime(uint64_t index) const {
+  const uint64_t trace_us = TraceMicroseconds(index);
+  const uint64_t wall_us =
+      (trace_us + options_.speedup - 1) / options_.speedup;
+  return start_ + SystemClock::for_at_least(std::chrono::microseconds(
+                      static_cast<int64_t>(wall_us)));
+}
+
+RawAxes TraceImu::Perturb(const RawAxes& axes,
+                          const RawAxes& bias,
+                          uint16_t noise) {
+  // The sum of four uniform variables in [-a, a] has a standard deviation of
+  // 2a / sqrt(3), and is close enough to Gaussian for a sensor's noise.
+  const int32_t a = noise * 866 / 1000;
+  const auto perturb = [&](int16_t value, int16_t offset) {
+    int32_t result = int32_t{value} + offset;
+    if (a > 0) {
+      for (int i = 0; i < 4; i++) {
+        uint32_t random = 0;
+        rng_.GetInt(random);
+        result += static_cast<int32_t>(random % (2 * a + 1)) - a;
+      }
+    }
+    return static_cast<int16_t>(std::clamp<int32_t>(result, -32768, 32767));
+  };
+  return {perturb(axes.x, bias.x),
+          perturb(axes.y, bias.y),
+          perturb(axes.z, bias.z)};
+}
+
+TimestampedImuSample TraceImu::Sample(uint64_t index) {
+  const RawImuSample& raw =
+      trace_.samples[index % trace_.samples.size()].sample;
+  return {
+      trace_.samples.front().timestamp_us + TraceMicroseconds(index),
+      {Perturb(raw.accelerometer, options_.accel_bias, options_.accel_noise),
+       Perturb(raw.gyroscope, options_.gyro_bias, options_.gyro_noise)},
+  };
+}
+
+pw::Result<RawImuSample> TraceImu::ReadRaw() {
+  if (!started_) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (options_.speedup == 0) {
+    return Sample(next_++).sample;
+  }
+  const uint64_t due = DueSamples(SystemClock::now());
+  return Sample(due == 0 ? 0 : due - 1).sample;
+}
+
+pw::Result<pw::span<TimestampedImuSample>> TraceImu::ReadBatch(
+    pw::span<TimestampedImuSample> samples, SystemClock::duration timeout) {
+  if (!started_) {
+    return pw::Status::FailedPrecondition();
+  }
+  uint64_t available = options_.watermark;
+  if (options_.speedup != 0) {
+    const SystemClock::time_point deadline =
+        SystemClock::TimePointAfterAtLeast(timeout);
+    const uint64_t watermark = std::max<uint64_t>(options_.watermark, 1);
+    pw::this_thread::sleep_until(
+        std::min(DueTime(next_ + watermark - 1), deadline));
+
+    const uint64_t due = DueSamples(SystemClock::now());
+    if (due > next_ + options_.fifo_capacity) {
+      dropped_ += due - options_.fifo_capacity - next_;
+      next_ = due - options_.fifo_capacity;
+    }
+    available = due - next_;
+  }
+
+  const size_t count =
+      static_cast<size_t>(std::min<uint64_t>(available, samples.size()));
+  if (count == 0) {
+    return pw::Status::DeadlineExceeded();
+  }
+  for (size_t i = 0; i < count; i++) {
+    samples[i] = Sample(next_++);
+  }
+  return samples.first(count);
+}
+
+}  // namespace kudzu::imu
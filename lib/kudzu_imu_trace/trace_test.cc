@@ -0,0 +1,211 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "kudzu_imu/imu.h"
+#include "kudzu_imu_trace/trace.h"
+#include "kudzu_imu_trace/trace_imu.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_status/status.h"
+#include "pw_thread/sleep.h"
+
+namespace kudzu::imu {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr ImuFullScale kFullScale = {.accel_g = 8, .gyro_dps = 1000};
+
+// 1 kHz, alternating between lying flat and turning at 125 dps.
+constexpr std::array<TimestampedImuSample, 4> kSamples = {{
+    {5000, {{0, 0, 4096}, {0, 0, 0}}},
+    {6000, {{0, 0, 4096}, {0, 0, 4096}}},
+    {7000, {{0, 0, 4096}, {0, 0, 0}}},
+    {8000, {{0, 0, 4096}, {0, 0, 4096}}},
+}};
+constexpr ImuTrace kTrace = {kFullScale, kSamples};
+
+void ExpectEqual(const TimestampedImuSample& a, const TimestampedImuSample& b) {
+  EXPECT_EQ(a.timestamp_us, b.timestamp_us);
+  EXPECT_EQ(a.sample.accelerometer.x, b.sample.accelerometer.x);
+  EXPECT_EQ(a.sample.accelerometer.y, b.sample.accelerometer.y);
+  EXPECT_EQ(a.sample.accelerometer.z, b.sample.accelerometer.z);
+  EXPECT_EQ(a.sample.gyroscope.x, b.sample.gyroscope.x);
+  EXPECT_EQ(a.sample.gyroscope.y, b.sample.gyroscope.y);
+  EXPECT_EQ(a.sample.gyroscope.z, b.sample.gyroscope.z);
+}
+
+TEST(ImuTraceTest, ParsesCsv) {
+  constexpr std::string_view kCsv =
+      "timestamp_us,ax,ay,az,gx,gy,gz\r\n"
+      "# Lying flat\n"
+      "\n"
+      "5000,0,0,1,0,0,0\r\n"
+      "6000,-0.5,0.25,1,0,0,125\n"
+      "7000,8,-8,0,1000,-1000,0";
+  std::array<TimestampedImuSample, 3> buffer;
+  pw::Result<ImuTrace> trace = ParseImuTraceCsv(kCsv, kFullScale, buffer);
+  ASSERT_TRUE(trace.ok());
+  ASSERT_EQ(trace->samples.size(), 3u);
+  ExpectEqual(trace->samples[0], kSamples[0]);
+  ExpectEqual(trace->samples[1], {6000, {{-2048, 1024, 4096}, {0, 0, 4096}}});
+  // Full scale clamps to the int16 range.
+  ExpectEqual(trace->samples[2],
+              {7000, {{32767, -32768, 0}, {32767, -32768, 0}}});
+}
+
+TEST(ImuTraceTest, RejectsBadCsv) {
+  std::array<TimestampedImuSample, 2> buffer;
+  EXPECT_EQ(ParseImuTraceCsv("5000,0,0,1,0,0\n", kFullScale, buffer).status(),
+            pw::Status::DataLoss());
+  EXPECT_EQ(
+      ParseImuTraceCsv("5000,0,0,1,0,0,x\n", kFullScale, buffer).status(),
+      pw::Status::DataLoss());
+  EXPECT_EQ(ParseImuTraceCsv("5000,0,0,1,0,0,0\n4000,0,0,1,0,0,0\n",
+                             kFullScale,
+                             buffer)
+                .status(),
+            pw::Status::DataLoss());
+  EXPECT_EQ(ParseImuTraceCsv("1,0,0,1,0,0,0\n2,0,0,1,0,0,0\n3,0,0,1,0,0,0\n",
+                             kFullScale,
+                             buffer)
+                .status(),
+            pw::Status::ResourceExhausted());
+}
+
+TEST(ImuTraceTest, BinaryRoundTrips) {
+  std::array<std::byte, kImuTraceHeaderSize + 4 * kImuTraceRecordSize> data;
+  pw::Result<pw::ConstByteSpan> written = WriteImuTraceBinary(kTrace, data);
+  ASSERT_TRUE(written.ok());
+  EXPECT_EQ(written->size(), data.size());
+
+  std::array<TimestampedImuSample, 4> buffer;
+  pw::Result<ImuTrace> trace = ParseImuTraceBinary(*written, buffer);
+  ASSERT_TRUE(trace.ok());
+  EXPECT_EQ(trace->full_scale.accel_g, 8);
+  EXPECT_EQ(trace->full_scale.gyro_dps, 1000);
+  ASSERT_EQ(trace->samples.size(), 4u);
+  for (size_t i = 0; i < kSamples.size(); i++) {
+    ExpectEqual(trace->samples[i], kSamples[i]);
+  }
+
+  EXPECT_EQ(ParseImuTraceBinary(*written, pw::span(buffer).first(3)).status(),
+            pw::Status::ResourceExhausted());
+  EXPECT_EQ(ParseImuTraceBinary(written->first(data.size() - 1), buffer)
+                .status(),
+            pw::Status::DataLoss());
+  data[0] = std::byte{'X'};
+  EXPECT_EQ(ParseImuTraceBinary(data, buffer).status(),
+            pw::Status::DataLoss());
+  EXPECT_EQ(WriteImuTraceBinary(kTrace, pw::span(data).first(40)).status(),
+            pw::Status::ResourceExhausted());
+}
+
+TEST(TraceImuTest, UnpacedBatchesLoop) {
+  TraceImu imu(kTrace, {.speedup = 0, .watermark = 3});
+  std::array<TimestampedImuSample, 8> samples;
+  EXPECT_EQ(imu.ReadBatch(samples, 0ms).status(),
+            pw::Status::FailedPrecondition());
+  ASSERT_EQ(imu.Init(), pw::OkStatus());
+
+  pw::Result<pw::span<TimestampedImuSample>> batch =
+      imu.ReadBatch(samples, 0ms);
+  ASSERT_TRUE(batch.ok());
+  ASSERT_EQ(batch->size(), 3u);
+  ExpectEqual((*batch)[0], kSamples[0]);
+  ExpectEqual((*batch)[2], kSamples[2]);
+
+  // The second pass starts a sample period after the end of the first.
+  batch = imu.ReadBatch(samples, 0ms);
+  ASSERT_TRUE(batch.ok());
+  ExpectEqual((*batch)[0], kSamples[3]);
+  EXPECT_EQ((*batch)[1].timestamp_us, 9000u);
+  EXPECT_EQ((*batch)[2].timestamp_us, 10000u);
+  EXPECT_EQ((*batch)[2].sample.gyroscope.z, 4096);
+
+  // Polling carries on from the batches.
+  pw::Result<RawImuSample> raw = imu.ReadRaw();
+  ASSERT_TRUE(raw.ok());
+  EXPECT_EQ(raw->gyroscope.z, 0);
+}
+
+TEST(TraceImuTest, AddsBiasAndNoise) {
+  constexpr TraceImu::Options kOptions = {
+      .speedup = 0,
+      .accel_bias = {10, -20, 0},
+      .gyro_bias = {0, 0, 5},
+      .gyro_noise = 40,
+      .seed = 7,
+  };
+  TraceImu imu(kTrace, kOptions);
+  TraceImu same_seed(kTrace, kOptions);
+  ASSERT_EQ(imu.Init(), pw::OkStatus());
+  ASSERT_EQ(same_seed.Init(), pw::OkStatus());
+
+  constexpr int kReads = 4000;
+  double sum = 0;
+  double sum_of_squares = 0;
+  for (int i = 0; i < kReads; i++) {
+    const RawImuSample sample = *imu.ReadRaw();
+    EXPECT_EQ(sample.accelerometer.x, 10);
+    EXPECT_EQ(sample.accelerometer.y, -20);
+    EXPECT_EQ(sample.accelerometer.z, 4096);
+    EXPECT_EQ(same_seed.ReadRaw()->gyroscope.x, sample.gyroscope.x);
+    sum += sample.gyroscope.x;
+    sum_of_squares += sample.gyroscope.x * sample.gyroscope.x;
+  }
+  const double mean = sum / kReads;
+  EXPECT_NEAR(mean, 0, 3);
+  EXPECT_NEAR(std::sqrt(sum_of_squares / kReads - mean * mean), 40, 4);
+}
+
+TEST(TraceImuTest, PacedBatchWaitsForWatermark) {
+  TraceImu imu(kTrace, {.watermark = 3});
+  ASSERT_EQ(imu.Init(), pw::OkStatus());
+  std::array<TimestampedImuSample, 8> samples;
+  const auto start = pw::chrono::SystemClock::now();
+  pw::Result<pw::span<TimestampedImuSample>> batch =
+      imu.ReadBatch(samples, pw::chrono::SystemClock::for_at_least(1s));
+  ASSERT_TRUE(batch.ok());
+  EXPECT_GE(batch->size(), 3u);
+  EXPECT_GE(pw::chrono::SystemClock::now() - start, 2ms);
+  ExpectEqual((*batch)[0], kSamples[0]);
+}
+
+TEST(TraceImuTest, PacedFifoDropsOldest) {
+  TraceImu imu(kTrace, {.speedup = 1000, .fifo_capacity = 16});
+  ASSERT_EQ(imu.Init(), pw::OkStatus());
+  // Thousands of samples come due at 1 per microsecond.
+  pw::this_thread::sleep_for(pw::chrono::SystemClock::for_at_least(10ms));
+
+  std::array<TimestampedImuSample, 32> samples;
+  pw::Result<pw::span<TimestampedImuSample>> batch =
+      imu.ReadBatch(samples, pw::chrono::SystemClock::for_at_least(0ms));
+  ASSERT_TRUE(batch.ok());
+  EXPECT_EQ(batch->size(), 16u);
+  EXPECT_GT(imu.dropped_samples(), 1000u);
+  for (size_t i = 1; i < batch->size(); i++) {
+    EXPECT_EQ((*batch)[i].timestamp_us, (*batch)[i - 1].timestamp_us + 1000);
+  }
+}
+
+}  // namespace
+}  // namespace kudzu::imu
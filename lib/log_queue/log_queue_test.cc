@@ -0,0 +1,141 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/log_queue.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using TestQueue = kudzu::LogQueue<4, 8>;
+
+std::vector<std::string> DrainAll(TestQueue& queue) {
+  std::vector<std::string> lines;
+  queue.Drain([&lines](std::string_view line) { lines.emplace_back(line); });
+  return lines;
+}
+
+TEST(LogQueueTest, EmptyDrainsNothing) {
+  TestQueue queue;
+  EXPECT_TRUE(DrainAll(queue).empty());
+}
+
+TEST(LogQueueTest, LinesDrainInOrder) {
+  TestQueue queue;
+  EXPECT_TRUE(queue.Push("one"));
+  EXPECT_TRUE(queue.Push("two"));
+  EXPECT_TRUE(queue.Push("three"));
+
+  auto lines = DrainAll(queue);
+  ASSERT_EQ(3u, lines.size());
+  EXPECT_EQ("one", lines[0]);
+  EXPECT_EQ("two", lines[1]);
+  EXPECT_EQ("three", lines[2]);
+  EXPECT_TRUE(DrainAll(queue).empty());
+}
+
+TEST(LogQueueTest, FullQueueDropsAndCounts) {
+  TestQueue queue;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.Push("line"));
+  }
+  EXPECT_FALSE(queue.Push("dropped"));
+  EXPECT_FALSE(queue.Push("dropped"));
+  EXPECT_EQ(2u, queue.dropped_lines());
+
+  EXPECT_EQ(4u, DrainAll(queue).size());
+  EXPECT_TRUE(queue.Push("again"));
+}
+
+TEST(LogQueueTest, LongLinesTruncated) {
+  TestQueue queue;
+  EXPECT_TRUE(queue.Push("0123456789"));
+  auto lines = DrainAll(queue);
+  ASSERT_EQ(1u, lines.size());
+  EXPECT_EQ("01234567", lines[0]);
+  EXPECT_EQ(1u, queue.truncated_lines());
+}
+
+TEST(LogQueueTest, DrainRespectsLimitAndWraps) {
+  TestQueue queue;
+  for (int round = 0; round < 3; round++) {
+    EXPECT_TRUE(queue.Push("a"));
+    EXPECT_TRUE(queue.Push("b"));
+    EXPECT_TRUE(queue.Push("c"));
+
+    std::string drained;
+    EXPECT_EQ(2u,
+              queue.Drain([&](std::string_view line) { drained += line; }, 2));
+    EXPECT_EQ(1u, queue.Drain([&](std::string_view line) { drained += line; }));
+    EXPECT_EQ("abc", drained);
+  }
+}
+
+TEST(LogQueueTest, ProducersOnManyThreads) {
+  constexpr int kProducers = 4;
+  constexpr int kLinesPerProducer = 2000;
+  kudzu::LogQueue<16, 16> queue;
+  std::atomic<int> running = kProducers;
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kProducers; producer++) {
+    producers.emplace_back([&queue, &running, producer] {
+      for (int i = 0; i < kLinesPerProducer; i++) {
+        char line[16];
+        std::snprintf(line, sizeof(line), "%d %d", producer, i);
+        queue.Push(line);
+      }
+      running--;
+    });
+  }
+
+  // Each producer's lines arrive whole and in the order it pushed them.
+  std::array<int, kProducers> last_line;
+  last_line.fill(-1);
+  int drained = 0;
+  bool in_order = true;
+  const auto check = [&](std::string_view line) {
+    int producer = -1;
+    int index = -1;
+    const std::string text(line);
+    ASSERT_EQ(2, std::sscanf(text.c_str(), "%d %d", &producer, &index));
+    ASSERT_GE(producer, 0);
+    ASSERT_LT(producer, kProducers);
+    in_order = in_order && index > last_line[producer];
+    last_line[producer] = index;
+    drained++;
+  };
+  while (running > 0) {
+    queue.Drain(check);
+  }
+  for (std::thread& thread : producers) {
+    thread.join();
+  }
+  queue.Drain(check);
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(kProducers * kLinesPerProducer,
+            drained + static_cast<int>(queue.dropped_lines()));
+  EXPECT_EQ(0u, queue.truncated_lines());
+}
+
+}  // namespace
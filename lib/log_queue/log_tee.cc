@@ -0,0 +1,96 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/log_tee.h"
+
+#include <atomic>
+#include <cstdarg>
+
+#include "pw_log/levels.h"
+#include "pw_string/string_builder.h"
+
+namespace kudzu {
+namespace {
+
+std::atomic<LogTeeOutput> s_output{nullptr};
+
+}  // namespace
+
+void SetLogTeeOutput(LogTeeOutput output) {
+  s_output.store(output, std::memory_order_relaxed);
+}
+
+}  // namespace kudzu
+
+#if KUDZU_LOG_TEE_WRAPS_PW_LOG_STRING
+
+namespace {
+
+// Longer lines are truncated; the backend still gets the whole message.
+constexpr size_t kMaxLineLength = 128;
+
+const char* LevelPrefix(int level) {
+  switch (level) {
+    case PW_LOG_LEVEL_DEBUG:
+      return "\e[38;5;244mDBG\e[0m ";
+    case PW_LOG_LEVEL_INFO:
+      return "\e[32mINF\e[0m ";
+    case PW_LOG_LEVEL_WARN:
+      return "\e[33mWRN\e[0m ";
+    case PW_LOG_LEVEL_ERROR:
+      return "\e[31mERR\e[0m ";
+    case PW_LOG_LEVEL_CRITICAL:
+      return "\e[41;97mCRT\e[0m ";
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+// The linker sends calls to the handler here, with
+// -Wl,--wrap=pw_log_string_HandleMessageVaList, and the original handler is
+// reached through __real_.
+extern "C" void __real_pw_log_string_HandleMessageVaList(
+    int level,
+    unsigned int flags,
+    const char* module_name,
+    const char* file_name,
+    int line_number,
+    const char* message,
+    va_list args);
+
+extern "C" void __wrap_pw_log_string_HandleMessageVaList(
+    int level,
+    unsigned int flags,
+    const char* module_name,
+    const char* file_name,
+    int line_number,
+    const char* message,
+    va_list args) {
+  if (kudzu::LogTeeOutput output =
+          kudzu::s_output.load(std::memory_order_relaxed)) {
+    pw::StringBuffer<kMaxLineLength> line;
+    line << LevelPrefix(level);
+    va_list copy;
+    va_copy(copy, args);
+    line.FormatVaList(message, copy);
+    va_end(copy);
+    output(line.view());
+  }
+  __real_pw_log_string_HandleMessageVaList(
+      level, flags, module_name, file_name, line_number, message, args);
+}
+
+#endif  // KUDZU_LOG_TEE_WRAPS_PW_LOG_STRING
@@ -0,0 +1,149 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace kudzu {
+
+/// A bounded multi-producer, single-consumer queue of text lines.
+///
+/// Any thread may call `Push()`; it never waits on the consumer. When the
+/// queue is full the line is dropped and counted instead. Lines longer than
+/// `kMaxLineLength` are truncated and counted.
+///
+/// A single consumer thread calls `Drain()` to hand the queued lines to a
+/// callback, typically once per frame.
+///
+/// This is not lock-free. The Cortex-M0+ has no atomic read-modify-write, so
+/// producers claim a slot under an interrupt spin lock, which is held for a
+/// few instructions and never while a line is copied. A producer can wait
+/// only for another producer's claim. Each slot's sequence number, which is
+/// only ever loaded and stored, tells the consumer when the line in it is
+/// complete, so the consumer never takes the lock.
+template <size_t kNumLines, size_t kMaxLineLength>
+class LogQueue {
+ public:
+  static_assert(kNumLines > 1 && (kNumLines & (kNumLines - 1)) == 0,
+                "kNumLines must be a power of two");
+  static_assert(kMaxLineLength <= UINT16_MAX);
+
+  LogQueue() {
+    for (uint32_t i = 0; i < kNumLines; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  LogQueue(const LogQueue&) = delete;
+  LogQueue& operator=(const LogQueue&) = delete;
+
+  /// Copy a line into the queue. Returns false if the queue was full and the
+  /// line was dropped.
+  bool Push(std::string_view line) {
+    const bool truncated = line.size() > kMaxLineLength;
+    if (truncated) {
+      line = line.substr(0, kMaxLineLength);
+    }
+
+    uint32_t pos;
+    {
+      std::lock_guard lock(lock_);
+      pos = write_pos_;
+      if (slots_[pos & kIndexMask].sequence.load(std::memory_order_acquire) !=
+          pos) {
+        // The consumer hasn't released this slot yet.
+        Increment(dropped_lines_);
+        return false;
+      }
+      write_pos_ = pos + 1;
+      if (truncated) {
+        Increment(truncated_lines_);
+      }
+    }
+
+    Slot& slot = slots_[pos & kIndexMask];
+    std::memcpy(slot.data.data(), line.data(), line.size());
+    slot.length = static_cast<uint16_t>(line.size());
+    slot.sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pass up to `max_lines` queued lines, oldest first, to `callback` which is
+  /// invoked as `callback(std::string_view)`. The view is only valid for the
+  /// duration of the call. Returns the number of lines drained.
+  ///
+  /// Must only be called from one thread at a time.
+  template <typename Callback>
+  size_t Drain(Callback&& callback, size_t max_lines = kNumLines) {
+    size_t count = 0;
+    while (count < max_lines) {
+      Slot& slot = slots_[read_pos_ & kIndexMask];
+      if (slot.sequence.load(std::memory_order_acquire) != read_pos_ + 1) {
+        // Empty, or the producer hasn't finished writing this slot.
+        break;
+      }
+      callback(std::string_view(slot.data.data(), slot.length));
+      slot.sequence.store(read_pos_ + kNumLines, std::memory_order_release);
+      read_pos_++;
+      count++;
+    }
+    return count;
+  }
+
+  /// Number of lines dropped because the queue was full.
+  uint32_t dropped_lines() const {
+    return dropped_lines_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of lines that were shortened to fit in a slot.
+  uint32_t truncated_lines() const {
+    return truncated_lines_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr uint32_t kIndexMask = kNumLines - 1;
+
+  // Only called with `lock_` held, so a load and a store are enough.
+  static void Increment(std::atomic<uint32_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    uint16_t length = 0;
+    std::array<char, kMaxLineLength> data;
+  };
+
+  std::array<Slot, kNumLines> slots_;
+  pw::sync::InterruptSpinLock lock_;
+  uint32_t write_pos_ PW_GUARDED_BY(lock_) = 0;
+  // Only touched by the consumer.
+  uint32_t read_pos_ = 0;
+  // Written under `lock_`, and atomic so they can be read without it.
+  std::atomic<uint32_t> dropped_lines_{0};
+  std::atomic<uint32_t> truncated_lines_{0};
+};
+
+}  // namespace kudzu
@@ -0,0 +1,34 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <string_view>
+
+namespace kudzu {
+
+/// Receives a formatted log line. May be called from any thread, so it must
+/// not block or log.
+using LogTeeOutput = void (*)(std::string_view line);
+
+/// Copies every pw_log message to `output` as a single line, with its level
+/// as an ANSI colored prefix, e.g. `"\e[32mINF\e[0m Ready"`. The log
+/// backend still handles the message as before. Pass nullptr to stop.
+///
+/// This sits in front of pw_log_string's handler, so it only sees messages
+/// on targets whose pw_log backend is pw_log_string. Elsewhere `output` is
+/// never called.
+void SetLogTeeOutput(LogTeeOutput output);
+
+}  // namespace kudzu
@@ -17,6 +17,7 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
 #define PW_LOG_MODULE_NAME "max17048"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
@@ -26,6 +27,7 @@
 #include "pw_i2c/register_device.h"
 #include "pw_log/log.h"
 #include "pw_status/status.h"
+#include "pw_status/try.h"
 
 using ::pw::Status;
 using namespace std::chrono_literals;
@@ -36,11 +38,33 @@ namespace {
 
 constexpr pw::i2c::Address kAddress = pw::i2c::Address::SevenBit<0x36>();
 
-void FuelReadReg(pw::i2c::RegisterDevice& device,
-                 uint8_t addr,
-                 const char* name) {
-  auto data =
-      device.ReadRegister16(addr, pw::chrono::SystemClock::for_at_least(10ms));
+constexpr uint8_t kRegVcell = 0x02;
+constexpr uint8_t kRegSoc = 0x04;
+constexpr uint8_t kRegConfig = 0x0c;
+constexpr uint8_t kRegValrt = 0x14;
+constexpr uint8_t kRegCrate = 0x16;
+constexpr uint8_t kRegStatus = 0x1a;
+
+// VCELL through STATUS, all 16-bit registers.
+constexpr kudzu::RegisterCache::Layout kRegistersLayout = {
+    .first_address = kRegVcell,
+    .size = kRegStatus + 2 - kRegVcell,
+};
+
+// CONFIG: ALRT is set while any alert is, and ATHD sets the empty alert at
+// (32 - ATHD)%.
+constexpr uint16_t kConfigAlrt = 1 << 5;
+constexpr uint16_t kConfigAthdMask = 0x1f;
+
+// VALRT is 20 mV per bit.
+constexpr uint32_t kValrtMillivoltsPerBit = 20;
+
+constexpr auto kTimeout = pw::chrono::SystemClock::for_at_least(10ms);
+
+void FuelLogReg(const kudzu::RegisterCache& registers,
+                uint8_t addr,
+                const char* name) {
+  auto data = registers.Get16(addr);
 
   if (data.ok()) {
     PW_LOG_INFO("%s: %04x", name, *data);
@@ -55,8 +79,10 @@ Device::Device(pw::i2c::Initiator& initiator)
     : initiator_(initiator),
       device_(initiator,
               kAddress,
-              endian::little,
-              pw::i2c::RegisterAddressSize::k1Byte) {}
+              // Registers are sent most significant byte first.
+              endian::big,
+              pw::i2c::RegisterAddressSize::k1Byte),
+      registers_(initiator, kAddress, kRegistersLayout) {}
 
 Status Device::Enable() {
   device_.WriteRegister8(
@@ -78,22 +104,86 @@ Status Device::Probe() {
 }
 
 void Device::LogControllerInfo() {
-  auto data =
-      device_.ReadRegister16(0x2, pw::chrono::SystemClock::for_at_least(10ms));
-  if (data.ok()) {
-    PW_LOG_INFO("VCELL: %d mV", static_cast<uint32_t>(*data) * 78125 / 1000000);
-  } else {
-    PW_LOG_INFO("failed to read VCELL");
+  std::lock_guard lock(lock_);
+  // One read covers every register logged here.
+  if (!registers_.Load().ok()) {
+    PW_LOG_INFO("failed to read registers");
+    return;
+  }
+  PW_LOG_INFO("VCELL: %d mV",
+              static_cast<int>(CellMillivoltsFromRegister(
+                  registers_.Get16(kRegVcell).value())));
+  FuelLogReg(registers_, 0x4, "SOC");
+  FuelLogReg(registers_, 0x6, "MODE");
+  FuelLogReg(registers_, 0x8, "VERSION");
+  FuelLogReg(registers_, 0xa, "HIBRT");
+  FuelLogReg(registers_, 0xc, "CONFIG");
+  FuelLogReg(registers_, 0x14, "VALRT");
+  FuelLogReg(registers_, 0x16, "CRATE");
+  FuelLogReg(registers_, 0x18, "VRESET/ID");
+  FuelLogReg(registers_, 0x1a, "STATUS");
+}
+
+Result<uint32_t> Device::ReadCellMillivolts() {
+  PW_TRY_ASSIGN(const uint16_t vcell,
+                device_.ReadRegister16(kRegVcell, kTimeout));
+  return CellMillivoltsFromRegister(vcell);
+}
+
+Result<uint32_t> Device::ReadStateOfChargePercent() {
+  PW_TRY_ASSIGN(const uint16_t soc, device_.ReadRegister16(kRegSoc, kTimeout));
+  // The high byte is whole percent and the low byte 1/256ths of a percent.
+  return static_cast<uint32_t>(soc) >> 8;
+}
+
+Result<BatteryReading> Device::Read() {
+  std::lock_guard lock(lock_);
+  // VCELL and SOC are adjacent, as are CRATE, VRESET/ID and STATUS.
+  PW_TRY(registers_.Load(kRegVcell, 4));
+  PW_TRY(registers_.Load(kRegCrate, 6));
+  return ParseReading(registers_.Get16(kRegVcell).value(),
+                      registers_.Get16(kRegSoc).value(),
+                      registers_.Get16(kRegCrate).value(),
+                      registers_.Get16(kRegStatus).value());
+}
+
+Status Device::ClearAlerts(uint8_t alerts) {
+  std::lock_guard lock(lock_);
+  // The gauge sets alert bits by itself, so reload them before writing.
+  PW_TRY(registers_.Load(kRegStatus, 2));
+  registers_.Update16(
+      kRegStatus, static_cast<uint16_t>((alerts & alert::kAll) << 8), 0);
+  PW_TRY(registers_.Flush());
+  if (((registers_.Get16(kRegStatus).value() >> 8) & alert::kAll) != 0) {
+    return OkStatus();
+  }
+  PW_TRY(registers_.Load(kRegConfig, 2));
+  registers_.Update16(kRegConfig, kConfigAlrt, 0);
+  return registers_.Flush();
+}
+
+Status Device::SetEmptyAlertPercent(uint32_t percent) {
+  if (percent < 1 || percent > 32) {
+    return Status::InvalidArgument();
+  }
+  std::lock_guard lock(lock_);
+  // CONFIG.ALRT is set by the gauge, so reload it before writing.
+  PW_TRY(registers_.Load(kRegConfig, 2));
+  registers_.Update16(
+      kRegConfig, kConfigAthdMask, static_cast<uint16_t>(32 - percent));
+  return registers_.Flush();
+}
+
+Status Device::SetVoltageAlertMillivolts(uint32_t min_millivolts,
+                                         uint32_t max_millivolts) {
+  const uint32_t min_bits = min_millivolts / kValrtMillivoltsPerBit;
+  const uint32_t max_bits = max_millivolts / kValrtMillivoltsPerBit;
+  if (min_bits > max_bits || max_bits > 0xff) {
+    return Status::InvalidArgument();
   }
-  FuelReadReg(device_, 0x4, "SOC");
-  FuelReadReg(device_, 0x6, "MODE");
-  FuelReadReg(device_, 0x8, "VERSION");
-  FuelReadReg(device_, 0xa, "HIBRT");
-  FuelReadReg(device_, 0xc, "CONFIG");
-  FuelReadReg(device_, 0x14, "VALRT");
-  FuelReadReg(device_, 0x16, "CRATE");
-  FuelReadReg(device_, 0x18, "VRESET/ID");
-  FuelReadReg(device_, 0x1a, "STATUS");
+  std::lock_guard lock(lock_);
+  registers_.Set16(kRegValrt, static_cast<uint16_t>(min_bits << 8 | max_bits));
+  return registers_.Flush();
 }
 
 }  // namespace pw::max17048
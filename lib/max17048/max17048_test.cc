@@ -0,0 +1,51 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "max17048/device.h"
+
+namespace pw::max17048 {
+namespace {
+
+TEST(Max17048Test, CellVoltageIs78Point125MicrovoltsPerBit) {
+  EXPECT_EQ(CellMillivoltsFromRegister(0), 0u);
+  // 0xd000 * 78.125 uV = 4160 mV.
+  EXPECT_EQ(CellMillivoltsFromRegister(0xd000), 4160u);
+  EXPECT_EQ(CellMillivoltsFromRegister(0xffff), 5119u);
+}
+
+TEST(Max17048Test, ChargeRateIsSigned) {
+  EXPECT_EQ(ChargeRateFromRegister(0x0000), 0);
+  EXPECT_EQ(ChargeRateFromRegister(0x0005), 1040);
+  // Discharging at 5 * 0.208%/hr.
+  EXPECT_EQ(ChargeRateFromRegister(0xfffb), -1040);
+}
+
+TEST(Max17048Test, ParseReading) {
+  // 3.7 V, 87.5%, discharging, with the reset and SOC low alerts set and the
+  // EnVR bit, which isn't an alert, also set.
+  const BatteryReading reading =
+      ParseReading(0xb8f9, 0x5780, 0xfff0, 0x5100);
+  EXPECT_EQ(reading.millivolts, 3699u);
+  EXPECT_EQ(reading.state_of_charge, 0x5780u);
+  EXPECT_EQ(reading.percent(), 87u);
+  EXPECT_EQ(reading.charge_rate, -16 * 208);
+  EXPECT_FALSE(reading.charging());
+  EXPECT_EQ(reading.alerts, alert::kReset | alert::kStateOfChargeLow);
+}
+
+}  // namespace
+}  // namespace pw::max17048
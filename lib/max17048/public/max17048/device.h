@@ -16,13 +16,73 @@
 #include <array>
 #include <cstdint>
 
+#include "libkudzu/register_cache.h"
 #include "pw_i2c/address.h"
 #include "pw_i2c/initiator.h"
 #include "pw_i2c/register_device.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
 
 namespace pw::max17048 {
 
+// Alert flags, as kept in the high byte of the STATUS register.
+namespace alert {
+// The device powered up or was reset and needs configuring.
+inline constexpr uint8_t kReset = 1 << 0;
+// VCELL rose above VALRT.MAX.
+inline constexpr uint8_t kVoltageHigh = 1 << 1;
+// VCELL fell below VALRT.MIN.
+inline constexpr uint8_t kVoltageLow = 1 << 2;
+// VCELL fell below VRESET, so the battery may have been swapped.
+inline constexpr uint8_t kVoltageReset = 1 << 3;
+// SOC fell below the empty alert threshold.
+inline constexpr uint8_t kStateOfChargeLow = 1 << 4;
+// SOC changed by at least 1%, if enabled in CONFIG.ALSC.
+inline constexpr uint8_t kStateOfChargeChange = 1 << 5;
+inline constexpr uint8_t kAll = 0x3f;
+}  // namespace alert
+
+struct BatteryReading {
+  // Cell voltage in millivolts.
+  uint32_t millivolts;
+  // State of charge in 1/256ths of a percent.
+  uint32_t state_of_charge;
+  // Rate the charge is rising, or falling if negative, in thousandths of a
+  // percent per hour.
+  int32_t charge_rate;
+  // Set alert:: flags.
+  uint8_t alerts;
+
+  // State of charge in whole percent, rounded down.
+  uint32_t percent() const { return state_of_charge >> 8; }
+  bool charging() const { return charge_rate > 0; }
+};
+
+// VCELL is 78.125 uV, or 5/64 mV, per bit.
+constexpr uint32_t CellMillivoltsFromRegister(uint16_t vcell) {
+  return uint32_t{vcell} * 5 / 64;
+}
+
+// CRATE is signed, at 0.208% per hour per bit.
+constexpr int32_t ChargeRateFromRegister(uint16_t crate) {
+  return int32_t{static_cast<int16_t>(crate)} * 208;
+}
+
+// Builds a reading from the raw VCELL, SOC, CRATE and STATUS registers.
+constexpr BatteryReading ParseReading(uint16_t vcell,
+                                      uint16_t soc,
+                                      uint16_t crate,
+                                      uint16_t status) {
+  return {
+      .millivolts = CellMillivoltsFromRegister(vcell),
+      .state_of_charge = soc,
+      .charge_rate = ChargeRateFromRegister(crate),
+      .alerts = static_cast<uint8_t>((status >> 8) & alert::kAll),
+  };
+}
+
 class Device {
  public:
   Device(pw::i2c::Initiator& initiator);
@@ -32,9 +92,34 @@ class Device {
   Status Probe();
   void LogControllerInfo();
 
+  // Battery cell voltage in millivolts.
+  pw::Result<uint32_t> ReadCellMillivolts();
+  // Battery state of charge in whole percent.
+  pw::Result<uint32_t> ReadStateOfChargePercent();
+
+  // Reads voltage, state of charge, charge rate and alerts in two bus
+  // transactions.
+  pw::Result<BatteryReading> Read();
+
+  // Clears the given alert:: flags, and releases the ALRT pin once none are
+  // left set.
+  Status ClearAlerts(uint8_t alerts);
+
+  // Raises alert::kStateOfChargeLow once the charge falls below `percent`,
+  // which must be 1 to 32.
+  Status SetEmptyAlertPercent(uint32_t percent);
+
+  // Raises alert::kVoltageLow and kVoltageHigh outside of the given range,
+  // in 20 mV steps up to 5100 mV.
+  Status SetVoltageAlertMillivolts(uint32_t min_millivolts,
+                                   uint32_t max_millivolts);
+
  private:
   pw::i2c::Initiator& initiator_;
   pw::i2c::RegisterDevice device_;
+  // The work queue, RPCs and the health check all read the gauge.
+  pw::sync::Mutex lock_;
+  kudzu::RegisterCache registers_ PW_GUARDED_BY(lock_);
 };
 
 }  // namespace pw::max17048
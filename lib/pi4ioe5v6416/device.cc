@@ -28,6 +28,7 @@
 #include "pw_i2c/register_device.h"
 #include "pw_log/log.h"
 #include "pw_status/status.h"
+#include "pw_status/try.h"
 
 using ::pw::Status;
 using namespace std::chrono_literals;
@@ -48,6 +49,22 @@ enum Register : uint32_t {
   PullUpDownEnablePort1 = 0x47,
   PullUpDownSelectionPort0 = 0x48,
   PullUpDownSelectionPort1 = 0x49,
+  // 1=masked 0=interrupt enabled.
+  InterruptMaskPort0 = 0x4a,
+  InterruptMaskPort1 = 0x4b,
+};
+
+// Each port's pair of registers auto-increments within itself, so bursts
+// can't cross from one pair to the next.
+constexpr kudzu::RegisterCache::Layout kPortConfigLayout = {
+    .first_address = Register::OutputPort0,
+    .size = Register::ConfigPort1 - Register::OutputPort0 + 1,
+    .burst_alignment = 2,
+};
+constexpr kudzu::RegisterCache::Layout kPullConfigLayout = {
+    .first_address = Register::PullUpDownEnablePort0,
+    .size = Register::InterruptMaskPort1 - Register::PullUpDownEnablePort0 + 1,
+    .burst_alignment = 2,
 };
 
 }  // namespace
@@ -57,31 +74,36 @@ Device::Device(pw::i2c::Initiator& initiator)
       device_(initiator,
               kAddress,
               endian::little,
-              pw::i2c::RegisterAddressSize::k1Byte) {}
+              pw::i2c::RegisterAddressSize::k1Byte),
+      port_config_(initiator, kAddress, kPortConfigLayout),
+      pull_config_(initiator, kAddress, kPullConfigLayout) {}
 
 Status Device::Enable() {
+  // The expander may have been reset, so write everything.
+  port_config_.Invalidate();
+  pull_config_.Invalidate();
+
   // Set port 0 as inputs for buttons: 1=input 0=output
-  device_.WriteRegister8(
-      Register::ConfigPort0, 0xff, pw::chrono::SystemClock::for_at_least(10ms));
+  port_config_.Set(Register::ConfigPort0, 0xff);
   // Select pull up resistors for button input: 1=pull-up 0=pull-down.
-  device_.WriteRegister8(Register::PullUpDownSelectionPort0,
-                         0xff,
-                         pw::chrono::SystemClock::for_at_least(10ms));
+  pull_config_.Set(Register::PullUpDownSelectionPort0, 0xff);
   // Enable pull up/down resistors for button input: 1=enable 0=disable.
-  device_.WriteRegister8(Register::PullUpDownEnablePort0,
-                         0xff,
-                         pw::chrono::SystemClock::for_at_least(10ms));
+  pull_config_.Set(Register::PullUpDownEnablePort0, 0xff);
 
   // Port 1 pins 6 and 7 are DISP_RESET and TOUCH_RESET
   // Set port 1 pins 6 and 7 to outputs: 1=input 0=output
-  device_.WriteRegister8(Register::ConfigPort1,
-                         0b00111111,
-                         pw::chrono::SystemClock::for_at_least(10ms));
-  // Set pins 6 and 7 to high.
-  device_.WriteRegister8(
-      Register::OutputPort1, 0xff, pw::chrono::SystemClock::for_at_least(10ms));
-
-  return OkStatus();
+  port_config_.Set(Register::ConfigPort1, 0b00111111);
+  // Set pins 6 and 7 to high. The output register is flushed before the
+  // configuration registers, so the pins never drive low.
+  port_config_.Set(Register::OutputPort1, 0xff);
+
+  PW_TRY(port_config_.Flush());
+  return pull_config_.Flush();
+}
+
+Status Device::EnablePort0Interrupts(uint8_t pins) {
+  pull_config_.Set(Register::InterruptMaskPort0, static_cast<uint8_t>(~pins));
+  return pull_config_.Flush();
 }
 
 pw::Result<uint8_t> Device::ReadPort0() {
@@ -16,6 +16,7 @@
 #include <array>
 #include <cstdint>
 
+#include "libkudzu/register_cache.h"
 #include "pw_i2c/address.h"
 #include "pw_i2c/initiator.h"
 #include "pw_i2c/register_device.h"
@@ -32,12 +33,19 @@ class Device {
   Status Enable();
   Status Probe();
   void LogControllerInfo();
+  // Lets each port 0 pin set in `pins` pull the INT line low when its input
+  // changes. Reading port 0 releases it.
+  Status EnablePort0Interrupts(uint8_t pins);
   pw::Result<uint8_t> ReadPort0();
   pw::Result<uint8_t> ReadPort1();
 
  private:
   pw::i2c::Initiator& initiator_;
   pw::i2c::RegisterDevice device_;
+  // Output, polarity inversion and configuration registers.
+  kudzu::RegisterCache port_config_;
+  // Pull-up/down and interrupt mask registers.
+  kudzu::RegisterCache pull_config_;
 };
 
 }  // namespace pw::pi4ioe5v6416
@@ -0,0 +1,80 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/power_governor.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace kudzu {
+
+const char* PowerLevelName(PowerLevel level) {
+  switch (level) {
+    case PowerLevel::kPerformance:
+      return "performance";
+    case PowerLevel::kBalanced:
+      return "balanced";
+    case PowerLevel::kSaver:
+      return "saver";
+    case PowerLevel::kCritical:
+      return "critical";
+  }
+  return "unknown";
+}
+
+PowerLevel PowerGovernor::LevelForPercent(uint32_t percent,
+                                          uint32_t margin) const {
+  if (percent <= config_.critical_percent + margin) {
+    return PowerLevel::kCritical;
+  }
+  if (percent <= config_.saver_percent + margin) {
+    return PowerLevel::kSaver;
+  }
+  if (percent <= config_.balanced_percent + margin) {
+    return PowerLevel::kBalanced;
+  }
+  return PowerLevel::kPerformance;
+}
+
+bool PowerGovernor::Update(const PowerInputs& inputs) {
+  const PowerLevel previous = level_;
+
+  if (!inputs.battery.has_value() || inputs.battery->charge_rate > 0) {
+    level_ = PowerLevel::kPerformance;
+    return level_ != previous;
+  }
+
+  const PowerInputs::Battery& battery = *inputs.battery;
+  if (battery.millivolts <= config_.critical_millivolts) {
+    level_ = PowerLevel::kCritical;
+    return level_ != previous;
+  }
+
+  const bool heavy_load = inputs.frame_p95_us.has_value() &&
+                          *inputs.frame_p95_us >= config_.heavy_load_frame_us;
+  const uint32_t margin = heavy_load ? config_.heavy_load_percent : 0;
+
+  // Saving more takes effect at once, but saving less waits for the charge
+  // to clear the threshold by the hysteresis.
+  PowerLevel level = LevelForPercent(battery.percent, margin);
+  if (level < level_) {
+    level = std::min(
+        level_,
+        LevelForPercent(battery.percent, margin + config_.hysteresis_percent));
+  }
+  level_ = level;
+  return level_ != previous;
+}
+
+}  // namespace kudzu
@@ -0,0 +1,111 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/power_governor.h"
+
+#include <cstdint>
+#include <optional>
+
+#include "gtest/gtest.h"
+
+namespace kudzu {
+namespace {
+
+PowerInputs OnBattery(uint32_t percent,
+                      std::optional<uint32_t> frame_p95_us = std::nullopt) {
+  return {
+      .battery = PowerInputs::Battery{.millivolts = 3800,
+                                      .percent = percent,
+                                      .charge_rate = -2000},
+      .frame_p95_us = frame_p95_us,
+  };
+}
+
+TEST(PowerGovernorTest, StartsAtPerformance) {
+  PowerGovernor governor;
+  EXPECT_EQ(governor.level(), PowerLevel::kPerformance);
+  EXPECT_EQ(governor.profile().min_frame_period_us, 0u);
+  EXPECT_EQ(governor.profile().backlight, 0xffff);
+}
+
+TEST(PowerGovernorTest, StepsDownAsChargeFalls) {
+  PowerGovernor governor;
+  EXPECT_FALSE(governor.Update(OnBattery(80)));
+  EXPECT_EQ(governor.level(), PowerLevel::kPerformance);
+
+  EXPECT_TRUE(governor.Update(OnBattery(50)));
+  EXPECT_EQ(governor.level(), PowerLevel::kBalanced);
+
+  EXPECT_TRUE(governor.Update(OnBattery(20)));
+  EXPECT_EQ(governor.level(), PowerLevel::kSaver);
+
+  EXPECT_TRUE(governor.Update(OnBattery(5)));
+  EXPECT_EQ(governor.level(), PowerLevel::kCritical);
+  EXPECT_EQ(governor.profile().imu_rate_hz, 50);
+}
+
+TEST(PowerGovernorTest, StepsUpOnlyPastHysteresis) {
+  PowerGovernor governor;
+  governor.Update(OnBattery(50));
+  ASSERT_EQ(governor.level(), PowerLevel::kBalanced);
+
+  // Wobbling just over the threshold stays put.
+  EXPECT_FALSE(governor.Update(OnBattery(51)));
+  EXPECT_FALSE(governor.Update(OnBattery(53)));
+  EXPECT_EQ(governor.level(), PowerLevel::kBalanced);
+
+  EXPECT_TRUE(governor.Update(OnBattery(54)));
+  EXPECT_EQ(governor.level(), PowerLevel::kPerformance);
+}
+
+TEST(PowerGovernorTest, HeavyLoadStepsDownSooner) {
+  PowerGovernor governor;
+  EXPECT_FALSE(governor.Update(OnBattery(55, 10'000)));
+  EXPECT_EQ(governor.level(), PowerLevel::kPerformance);
+
+  EXPECT_TRUE(governor.Update(OnBattery(55, 30'000)));
+  EXPECT_EQ(governor.level(), PowerLevel::kBalanced);
+}
+
+TEST(PowerGovernorTest, ChargingOrNoGaugeIsPerformance) {
+  PowerGovernor governor;
+  governor.Update(OnBattery(3));
+  ASSERT_EQ(governor.level(), PowerLevel::kCritical);
+
+  PowerInputs charging = OnBattery(3);
+  charging.battery->charge_rate = 5000;
+  EXPECT_TRUE(governor.Update(charging));
+  EXPECT_EQ(governor.level(), PowerLevel::kPerformance);
+
+  governor.Update(OnBattery(3));
+  ASSERT_EQ(governor.level(), PowerLevel::kCritical);
+  EXPECT_TRUE(governor.Update({}));
+  EXPECT_EQ(governor.level(), PowerLevel::kPerformance);
+}
+
+TEST(PowerGovernorTest, LowVoltageIsCritical) {
+  PowerGovernor governor;
+  PowerInputs sagging = OnBattery(60);
+  sagging.battery->millivolts = 3350;
+  EXPECT_TRUE(governor.Update(sagging));
+  EXPECT_EQ(governor.level(), PowerLevel::kCritical);
+}
+
+TEST(PowerGovernorTest, LevelNames) {
+  EXPECT_STREQ(PowerLevelName(PowerLevel::kPerformance), "performance");
+  EXPECT_STREQ(PowerLevelName(PowerLevel::kCritical), "critical");
+}
+
+}  // namespace
+}  // namespace kudzu
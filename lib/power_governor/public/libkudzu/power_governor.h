@@ -0,0 +1,122 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace kudzu {
+
+/// How hard the governor is saving power, from not at all to as much as it
+/// can without stopping the app.
+enum class PowerLevel : uint8_t {
+  kPerformance,
+  kBalanced,
+  kSaver,
+  kCritical,
+};
+
+inline constexpr size_t kNumPowerLevels = 4;
+
+const char* PowerLevelName(PowerLevel level);
+
+/// The settings the board applies at a power level.
+struct PowerProfile {
+  /// Shortest time from the start of one frame to the next, or zero to leave
+  /// frames unpaced.
+  uint32_t min_frame_period_us;
+  /// Backlight PWM level out of 65535.
+  uint16_t backlight;
+  /// IMU output data rate.
+  uint16_t imu_rate_hz;
+};
+
+/// What the governor decides from. A missing battery reading counts as
+/// external power.
+struct PowerInputs {
+  struct Battery {
+    uint32_t millivolts;
+    uint32_t percent;
+    /// Thousandths of a percent per hour, positive while charging.
+    int32_t charge_rate;
+  };
+
+  std::optional<Battery> battery;
+  /// 95th percentile frame time over the last second, if the app is drawing.
+  std::optional<uint32_t> frame_p95_us;
+};
+
+/// Picks a power level from battery state and app load, and the profile the
+/// board should apply for it.
+///
+/// While charging, or with no fuel gauge, the app gets everything. On
+/// battery the level steps down as the charge falls, and steps down sooner
+/// while the app is heavily loaded, since that drains the battery faster.
+/// Stepping back up waits for the charge to clear the threshold by a margin,
+/// so a reading that wobbles across it doesn't make the backlight flicker.
+///
+/// Not thread safe; update and read it from one thread.
+class PowerGovernor {
+ public:
+  struct Config {
+    /// Charge at or below which each saving level starts.
+    uint32_t balanced_percent = 50;
+    uint32_t saver_percent = 20;
+    uint32_t critical_percent = 5;
+    /// Cell voltage at or below which the level is critical whatever the
+    /// reported charge, which lags on an aged cell.
+    uint32_t critical_millivolts = 3400;
+    /// How far the charge must rise past a threshold to leave its level.
+    uint32_t hysteresis_percent = 3;
+    /// Frames this slow at the 95th percentile count as heavy load, which
+    /// raises each threshold by `heavy_load_percent`.
+    uint32_t heavy_load_frame_us = 25'000;
+    uint32_t heavy_load_percent = 10;
+    /// Indexed by PowerLevel.
+    std::array<PowerProfile, kNumPowerLevels> profiles = {{
+        {.min_frame_period_us = 0, .backlight = 0xffff, .imu_rate_hz = 400},
+        {.min_frame_period_us = 33'333,
+         .backlight = 0xc000,
+         .imu_rate_hz = 200},
+        {.min_frame_period_us = 50'000,
+         .backlight = 0x8000,
+         .imu_rate_hz = 100},
+        {.min_frame_period_us = 100'000,
+         .backlight = 0x4000,
+         .imu_rate_hz = 50},
+    }};
+  };
+
+  PowerGovernor() : PowerGovernor(Config{}) {}
+  explicit PowerGovernor(const Config& config) : config_(config) {}
+
+  /// Picks the level for `inputs`. Returns true if it changed.
+  bool Update(const PowerInputs& inputs);
+
+  PowerLevel level() const { return level_; }
+  const PowerProfile& profile() const {
+    return config_.profiles[static_cast<size_t>(level_)];
+  }
+
+ private:
+  PowerLevel LevelForPercent(uint32_t percent, uint32_t margin) const;
+
+  const Config config_;
+  PowerLevel level_ = PowerLevel::kPerformance;
+};
+
+}  // namespace kudzu
@@ -0,0 +1,93 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "libkudzu/timing_scope.h"
+#include "pw_geometry/vector3.h"
+#include "pw_touchscreen/touchscreen.h"
+
+namespace pw::touchscreen {
+
+// Smooths a finger's track and predicts where it's headed.
+//
+// Smoothing is a 1-euro filter: a low-pass whose cutoff rises with speed, so a
+// resting finger doesn't jitter and a moving one doesn't lag. Prediction
+// carries the smoothed point along the smoothed velocity, which makes up for
+// the time between reading a touch and the frame drawn from it reaching the
+// panel.
+//
+// Times come from each event's `timing_ticks` on the board's TimingClock.
+// The system clock's tick is as long as the gap between touch reports, so
+// velocities measured on it jump between zero and double.
+//
+// Takes events in time order from one touchscreen. Each event costs a few
+// dozen float operations, which is cheap even in software at touch rates.
+class TouchFilter {
+ public:
+  struct Config {
+    // Cutoff while the finger rests, in Hz. Lower removes more jitter.
+    float min_cutoff_hz = 1.0f;
+    // How much the cutoff rises per pixel per second of speed. Higher lags
+    // less behind a moving finger.
+    float speed_coefficient = 0.05f;
+    // Cutoff for the velocity estimate, in Hz.
+    float speed_cutoff_hz = 1.0f;
+    // Furthest ahead Predict() extrapolates, since the guess worsens the
+    // further it reaches.
+    std::chrono::microseconds max_prediction = std::chrono::milliseconds(50);
+  };
+
+  // `clock` must be the one the touchscreen stamps events with.
+  explicit TouchFilter(const kudzu::TimingClock& clock)
+      : TouchFilter(clock, Config()) {}
+  TouchFilter(const kudzu::TimingClock& clock, const Config& config)
+      : clock_(clock), config_(config) {}
+
+  // Returns `event` with its point smoothed. A start begins a new track, and
+  // a stop ends it; both pass through unchanged. An event no newer than the
+  // last, such as the same read seen on two frames, doesn't move the track.
+  TouchEvent Filter(const TouchEvent& event);
+
+  // Returns where the finger is expected to be at `timing_ticks`, such as
+  // when the frame being drawn will reach the panel, with z set to 1. Returns
+  // all zeros if nothing is touching.
+  pw::geometry::Vector3<int> Predict(uint32_t timing_ticks) const;
+
+  // Forgets the track.
+  void Reset() { touching_ = false; }
+
+ private:
+  struct Axis {
+    float position;
+    // Pixels per second.
+    float velocity;
+  };
+
+  // Seconds from the last event's ticks to `timing_ticks`, negative if
+  // `timing_ticks` is older.
+  float SecondsSince(uint32_t timing_ticks) const;
+
+  const kudzu::TimingClock& clock_;
+  Config config_;
+  bool touching_ = false;
+  Axis x_ = {0, 0};
+  Axis y_ = {0, 0};
+  uint32_t ticks_ = 0;
+};
+
+}  // namespace pw::touchscreen
@@ -13,7 +13,14 @@
 // the License.
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_geometry/vector2.h"
 #include "pw_geometry/vector3.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
 
 namespace pw::touchscreen {
@@ -28,6 +35,39 @@ enum TouchEventType {
 struct TouchEvent {
   TouchEventType type = TouchEventType::None;
   pw::geometry::Vector3<int> point = {0, 0, 0};
+  // When the controller reported the touch.
+  pw::chrono::SystemClock::time_point time = {};
+  // The board's TimingClock at the same moment, which is much finer than the
+  // system clock, or zero if the backend has none.
+  uint32_t timing_ticks = 0;
+};
+
+// Most fingers any backend tracks at once.
+inline constexpr size_t kMaxTouchContacts = 2;
+
+// One finger on the screen.
+struct TouchContact {
+  // Stays the same for as long as the finger is down, and is less than
+  // kMaxTouchContacts.
+  uint8_t id = 0;
+  pw::geometry::Vector2<int> point = {0, 0};
+  // Where the panel read it, before calibration. Backends without a
+  // calibration report the same as `point`.
+  pw::geometry::Vector2<int> raw = {0, 0};
+  // Pressure and contact size, or zero if the controller doesn't report them.
+  uint8_t weight = 0;
+  uint8_t area = 0;
+};
+
+// Every finger on the screen at one moment.
+struct TouchContacts {
+  std::array<TouchContact, kMaxTouchContacts> contacts = {};
+  size_t count = 0;
+  // When the controller reported them.
+  pw::chrono::SystemClock::time_point time = {};
+  // The board's TimingClock at the same moment, or zero if the backend has
+  // none.
+  uint32_t timing_ticks = 0;
 };
 
 class Touchscreen {
@@ -45,6 +85,16 @@ class Touchscreen {
 
   // Return x, y, and z coordinate of the current touch event.
   virtual TouchEvent GetTouchPoint() = 0;
+
+  // Return every finger on the screen now. Unlike GetTouchPoint(), this
+  // keeps no state, so it can be called alongside it.
+  virtual TouchContacts GetContacts() = 0;
+
+  // Block until the next Start, Drag or Stop event, or return
+  // DEADLINE_EXCEEDED once `timeout` has passed without one. Backends which
+  // can't wait for the controller poll GetTouchPoint() instead.
+  virtual Result<TouchEvent> WaitForTouchEvent(
+      pw::chrono::SystemClock::duration timeout);
 };
 
 }  // namespace pw::touchscreen
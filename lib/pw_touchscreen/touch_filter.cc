@@ -0,0 +1,96 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_touchscreen/touch_filter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace pw::touchscreen {
+namespace {
+
+constexpr float kTwoPi = 6.28318530717958f;
+
+// Weight of a new sample `dt` seconds after the last in a low-pass with the
+// given cutoff.
+float Alpha(float cutoff_hz, float dt) {
+  const float tau = 1 / (kTwoPi * cutoff_hz);
+  return dt / (dt + tau);
+}
+
+int Round(float value) { return static_cast<int>(std::lround(value)); }
+
+}  // namespace
+
+TouchEvent TouchFilter::Filter(const TouchEvent& event) {
+  if (event.point.z == 0) {
+    touching_ = false;
+    return event;
+  }
+  if (!touching_ || event.type == TouchEventType::Start) {
+    touching_ = true;
+    x_ = {static_cast<float>(event.point.x), 0};
+    y_ = {static_cast<float>(event.point.y), 0};
+    ticks_ = event.timing_ticks;
+    return event;
+  }
+
+  TouchEvent filtered = event;
+  filtered.point = {Round(x_.position), Round(y_.position), 1};
+  const float dt = SecondsSince(event.timing_ticks);
+  if (dt <= 0) {
+    return filtered;
+  }
+  ticks_ = event.timing_ticks;
+
+  // Velocity from the raw point, smoothed with a fixed cutoff.
+  const float speed_alpha = Alpha(config_.speed_cutoff_hz, dt);
+  x_.velocity += speed_alpha * ((event.point.x - x_.position) / dt -
+                                x_.velocity);
+  y_.velocity += speed_alpha * ((event.point.y - y_.position) / dt -
+                                y_.velocity);
+
+  // One cutoff for both axes, so a diagonal drag isn't bent toward one.
+  const float speed = std::hypot(x_.velocity, y_.velocity);
+  const float alpha = Alpha(
+      config_.min_cutoff_hz + config_.speed_coefficient * speed, dt);
+  x_.position += alpha * (event.point.x - x_.position);
+  y_.position += alpha * (event.point.y - y_.position);
+
+  filtered.point = {Round(x_.position), Round(y_.position), 1};
+  return filtered;
+}
+
+pw::geometry::Vector3<int> TouchFilter::Predict(uint32_t timing_ticks) const {
+  if (!touching_) {
+    return {0, 0, 0};
+  }
+  const float ahead = std::clamp(
+      SecondsSince(timing_ticks),
+      0.0f,
+      std::chrono::duration<float>(config_.max_prediction).count());
+  return {Round(x_.position + x_.velocity * ahead),
+          Round(y_.position + y_.velocity * ahead),
+          1};
+}
+
+float TouchFilter::SecondsSince(uint32_t timing_ticks) const {
+  // The signed difference survives the counter wrapping.
+  return static_cast<float>(static_cast<int32_t>(timing_ticks - ticks_)) /
+         static_cast<float>(clock_.ticks_per_second);
+}
+
+}  // namespace pw::touchscreen
@@ -0,0 +1,126 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_touchscreen/touch_filter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+namespace pw::touchscreen {
+namespace {
+
+// The filter only uses the clock's rate; times come from the events.
+uint32_t FakeNow() { return 0; }
+constexpr kudzu::TimingClock kClock = {FakeNow, 1'000'000};
+
+// Start close to wrapping to check that the filter survives it.
+constexpr uint32_t kStart = 0xffff'0000;
+constexpr uint32_t kReportPeriod = 10'000;
+
+TouchEvent Touch(TouchEventType type, int x, int y, uint32_t ticks) {
+  return {.type = type, .point = {x, y, 1}, .timing_ticks = ticks};
+}
+
+TEST(TouchFilterTest, StartPassesThrough) {
+  TouchFilter filter(kClock);
+  const TouchEvent start = Touch(TouchEventType::Start, 40, 50, kStart);
+  const TouchEvent filtered = filter.Filter(start);
+  EXPECT_EQ(filtered.point.x, 40);
+  EXPECT_EQ(filtered.point.y, 50);
+  EXPECT_EQ(filter.Predict(kStart + kReportPeriod).x, 40);
+}
+
+TEST(TouchFilterTest, RemovesJitterWhileResting) {
+  TouchFilter filter(kClock);
+  uint32_t time = kStart;
+  filter.Filter(Touch(TouchEventType::Start, 80, 60, time));
+  int worst = 0;
+  for (int i = 1; i < 100; i++) {
+    time += kReportPeriod;
+    // Two pixels either way, every read.
+    const int jitter = i % 2 == 0 ? 2 : -2;
+    const TouchEvent filtered =
+        filter.Filter(Touch(TouchEventType::Drag, 80 + jitter, 60, time));
+    worst = std::max(worst, std::abs(filtered.point.x - 80));
+  }
+  EXPECT_LE(worst, 1);
+}
+
+TEST(TouchFilterTest, PredictionCatchesUpWithSteadyDrag) {
+  TouchFilter filter(kClock);
+  uint32_t time = kStart;
+  filter.Filter(Touch(TouchEventType::Start, 0, 0, time));
+  // 500 pixels per second to the right.
+  int x = 0;
+  TouchEvent filtered;
+  for (int i = 1; i <= 30; i++) {
+    time += kReportPeriod;
+    x += 5;
+    filtered = filter.Filter(Touch(TouchEventType::Drag, x, 0, time));
+  }
+  // Smoothing alone trails the finger; prediction to the read's own time
+  // should land close to it, and a frame ahead should be ahead of it.
+  EXPECT_LT(filtered.point.x, x);
+  EXPECT_NEAR(filter.Predict(time).x, x, 3);
+  const int ahead = filter.Predict(time + 20'000).x;
+  EXPECT_NEAR(ahead, x + 10, 3);
+}
+
+TEST(TouchFilterTest, PredictionIsCapped) {
+  TouchFilter filter(kClock);
+  uint32_t time = kStart;
+  filter.Filter(Touch(TouchEventType::Start, 0, 0, time));
+  for (int i = 1; i <= 30; i++) {
+    time += kReportPeriod;
+    filter.Filter(Touch(TouchEventType::Drag, i * 5, 0, time));
+  }
+  const uint32_t max_prediction = static_cast<uint32_t>(
+      TouchFilter::Config().max_prediction.count());
+  EXPECT_EQ(filter.Predict(time + 10'000'000).x,
+            filter.Predict(time + max_prediction).x);
+}
+
+TEST(TouchFilterTest, RepeatedReadDoesNotMove) {
+  TouchFilter filter(kClock);
+  uint32_t time = kStart;
+  filter.Filter(Touch(TouchEventType::Start, 0, 0, time));
+  time += kReportPeriod;
+  const TouchEvent first =
+      filter.Filter(Touch(TouchEventType::Drag, 20, 0, time));
+  const TouchEvent again =
+      filter.Filter(Touch(TouchEventType::Drag, 20, 0, time));
+  EXPECT_EQ(first.point.x, again.point.x);
+}
+
+TEST(TouchFilterTest, StopEndsTrack) {
+  TouchFilter filter(kClock);
+  filter.Filter(Touch(TouchEventType::Start, 10, 10, kStart));
+  const TouchEvent stop = {.type = TouchEventType::Stop,
+                           .point = {10, 10, 0},
+                           .timing_ticks = kStart + kReportPeriod};
+  EXPECT_EQ(filter.Filter(stop).type, TouchEventType::Stop);
+  EXPECT_EQ(filter.Predict(stop.timing_ticks).z, 0);
+
+  // The next touch starts fresh rather than sliding from the last.
+  const TouchEvent filtered = filter.Filter(Touch(
+      TouchEventType::Start, 100, 100, stop.timing_ticks + kReportPeriod));
+  EXPECT_EQ(filtered.point.x, 100);
+}
+
+}  // namespace
+}  // namespace pw::touchscreen
@@ -0,0 +1,50 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_touchscreen/touchscreen.h"
+
+#include <chrono>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_thread/sleep.h"
+
+namespace pw::touchscreen {
+namespace {
+
+// Roughly the rate controllers report touches at.
+constexpr auto kPollPeriod =
+    pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(10));
+
+}  // namespace
+
+Result<TouchEvent> Touchscreen::WaitForTouchEvent(
+    pw::chrono::SystemClock::duration timeout) {
+  const auto deadline = pw::chrono::SystemClock::TimePointAfterAtLeast(timeout);
+  while (true) {
+    TouchEvent event = GetTouchPoint();
+    if (event.type != TouchEventType::None) {
+      // Keep the time the backend read the touch, if it set one.
+      if (event.time == pw::chrono::SystemClock::time_point()) {
+        event.time = pw::chrono::SystemClock::now();
+      }
+      return event;
+    }
+    if (pw::chrono::SystemClock::now() >= deadline) {
+      return Status::DeadlineExceeded();
+    }
+    pw::this_thread::sleep_for(kPollPeriod);
+  }
+}
+
+}  // namespace pw::touchscreen
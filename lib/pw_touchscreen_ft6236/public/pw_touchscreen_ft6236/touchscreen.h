@@ -13,25 +13,92 @@
 // the License.
 #pragma once
 
+#include <atomic>
+
+#include "ft6236/device.h"
+#include "libkudzu/timing_scope.h"
+#include "libkudzu/touch_calibration.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_containers/inline_queue.h"
 #include "pw_geometry/vector3.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/timed_thread_notification.h"
 #include "pw_touchscreen/touchscreen.h"
 
 namespace pw::touchscreen {
 
+// Touches from an FT6236.
+//
+// Until RunInterruptHandler() starts, each GetTouchPoint() reads the
+// controller over I2C. After that the controller's INT pin drives everything:
+// the handler reads the controller only when it has a new report, and
+// GetTouchPoint(), NewTouchEvent() and WaitForTouchEvent() work from what the
+// handler read without touching the bus. NewTouchEvent() is then true while
+// the handler has read something GetTouchPoint() hasn't returned yet.
+// WaitForTouchEvent() keeps its own queue, so the two can be mixed.
+// GetContacts() never reads the bus; before the handler starts it returns
+// what the last GetTouchPoint() read.
+//
+// The calibration maps the controller's coordinates to the screen's with
+// integer math. It defaults to the identity, so pass one for the panel's
+// mounting. Touches are also stamped with `timing_clock` if it isn't null.
 class TouchscreenFT6236 : public Touchscreen {
  public:
-  TouchscreenFT6236(pw::ft6236::Device* touch_screen_controller);
+  TouchscreenFT6236(pw::ft6236::Device* touch_screen_controller,
+                    const kudzu::TouchCalibration& calibration = {},
+                    const kudzu::TimingClock* timing_clock = nullptr);
 
   Status Init() override;
   bool Available() override;
   bool NewTouchEvent() override;
   TouchEvent GetTouchPoint() override;
+  TouchContacts GetContacts() override;
+  Result<TouchEvent> WaitForTouchEvent(
+      pw::chrono::SystemClock::duration timeout) override;
+
+  // Takes effect from the next read. Safe to call while the interrupt handler
+  // runs.
+  void SetCalibration(const kudzu::TouchCalibration& calibration);
+  kudzu::TouchCalibration calibration();
+
+  // Call from the interrupt for the INT pin's falling edge.
+  void HandleInterrupt();
+
+  // Switches the controller to pulsing INT once per report, retrying with a
+  // backoff until it answers, then reads it each time HandleInterrupt() runs,
+  // forever. Run this on its own thread once the INT pin's interrupt is
+  // enabled.
+  void RunInterruptHandler();
 
   TouchEvent last_touch_event;
 
  private:
+  static constexpr size_t kEventQueueCapacity = 16;
+
+  // Reads the controller and returns every touch in screen coordinates.
+  Result<TouchContacts> ReadContacts();
+  uint32_t ReadTimingClock() const;
+
   pw::ft6236::Device* touch_screen_controller_;
+  const kudzu::TimingClock* const timing_clock_;
+
+  std::atomic<bool> interrupt_driven_ = false;
+  pw::sync::TimedThreadNotification interrupt_;
+  pw::sync::TimedThreadNotification event_ready_;
+
+  pw::sync::Mutex lock_;
+  kudzu::TouchCalibration calibration_ PW_GUARDED_BY(lock_);
+  // The latest read, by the handler or GetTouchPoint().
+  TouchContacts contacts_ PW_GUARDED_BY(lock_);
+  // The handler has read the controller since GetTouchPoint() last ran.
+  bool contacts_updated_ PW_GUARDED_BY(lock_) = false;
+  // Changes waiting for WaitForTouchEvent(). Once full, the oldest are
+  // dropped.
+  pw::InlineQueue<TouchEvent, kEventQueueCapacity> events_
+      PW_GUARDED_BY(lock_);
 };
 
 }  // namespace pw::touchscreen
@@ -14,23 +14,81 @@
 
 #include "pw_touchscreen/touchscreen.h"
 
-#include <math.h>
-
+#include <algorithm>
+#include <chrono>
 #include <cinttypes>
+#include <mutex>
 
 #define PW_LOG_MODULE_NAME "pw_touchscreen_ft6236"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
 #include "ft6236/device.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_geometry/vector2.h"
 #include "pw_geometry/vector3.h"
 #include "pw_log/log.h"
+#include "pw_thread/sleep.h"
 #include "pw_touchscreen_ft6236/touchscreen.h"
 
 namespace pw::touchscreen {
+namespace {
+
+// Trigger mode should pulse INT when the finger lifts too, but re-read this
+// often while touched so a missed pulse can't leave a touch stuck down.
+constexpr auto kReleaseCheckPeriod =
+    pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(100));
+
+// Backoff between attempts to switch the controller to trigger mode.
+constexpr auto kFirstEnableRetryDelay =
+    pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(50));
+constexpr auto kMaxEnableRetryDelay =
+    pw::chrono::SystemClock::for_at_least(std::chrono::seconds(2));
+
+// Returns the first of `contacts` with z set to 1, or all zeros if nothing
+// is touching.
+pw::geometry::Vector3<int> PrimaryPoint(const TouchContacts& contacts) {
+  if (contacts.count == 0) {
+    return {0, 0, 0};
+  }
+  const pw::geometry::Vector2<int>& point = contacts.contacts[0].point;
+  return {point.x, point.y, 1};
+}
+
+// Returns `contacts` as an event following `previous`.
+TouchEvent NextEvent(const TouchEvent& previous,
+                     const TouchContacts& contacts) {
+  TouchEvent event = {
+      .type = TouchEventType::None,
+      .point = PrimaryPoint(contacts),
+  };
+
+  if (previous.point.z == 0 && event.point.z == 1) {
+    event.type = TouchEventType::Start;
+    PW_LOG_DEBUG("Touch Start: x:%d, y:%d, z:%d",
+                 event.point.x,
+                 event.point.y,
+                 event.point.z);
+  } else if (previous.point.z == 1 && event.point.z == 1) {
+    event.type = TouchEventType::Drag;
+  } else if (previous.point.z == 1 && event.point.z == 0) {
+    event.type = TouchEventType::Stop;
+    PW_LOG_DEBUG("Touch Stop : x:%d, y:%d, z:%d",
+                 event.point.x,
+                 event.point.y,
+                 event.point.z);
+  }
+  return event;
+}
+
+}  // namespace
 
 TouchscreenFT6236::TouchscreenFT6236(
-    pw::ft6236::Device* touch_screen_controller)
-    : touch_screen_controller_(touch_screen_controller) {}
+    pw::ft6236::Device* touch_screen_controller,
+    const kudzu::TouchCalibration& calibration,
+    const kudzu::TimingClock* timing_clock)
+    : touch_screen_controller_(touch_screen_controller),
+      timing_clock_(timing_clock),
+      calibration_(calibration) {}
 
 Status TouchscreenFT6236::Init() {
   touch_screen_controller_->Enable();
@@ -41,6 +99,10 @@ Status TouchscreenFT6236::Init() {
 bool TouchscreenFT6236::Available() { return true; }
 
 bool TouchscreenFT6236::NewTouchEvent() {
+  if (interrupt_driven_.load(std::memory_order_acquire)) {
+    std::lock_guard lock(lock_);
+    return contacts_updated_;
+  }
   if (touch_screen_controller_->TouchCount() > 0) {
     return true;
   }
@@ -48,55 +110,145 @@ bool TouchscreenFT6236::NewTouchEvent() {
 }
 
 TouchEvent TouchscreenFT6236::GetTouchPoint() {
-  TouchEvent event = {
-      .type = TouchEventType::None,
-      .point = {0, 0, 0},
-  };
+  TouchContacts contacts;
+  if (interrupt_driven_.load(std::memory_order_acquire)) {
+    std::lock_guard lock(lock_);
+    contacts = contacts_;
+    contacts_updated_ = false;
+  } else {
+    Result<TouchContacts> read_result = ReadContacts();
+    if (!read_result.ok()) {
+      return TouchEvent();
+    }
+    contacts = *read_result;
+    std::lock_guard lock(lock_);
+    contacts_ = contacts;
+  }
 
-  Result<bool> read_result = touch_screen_controller_->ReadData();
-  if (!read_result.ok()) {
-    return event;
+  last_touch_event = NextEvent(last_touch_event, contacts);
+  // The read's own time, so a frame which sees the same read again doesn't
+  // look like a finger holding still.
+  last_touch_event.time = contacts.time;
+  last_touch_event.timing_ticks = contacts.timing_ticks;
+  return last_touch_event;
+}
+
+TouchContacts TouchscreenFT6236::GetContacts() {
+  std::lock_guard lock(lock_);
+  return contacts_;
+}
+
+Result<TouchEvent> TouchscreenFT6236::WaitForTouchEvent(
+    pw::chrono::SystemClock::duration timeout) {
+  if (!interrupt_driven_.load(std::memory_order_acquire)) {
+    return Touchscreen::WaitForTouchEvent(timeout);
+  }
+  const auto deadline = pw::chrono::SystemClock::TimePointAfterAtLeast(timeout);
+  while (true) {
+    {
+      std::lock_guard lock(lock_);
+      if (!events_.empty()) {
+        TouchEvent event = events_.front();
+        events_.pop();
+        return event;
+      }
+    }
+    if (!event_ready_.try_acquire_until(deadline)) {
+      return Status::DeadlineExceeded();
+    }
   }
+}
 
-  if (touch_screen_controller_->TouchCount() > 0) {
-    pw::ft6236::Touch touch_point1 = touch_screen_controller_->Touch1();
-    event.point.x = touch_point1.x;
-    event.point.y = touch_point1.y;
-    event.point.z = 1;
+void TouchscreenFT6236::SetCalibration(
+    const kudzu::TouchCalibration& calibration) {
+  std::lock_guard lock(lock_);
+  calibration_ = calibration;
+}
+
+kudzu::TouchCalibration TouchscreenFT6236::calibration() {
+  std::lock_guard lock(lock_);
+  return calibration_;
+}
+
+void TouchscreenFT6236::HandleInterrupt() { interrupt_.release(); }
+
+void TouchscreenFT6236::RunInterruptHandler() {
+  // The controller may still be starting up. GetTouchPoint() polls it until
+  // this succeeds.
+  auto retry_delay = kFirstEnableRetryDelay;
+  while (!touch_screen_controller_->EnableTriggerMode().ok()) {
+    if (retry_delay == kFirstEnableRetryDelay) {
+      PW_LOG_WARN("Failed to enable touch interrupts; polling until it works");
+    }
+    pw::this_thread::sleep_for(retry_delay);
+    retry_delay = std::min(retry_delay * 2, kMaxEnableRetryDelay);
   }
+  interrupt_driven_.store(true, std::memory_order_release);
+
+  TouchEvent previous;
+  while (true) {
+    if (previous.point.z == 0) {
+      interrupt_.acquire();
+    } else {
+      interrupt_.try_acquire_for(kReleaseCheckPeriod);
+    }
+    const pw::chrono::SystemClock::time_point time =
+        pw::chrono::SystemClock::now();
+    const uint32_t timing_ticks = ReadTimingClock();
+
+    Result<TouchContacts> contacts = ReadContacts();
+    if (!contacts.ok()) {
+      continue;
+    }
+    contacts->time = time;
+    contacts->timing_ticks = timing_ticks;
+    TouchEvent event = NextEvent(previous, *contacts);
+    event.time = time;
+    event.timing_ticks = timing_ticks;
+    previous = event;
+
+    {
+      std::lock_guard lock(lock_);
+      contacts_ = *contacts;
+      contacts_updated_ = true;
+      if (event.type == TouchEventType::None) {
+        continue;
+      }
+      if (events_.full()) {
+        events_.pop();
+      }
+      events_.push(event);
+    }
+    event_ready_.release();
+  }
+}
 
-  if (last_touch_event.point.z == 0 && event.point.z == 1) {
-    event.type = TouchEventType::Start;
-    PW_LOG_DEBUG("Touch Start: x:%d, y:%d, z:%d",
-                 event.point.x,
-                 event.point.y,
-                 event.point.z);
-  } else if (last_touch_event.point.z == 1 && event.point.z == 1) {
-    event.type = TouchEventType::Drag;
-    PW_LOG_DEBUG("Touch Drag : x:%d, y:%d, z:%d",
-                 event.point.x,
-                 event.point.y,
-                 event.point.z);
-  } else if (last_touch_event.point.z == 1 && event.point.z == 0) {
-    event.type = TouchEventType::Stop;
-    PW_LOG_DEBUG("Touch Stop : x:%d, y:%d, z:%d",
-                 event.point.x,
-                 event.point.y,
-                 event.point.z);
+Result<TouchContacts> TouchscreenFT6236::ReadContacts() {
+  Result<bool> read_result = touch_screen_controller_->ReadData();
+  if (!read_result.ok()) {
+    return read_result.status();
   }
 
-  // TODO(tonymd): Touchscreen should accept parameters on how to transform
-  // mouse to screen coordinates.
-  if (event.type == TouchEventType::Start ||
-      event.type == TouchEventType::Drag) {
-    int new_x = round(((float)event.point.y / 320.0) * 160.0);
-    int new_y = round(((240.0 - (float)event.point.x) / 240.0) * 120.0);
-    event.point.x = new_x;
-    event.point.y = new_y;
+  const kudzu::TouchCalibration calibration = this->calibration();
+  TouchContacts contacts = {.time = pw::chrono::SystemClock::now(),
+                            .timing_ticks = ReadTimingClock()};
+  const int count = touch_screen_controller_->TouchCount();
+  for (int i = 0; i < count; i++) {
+    const pw::ft6236::Touch touch = i == 0
+                                        ? touch_screen_controller_->Touch1()
+                                        : touch_screen_controller_->Touch2();
+    TouchContact& contact = contacts.contacts[contacts.count++];
+    contact.id = touch.id % kMaxTouchContacts;
+    contact.raw = {touch.x, touch.y};
+    contact.point = calibration.Apply(contact.raw);
+    contact.weight = touch.weight;
+    contact.area = touch.area;
   }
+  return contacts;
+}
 
-  last_touch_event = event;
-  return event;
+uint32_t TouchscreenFT6236::ReadTimingClock() const {
+  return timing_clock_ == nullptr ? 0 : timing_clock_->now();
 }
 
 }  // namespace pw::touchscreen
@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include "libkudzu/timing_scope.h"
 #include "pw_display_driver_imgui/display_driver.h"
 #include "pw_geometry/vector3.h"
 #include "pw_status/status.h"
@@ -22,17 +23,24 @@ namespace pw::touchscreen {
 
 class TouchscreenImGui : public Touchscreen {
  public:
-  TouchscreenImGui(pw::display_driver::DisplayDriverImgUI& display_driver);
+  // Touches are also stamped with `timing_clock` if it isn't null.
+  TouchscreenImGui(pw::display_driver::DisplayDriverImgUI& display_driver,
+                   const kudzu::TimingClock* timing_clock = nullptr);
 
   Status Init() override;
   bool Available() override;
   bool NewTouchEvent() override;
   TouchEvent GetTouchPoint() override;
+  // The mouse is the only contact.
+  TouchContacts GetContacts() override;
 
   TouchEvent last_touch_event;
 
  private:
+  uint32_t ReadTimingClock() const;
+
   pw::display_driver::DisplayDriverImgUI& display_driver_;
+  const kudzu::TimingClock* const timing_clock_;
 };
 
 }  // namespace pw::touchscreen
@@ -19,6 +19,8 @@
 #define PW_LOG_MODULE_NAME "pw_touchscreen_imgui"
 #define PW_LOG_LEVEL PW_LOG_LEVEL_DEBUG
 
+#include "libkudzu/trace.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_display_driver_imgui/display_driver.h"
 #include "pw_geometry/vector3.h"
 #include "pw_log/log.h"
@@ -27,8 +29,9 @@
 namespace pw::touchscreen {
 
 TouchscreenImGui::TouchscreenImGui(
-    pw::display_driver::DisplayDriverImgUI& display_driver)
-    : display_driver_(display_driver) {}
+    pw::display_driver::DisplayDriverImgUI& display_driver,
+    const kudzu::TimingClock* timing_clock)
+    : display_driver_(display_driver), timing_clock_(timing_clock) {}
 
 Status TouchscreenImGui::Init() { return OkStatus(); }
 
@@ -40,9 +43,13 @@ bool TouchscreenImGui::NewTouchEvent() {
 }
 
 TouchEvent TouchscreenImGui::GetTouchPoint() {
+  // Traced as the I2C read it stands in for on the device.
+  kudzu::trace::Scope scope("bus", "i2c0 ft6236 touch");
   TouchEvent event = {
       .type = TouchEventType::None,
       .point = {0, 0, 0},
+      .time = pw::chrono::SystemClock::now(),
+      .timing_ticks = ReadTimingClock(),
   };
 
   auto mouse = display_driver_.GetImGuiMousePosition();
@@ -73,4 +80,20 @@ TouchEvent TouchscreenImGui::GetTouchPoint() {
   return event;
 }
 
+TouchContacts TouchscreenImGui::GetContacts() {
+  TouchContacts contacts = {.time = pw::chrono::SystemClock::now(),
+                            .timing_ticks = ReadTimingClock()};
+  auto mouse = display_driver_.GetImGuiMousePosition();
+  if (mouse.left_button_pressed) {
+    contacts.contacts[0].point = {mouse.position_x, mouse.position_y};
+    contacts.contacts[0].raw = contacts.contacts[0].point;
+    contacts.count = 1;
+  }
+  return contacts;
+}
+
+uint32_t TouchscreenImGui::ReadTimingClock() const {
+  return timing_clock_ == nullptr ? 0 : timing_clock_->now();
+}
+
 }  // namespace pw::touchscreen
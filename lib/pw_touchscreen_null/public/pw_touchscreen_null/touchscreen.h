@@ -29,6 +29,7 @@ class TouchscreenNull : public Touchscreen {
 
   bool NewTouchEvent() override;
   TouchEvent GetTouchPoint() override;
+  TouchContacts GetContacts() override;
 };
 
 }  // namespace pw::touchscreen
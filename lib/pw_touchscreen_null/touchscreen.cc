@@ -31,4 +31,6 @@ bool TouchscreenNull::NewTouchEvent() { return false; }
 
 TouchEvent TouchscreenNull::GetTouchPoint() { return TouchEvent(); }
 
+TouchContacts TouchscreenNull::GetContacts() { return TouchContacts(); }
+
 }  // namespace pw::touchscreen
@@ -0,0 +1,120 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace kudzu {
+
+/// Shadows a block of an I2C device's 8-bit registers, so drivers can read
+/// and modify their settings without going back to the bus.
+///
+/// `Set()` and `Update()` only change the cached value and mark it dirty, and
+/// setting a register to the value it already holds costs nothing. `Flush()`
+/// then writes each run of consecutive dirty registers in one auto-increment
+/// burst, lowest address first. Devices which only increment within groups
+/// of registers, such as the ports of an IO expander, set `burst_alignment`
+/// so that no burst crosses a multiple of it. `Load()` reads a range back in
+/// one transaction.
+///
+/// Only registers which the device never changes by itself should be left
+/// cached between calls. Reload status bits before modifying them, and call
+/// `Invalidate()` when the device resets.
+///
+/// An out of range address, or an `Update()` of a register whose value isn't
+/// known, is an error which the next `Flush()` returns. Not thread safe.
+class RegisterCache {
+ public:
+  static constexpr size_t kMaxRegisters = 64;
+  /// Most registers written in one burst.
+  static constexpr size_t kMaxBurst = 16;
+
+  struct Layout {
+    /// Address of the first register in the block.
+    uint8_t first_address;
+    /// Registers in the block, up to kMaxRegisters.
+    uint8_t size;
+    /// If nonzero, bursts never cross an address which is a multiple of it.
+    uint8_t burst_alignment = 0;
+  };
+
+  RegisterCache(pw::i2c::Initiator& initiator,
+                pw::i2c::Address address,
+                const Layout& layout,
+                pw::chrono::SystemClock::duration timeout =
+                    pw::chrono::SystemClock::for_at_least(
+                        std::chrono::milliseconds(10)));
+
+  /// Reads `count` registers starting at `address` in one transaction. Any
+  /// unflushed changes to them are dropped.
+  pw::Status Load(uint8_t address, size_t count);
+  /// Reads the whole block in one transaction.
+  pw::Status Load() { return Load(layout_.first_address, layout_.size); }
+
+  /// Returns a register's cached value, or FAILED_PRECONDITION if it hasn't
+  /// been loaded or set.
+  pw::Result<uint8_t> Get(uint8_t address) const;
+  /// Returns a big-endian 16-bit register at `address` and `address + 1`.
+  pw::Result<uint16_t> Get16(uint8_t address) const;
+
+  void Set(uint8_t address, uint8_t value);
+  /// Sets a big-endian 16-bit register. Both bytes are written if either
+  /// changes, for devices which only latch whole words.
+  void Set16(uint8_t address, uint16_t value);
+
+  /// Replaces the bits in `mask` with those of `value`.
+  void Update(uint8_t address, uint8_t mask, uint8_t value);
+  void Update16(uint8_t address, uint16_t mask, uint16_t value);
+
+  /// Writes the dirty registers. Registers which weren't written stay dirty,
+  /// so a failed flush can be retried.
+  pw::Status Flush();
+
+  /// Forgets every cached value and pending change.
+  void Invalidate();
+
+  bool dirty() const { return dirty_ != 0; }
+
+ private:
+  // Returns the register's index in the block, or nothing after recording an
+  // error if it's outside of it.
+  std::optional<size_t> Index(uint8_t address, size_t count = 1);
+  bool Valid(uint8_t address, size_t count) const;
+  static constexpr uint64_t Bits(size_t index, size_t count) {
+    return (count >= 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1) << index;
+  }
+
+  pw::i2c::Initiator& initiator_;
+  const pw::i2c::Address address_;
+  const Layout layout_;
+  const pw::chrono::SystemClock::duration timeout_;
+  std::array<uint8_t, kMaxRegisters> shadow_ = {};
+  // Bit i stands for the register at first_address + i.
+  uint64_t valid_ = 0;
+  uint64_t dirty_ = 0;
+  pw::Status error_;
+};
+
+}  // namespace kudzu
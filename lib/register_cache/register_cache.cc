@@ -0,0 +1,192 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/register_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "pw_bytes/span.h"
+#include "pw_span/span.h"
+#include "pw_status/try.h"
+
+namespace kudzu {
+
+RegisterCache::RegisterCache(pw::i2c::Initiator& initiator,
+                             pw::i2c::Address address,
+                             const Layout& layout,
+                             pw::chrono::SystemClock::duration timeout)
+    : initiator_(initiator),
+      address_(address),
+      layout_{
+          .first_address = layout.first_address,
+          .size = static_cast<uint8_t>(
+              std::min<size_t>(layout.size, kMaxRegisters)),
+          .burst_alignment = layout.burst_alignment,
+      },
+      timeout_(timeout) {
+  if (layout.size > kMaxRegisters) {
+    error_ = pw::Status::InvalidArgument();
+  }
+}
+
+std::optional<size_t> RegisterCache::Index(uint8_t address, size_t count) {
+  if (address < layout_.first_address ||
+      address - layout_.first_address + count > layout_.size) {
+    error_.Update(pw::Status::InvalidArgument());
+    return std::nullopt;
+  }
+  return address - layout_.first_address;
+}
+
+bool RegisterCache::Valid(uint8_t address, size_t count) const {
+  if (address < layout_.first_address ||
+      address - layout_.first_address + count > layout_.size) {
+    return false;
+  }
+  const uint64_t bits = Bits(address - layout_.first_address, count);
+  return (valid_ & bits) == bits;
+}
+
+pw::Status RegisterCache::Load(uint8_t address, size_t count) {
+  const std::optional<size_t> index = Index(address, count);
+  if (!index.has_value()) {
+    return pw::Status::InvalidArgument();
+  }
+  const std::array<std::byte, 1> tx = {std::byte{address}};
+  PW_TRY(initiator_.WriteReadFor(
+      address_,
+      tx,
+      pw::as_writable_bytes(pw::span(shadow_).subspan(*index, count)),
+      timeout_));
+  valid_ |= Bits(*index, count);
+  dirty_ &= ~Bits(*index, count);
+  return pw::OkStatus();
+}
+
+pw::Result<uint8_t> RegisterCache::Get(uint8_t address) const {
+  if (!Valid(address, 1)) {
+    return pw::Status::FailedPrecondition();
+  }
+  return shadow_[address - layout_.first_address];
+}
+
+pw::Result<uint16_t> RegisterCache::Get16(uint8_t address) const {
+  if (!Valid(address, 2)) {
+    return pw::Status::FailedPrecondition();
+  }
+  const size_t index = address - layout_.first_address;
+  return static_cast<uint16_t>(shadow_[index] << 8 | shadow_[index + 1]);
+}
+
+void RegisterCache::Set(uint8_t address, uint8_t value) {
+  const std::optional<size_t> index = Index(address);
+  if (!index.has_value()) {
+    return;
+  }
+  const uint64_t bit = Bits(*index, 1);
+  if ((valid_ & bit) != 0 && shadow_[*index] == value) {
+    return;
+  }
+  shadow_[*index] = value;
+  valid_ |= bit;
+  dirty_ |= bit;
+}
+
+void RegisterCache::Set16(uint8_t address, uint16_t value) {
+  const std::optional<size_t> index = Index(address, 2);
+  if (!index.has_value()) {
+    return;
+  }
+  const uint8_t high = value >> 8;
+  const uint8_t low = value & 0xff;
+  const uint64_t bits = Bits(*index, 2);
+  if ((valid_ & bits) == bits && shadow_[*index] == high &&
+      shadow_[*index + 1] == low) {
+    return;
+  }
+  shadow_[*index] = high;
+  shadow_[*index + 1] = low;
+  valid_ |= bits;
+  dirty_ |= bits;
+}
+
+void RegisterCache::Update(uint8_t address, uint8_t mask, uint8_t value) {
+  if (!Index(address).has_value()) {
+    return;
+  }
+  const pw::Result<uint8_t> current = Get(address);
+  if (!current.ok()) {
+    error_.Update(current.status());
+    return;
+  }
+  Set(address, (*current & ~mask) | (value & mask));
+}
+
+void RegisterCache::Update16(uint8_t address, uint16_t mask, uint16_t value) {
+  if (!Index(address, 2).has_value()) {
+    return;
+  }
+  const pw::Result<uint16_t> current = Get16(address);
+  if (!current.ok()) {
+    error_.Update(current.status());
+    return;
+  }
+  Set16(address, (*current & ~mask) | (value & mask));
+}
+
+pw::Status RegisterCache::Flush() {
+  if (!error_.ok()) {
+    const pw::Status error = error_;
+    error_ = pw::OkStatus();
+    return error;
+  }
+
+  std::array<std::byte, 1 + kMaxBurst> tx;
+  size_t index = 0;
+  while (index < layout_.size) {
+    if ((dirty_ & Bits(index, 1)) == 0) {
+      index++;
+      continue;
+    }
+    size_t end = index + 1;
+    while (end < layout_.size && (dirty_ & Bits(end, 1)) != 0 &&
+           end - index < kMaxBurst &&
+           (layout_.burst_alignment == 0 ||
+            (layout_.first_address + end) % layout_.burst_alignment != 0)) {
+      end++;
+    }
+
+    const size_t count = end - index;
+    tx[0] = std::byte{static_cast<uint8_t>(layout_.first_address + index)};
+    std::copy_n(reinterpret_cast<const std::byte*>(&shadow_[index]),
+                count,
+                &tx[1]);
+    PW_TRY(initiator_.WriteFor(
+        address_, pw::span(tx).first(1 + count), timeout_));
+    dirty_ &= ~Bits(index, count);
+    index = end;
+  }
+  return pw::OkStatus();
+}
+
+void RegisterCache::Invalidate() {
+  valid_ = 0;
+  dirty_ = 0;
+}
+
+}  // namespace kudzu
@@ -0,0 +1,207 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/register_cache.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_i2c/address.h"
+#include "pw_i2c/initiator.h"
+#include "pw_status/status.h"
+
+namespace kudzu {
+namespace {
+
+constexpr pw::i2c::Address kAddress = pw::i2c::Address::SevenBit<0x20>();
+
+// A device with 256 auto-incrementing registers, which records each write.
+class FakeDevice : public pw::i2c::Initiator {
+ public:
+  std::array<uint8_t, 256> registers = {};
+  // Each write transaction's bytes, register address first.
+  std::vector<std::vector<uint8_t>> writes;
+  int reads = 0;
+  pw::Status status = pw::OkStatus();
+
+ private:
+  pw::Status DoWriteReadFor(pw::i2c::Address,
+                            pw::ConstByteSpan tx,
+                            pw::ByteSpan rx,
+                            pw::chrono::SystemClock::duration) override {
+    if (!status.ok()) {
+      return status;
+    }
+    const uint8_t first = static_cast<uint8_t>(tx[0]);
+    if (rx.empty()) {
+      std::vector<uint8_t>& write = writes.emplace_back();
+      for (size_t i = 0; i < tx.size(); i++) {
+        write.push_back(static_cast<uint8_t>(tx[i]));
+        if (i > 0) {
+          registers[first + i - 1] = static_cast<uint8_t>(tx[i]);
+        }
+      }
+    } else {
+      reads++;
+      for (size_t i = 0; i < rx.size(); i++) {
+        rx[i] = std::byte{registers[first + i]};
+      }
+    }
+    return pw::OkStatus();
+  }
+};
+
+using Writes = std::vector<std::vector<uint8_t>>;
+
+TEST(RegisterCacheTest, FlushBurstsConsecutiveDirtyRegisters) {
+  FakeDevice device;
+  RegisterCache cache(device, kAddress, {.first_address = 0x20, .size = 16});
+
+  cache.Set(0x21, 0xaa);
+  cache.Set(0x22, 0xbb);
+  cache.Set(0x23, 0xcc);
+  cache.Set(0x28, 0xdd);
+  EXPECT_TRUE(cache.dirty());
+  EXPECT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_FALSE(cache.dirty());
+
+  EXPECT_EQ(device.writes, (Writes{{0x21, 0xaa, 0xbb, 0xcc}, {0x28, 0xdd}}));
+  EXPECT_EQ(device.registers[0x22], 0xbb);
+}
+
+TEST(RegisterCacheTest, UnchangedValuesAreNotWritten) {
+  FakeDevice device;
+  RegisterCache cache(device, kAddress, {.first_address = 0x20, .size = 16});
+
+  cache.Set(0x21, 0x01);
+  cache.Set16(0x24, 0x1234);
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  device.writes.clear();
+
+  cache.Set(0x21, 0x01);
+  cache.Set16(0x24, 0x1234);
+  EXPECT_FALSE(cache.dirty());
+  EXPECT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_TRUE(device.writes.empty());
+
+  // Changing either byte of a word rewrites the whole word.
+  cache.Set16(0x24, 0x1235);
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_EQ(device.writes, (Writes{{0x24, 0x12, 0x35}}));
+}
+
+TEST(RegisterCacheTest, BurstsDontCrossAlignment) {
+  FakeDevice device;
+  RegisterCache cache(
+      device,
+      kAddress,
+      {.first_address = 0x02, .size = 6, .burst_alignment = 2});
+
+  for (uint8_t address = 0x03; address < 0x08; address++) {
+    cache.Set(address, address);
+  }
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_EQ(device.writes,
+            (Writes{{0x03, 0x03}, {0x04, 0x04, 0x05}, {0x06, 0x06, 0x07}}));
+}
+
+TEST(RegisterCacheTest, LongRunsAreSplitAtMaxBurst) {
+  FakeDevice device;
+  RegisterCache cache(device, kAddress, {.first_address = 0, .size = 40});
+
+  for (uint8_t address = 0; address < 20; address++) {
+    cache.Set(address, 0xff);
+  }
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  ASSERT_EQ(device.writes.size(), 2u);
+  EXPECT_EQ(device.writes[0].size(), 1 + RegisterCache::kMaxBurst);
+  EXPECT_EQ(device.writes[1][0], RegisterCache::kMaxBurst);
+}
+
+TEST(RegisterCacheTest, LoadReadsBackInOneTransaction) {
+  FakeDevice device;
+  for (size_t i = 0; i < 8; i++) {
+    device.registers[0x40 + i] = static_cast<uint8_t>(i * 3);
+  }
+  RegisterCache cache(device, kAddress, {.first_address = 0x40, .size = 8});
+
+  EXPECT_EQ(cache.Get(0x42).status(), pw::Status::FailedPrecondition());
+  ASSERT_EQ(cache.Load(), pw::OkStatus());
+  EXPECT_EQ(device.reads, 1);
+  EXPECT_EQ(cache.Get(0x42).value(), 6);
+  EXPECT_EQ(cache.Get16(0x44).value(), 0x0c0f);
+  EXPECT_FALSE(cache.dirty());
+}
+
+TEST(RegisterCacheTest, UpdateModifiesCachedBits) {
+  FakeDevice device;
+  device.registers[0x11] = 0b1010'0101;
+  RegisterCache cache(device, kAddress, {.first_address = 0x10, .size = 4});
+
+  ASSERT_EQ(cache.Load(0x11, 1), pw::OkStatus());
+  cache.Update(0x11, 0x0f, 0x03);
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_EQ(device.registers[0x11], 0b1010'0011);
+  EXPECT_EQ(device.reads, 1);
+}
+
+TEST(RegisterCacheTest, ErrorsAreReportedByFlush) {
+  FakeDevice device;
+  RegisterCache cache(device, kAddress, {.first_address = 0x10, .size = 4});
+
+  // Not loaded yet.
+  cache.Update(0x11, 0x0f, 0x03);
+  EXPECT_EQ(cache.Flush(), pw::Status::FailedPrecondition());
+
+  cache.Set(0x20, 0x00);
+  EXPECT_EQ(cache.Flush(), pw::Status::InvalidArgument());
+  EXPECT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_TRUE(device.writes.empty());
+}
+
+TEST(RegisterCacheTest, FailedFlushCanBeRetried) {
+  FakeDevice device;
+  RegisterCache cache(device, kAddress, {.first_address = 0x10, .size = 4});
+
+  cache.Set(0x10, 0x55);
+  device.status = pw::Status::Unavailable();
+  EXPECT_EQ(cache.Flush(), pw::Status::Unavailable());
+  EXPECT_TRUE(cache.dirty());
+
+  device.status = pw::OkStatus();
+  EXPECT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_EQ(device.registers[0x10], 0x55);
+}
+
+TEST(RegisterCacheTest, InvalidateForgetsValues) {
+  FakeDevice device;
+  RegisterCache cache(device, kAddress, {.first_address = 0x10, .size = 4});
+
+  cache.Set(0x10, 0x55);
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  cache.Invalidate();
+  EXPECT_EQ(cache.Get(0x10).status(), pw::Status::FailedPrecondition());
+
+  // The same value is written again, since the device may have reset.
+  cache.Set(0x10, 0x55);
+  ASSERT_EQ(cache.Flush(), pw::OkStatus());
+  EXPECT_EQ(device.writes.size(), 2u);
+}
+
+}  // namespace
+}  // namespace kudzu
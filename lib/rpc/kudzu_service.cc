@@ -0,0 +1,258 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "kudzu/kudzu_service_pwpb.h"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#define PW_LOG_MODULE_NAME "KudzuService"
+
+#include "libkudzu/device_health.h"
+#include "libkudzu/overrun_log.h"
+#include "libkudzu/profiling_initiator.h"
+#include "libkudzu/task_cpu.h"
+#include "libkudzu/telemetry.h"
+#include "pico/stdlib.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_system/work_queue.h"
+
+namespace kudzu::rpc {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto kDefaultTelemetryInterval = 1000ms;
+constexpr auto kMinTelemetryInterval = 100ms;
+
+void CopyTaskUsage(const TaskCpuUsage& usage,
+                   pwpb::TaskTelemetry::Message& task) {
+  task.name = usage.name.data();
+  task.cpu_permille = usage.cpu_permille;
+  task.stack_high_water_bytes = usage.stack_high_water_bytes;
+  task.run_time_us = usage.run_time;
+}
+
+void CopyOverrun(const FrameOverrun& overrun,
+                 uint32_t boot_count,
+                 pwpb::FrameOverrun::Message& message) {
+  message.sequence = overrun.sequence;
+  message.boots_ago = boot_count - overrun.boot;
+  message.uptime_ms = overrun.uptime_ms;
+  message.budget_us = overrun.budget_us;
+  message.acquire_us = overrun.acquire_us;
+  message.draw_us = overrun.draw_us;
+  message.flush_us = overrun.flush_us;
+  message.frame_us = overrun.frame_us;
+  message.i2c_transactions.assign(overrun.i2c_transactions.begin(),
+                                  overrun.i2c_transactions.end());
+  message.tasks.clear();
+  for (size_t i = 0; i < overrun.task_count; i++) {
+    const OverrunTask& task = overrun.tasks[i];
+    pwpb::OverrunTask::Message& task_message = message.tasks.emplace_back();
+    task_message.name = task.name.data();
+    task_message.state = task.state;
+    task_message.priority = task.priority;
+    task_message.stack_high_water_bytes = task.stack_high_water_bytes;
+  }
+}
+
+void CopyI2cDeviceStats(const I2cDeviceStats& stats,
+                        pwpb::I2cDeviceStats::Message& message) {
+  message.address = stats.address;
+  message.transactions = stats.transactions;
+  message.bytes_written = stats.bytes_written;
+  message.bytes_read = stats.bytes_read;
+  message.nacks = stats.nacks;
+  message.timeouts = stats.timeouts;
+  message.errors = stats.errors;
+  message.busy_us = stats.busy_us;
+  message.latency_p50_us = stats.latency_us.Percentile(50);
+  message.latency_p95_us = stats.latency_us.Percentile(95);
+  message.latency_p99_us = stats.latency_us.Percentile(99);
+  message.latency_max_us = stats.latency_us.max();
+}
+
+}  // namespace
+
+KudzuService::KudzuService()
+    : telemetry_timer_([this](pw::chrono::SystemClock::time_point) {
+        // Sampling reads the I2C bus and writes to the RPC channel, neither of
+        // which belongs in the timer's callback.
+        if (!pw::system::GetWorkQueue()
+                 .PushWork([this]() { SampleTelemetry(); })
+                 .ok()) {
+          PW_LOG_WARN("Work queue full; telemetry stopped");
+        }
+      }),
+      telemetry_interval_(
+          pw::chrono::SystemClock::for_at_least(kDefaultTelemetryInterval)) {}
+
+void KudzuService::StreamTelemetry(
+    const pwpb::TelemetryRequest::Message& request,
+    ServerWriter<pwpb::TelemetryBatch::Message>& writer) {
+  std::lock_guard lock(telemetry_lock_);
+  if (telemetry_writer_.active()) {
+    telemetry_writer_.Finish().IgnoreError();
+  }
+  telemetry_writer_ = std::move(writer);
+
+  auto interval = kDefaultTelemetryInterval;
+  if (request.interval_ms != 0) {
+    interval = std::max(std::chrono::milliseconds(request.interval_ms),
+                        std::chrono::milliseconds(kMinTelemetryInterval));
+  }
+  telemetry_interval_ = pw::chrono::SystemClock::for_at_least(interval);
+  samples_per_batch_ = std::clamp<size_t>(
+      request.samples_per_batch, 1, batch_.samples.max_size());
+  batch_.samples.clear();
+
+  telemetry_timer_.InvokeAfter(telemetry_interval_);
+}
+
+void KudzuService::SampleTelemetry() {
+  std::lock_guard lock(telemetry_lock_);
+  if (!telemetry_writer_.active()) {
+    // The client cancelled the stream; stop sampling until the next one.
+    return;
+  }
+
+  pwpb::TelemetrySample::Message& sample = batch_.samples.emplace_back();
+  sample.uptime_ms = to_ms_since_boot(get_absolute_time());
+
+  if (std::optional<FrameTelemetry> frame = GetTelemetryStore().frame()) {
+    sample.frames_per_second = frame->frames_per_second;
+    sample.frame_p50_us = frame->p50_us;
+    sample.frame_p95_us = frame->p95_us;
+    sample.frame_p99_us = frame->p99_us;
+    sample.frame_max_us = frame->max_us;
+  }
+
+  CollectTasks(sample);
+
+  const struct mallinfo heap = mallinfo();
+  sample.heap_used_bytes = heap.uordblks;
+  sample.heap_high_water_bytes = heap.arena;
+
+  if (std::optional<BatteryTelemetry> battery =
+          GetTelemetryStore().ReadBattery()) {
+    sample.battery_millivolts = battery->millivolts;
+    sample.battery_percent = battery->percent;
+  }
+
+  sample.package_temp = ReadPackageTemp();
+
+  if (batch_.samples.size() >= samples_per_batch_) {
+    const pw::Status status = telemetry_writer_.Write(batch_);
+    batch_.samples.clear();
+    if (!status.ok()) {
+      PW_LOG_WARN("Failed to send telemetry: %s", status.str());
+    }
+  }
+
+  telemetry_timer_.InvokeAfter(telemetry_interval_);
+}
+
+void KudzuService::CollectTasks(pwpb::TelemetrySample::Message& sample) {
+  const size_t num_tasks = telemetry_cpu_.Sample(telemetry_usage_);
+  for (size_t i = 0; i < num_tasks && !sample.tasks.full(); i++) {
+    CopyTaskUsage(telemetry_usage_[i], sample.tasks.emplace_back());
+  }
+}
+
+pw::Status KudzuService::CpuUsage(
+    const pwpb::CpuUsageRequest::Message& /*request*/,
+    pwpb::CpuUsageResponse::Message& response) {
+  const size_t num_tasks = rpc_cpu_.Sample(rpc_usage_);
+  // Run-time stats count microseconds.
+  response.interval_us = rpc_cpu_.interval();
+  for (size_t i = 0; i < num_tasks && !response.tasks.full(); i++) {
+    CopyTaskUsage(rpc_usage_[i], response.tasks.emplace_back());
+  }
+  return pw::OkStatus();
+}
+
+void KudzuService::FrameOverruns(
+    const pwpb::FrameOverrunsRequest::Message& request,
+    ServerWriter<pwpb::FrameOverrun::Message>& writer) {
+  OverrunLog& log = GetOverrunLog();
+  const size_t count = log.Read(overruns_);
+  const uint32_t boot_count = log.boot_count();
+  for (size_t i = 0; i < count; i++) {
+    CopyOverrun(overruns_[i], boot_count, overrun_message_);
+    const pw::Status status = writer.Write(overrun_message_);
+    if (!status.ok()) {
+      // Keep the log so the client can try again.
+      PW_LOG_WARN("Failed to send frame overruns: %s", status.str());
+      writer.Finish(status).IgnoreError();
+      return;
+    }
+  }
+  if (request.clear) {
+    log.Clear();
+  }
+  writer.Finish().IgnoreError();
+}
+
+pw::Status KudzuService::I2cStats(const pwpb::I2cStatsRequest::Message& request,
+                                  pwpb::I2cStatsResponse::Message& response) {
+  for (size_t bus = 0; bus < kMaxI2cProfilers; bus++) {
+    ProfilingInitiator* profiler = GetI2cProfiler(bus);
+    if (profiler == nullptr || response.buses.full()) {
+      continue;
+    }
+    pwpb::I2cBusStats::Message& bus_stats = response.buses.emplace_back();
+    bus_stats.name = profiler->name();
+    bus_stats.window_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              profiler->window())
+                              .count();
+    bus_stats.untracked_transactions = profiler->untracked_transactions();
+    const size_t count = profiler->ReadStats(i2c_devices_);
+    for (size_t i = 0; i < count && !bus_stats.devices.full(); i++) {
+      CopyI2cDeviceStats(i2c_devices_[i], bus_stats.devices.emplace_back());
+    }
+    if (request.reset) {
+      profiler->ResetStats();
+    }
+  }
+  return pw::OkStatus();
+}
+
+pw::Status KudzuService::DeviceHealth(
+    const pwpb::DeviceHealthRequest::Message& /*request*/,
+    pwpb::DeviceHealthResponse::Message& response) {
+  const auto now = pw::chrono::SystemClock::now();
+  const size_t count = GetDeviceHealthMonitor().Read(devices_);
+  for (size_t i = 0; i < count && !response.devices.full(); i++) {
+    const kudzu::DeviceHealth& health = devices_[i];
+    pwpb::DeviceStatus::Message& device = response.devices.emplace_back();
+    device.name = health.name;
+    device.state = static_cast<pwpb::DeviceHealthState::Enum>(health.state);
+    if (health.last_seen.has_value()) {
+      device.ms_since_seen =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              now - *health.last_seen)
+              .count();
+    }
+    device.consecutive_failures = health.consecutive_failures;
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace kudzu::rpc
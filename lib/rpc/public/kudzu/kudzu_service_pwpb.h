@@ -13,16 +13,30 @@
 // the License.
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 #include "hardware/adc.h"
 #include "kudzu/kudzu.pwpb.h"
 #include "kudzu/kudzu.rpc.pwpb.h"
+#include "libkudzu/device_health.h"
+#include "libkudzu/overrun_log.h"
+#include "libkudzu/profiling_initiator.h"
+#include "libkudzu/task_cpu.h"
+#include "libkudzu/task_cpu_freertos.h"
 #include "pico/bootrom.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono/system_timer.h"
 #include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
 
 namespace kudzu::rpc {
 
 class KudzuService final : public pw_rpc::pwpb::Kudzu::Service<KudzuService> {
  public:
+  KudzuService();
+
   pw::Status Reboot(const pwpb::RebootRequest::Message& request,
                     pwpb::RebootResponse::Message& /*response*/) {
     uint32_t disable_interface_mask = 0;
@@ -45,17 +59,63 @@ class KudzuService final : public pw_rpc::pwpb::Kudzu::Service<KudzuService> {
 
   pw::Status PackageTemp(const pwpb::PackageTempRequest::Message& /*request*/,
                          pwpb::PackageTempResponse::Message& response) {
+    response.temp = ReadPackageTemp();
+    return pw::OkStatus();
+  }
+
+  void StreamTelemetry(const pwpb::TelemetryRequest::Message& request,
+                       ServerWriter<pwpb::TelemetryBatch::Message>& writer);
+
+  pw::Status CpuUsage(const pwpb::CpuUsageRequest::Message& /*request*/,
+                      pwpb::CpuUsageResponse::Message& response);
+
+  void FrameOverruns(const pwpb::FrameOverrunsRequest::Message& request,
+                     ServerWriter<pwpb::FrameOverrun::Message>& writer);
+
+  pw::Status I2cStats(const pwpb::I2cStatsRequest::Message& request,
+                      pwpb::I2cStatsResponse::Message& response);
+
+  pw::Status DeviceHealth(const pwpb::DeviceHealthRequest::Message& request,
+                          pwpb::DeviceHealthResponse::Message& response);
+
+ private:
+  static float ReadPackageTemp() {
     adc_set_temp_sensor_enabled(true);
     adc_select_input(4);  // 4 is the on board temp sensor.
 
     // See raspberry-pi-pico-c-sdk.pdf, Section '4.1.1. hardware_adc'
     const float conversion_factor = 3.3f / (1 << 12);
     float adc = static_cast<float>(adc_read()) * conversion_factor;
-    float temp_c = 27.0f - (adc - 0.706f) / 0.001721f;
-    response.temp = temp_c;
-
-    return pw::OkStatus();
+    return 27.0f - (adc - 0.706f) / 0.001721f;
   }
+
+  // Runs on the pw_system work queue, which the timer hands each sample to.
+  void SampleTelemetry();
+  void CollectTasks(pwpb::TelemetrySample::Message& sample)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(telemetry_lock_);
+
+  pw::chrono::SystemTimer telemetry_timer_;
+  pw::sync::Mutex telemetry_lock_;
+  ServerWriter<pwpb::TelemetryBatch::Message> telemetry_writer_
+      PW_GUARDED_BY(telemetry_lock_);
+  pw::chrono::SystemClock::duration telemetry_interval_
+      PW_GUARDED_BY(telemetry_lock_);
+  size_t samples_per_batch_ PW_GUARDED_BY(telemetry_lock_) = 1;
+  // The batch and task stats are kept here rather than on the work queue's
+  // stack, as they are large.
+  pwpb::TelemetryBatch::Message batch_ PW_GUARDED_BY(telemetry_lock_);
+  FreeRtosTaskCpuSampler telemetry_cpu_ PW_GUARDED_BY(telemetry_lock_);
+  std::array<TaskCpuUsage, TaskCpuTracker::kMaxTasks> telemetry_usage_
+      PW_GUARDED_BY(telemetry_lock_);
+
+  // CpuUsage(), FrameOverruns(), I2cStats() and DeviceHealth() are only
+  // called from the RPC thread, so need no lock.
+  FreeRtosTaskCpuSampler rpc_cpu_;
+  std::array<TaskCpuUsage, TaskCpuTracker::kMaxTasks> rpc_usage_;
+  std::array<FrameOverrun, OverrunLog::kCapacity> overruns_;
+  pwpb::FrameOverrun::Message overrun_message_;
+  std::array<I2cDeviceStats, ProfilingInitiator::kMaxDevices> i2c_devices_;
+  std::array<kudzu::DeviceHealth, DeviceHealthMonitor::kMaxDevices> devices_;
 };
 
 }  // namespace kudzu::rpc
@@ -0,0 +1,80 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_span/span.h"
+
+namespace kudzu {
+
+/// One task's run-time counter at the moment of a snapshot.
+struct TaskCounters {
+  // Unique for the life of the task, unlike its name.
+  uint32_t task_number;
+  const char* name;
+  uint32_t run_time;
+  uint32_t stack_high_water_bytes;
+};
+
+/// How much CPU a task used between two snapshots.
+struct TaskCpuUsage {
+  static constexpr size_t kMaxNameLength = 15;
+
+  uint32_t task_number;
+  std::array<char, kMaxNameLength + 1> name;
+  // Run-time counter ticks spent in the task.
+  uint32_t run_time;
+  // Share of the whole interval, in tenths of a percent.
+  uint32_t cpu_permille;
+  uint32_t stack_high_water_bytes;
+};
+
+/// Turns cumulative per-task run-time counters into each task's share of the
+/// CPU since the previous snapshot. Counters may wrap between snapshots.
+///
+/// Each tracker keeps its own previous snapshot, so separate consumers which
+/// sample at different rates should each have their own.
+class TaskCpuTracker {
+ public:
+  static constexpr size_t kMaxTasks = 12;
+
+  /// Record a snapshot of `tasks`, whose counters were read at
+  /// `total_run_time`, and write each task's usage since the previous
+  /// snapshot to `usage`. Tasks which are new since then are charged for
+  /// their whole run time. Returns the number of entries written, which is at
+  /// most `usage.size()`.
+  size_t Update(pw::span<const TaskCounters> tasks,
+                uint32_t total_run_time,
+                pw::span<TaskCpuUsage> usage);
+
+  /// Counter ticks between the last two snapshots.
+  uint32_t interval() const { return interval_; }
+
+ private:
+  struct Previous {
+    uint32_t task_number;
+    uint32_t run_time;
+  };
+
+  std::array<Previous, kMaxTasks> previous_ = {};
+  size_t num_previous_ = 0;
+  uint32_t previous_total_ = 0;
+  uint32_t interval_ = 0;
+};
+
+}  // namespace kudzu
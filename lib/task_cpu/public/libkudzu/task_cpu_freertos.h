@@ -0,0 +1,54 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "FreeRTOS.h"
+#include "libkudzu/task_cpu.h"
+#include "pw_span/span.h"
+#include "task.h"
+
+namespace kudzu {
+
+/// Most tasks the system may run at once. `uxTaskGetSystemState()` returns
+/// nothing at all when given room for fewer tasks than exist, so anything
+/// which calls it sizes its array with this rather than with how many tasks
+/// it keeps. Leaves headroom over the 11 tasks the busiest app runs.
+inline constexpr size_t kMaxFreeRtosTasks = 24;
+
+/// Samples per-task CPU usage from FreeRTOS's run-time stats, which need
+/// configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY.
+///
+/// A sample suspends the scheduler only long enough to copy each task's
+/// counters, so it is cheap enough to take once a second or faster.
+class FreeRtosTaskCpuSampler {
+ public:
+  /// Write each task's CPU usage since the previous sample to `usage` and
+  /// return the number of tasks written. The first sample covers the time
+  /// since boot. Only the first TaskCpuTracker::kMaxTasks tasks are reported.
+  size_t Sample(pw::span<TaskCpuUsage> usage);
+
+  /// Run-time counter ticks covered by the last sample.
+  uint32_t interval() const { return tracker_.interval(); }
+
+ private:
+  TaskCpuTracker tracker_;
+  std::array<TaskStatus_t, kMaxFreeRtosTasks> status_;
+  std::array<TaskCounters, TaskCpuTracker::kMaxTasks> counters_;
+};
+
+}  // namespace kudzu
@@ -0,0 +1,69 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/task_cpu.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace kudzu {
+
+size_t TaskCpuTracker::Update(pw::span<const TaskCounters> tasks,
+                              uint32_t total_run_time,
+                              pw::span<TaskCpuUsage> usage) {
+  // Unsigned subtraction keeps the deltas right across a counter wrap.
+  interval_ = total_run_time - previous_total_;
+  previous_total_ = total_run_time;
+
+  std::array<Previous, kMaxTasks> current;
+  size_t num_current = 0;
+  size_t num_usage = 0;
+  for (const TaskCounters& task : tasks) {
+    uint32_t run_time = task.run_time;
+    for (size_t i = 0; i < num_previous_; i++) {
+      if (previous_[i].task_number == task.task_number) {
+        run_time = task.run_time - previous_[i].run_time;
+        break;
+      }
+    }
+    if (num_current < current.size()) {
+      current[num_current++] = {task.task_number, task.run_time};
+    }
+    if (num_usage == usage.size()) {
+      continue;
+    }
+
+    TaskCpuUsage& entry = usage[num_usage++];
+    entry.task_number = task.task_number;
+    entry.name = {};
+    std::strncpy(entry.name.data(),
+                 task.name != nullptr ? task.name : "",
+                 TaskCpuUsage::kMaxNameLength);
+    entry.run_time = run_time;
+    entry.cpu_permille =
+        interval_ == 0
+            ? 0
+            : static_cast<uint32_t>(std::min<uint64_t>(
+                  uint64_t{run_time} * 1000 / interval_, 1000));
+    entry.stack_high_water_bytes = task.stack_high_water_bytes;
+  }
+
+  previous_ = current;
+  num_previous_ = num_current;
+  return num_usage;
+}
+
+}  // namespace kudzu
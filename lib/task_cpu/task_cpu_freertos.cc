@@ -0,0 +1,48 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/task_cpu_freertos.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+namespace kudzu {
+
+size_t FreeRtosTaskCpuSampler::Sample(pw::span<TaskCpuUsage> usage) {
+  configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+  // Returns zero if there are more tasks than status_ can hold.
+  const size_t num_tasks = std::min<size_t>(
+      uxTaskGetSystemState(status_.data(), status_.size(), &total_run_time),
+      counters_.size());
+
+  for (size_t i = 0; i < num_tasks; i++) {
+    const TaskStatus_t& status = status_[i];
+    counters_[i] = {
+        .task_number = static_cast<uint32_t>(status.xTaskNumber),
+        .name = status.pcTaskName,
+        .run_time = static_cast<uint32_t>(status.ulRunTimeCounter),
+        .stack_high_water_bytes = static_cast<uint32_t>(
+            status.usStackHighWaterMark * sizeof(StackType_t)),
+    };
+  }
+  return tracker_.Update(pw::span(counters_.data(), num_tasks),
+                         static_cast<uint32_t>(total_run_time),
+                         usage);
+}
+
+}  // namespace kudzu
@@ -0,0 +1,121 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/task_cpu.h"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using kudzu::TaskCounters;
+using kudzu::TaskCpuTracker;
+using kudzu::TaskCpuUsage;
+
+TEST(TaskCpuTrackerTest, FirstUpdateCoversEverything) {
+  TaskCpuTracker tracker;
+  const std::array<TaskCounters, 2> tasks = {{
+      {1, "IDLE", 750, 100},
+      {2, "DisplayDrawThread", 250, 800},
+  }};
+  std::array<TaskCpuUsage, 4> usage;
+  ASSERT_EQ(tracker.Update(tasks, 1000, usage), 2u);
+  EXPECT_EQ(tracker.interval(), 1000u);
+
+  EXPECT_EQ(std::string_view(usage[0].name.data()), "IDLE");
+  EXPECT_EQ(usage[0].run_time, 750u);
+  EXPECT_EQ(usage[0].cpu_permille, 750u);
+  EXPECT_EQ(usage[0].stack_high_water_bytes, 100u);
+
+  // Names are cut to the FreeRTOS limit.
+  EXPECT_EQ(std::string_view(usage[1].name.data()), "DisplayDrawThre");
+  EXPECT_EQ(usage[1].cpu_permille, 250u);
+}
+
+TEST(TaskCpuTrackerTest, LaterUpdatesCoverTheInterval) {
+  TaskCpuTracker tracker;
+  std::array<TaskCpuUsage, 4> usage;
+  const std::array<TaskCounters, 2> first = {{
+      {1, "IDLE", 9000, 0},
+      {2, "Draw", 1000, 0},
+  }};
+  tracker.Update(first, 10000, usage);
+
+  const std::array<TaskCounters, 2> second = {{
+      {1, "IDLE", 9100, 0},
+      {2, "Draw", 1900, 0},
+  }};
+  ASSERT_EQ(tracker.Update(second, 11000, usage), 2u);
+  EXPECT_EQ(tracker.interval(), 1000u);
+  EXPECT_EQ(usage[0].run_time, 100u);
+  EXPECT_EQ(usage[0].cpu_permille, 100u);
+  EXPECT_EQ(usage[1].run_time, 900u);
+  EXPECT_EQ(usage[1].cpu_permille, 900u);
+}
+
+TEST(TaskCpuTrackerTest, CountersMayWrap) {
+  TaskCpuTracker tracker;
+  std::array<TaskCpuUsage, 1> usage;
+  const std::array<TaskCounters, 1> first = {{{1, "IDLE", 0xffff'ff00, 0}}};
+  tracker.Update(first, 0xffff'ff00, usage);
+
+  const std::array<TaskCounters, 1> second = {{{1, "IDLE", 0x100, 0}}};
+  ASSERT_EQ(tracker.Update(second, 0x200, usage), 1u);
+  EXPECT_EQ(tracker.interval(), 0x300u);
+  EXPECT_EQ(usage[0].run_time, 0x200u);
+  EXPECT_EQ(usage[0].cpu_permille, 666u);
+}
+
+TEST(TaskCpuTrackerTest, NewTasksAreChargedForTheirWholeRunTime) {
+  TaskCpuTracker tracker;
+  std::array<TaskCpuUsage, 2> usage;
+  const std::array<TaskCounters, 1> first = {{{1, "IDLE", 1000, 0}}};
+  tracker.Update(first, 1000, usage);
+
+  const std::array<TaskCounters, 2> second = {{
+      {1, "IDLE", 1600, 0},
+      {7, "Worker", 400, 0},
+  }};
+  ASSERT_EQ(tracker.Update(second, 2000, usage), 2u);
+  EXPECT_EQ(usage[1].task_number, 7u);
+  EXPECT_EQ(usage[1].run_time, 400u);
+  EXPECT_EQ(usage[1].cpu_permille, 400u);
+}
+
+TEST(TaskCpuTrackerTest, OutputIsLimitedToTheSpan) {
+  TaskCpuTracker tracker;
+  const std::array<TaskCounters, 3> tasks = {{
+      {1, "a", 1, 0},
+      {2, "b", 2, 0},
+      {3, "c", 3, 0},
+  }};
+  std::array<TaskCpuUsage, 2> usage;
+  EXPECT_EQ(tracker.Update(tasks, 6, usage), 2u);
+
+  // Every task was still recorded for the next interval.
+  const std::array<TaskCounters, 3> later = {{
+      {3, "c", 5, 0},
+      {1, "a", 1, 0},
+      {2, "b", 2, 0},
+  }};
+  EXPECT_EQ(tracker.Update(later, 8, usage), 2u);
+  EXPECT_EQ(usage[0].task_number, 3u);
+  EXPECT_EQ(usage[0].run_time, 2u);
+  EXPECT_EQ(usage[0].cpu_permille, 1000u);
+}
+
+}  // namespace
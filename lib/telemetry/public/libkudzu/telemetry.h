@@ -0,0 +1,69 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace kudzu {
+
+/// Frame rate and frame time percentiles over the last second.
+struct FrameTelemetry {
+  uint32_t frames_per_second;
+  uint32_t p50_us;
+  uint32_t p95_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+};
+
+struct BatteryTelemetry {
+  uint32_t millivolts;
+  uint32_t percent;
+};
+
+/// The latest metrics from the app and board, collected in one place for the
+/// telemetry RPC to sample.
+///
+/// Frame metrics are pushed by whoever measures them. Battery metrics are
+/// pulled through a reader the board registers, since reading them costs an
+/// I2C transaction which shouldn't happen on the frame path.
+class TelemetryStore {
+ public:
+  using BatteryReader = std::optional<BatteryTelemetry> (*)();
+
+  void PublishFrame(const FrameTelemetry& frame);
+
+  /// Returns the last published frame metrics, if any.
+  std::optional<FrameTelemetry> frame() const;
+
+  void SetBatteryReader(BatteryReader reader);
+
+  /// Reads the battery with the registered reader. Returns nothing if there
+  /// is no reader or the read failed.
+  std::optional<BatteryTelemetry> ReadBattery() const;
+
+ private:
+  mutable pw::sync::Mutex lock_;
+  std::optional<FrameTelemetry> frame_ PW_GUARDED_BY(lock_);
+  BatteryReader battery_reader_ PW_GUARDED_BY(lock_) = nullptr;
+};
+
+/// The store shared by the app, board and RPC services.
+TelemetryStore& GetTelemetryStore();
+
+}  // namespace kudzu
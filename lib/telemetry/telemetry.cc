@@ -0,0 +1,55 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/telemetry.h"
+
+#include <mutex>
+#include <optional>
+
+namespace kudzu {
+
+void TelemetryStore::PublishFrame(const FrameTelemetry& frame) {
+  std::lock_guard lock(lock_);
+  frame_ = frame;
+}
+
+std::optional<FrameTelemetry> TelemetryStore::frame() const {
+  std::lock_guard lock(lock_);
+  return frame_;
+}
+
+void TelemetryStore::SetBatteryReader(BatteryReader reader) {
+  std::lock_guard lock(lock_);
+  battery_reader_ = reader;
+}
+
+std::optional<BatteryTelemetry> TelemetryStore::ReadBattery() const {
+  BatteryReader reader;
+  {
+    std::lock_guard lock(lock_);
+    reader = battery_reader_;
+  }
+  // Read outside of the lock so a slow bus doesn't hold up publishers.
+  if (reader == nullptr) {
+    return std::nullopt;
+  }
+  return reader();
+}
+
+TelemetryStore& GetTelemetryStore() {
+  static TelemetryStore store;
+  return store;
+}
+
+}  // namespace kudzu
@@ -0,0 +1,62 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/telemetry.h"
+
+#include <optional>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using kudzu::BatteryTelemetry;
+using kudzu::FrameTelemetry;
+using kudzu::TelemetryStore;
+
+TEST(TelemetryStoreTest, EmptyUntilPublished) {
+  TelemetryStore store;
+  EXPECT_FALSE(store.frame().has_value());
+  EXPECT_FALSE(store.ReadBattery().has_value());
+}
+
+TEST(TelemetryStoreTest, ReturnsLatestFrame) {
+  TelemetryStore store;
+  store.PublishFrame({30, 33000, 34000, 40000, 41000});
+  store.PublishFrame({60, 16000, 17000, 18000, 25000});
+  std::optional<FrameTelemetry> frame = store.frame();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->frames_per_second, 60u);
+  EXPECT_EQ(frame->p50_us, 16000u);
+  EXPECT_EQ(frame->max_us, 25000u);
+}
+
+std::optional<BatteryTelemetry> ReadFullBattery() {
+  return BatteryTelemetry{4150, 98};
+}
+
+std::optional<BatteryTelemetry> ReadMissingBattery() { return std::nullopt; }
+
+TEST(TelemetryStoreTest, ReadsBatteryThroughReader) {
+  TelemetryStore store;
+  store.SetBatteryReader(ReadFullBattery);
+  std::optional<BatteryTelemetry> battery = store.ReadBattery();
+  ASSERT_TRUE(battery.has_value());
+  EXPECT_EQ(battery->millivolts, 4150u);
+  EXPECT_EQ(battery->percent, 98u);
+
+  store.SetBatteryReader(ReadMissingBattery);
+  EXPECT_FALSE(store.ReadBattery().has_value());
+}
+
+}  // namespace
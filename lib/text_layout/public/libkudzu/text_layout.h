@@ -0,0 +1,128 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "graphics/surface.hpp"
+#include "pw_containers/vector.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_span/span.h"
+
+namespace kudzu {
+
+/// A block of text that is measured, wrapped and split into lines once, then
+/// drawn every frame without allocating or measuring again.
+///
+/// The text is not copied and must outlive the layout. String literals and
+/// strings from a `TextArena` that is not reset before the layout is drawn are
+/// both fine. To change the text, build a new layout.
+///
+/// @code
+///   static const kudzu::TextLayout title(
+///       screen, "Pigweed + 32blit", blit::minimal_font);
+///   title.Draw(screen, blit::Point(10, 20));
+/// @endcode
+class TextLayout {
+ public:
+  static constexpr size_t kMaxLines = 8;
+
+  /// Horizontal alignment of each line within the block.
+  enum class Align {
+    kLeft,
+    kCenter,
+    kRight,
+  };
+
+  /// Lay out `text` using `screen` to measure it. Lines are split on '\n' and,
+  /// if `max_width` is positive, wrapped at spaces to fit within it. Lines
+  /// beyond kMaxLines are dropped.
+  TextLayout(blit::Surface& screen,
+             std::string_view text,
+             const blit::Font& font,
+             bool variable = true,
+             Align align = Align::kLeft,
+             int max_width = 0);
+
+  /// Size of the whole block of text in pixels.
+  blit::Size size() const { return size_; }
+
+  /// Bounds of the block when drawn with its top left corner at `top_left`.
+  blit::Rect Bounds(blit::Point top_left) const {
+    return blit::Rect(top_left, size_);
+  }
+
+  /// Draw with the top left corner of the block at `top_left` using the
+  /// current pen of `screen`.
+  void Draw(blit::Surface& screen, blit::Point top_left) const;
+
+ private:
+  struct Line {
+    std::string_view text;
+    int16_t width;
+    int16_t x_offset;
+  };
+
+  // Split one hard line into wrapped lines no wider than max_width.
+  void AddWrappedLines(blit::Surface& screen,
+                       std::string_view text,
+                       int max_width);
+  int MeasureWidth(blit::Surface& screen, std::string_view text) const;
+
+  const blit::Font& font_;
+  const bool variable_;
+  // Distance between the tops of consecutive lines.
+  int line_height_ = 0;
+  blit::Size size_;
+  pw::Vector<Line, kMaxLines> lines_;
+};
+
+/// A bump allocator for text which only lives for one frame, such as strings
+/// formatted with the current score or frame rate. Call `Reset()` once at the
+/// start of each frame; any views returned before that become invalid.
+///
+/// @code
+///   std::array<char, 256> arena_buffer;
+///   kudzu::TextArena arena(arena_buffer);
+///   ...
+///   arena.Reset();
+///   std::string_view fps = arena.Format("FPS: %d", frames_per_second);
+///   screen.text(fps, blit::minimal_font, blit::Point(0, 0));
+/// @endcode
+class TextArena {
+ public:
+  explicit TextArena(pw::span<char> buffer) : buffer_(buffer) {}
+
+  /// Release all strings returned since the last reset.
+  void Reset() { used_ = 0; }
+
+  /// Format a string into the arena. If the arena runs out of space the result
+  /// is truncated.
+  std::string_view Format(const char* format, ...) PW_PRINTF_FORMAT(2, 3);
+
+  /// Copy a string into the arena, truncating it if the arena is full.
+  std::string_view Copy(std::string_view text);
+
+  size_t used() const { return used_; }
+  size_t capacity() const { return buffer_.size(); }
+
+ private:
+  pw::span<char> buffer_;
+  size_t used_ = 0;
+};
+
+}  // namespace kudzu
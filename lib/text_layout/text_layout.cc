@@ -0,0 +1,152 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/text_layout.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+
+#include "pw_string/string_builder.h"
+
+namespace kudzu {
+
+TextLayout::TextLayout(blit::Surface& screen,
+                       std::string_view text,
+                       const blit::Font& font,
+                       bool variable,
+                       Align align,
+                       int max_width)
+    : font_(font), variable_(variable) {
+  // Let 32blit decide the line spacing so the cached layout matches what
+  // Surface::text() would draw for the same string.
+  const int glyph_height = screen.measure_text("A", font_, variable_).h;
+  line_height_ = screen.measure_text("A\nA", font_, variable_).h - glyph_height;
+
+  while (!text.empty() && !lines_.full()) {
+    const size_t newline = text.find('\n');
+    AddWrappedLines(screen, text.substr(0, newline), max_width);
+    if (newline == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(newline + 1);
+  }
+
+  int width = 0;
+  for (const Line& line : lines_) {
+    width = std::max<int>(width, line.width);
+  }
+  for (Line& line : lines_) {
+    switch (align) {
+      case Align::kLeft:
+        line.x_offset = 0;
+        break;
+      case Align::kCenter:
+        line.x_offset = static_cast<int16_t>((width - line.width) / 2);
+        break;
+      case Align::kRight:
+        line.x_offset = static_cast<int16_t>(width - line.width);
+        break;
+    }
+  }
+
+  const int num_lines = static_cast<int>(lines_.size());
+  const int height =
+      num_lines == 0 ? 0 : glyph_height + (num_lines - 1) * line_height_;
+  size_ = blit::Size(width, height);
+}
+
+void TextLayout::AddWrappedLines(blit::Surface& screen,
+                                 std::string_view text,
+                                 int max_width) {
+  while (!lines_.full()) {
+    const int width = MeasureWidth(screen, text);
+    if (max_width <= 0 || width <= max_width) {
+      lines_.push_back({.text = text,
+                        .width = static_cast<int16_t>(width),
+                        .x_offset = 0});
+      return;
+    }
+
+    // Break at the last space which keeps the line within max_width.
+    size_t break_at = std::string_view::npos;
+    int break_width = 0;
+    for (size_t space = text.find(' '); space != std::string_view::npos;
+         space = text.find(' ', space + 1)) {
+      const int prefix_width = MeasureWidth(screen, text.substr(0, space));
+      if (prefix_width > max_width) {
+        break;
+      }
+      break_at = space;
+      break_width = prefix_width;
+    }
+
+    if (break_at == std::string_view::npos) {
+      // A single word wider than max_width; let it overflow.
+      lines_.push_back({.text = text,
+                        .width = static_cast<int16_t>(width),
+                        .x_offset = 0});
+      return;
+    }
+
+    lines_.push_back({.text = text.substr(0, break_at),
+                      .width = static_cast<int16_t>(break_width),
+                      .x_offset = 0});
+    text.remove_prefix(break_at + 1);
+  }
+}
+
+int TextLayout::MeasureWidth(blit::Surface& screen,
+                             std::string_view text) const {
+  return text.empty() ? 0 : screen.measure_text(text, font_, variable_).w;
+}
+
+void TextLayout::Draw(blit::Surface& screen, blit::Point top_left) const {
+  blit::Point position = top_left;
+  for (const Line& line : lines_) {
+    position.x = top_left.x + line.x_offset;
+    screen.text(line.text, font_, position, variable_);
+    position.y += line_height_;
+  }
+}
+
+std::string_view TextArena::Format(const char* format, ...) {
+  if (used_ >= buffer_.size()) {
+    return std::string_view();
+  }
+  pw::StringBuilder builder(buffer_.subspan(used_));
+  va_list args;
+  va_start(args, format);
+  builder.FormatVaList(format, args);
+  va_end(args);
+
+  std::string_view result(builder.data(), builder.size());
+  // Keep the null terminator so the result can be passed to C APIs.
+  used_ += builder.size() + 1;
+  return result;
+}
+
+std::string_view TextArena::Copy(std::string_view text) {
+  if (used_ >= buffer_.size()) {
+    return std::string_view();
+  }
+  const size_t length = std::min(text.size(), buffer_.size() - used_ - 1);
+  char* destination = buffer_.data() + used_;
+  std::memcpy(destination, text.data(), length);
+  destination[length] = '\0';
+  used_ += length + 1;
+  return std::string_view(destination, length);
+}
+
+}  // namespace kudzu
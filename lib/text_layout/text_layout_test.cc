@@ -0,0 +1,143 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/text_layout.h"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "graphics/surface.hpp"
+#include "gtest/gtest.h"
+
+namespace kudzu {
+namespace {
+
+constexpr int kWidth = 160;
+constexpr int kHeight = 120;
+
+class TextLayoutTest : public ::testing::Test {
+ protected:
+  blit::Size Measure(std::string_view text) {
+    return screen_.measure_text(text, blit::minimal_font);
+  }
+
+  std::array<uint8_t, kWidth * kHeight * 2> pixels_ = {};
+  blit::Surface screen_{
+      pixels_.data(), blit::PixelFormat::RGB565, blit::Size(kWidth, kHeight)};
+};
+
+TEST_F(TextLayoutTest, SizeMatchesSurface) {
+  constexpr std::string_view kText = "Nice to meet you\nMade with Pigweed";
+  const TextLayout layout(screen_, kText, blit::minimal_font);
+  EXPECT_EQ(layout.size().w, Measure(kText).w);
+  EXPECT_EQ(layout.size().h, Measure(kText).h);
+}
+
+TEST_F(TextLayoutTest, EmptyTextHasNoSize) {
+  const TextLayout layout(screen_, "", blit::minimal_font);
+  EXPECT_EQ(layout.size().w, 0);
+  EXPECT_EQ(layout.size().h, 0);
+}
+
+TEST_F(TextLayoutTest, WrapsAtSpaces) {
+  const int max_width = Measure("abcd abcd").w;
+  const TextLayout layout(screen_,
+                          "abcd abcd abcd abcd",
+                          blit::minimal_font,
+                          true,
+                          TextLayout::Align::kLeft,
+                          max_width);
+  EXPECT_EQ(layout.size().w, max_width);
+  EXPECT_EQ(layout.size().h, Measure("abcd abcd\nabcd abcd").h);
+}
+
+TEST_F(TextLayoutTest, LongWordOverflows) {
+  const TextLayout layout(screen_,
+                          "abcdefgh",
+                          blit::minimal_font,
+                          true,
+                          TextLayout::Align::kLeft,
+                          Measure("abcd").w);
+  EXPECT_EQ(layout.size().w, Measure("abcdefgh").w);
+  EXPECT_EQ(layout.size().h, Measure("abcdefgh").h);
+}
+
+TEST_F(TextLayoutTest, DropsLinesPastMax) {
+  const TextLayout layout(
+      screen_, "1\n2\n3\n4\n5\n6\n7\n8\n9\n10", blit::minimal_font);
+  static_assert(TextLayout::kMaxLines == 8);
+  EXPECT_EQ(layout.size().h, Measure("1\n2\n3\n4\n5\n6\n7\n8").h);
+}
+
+TEST_F(TextLayoutTest, DrawsLikeSurfaceText) {
+  constexpr std::string_view kText = "Nice to meet you\nMade with Pigweed";
+  screen_.pen = blit::Pen(255, 255, 255);
+  screen_.text(kText, blit::minimal_font, blit::Point(4, 6));
+  const auto expected = pixels_;
+
+  pixels_ = {};
+  const TextLayout layout(screen_, kText, blit::minimal_font);
+  layout.Draw(screen_, blit::Point(4, 6));
+  EXPECT_EQ(pixels_, expected);
+}
+
+TEST_F(TextLayoutTest, CenteringLinesOfEqualWidthMovesNothing) {
+  constexpr std::string_view kText = "abc\nabc";
+  screen_.pen = blit::Pen(255, 255, 255);
+  screen_.text(kText, blit::minimal_font, blit::Point(0, 0));
+  const auto expected = pixels_;
+
+  pixels_ = {};
+  const TextLayout layout(
+      screen_, kText, blit::minimal_font, true, TextLayout::Align::kCenter);
+  layout.Draw(screen_, blit::Point(0, 0));
+  EXPECT_EQ(pixels_, expected);
+}
+
+TEST(TextArena, FormatsAndCopiesUntilReset) {
+  std::array<char, 32> buffer;
+  TextArena arena(buffer);
+  const std::string_view fps = arena.Format("FPS: %d", 60);
+  const std::string_view name = arena.Copy("kudzu");
+  EXPECT_EQ(fps, "FPS: 60");
+  EXPECT_EQ(name, "kudzu");
+  // Each string keeps its null terminator.
+  EXPECT_EQ(fps.data()[fps.size()], '\0');
+  EXPECT_EQ(arena.used(), fps.size() + 1 + name.size() + 1);
+
+  arena.Reset();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.Format("%s", "again").data(), buffer.data());
+}
+
+TEST(TextArena, TruncatesWhenFull) {
+  std::array<char, 8> buffer;
+  TextArena arena(buffer);
+  EXPECT_EQ(arena.Copy("abc"), "abc");
+  EXPECT_EQ(arena.Copy("defghijk"), "def");
+  EXPECT_EQ(arena.used(), arena.capacity());
+  EXPECT_TRUE(arena.Copy("l").empty());
+  EXPECT_TRUE(arena.Format("%d", 1).empty());
+}
+
+TEST(TextArena, FormatTruncatesWhenFull) {
+  std::array<char, 8> buffer;
+  TextArena arena(buffer);
+  EXPECT_EQ(arena.Format("FPS: %d", 1000), "FPS: 10");
+  EXPECT_EQ(arena.used(), arena.capacity());
+}
+
+}  // namespace
+}  // namespace kudzu
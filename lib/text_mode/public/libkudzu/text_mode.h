@@ -0,0 +1,197 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pw_color/color.h"
+#include "pw_display_driver/display_driver.h"
+#include "pw_draw/font_set.h"
+#include "pw_geometry/size.h"
+#include "pw_geometry/vector2.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+namespace kudzu {
+
+/// Receives the pixels rasterized by a `TextModeDisplay`, one scanline at a
+/// time.
+class ScanlineWriter {
+ public:
+  virtual ~ScanlineWriter() = default;
+
+  /// Write a run of RGB565 pixels to display row `y` starting at column `x`.
+  /// The pixels are only valid for the duration of the call.
+  virtual pw::Status WriteScanline(uint16_t x,
+                                   uint16_t y,
+                                   pw::span<uint16_t> pixels) = 0;
+};
+
+/// Writes scanlines straight to the panel with `DisplayDriver::WriteRow()`.
+class DisplayDriverScanlineWriter : public ScanlineWriter {
+ public:
+  explicit DisplayDriverScanlineWriter(
+      pw::display_driver::DisplayDriver& driver)
+      : driver_(driver) {}
+
+  pw::Status WriteScanline(uint16_t x,
+                           uint16_t y,
+                           pw::span<uint16_t> pixels) override {
+    return driver_.WriteRow(pixels, y, x);
+  }
+
+ private:
+  pw::display_driver::DisplayDriver& driver_;
+};
+
+/// An ASCII character with a foreground and background color.
+struct TextCell {
+  char ch = ' ';
+  pw::color::color_rgb565_t foreground_color = 0xffff;
+  pw::color::color_rgb565_t background_color = 0x0000;
+
+  bool operator==(const TextCell& other) const {
+    return ch == other.ch && foreground_color == other.foreground_color &&
+           background_color == other.background_color;
+  }
+  bool operator!=(const TextCell& other) const { return !(*this == other); }
+};
+
+/// A display which only holds a grid of characters in RAM instead of a
+/// framebuffer. `Update()` rasterizes the cells that changed since the last
+/// update one scanline at a time into a line buffer a single row of characters
+/// wide and hands each scanline to a `ScanlineWriter`.
+///
+/// Only printable ASCII is drawn, in a fixed width font no larger than 8x16
+/// pixels. Other characters are drawn as blanks.
+///
+/// Not thread safe; use it from a single draw thread.
+class TextModeDisplay {
+ public:
+  static constexpr int kMaxGlyphWidth = 8;
+  static constexpr int kMaxGlyphHeight = 16;
+
+  TextModeDisplay(const TextModeDisplay&) = delete;
+  TextModeDisplay& operator=(const TextModeDisplay&) = delete;
+
+  /// Size of the grid in characters.
+  pw::geometry::Size<int> GetSize() const { return {columns_, rows_}; }
+
+  /// Size of one character in pixels.
+  pw::geometry::Size<int> GetCharSize() const {
+    return {glyph_width_, glyph_height_};
+  }
+
+  /// Return the cell at `loc`, which must be within the grid.
+  const TextCell& GetCell(pw::geometry::Vector2<int> loc) const {
+    return cells_[loc.y * columns_ + loc.x];
+  }
+
+  /// Set the cell at `loc`. Locations outside the grid are ignored, and
+  /// setting a cell to its current value costs nothing at the next update.
+  void SetCell(pw::geometry::Vector2<int> loc, const TextCell& cell);
+
+  /// Write `text` starting at `loc`, clipped to the end of the row.
+  void Print(pw::geometry::Vector2<int> loc,
+             std::string_view text,
+             pw::color::color_rgb565_t foreground_color,
+             pw::color::color_rgb565_t background_color);
+
+  /// Set every cell in rows [first_row, end_row) to `cell`.
+  void FillRows(int first_row, int end_row, const TextCell& cell);
+
+  /// Move rows [first_row, end_row) up by one row and fill the last row with
+  /// `cell`. Only cells whose contents actually change are redrawn.
+  void ScrollUp(int first_row, int end_row, const TextCell& cell);
+
+  /// Mark every cell as needing to be redrawn, such as after the panel has
+  /// been reset.
+  void Invalidate();
+
+  /// Rasterize and write every cell that changed since the last update. If a
+  /// write fails the remaining cells stay dirty and the error is returned.
+  pw::Status Update();
+
+ protected:
+  // Columns of changed cells in one row, [begin, end).
+  struct DirtyRange {
+    uint16_t begin;
+    uint16_t end;
+  };
+
+  /// The grid is `columns` wide and `cells.size() / columns` tall. The line
+  /// buffer must hold at least `columns * font.width` pixels. The storage is
+  /// not touched, so it may be constructed afterwards; call `Invalidate()` once
+  /// it has been.
+  TextModeDisplay(ScanlineWriter& writer,
+                  const pw::draw::FontSet& font,
+                  int columns,
+                  pw::span<TextCell> cells,
+                  pw::span<DirtyRange> dirty_rows,
+                  pw::span<uint16_t> line_buffer);
+
+ private:
+  static constexpr char kFirstGlyph = ' ';
+  static constexpr char kLastGlyph = '~';
+  static constexpr size_t kNumGlyphs = kLastGlyph - kFirstGlyph + 1;
+
+  // Render each glyph through pw_draw once and keep one byte per glyph row,
+  // leftmost pixel in the most significant bit.
+  void CacheGlyphs(const pw::draw::FontSet& font);
+
+  void MarkDirty(int row, int begin, int end);
+
+  // Rasterize one scanline of the cells in columns [begin, end) of `row`.
+  void RasterizeScanline(int row, int glyph_row, int begin, int end);
+
+  ScanlineWriter& writer_;
+  const int glyph_width_;
+  const int glyph_height_;
+  const int columns_;
+  const int rows_;
+  pw::span<TextCell> cells_;
+  pw::span<DirtyRange> dirty_rows_;
+  pw::span<uint16_t> line_buffer_;
+  std::array<uint8_t, kNumGlyphs * kMaxGlyphHeight> glyph_rows_ = {};
+};
+
+/// A `TextModeDisplay` with statically allocated storage for a `kColumns` by
+/// `kRows` grid.
+///
+/// @code
+///   kudzu::DisplayDriverScanlineWriter writer(display_driver);
+///   kudzu::TextModeDisplayBuffer<53, 30> text_mode(writer, font);
+///   text_mode.Print({0, 0}, "Hello", kWhite, kBlack);
+///   text_mode.Update();
+/// @endcode
+template <int kColumns, int kRows>
+class TextModeDisplayBuffer : public TextModeDisplay {
+ public:
+  TextModeDisplayBuffer(ScanlineWriter& writer, const pw::draw::FontSet& font)
+      : TextModeDisplay(
+            writer, font, kColumns, cells_, dirty_rows_, line_buffer_) {
+    Invalidate();
+  }
+
+ private:
+  std::array<TextCell, kColumns * kRows> cells_;
+  std::array<DirtyRange, kRows> dirty_rows_;
+  std::array<uint16_t, kColumns * kMaxGlyphWidth> line_buffer_;
+};
+
+}  // namespace kudzu
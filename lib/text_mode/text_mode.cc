@@ -0,0 +1,192 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/text_mode.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "pw_assert/check.h"
+#include "pw_draw/draw.h"
+#include "pw_framebuffer/framebuffer.h"
+
+namespace kudzu {
+
+using pw::color::color_rgb565_t;
+using pw::geometry::Vector2;
+
+TextModeDisplay::TextModeDisplay(ScanlineWriter& writer,
+                                 const pw::draw::FontSet& font,
+                                 int columns,
+                                 pw::span<TextCell> cells,
+                                 pw::span<DirtyRange> dirty_rows,
+                                 pw::span<uint16_t> line_buffer)
+    : writer_(writer),
+      glyph_width_(font.width),
+      glyph_height_(font.height),
+      columns_(columns),
+      rows_(static_cast<int>(cells.size()) / columns),
+      cells_(cells),
+      dirty_rows_(dirty_rows),
+      line_buffer_(line_buffer) {
+  PW_CHECK_INT_LE(glyph_width_, kMaxGlyphWidth);
+  PW_CHECK_INT_LE(glyph_height_, kMaxGlyphHeight);
+  PW_CHECK_INT_GE(static_cast<int>(dirty_rows_.size()), rows_);
+  PW_CHECK_INT_GE(static_cast<int>(line_buffer_.size()),
+                  columns_ * glyph_width_);
+  CacheGlyphs(font);
+}
+
+void TextModeDisplay::CacheGlyphs(const pw::draw::FontSet& font) {
+  std::array<color_rgb565_t, kMaxGlyphWidth * kMaxGlyphHeight> pixels;
+  pw::framebuffer::Framebuffer scratch(
+      pixels.data(),
+      pw::framebuffer::PixelFormat::RGB565,
+      {static_cast<uint16_t>(kMaxGlyphWidth),
+       static_cast<uint16_t>(kMaxGlyphHeight)},
+      kMaxGlyphWidth * sizeof(color_rgb565_t));
+
+  const int first = std::max<int>(kFirstGlyph, font.starting_character);
+  const int last = std::min<int>(kLastGlyph, font.ending_character);
+  for (int c = first; c <= last; c++) {
+    pixels.fill(0);
+    pw::draw::DrawCharacter(c, {0, 0}, 0xffff, 0, font, scratch);
+    uint8_t* glyph = &glyph_rows_[(c - kFirstGlyph) * kMaxGlyphHeight];
+    for (int y = 0; y < glyph_height_; y++) {
+      uint8_t bits = 0;
+      for (int x = 0; x < glyph_width_; x++) {
+        if (pixels[y * kMaxGlyphWidth + x] != 0) {
+          bits |= 0x80 >> x;
+        }
+      }
+      glyph[y] = bits;
+    }
+  }
+}
+
+void TextModeDisplay::MarkDirty(int row, int begin, int end) {
+  DirtyRange& dirty = dirty_rows_[row];
+  if (dirty.begin >= dirty.end) {
+    dirty.begin = static_cast<uint16_t>(begin);
+    dirty.end = static_cast<uint16_t>(end);
+    return;
+  }
+  dirty.begin = std::min(dirty.begin, static_cast<uint16_t>(begin));
+  dirty.end = std::max(dirty.end, static_cast<uint16_t>(end));
+}
+
+void TextModeDisplay::SetCell(Vector2<int> loc, const TextCell& cell) {
+  if (loc.x < 0 || loc.x >= columns_ || loc.y < 0 || loc.y >= rows_) {
+    return;
+  }
+  TextCell& current = cells_[loc.y * columns_ + loc.x];
+  if (current == cell) {
+    return;
+  }
+  current = cell;
+  MarkDirty(loc.y, loc.x, loc.x + 1);
+}
+
+void TextModeDisplay::Print(Vector2<int> loc,
+                            std::string_view text,
+                            color_rgb565_t foreground_color,
+                            color_rgb565_t background_color) {
+  for (char c : text) {
+    if (loc.x >= columns_) {
+      break;
+    }
+    SetCell(loc, {c, foreground_color, background_color});
+    loc.x++;
+  }
+}
+
+void TextModeDisplay::FillRows(int first_row,
+                               int end_row,
+                               const TextCell& cell) {
+  first_row = std::max(first_row, 0);
+  end_row = std::min(end_row, rows_);
+  for (int y = first_row; y < end_row; y++) {
+    for (int x = 0; x < columns_; x++) {
+      SetCell({x, y}, cell);
+    }
+  }
+}
+
+void TextModeDisplay::ScrollUp(int first_row,
+                               int end_row,
+                               const TextCell& cell) {
+  first_row = std::max(first_row, 0);
+  end_row = std::min(end_row, rows_);
+  // Copying through SetCell() leaves cells which already match, such as the
+  // blank ends of lines, out of the next update.
+  for (int y = first_row; y + 1 < end_row; y++) {
+    for (int x = 0; x < columns_; x++) {
+      SetCell({x, y}, cells_[(y + 1) * columns_ + x]);
+    }
+  }
+  FillRows(end_row - 1, end_row, cell);
+}
+
+void TextModeDisplay::Invalidate() {
+  for (int y = 0; y < rows_; y++) {
+    dirty_rows_[y] = {0, static_cast<uint16_t>(columns_)};
+  }
+}
+
+void TextModeDisplay::RasterizeScanline(int row,
+                                        int glyph_row,
+                                        int begin,
+                                        int end) {
+  uint16_t* out = line_buffer_.data();
+  const TextCell* cell = &cells_[row * columns_ + begin];
+  for (int x = begin; x < end; x++, cell++) {
+    uint8_t bits = 0;
+    if (cell->ch >= kFirstGlyph && cell->ch <= kLastGlyph) {
+      bits = glyph_rows_[(cell->ch - kFirstGlyph) * kMaxGlyphHeight +
+                         glyph_row];
+    }
+    const color_rgb565_t fg = cell->foreground_color;
+    const color_rgb565_t bg = cell->background_color;
+    for (int i = 0; i < glyph_width_; i++) {
+      *out++ = (bits & 0x80) ? fg : bg;
+      bits <<= 1;
+    }
+  }
+}
+
+pw::Status TextModeDisplay::Update() {
+  for (int row = 0; row < rows_; row++) {
+    DirtyRange& dirty = dirty_rows_[row];
+    if (dirty.begin >= dirty.end) {
+      continue;
+    }
+    const uint16_t x = static_cast<uint16_t>(dirty.begin * glyph_width_);
+    const size_t num_pixels =
+        static_cast<size_t>(dirty.end - dirty.begin) * glyph_width_;
+    for (int glyph_row = 0; glyph_row < glyph_height_; glyph_row++) {
+      RasterizeScanline(row, glyph_row, dirty.begin, dirty.end);
+      const uint16_t y = static_cast<uint16_t>(row * glyph_height_ + glyph_row);
+      pw::Status status =
+          writer_.WriteScanline(x, y, line_buffer_.first(num_pixels));
+      if (!status.ok()) {
+        return status;
+      }
+    }
+    dirty = {0, 0};
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace kudzu
@@ -0,0 +1,135 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/text_mode.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_draw/font6x8.h"
+
+namespace kudzu {
+namespace {
+
+constexpr pw::color::color_rgb565_t kWhite = 0xffff;
+constexpr pw::color::color_rgb565_t kBlack = 0x0000;
+constexpr pw::color::color_rgb565_t kBlue = 0x001f;
+
+struct Scanline {
+  uint16_t x;
+  uint16_t y;
+  std::vector<uint16_t> pixels;
+};
+
+class RecordingWriter : public ScanlineWriter {
+ public:
+  pw::Status WriteScanline(uint16_t x,
+                           uint16_t y,
+                           pw::span<uint16_t> pixels) override {
+    scanlines.push_back({x, y, {pixels.begin(), pixels.end()}});
+    return status;
+  }
+
+  std::vector<Scanline> scanlines;
+  pw::Status status;
+};
+
+class TextModeDisplayTest : public ::testing::Test {
+ protected:
+  TextModeDisplayTest()
+      : font_(pw::draw::GetFont6x8()), display_(writer_, font_) {
+    // Flush the initial full redraw.
+    EXPECT_EQ(pw::OkStatus(), display_.Update());
+    writer_.scanlines.clear();
+  }
+
+  RecordingWriter writer_;
+  pw::draw::FontSet font_;
+  TextModeDisplayBuffer<10, 4> display_;
+};
+
+TEST_F(TextModeDisplayTest, InitialUpdateDrawsEverything) {
+  display_.Invalidate();
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  ASSERT_EQ(4u * font_.height, writer_.scanlines.size());
+  EXPECT_EQ(10u * font_.width, writer_.scanlines[0].pixels.size());
+}
+
+TEST_F(TextModeDisplayTest, UnchangedCellsAreNotRedrawn) {
+  display_.SetCell({3, 1}, TextCell{});
+  display_.Print({0, 2}, "   ", kWhite, kBlack);
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  EXPECT_TRUE(writer_.scanlines.empty());
+}
+
+TEST_F(TextModeDisplayTest, OnlyChangedCellsAreRedrawn) {
+  display_.SetCell({3, 1}, {'A', kWhite, kBlue});
+  display_.SetCell({5, 1}, {'B', kWhite, kBlue});
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+
+  // Columns 3 through 5 of row 1, one scanline per glyph row.
+  ASSERT_EQ(static_cast<size_t>(font_.height), writer_.scanlines.size());
+  for (int i = 0; i < font_.height; i++) {
+    const Scanline& scanline = writer_.scanlines[i];
+    EXPECT_EQ(3 * font_.width, scanline.x);
+    EXPECT_EQ(font_.height + i, scanline.y);
+    EXPECT_EQ(3u * font_.width, scanline.pixels.size());
+  }
+
+  writer_.scanlines.clear();
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  EXPECT_TRUE(writer_.scanlines.empty());
+}
+
+TEST_F(TextModeDisplayTest, SpaceIsDrawnInBackgroundColor) {
+  display_.SetCell({0, 0}, {' ', kWhite, kBlue});
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  ASSERT_FALSE(writer_.scanlines.empty());
+  for (const Scanline& scanline : writer_.scanlines) {
+    for (uint16_t pixel : scanline.pixels) {
+      EXPECT_EQ(kBlue, pixel);
+    }
+  }
+}
+
+TEST_F(TextModeDisplayTest, ScrollOnlyRedrawsCellsThatChange) {
+  display_.Print({0, 2}, "ab", kWhite, kBlack);
+  display_.Print({0, 3}, "ab", kWhite, kBlack);
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  writer_.scanlines.clear();
+
+  // Row 2 keeps its contents and row 3 is cleared.
+  display_.ScrollUp(2, 4, TextCell{});
+  EXPECT_EQ('a', display_.GetCell({0, 2}).ch);
+  EXPECT_EQ(' ', display_.GetCell({0, 3}).ch);
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  ASSERT_EQ(static_cast<size_t>(font_.height), writer_.scanlines.size());
+  EXPECT_EQ(3 * font_.height, writer_.scanlines[0].y);
+  EXPECT_EQ(2u * font_.width, writer_.scanlines[0].pixels.size());
+}
+
+TEST_F(TextModeDisplayTest, FailedWriteKeepsCellsDirty) {
+  display_.SetCell({0, 0}, {'x', kWhite, kBlack});
+  writer_.status = pw::Status::Unavailable();
+  EXPECT_EQ(pw::Status::Unavailable(), display_.Update());
+
+  writer_.status = pw::OkStatus();
+  writer_.scanlines.clear();
+  EXPECT_EQ(pw::OkStatus(), display_.Update());
+  EXPECT_EQ(static_cast<size_t>(font_.height), writer_.scanlines.size());
+}
+
+}  // namespace
+}  // namespace kudzu
@@ -0,0 +1,210 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "pw_geometry/size.h"
+#include "pw_geometry/vector2.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+
+namespace kudzu {
+
+/// One touch on a calibration target: where the panel read it, and where on
+/// screen the target was drawn.
+struct CalibrationPoint {
+  pw::geometry::Vector2<int> panel;
+  pw::geometry::Vector2<int> screen;
+};
+
+/// Maps touch panel coordinates to screen coordinates with a 2x3 affine
+/// matrix in Q16.16 fixed point:
+///
+///   screen.x = (a * panel.x + b * panel.y + c) >> 16
+///   screen.y = (d * panel.x + e * panel.y + f) >> 16
+///
+/// Applying it takes four integer multiplies, so it costs next to nothing on
+/// cores without an FPU. Build one from how the panel is mounted with
+/// `FromRotation()`, or fit one to touches on known targets with
+/// `FromPoints()`, which also corrects each unit's offset, scale and skew.
+class TouchCalibration {
+ public:
+  static constexpr int kFractionBits = 16;
+  static constexpr int32_t kOne = int32_t{1} << kFractionBits;
+
+  struct Matrix {
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int32_t d;
+    int32_t e;
+    int32_t f;
+  };
+
+  /// How the panel's axes lie on the screen's, before scaling. `W` and `H`
+  /// are the panel's width and height.
+  enum class Rotation : uint8_t {
+    /// screen = (x, y)
+    k0,
+    /// screen = (y, W - x)
+    k90,
+    /// screen = (W - x, H - y)
+    k180,
+    /// screen = (H - y, x)
+    k270,
+  };
+
+  /// Size of what `Encode()` writes.
+  static constexpr size_t kEncodedSize = 32;
+
+  /// Passes panel coordinates through unchanged.
+  constexpr TouchCalibration()
+      : TouchCalibration(Matrix{kOne, 0, 0, 0, kOne, 0}) {}
+
+  explicit constexpr TouchCalibration(const Matrix& matrix)
+      : matrix_(matrix) {}
+
+  /// Returns the calibration for a panel of size `panel`, turned by
+  /// `rotation`, and scaled to cover a screen of size `screen`, such as a
+  /// framebuffer drawn at a fraction of the panel's resolution.
+  static constexpr TouchCalibration FromRotation(
+      Rotation rotation,
+      pw::geometry::Size<int> panel,
+      pw::geometry::Size<int> screen) {
+    switch (rotation) {
+      case Rotation::k0:
+        return TouchCalibration(Matrix{
+            .a = Ratio(screen.width, panel.width),
+            .b = 0,
+            .c = 0,
+            .d = 0,
+            .e = Ratio(screen.height, panel.height),
+            .f = 0,
+        });
+      case Rotation::k90:
+        return TouchCalibration(Matrix{
+            .a = 0,
+            .b = Ratio(screen.width, panel.height),
+            .c = 0,
+            .d = -Ratio(screen.height, panel.width),
+            .e = 0,
+            .f = screen.height * kOne,
+        });
+      case Rotation::k180:
+        return TouchCalibration(Matrix{
+            .a = -Ratio(screen.width, panel.width),
+            .b = 0,
+            .c = screen.width * kOne,
+            .d = 0,
+            .e = -Ratio(screen.height, panel.height),
+            .f = screen.height * kOne,
+        });
+      case Rotation::k270:
+        return TouchCalibration(Matrix{
+            .a = 0,
+            .b = -Ratio(screen.width, panel.height),
+            .c = screen.width * kOne,
+            .d = Ratio(screen.height, panel.width),
+            .e = 0,
+            .f = 0,
+        });
+    }
+    return TouchCalibration();
+  }
+
+  /// Returns the least squares fit to `points`, which needs at least three
+  /// points not all on one line. Returns INVALID_ARGUMENT if they don't pin
+  /// down a calibration.
+  ///
+  /// This uses floating point, but only runs once per calibration.
+  static pw::Result<TouchCalibration> FromPoints(
+      pw::span<const CalibrationPoint> points);
+
+  /// Returns where `panel` is on screen, rounded to the nearest pixel.
+  constexpr pw::geometry::Vector2<int> Apply(
+      pw::geometry::Vector2<int> panel) const {
+    return {
+        Round(int64_t{matrix_.a} * panel.x + int64_t{matrix_.b} * panel.y +
+              matrix_.c),
+        Round(int64_t{matrix_.d} * panel.x + int64_t{matrix_.e} * panel.y +
+              matrix_.f),
+    };
+  }
+
+  constexpr const Matrix& matrix() const { return matrix_; }
+
+  /// Writes the calibration, with a magic number and a checksum, for storage
+  /// in flash.
+  void Encode(pw::span<std::byte, kEncodedSize> out) const;
+
+  /// Reads a calibration written by `Encode()`. Returns NOT_FOUND if `data`
+  /// doesn't hold one, such as erased flash, and DATA_LOSS if it was
+  /// corrupted.
+  static pw::Result<TouchCalibration> Decode(pw::span<const std::byte> data);
+
+ private:
+  // Returns num / den in Q16.16, rounded to nearest.
+  static constexpr int32_t Ratio(int num, int den) {
+    return static_cast<int32_t>(
+        ((int64_t{num} << kFractionBits) + den / 2) / den);
+  }
+
+  static constexpr int Round(int64_t value) {
+    return static_cast<int>((value + kOne / 2) >> kFractionBits);
+  }
+
+  Matrix matrix_;
+};
+
+/// Walks through a calibration. Draw a target at `target()`, pass where the
+/// panel read the touch on it to `AddSample()`, and repeat until `target()`
+/// returns nothing. Then `Finish()` fits the calibration.
+///
+/// Read the panel through an identity calibration while this runs, so the
+/// samples are in panel coordinates.
+class TouchCalibrator {
+ public:
+  /// Targets sit near each corner, where errors are largest, and in the
+  /// middle.
+  static constexpr size_t kNumTargets = 5;
+
+  explicit TouchCalibrator(pw::geometry::Size<int> screen);
+
+  /// Where to draw the next target, or nothing once every target has been
+  /// touched.
+  std::optional<pw::geometry::Vector2<int>> target() const;
+
+  /// Records a touch on the current target and moves to the next. Does
+  /// nothing once every target has been touched.
+  void AddSample(pw::geometry::Vector2<int> panel);
+
+  /// Returns FAILED_PRECONDITION until every target has been touched, and
+  /// INVALID_ARGUMENT if the touches can't be fit, such as when the same
+  /// spot was touched for each.
+  pw::Result<TouchCalibration> Finish() const;
+
+  /// Starts again from the first target.
+  void Restart() { count_ = 0; }
+
+ private:
+  std::array<CalibrationPoint, kNumTargets> points_;
+  size_t count_ = 0;
+};
+
+}  // namespace kudzu
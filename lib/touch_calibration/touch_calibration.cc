@@ -0,0 +1,210 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/touch_calibration.h"
+
+#include <array>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "pw_bytes/endian.h"
+#include "pw_status/status.h"
+
+namespace kudzu {
+namespace {
+
+constexpr uint32_t kMagic = 0x4c414354;  // "TCAL"
+
+// Where each field sits in the encoding.
+constexpr size_t kMagicOffset = 0;
+constexpr size_t kMatrixOffset = 4;
+constexpr size_t kChecksumOffset = 28;
+
+// FNV-1a over everything before the checksum.
+uint32_t Checksum(pw::span<const std::byte> data) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < kChecksumOffset; i++) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+  }
+  return hash;
+}
+
+// Returns `value` in Q16.16, or nothing if it doesn't fit.
+std::optional<int32_t> ToFixed(double value) {
+  const double fixed = std::round(value * TouchCalibration::kOne);
+  if (!(std::abs(fixed) <= std::numeric_limits<int32_t>::max())) {
+    return std::nullopt;
+  }
+  return static_cast<int32_t>(fixed);
+}
+
+}  // namespace
+
+pw::Result<TouchCalibration> TouchCalibration::FromPoints(
+    pw::span<const CalibrationPoint> points) {
+  if (points.size() < 3) {
+    return pw::Status::InvalidArgument();
+  }
+
+  // Fit each screen axis as a plane over the panel's x and y. Working about
+  // the means leaves a 2x2 system for the slopes.
+  double mean_x = 0;
+  double mean_y = 0;
+  double mean_u = 0;
+  double mean_v = 0;
+  for (const CalibrationPoint& point : points) {
+    mean_x += point.panel.x;
+    mean_y += point.panel.y;
+    mean_u += point.screen.x;
+    mean_v += point.screen.y;
+  }
+  const double n = static_cast<double>(points.size());
+  mean_x /= n;
+  mean_y /= n;
+  mean_u /= n;
+  mean_v /= n;
+
+  double sxx = 0;
+  double sxy = 0;
+  double syy = 0;
+  double sxu = 0;
+  double syu = 0;
+  double sxv = 0;
+  double syv = 0;
+  for (const CalibrationPoint& point : points) {
+    const double x = point.panel.x - mean_x;
+    const double y = point.panel.y - mean_y;
+    const double u = point.screen.x - mean_u;
+    const double v = point.screen.y - mean_v;
+    sxx += x * x;
+    sxy += x * y;
+    syy += y * y;
+    sxu += x * u;
+    syu += y * u;
+    sxv += x * v;
+    syv += y * v;
+  }
+
+  // Zero, or close enough to it to be noise, when the points are on a line.
+  const double det = sxx * syy - sxy * sxy;
+  if (!(det > 1e-6 * sxx * syy)) {
+    return pw::Status::InvalidArgument();
+  }
+
+  const double a = (syy * sxu - sxy * syu) / det;
+  const double b = (sxx * syu - sxy * sxu) / det;
+  const double d = (syy * sxv - sxy * syv) / det;
+  const double e = (sxx * syv - sxy * sxv) / det;
+  const double c = mean_u - a * mean_x - b * mean_y;
+  const double f = mean_v - d * mean_x - e * mean_y;
+
+  Matrix matrix;
+  for (auto [field, value] : {std::pair{&matrix.a, a},
+                              std::pair{&matrix.b, b},
+                              std::pair{&matrix.c, c},
+                              std::pair{&matrix.d, d},
+                              std::pair{&matrix.e, e},
+                              std::pair{&matrix.f, f}}) {
+    std::optional<int32_t> fixed = ToFixed(value);
+    if (!fixed.has_value()) {
+      return pw::Status::InvalidArgument();
+    }
+    *field = *fixed;
+  }
+  return TouchCalibration(matrix);
+}
+
+void TouchCalibration::Encode(pw::span<std::byte, kEncodedSize> out) const {
+  const std::array<int32_t, 6> fields = {
+      matrix_.a, matrix_.b, matrix_.c, matrix_.d, matrix_.e, matrix_.f};
+  pw::bytes::CopyInOrder(pw::endian::little, kMagic, &out[kMagicOffset]);
+  for (size_t i = 0; i < fields.size(); i++) {
+    pw::bytes::CopyInOrder(
+        pw::endian::little, fields[i], &out[kMatrixOffset + i * 4]);
+  }
+  pw::bytes::CopyInOrder(
+      pw::endian::little, Checksum(out), &out[kChecksumOffset]);
+}
+
+pw::Result<TouchCalibration> TouchCalibration::Decode(
+    pw::span<const std::byte> data) {
+  if (data.size() < kEncodedSize ||
+      pw::bytes::ReadInOrder<uint32_t>(pw::endian::little,
+                                       &data[kMagicOffset]) != kMagic) {
+    return pw::Status::NotFound();
+  }
+  if (pw::bytes::ReadInOrder<uint32_t>(pw::endian::little,
+                                       &data[kChecksumOffset]) !=
+      Checksum(data)) {
+    return pw::Status::DataLoss();
+  }
+
+  std::array<int32_t, 6> fields;
+  for (size_t i = 0; i < fields.size(); i++) {
+    fields[i] = pw::bytes::ReadInOrder<int32_t>(pw::endian::little,
+                                                &data[kMatrixOffset + i * 4]);
+  }
+  return TouchCalibration(Matrix{
+      .a = fields[0],
+      .b = fields[1],
+      .c = fields[2],
+      .d = fields[3],
+      .e = fields[4],
+      .f = fields[5],
+  });
+}
+
+TouchCalibrator::TouchCalibrator(pw::geometry::Size<int> screen) {
+  // An eighth of the way in, so the targets are easy to hit.
+  const int left = screen.width / 8;
+  const int right = screen.width - left;
+  const int top = screen.height / 8;
+  const int bottom = screen.height - top;
+  const std::array<pw::geometry::Vector2<int>, kNumTargets> targets = {{
+      {left, top},
+      {right, top},
+      {right, bottom},
+      {left, bottom},
+      {screen.width / 2, screen.height / 2},
+  }};
+  for (size_t i = 0; i < kNumTargets; i++) {
+    points_[i] = {.panel = {0, 0}, .screen = targets[i]};
+  }
+}
+
+std::optional<pw::geometry::Vector2<int>> TouchCalibrator::target() const {
+  if (count_ == kNumTargets) {
+    return std::nullopt;
+  }
+  return points_[count_].screen;
+}
+
+void TouchCalibrator::AddSample(pw::geometry::Vector2<int> panel) {
+  if (count_ == kNumTargets) {
+    return;
+  }
+  points_[count_++].panel = panel;
+}
+
+pw::Result<TouchCalibration> TouchCalibrator::Finish() const {
+  if (count_ < kNumTargets) {
+    return pw::Status::FailedPrecondition();
+  }
+  return TouchCalibration::FromPoints(points_);
+}
+
+}  // namespace kudzu
@@ -0,0 +1,148 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/touch_calibration.h"
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+
+namespace kudzu {
+namespace {
+
+using pw::geometry::Vector2;
+using Rotation = TouchCalibration::Rotation;
+
+void ExpectPoint(Vector2<int> actual, int x, int y) {
+  EXPECT_EQ(actual.x, x);
+  EXPECT_EQ(actual.y, y);
+}
+
+TEST(TouchCalibrationTest, DefaultIsIdentity) {
+  constexpr TouchCalibration calibration;
+  ExpectPoint(calibration.Apply({123, 45}), 123, 45);
+}
+
+TEST(TouchCalibrationTest, RotationMatchesBadgeMapping) {
+  // The badge's 240x320 panel, turned and halved onto a 160x120 framebuffer.
+  constexpr TouchCalibration calibration =
+      TouchCalibration::FromRotation(Rotation::k90, {240, 320}, {160, 120});
+  for (int x = 0; x < 240; x += 7) {
+    for (int y = 0; y < 320; y += 11) {
+      // The float mapping this replaces, which rounds halves up too.
+      const int expected_x = static_cast<int>(y / 320.0 * 160.0 + 0.5);
+      const int expected_y = static_cast<int>((240 - x) / 240.0 * 120.0 + 0.5);
+      ExpectPoint(calibration.Apply({x, y}), expected_x, expected_y);
+    }
+  }
+}
+
+TEST(TouchCalibrationTest, EachRotationMapsCorners) {
+  constexpr pw::geometry::Size<int> kPanel = {100, 200};
+  constexpr pw::geometry::Size<int> kScreen = {200, 100};
+  ExpectPoint(TouchCalibration::FromRotation(Rotation::k0, kPanel, kScreen)
+                  .Apply({100, 0}),
+              200,
+              0);
+  ExpectPoint(TouchCalibration::FromRotation(Rotation::k90, kPanel, kScreen)
+                  .Apply({100, 0}),
+              0,
+              0);
+  ExpectPoint(TouchCalibration::FromRotation(Rotation::k180, kPanel, kScreen)
+                  .Apply({100, 0}),
+              0,
+              100);
+  ExpectPoint(TouchCalibration::FromRotation(Rotation::k270, kPanel, kScreen)
+                  .Apply({100, 0}),
+              200,
+              100);
+}
+
+TEST(TouchCalibrationTest, FitRecoversAffineMapping) {
+  // A skewed, offset panel.
+  auto truth = [](int x, int y) {
+    return Vector2<int>{x / 2 + y / 10 + 5, -x / 4 + y / 2 + 30};
+  };
+  std::array<CalibrationPoint, 4> points;
+  const std::array<Vector2<int>, 4> panel = {{
+      {20, 40},
+      {200, 40},
+      {200, 280},
+      {20, 280},
+  }};
+  for (size_t i = 0; i < points.size(); i++) {
+    points[i] = {.panel = panel[i], .screen = truth(panel[i].x, panel[i].y)};
+  }
+
+  pw::Result<TouchCalibration> calibration =
+      TouchCalibration::FromPoints(points);
+  ASSERT_TRUE(calibration.ok());
+  for (const Vector2<int>& point : panel) {
+    const Vector2<int> expected = truth(point.x, point.y);
+    ExpectPoint(calibration->Apply(point), expected.x, expected.y);
+  }
+  ExpectPoint(calibration->Apply({100, 100}), 65, 55);
+}
+
+TEST(TouchCalibrationTest, FitRejectsPointsOnALine) {
+  const std::array<CalibrationPoint, 3> points = {{
+      {.panel = {0, 0}, .screen = {0, 0}},
+      {.panel = {10, 10}, .screen = {5, 5}},
+      {.panel = {20, 20}, .screen = {10, 10}},
+  }};
+  EXPECT_EQ(TouchCalibration::FromPoints(points).status(),
+            pw::Status::InvalidArgument());
+  EXPECT_EQ(TouchCalibration::FromPoints(pw::span(points).first(2)).status(),
+            pw::Status::InvalidArgument());
+}
+
+TEST(TouchCalibrationTest, EncodeRoundTrips) {
+  const TouchCalibration calibration(TouchCalibration::Matrix{
+      .a = 1, .b = -2, .c = 3, .d = -4, .e = 5, .f = -6});
+  std::array<std::byte, TouchCalibration::kEncodedSize> data;
+  calibration.Encode(data);
+
+  pw::Result<TouchCalibration> decoded = TouchCalibration::Decode(data);
+  ASSERT_TRUE(decoded.ok());
+  EXPECT_EQ(decoded->matrix().b, -2);
+  EXPECT_EQ(decoded->matrix().f, -6);
+
+  data[10] ^= std::byte{1};
+  EXPECT_EQ(TouchCalibration::Decode(data).status(), pw::Status::DataLoss());
+
+  // Erased flash.
+  data.fill(std::byte{0xff});
+  EXPECT_EQ(TouchCalibration::Decode(data).status(), pw::Status::NotFound());
+}
+
+TEST(TouchCalibratorTest, FitsAfterEveryTarget) {
+  TouchCalibrator calibrator({160, 120});
+  EXPECT_EQ(calibrator.Finish().status(), pw::Status::FailedPrecondition());
+
+  // A panel reading twice the screen's coordinates, shifted by 8.
+  size_t targets = 0;
+  while (std::optional<Vector2<int>> target = calibrator.target()) {
+    calibrator.AddSample({target->x * 2 + 8, target->y * 2 + 8});
+    targets++;
+  }
+  EXPECT_EQ(targets, TouchCalibrator::kNumTargets);
+
+  pw::Result<TouchCalibration> calibration = calibrator.Finish();
+  ASSERT_TRUE(calibration.ok());
+  ExpectPoint(calibration->Apply({108, 48}), 50, 20);
+}
+
+}  // namespace
+}  // namespace kudzu
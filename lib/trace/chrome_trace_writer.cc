@@ -0,0 +1,91 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/chrome_trace_writer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace kudzu::trace {
+namespace {
+
+constexpr int64_t kFlushIntervalUs = 1'000'000;
+
+}  // namespace
+
+ChromeTraceWriter::ChromeTraceWriter(std::FILE* file) : file_(file) {
+  std::lock_guard lock(lock_);
+  std::fputs(
+      "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+      "\"args\":{\"name\":\"Kudzu\"}}",
+      file_);
+}
+
+void ChromeTraceWriter::Complete(const char* category,
+                                 const char* name,
+                                 int64_t start_us,
+                                 int64_t duration_us) {
+  std::lock_guard lock(lock_);
+  const int tid = ThreadId();
+  std::fputs(",\n{\"name\":", file_);
+  WriteString(name);
+  std::fputs(",\"cat\":", file_);
+  WriteString(category);
+  std::fprintf(file_,
+               ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%" PRId64
+               ",\"dur\":%" PRId64 "}",
+               tid,
+               start_us,
+               duration_us);
+  if (start_us - last_flush_us_ >= kFlushIntervalUs) {
+    std::fflush(file_);
+    last_flush_us_ = start_us;
+  }
+}
+
+void ChromeTraceWriter::Flush() {
+  std::lock_guard lock(lock_);
+  std::fflush(file_);
+}
+
+int ChromeTraceWriter::ThreadId() {
+  const std::thread::id id = std::this_thread::get_id();
+  auto it = std::find(threads_.begin(), threads_.end(), id);
+  if (it == threads_.end()) {
+    threads_.push_back(id);
+    it = threads_.end() - 1;
+  }
+  return static_cast<int>(it - threads_.begin()) + 1;
+}
+
+void ChromeTraceWriter::WriteString(const char* string) {
+  std::fputc('"', file_);
+  for (const char* c = string; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      std::fputc('\\', file_);
+      std::fputc(*c, file_);
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      std::fprintf(file_, "\\u%04x", static_cast<unsigned>(*c));
+    } else {
+      std::fputc(*c, file_);
+    }
+  }
+  std::fputc('"', file_);
+}
+
+}  // namespace kudzu::trace
@@ -0,0 +1,79 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/chrome_trace_writer.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using kudzu::trace::ChromeTraceWriter;
+
+class ChromeTraceWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override { file_ = std::tmpfile(); }
+  void TearDown() override { std::fclose(file_); }
+
+  std::string Contents() {
+    std::fflush(file_);
+    std::rewind(file_);
+    std::string contents;
+    char buffer[256];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file_)) > 0) {
+      contents.append(buffer, read);
+    }
+    return contents;
+  }
+
+  std::FILE* file_;
+};
+
+TEST_F(ChromeTraceWriterTest, WritesCompleteEvents) {
+  ChromeTraceWriter writer(file_);
+  writer.Complete("frame", "draw", 1000, 250);
+
+  const std::string contents = Contents();
+  EXPECT_EQ(contents.front(), '[');
+  EXPECT_NE(contents.find("{\"name\":\"draw\",\"cat\":\"frame\",\"ph\":\"X\","
+                          "\"pid\":1,\"tid\":1,\"ts\":1000,\"dur\":250}"),
+            std::string::npos);
+}
+
+TEST_F(ChromeTraceWriterTest, EscapesNames) {
+  ChromeTraceWriter writer(file_);
+  writer.Complete("lock", "a \"b\"\\c\n", 0, 0);
+
+  EXPECT_NE(Contents().find("\"name\":\"a \\\"b\\\"\\\\c\\u000a\""),
+            std::string::npos);
+}
+
+TEST_F(ChromeTraceWriterTest, NumbersThreadsInOrder) {
+  ChromeTraceWriter writer(file_);
+  writer.Complete("frame", "main", 0, 1);
+  std::thread([&writer] { writer.Complete("frame", "other", 1, 1); }).join();
+  writer.Complete("frame", "main", 2, 1);
+
+  const std::string contents = Contents();
+  EXPECT_NE(contents.find("\"name\":\"other\",\"cat\":\"frame\",\"ph\":\"X\","
+                          "\"pid\":1,\"tid\":2"),
+            std::string::npos);
+  EXPECT_EQ(contents.find("\"tid\":3"), std::string::npos);
+}
+
+}  // namespace
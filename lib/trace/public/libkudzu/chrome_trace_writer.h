@@ -0,0 +1,60 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "libkudzu/trace.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace kudzu::trace {
+
+/// Writes events to a file in Chrome's trace event JSON format, which
+/// chrome://tracing and ui.perfetto.dev can open. Each thread gets its own
+/// track, numbered in the order the threads first record an event.
+///
+/// Events are written as they arrive and the array is never closed, which
+/// both viewers accept, so the trace stays readable if the process is killed.
+/// The file is flushed about once a second.
+///
+/// For host builds; this allocates and does file IO.
+class ChromeTraceWriter final : public Sink {
+ public:
+  /// Writes to `file`, which must stay open for the writer's lifetime.
+  explicit ChromeTraceWriter(std::FILE* file);
+
+  void Complete(const char* category,
+                const char* name,
+                int64_t start_us,
+                int64_t duration_us) override;
+
+  void Flush();
+
+ private:
+  int ThreadId() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void WriteString(const char* string) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  pw::sync::Mutex lock_;
+  std::FILE* const file_ PW_GUARDED_BY(lock_);
+  // A thread's track number is its index plus one.
+  std::vector<std::thread::id> threads_ PW_GUARDED_BY(lock_);
+  int64_t last_flush_us_ PW_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace kudzu::trace
@@ -0,0 +1,104 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "pw_sync/lock_annotations.h"
+
+namespace kudzu::trace {
+
+/// Receives trace events. Tracing is off until a sink is installed with
+/// `SetSink()`, so instrumented code only pays for a load and a branch.
+///
+/// Sinks are called from any thread and must be thread safe.
+class Sink {
+ public:
+  virtual ~Sink() = default;
+
+  /// The calling thread spent `duration_us` in `name`, starting at
+  /// `start_us` on the `NowMicros()` clock. `category` and `name` must
+  /// outlive the sink, e.g. string literals.
+  virtual void Complete(const char* category,
+                        const char* name,
+                        int64_t start_us,
+                        int64_t duration_us) = 0;
+};
+
+/// Install `sink`, or turn tracing off with nullptr. The sink must outlive
+/// any events in flight.
+void SetSink(Sink* sink);
+
+/// Returns the installed sink, or nullptr when tracing is off.
+Sink* GetSink();
+
+/// Microseconds on the system clock, which is what events are timed with.
+int64_t NowMicros();
+
+/// Records the time between its construction and destruction as an event.
+class Scope {
+ public:
+  Scope(const char* category, const char* name)
+      : sink_(GetSink()),
+        category_(category),
+        name_(name),
+        start_us_(sink_ != nullptr ? NowMicros() : 0) {}
+
+  ~Scope() {
+    if (sink_ != nullptr) {
+      sink_->Complete(category_, name_, start_us_, NowMicros() - start_us_);
+    }
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  Sink* const sink_;
+  const char* const category_;
+  const char* const name_;
+  const int64_t start_us_;
+};
+
+/// A `std::lock_guard` which records time spent waiting for a contended lock
+/// as a "lock" event named `name`. Uncontended locks record nothing.
+template <typename Lockable>
+class PW_SCOPED_LOCKABLE LockGuard {
+ public:
+  LockGuard(Lockable& lock, const char* name) PW_EXCLUSIVE_LOCK_FUNCTION(lock)
+      : lock_(lock) {
+    Sink* sink = GetSink();
+    if (sink == nullptr) {
+      lock_.lock();
+      return;
+    }
+    if (lock_.try_lock()) {
+      return;
+    }
+    const int64_t start_us = NowMicros();
+    lock_.lock();
+    sink->Complete("lock", name, start_us, NowMicros() - start_us);
+  }
+
+  ~LockGuard() PW_UNLOCK_FUNCTION() { lock_.unlock(); }
+
+  LockGuard(const LockGuard&) = delete;
+  LockGuard& operator=(const LockGuard&) = delete;
+
+ private:
+  Lockable& lock_;
+};
+
+}  // namespace kudzu::trace
@@ -0,0 +1,40 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+
+namespace kudzu::trace {
+namespace {
+
+std::atomic<Sink*> s_sink = nullptr;
+
+}  // namespace
+
+void SetSink(Sink* sink) { s_sink.store(sink); }
+
+Sink* GetSink() { return s_sink.load(std::memory_order_relaxed); }
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             pw::chrono::SystemClock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace kudzu::trace
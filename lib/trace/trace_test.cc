@@ -0,0 +1,95 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "libkudzu/trace.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_sync/mutex.h"
+
+namespace {
+
+using kudzu::trace::LockGuard;
+using kudzu::trace::Scope;
+using kudzu::trace::SetSink;
+using kudzu::trace::Sink;
+
+struct Event {
+  std::string_view category;
+  std::string_view name;
+  int64_t duration_us;
+};
+
+class RecordingSink : public Sink {
+ public:
+  void Complete(const char* category,
+                const char* name,
+                int64_t,
+                int64_t duration_us) override {
+    events.push_back({category, name, duration_us});
+  }
+
+  std::vector<Event> events;
+};
+
+class TraceTest : public ::testing::Test {
+ protected:
+  void TearDown() override { SetSink(nullptr); }
+
+  RecordingSink sink_;
+};
+
+TEST_F(TraceTest, ScopeRecordsNothingWhenOff) {
+  { Scope scope("frame", "draw"); }
+  SetSink(&sink_);
+  EXPECT_TRUE(sink_.events.empty());
+}
+
+TEST_F(TraceTest, ScopeRecordsEvent) {
+  SetSink(&sink_);
+  { Scope scope("frame", "draw"); }
+  ASSERT_EQ(sink_.events.size(), 1u);
+  EXPECT_EQ(sink_.events[0].category, "frame");
+  EXPECT_EQ(sink_.events[0].name, "draw");
+  EXPECT_GE(sink_.events[0].duration_us, 0);
+}
+
+TEST_F(TraceTest, UncontendedLockRecordsNothing) {
+  SetSink(&sink_);
+  pw::sync::Mutex mutex;
+  { LockGuard lock(mutex, "mutex"); }
+  EXPECT_TRUE(sink_.events.empty());
+}
+
+TEST_F(TraceTest, ContendedLockRecordsWait) {
+  SetSink(&sink_);
+  pw::sync::Mutex mutex;
+  mutex.lock();
+  std::thread waiter([&mutex] { LockGuard lock(mutex, "mutex"); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  mutex.unlock();
+  waiter.join();
+
+  ASSERT_EQ(sink_.events.size(), 1u);
+  EXPECT_EQ(sink_.events[0].category, "lock");
+  EXPECT_EQ(sink_.events[0].name, "mutex");
+  EXPECT_GT(sink_.events[0].duration_us, 0);
+}
+
+}  // namespace
@@ -15,13 +15,40 @@
 #define PW_LOG_MODULE_NAME "SYS"
 
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 
+#include "libkudzu/chrome_trace_writer.h"
+#include "libkudzu/trace.h"
 #include "pw_log/log.h"
 #include "pw_system/init.h"
 #include "pw_thread/sleep.h"
 
+namespace {
+
+// Set KUDZU_TRACE to a file path to record frame phases, timing scopes, lock
+// waits and simulated bus reads there as a Chrome trace. Open it with
+// chrome://tracing or ui.perfetto.dev.
+void StartTracing() {
+  const char* path = std::getenv("KUDZU_TRACE");
+  if (path == nullptr || path[0] == '\0') {
+    return;
+  }
+  std::FILE* file = std::fopen(path, "w");
+  if (file == nullptr) {
+    PW_LOG_ERROR("Can't open %s for tracing", path);
+    return;
+  }
+  static kudzu::trace::ChromeTraceWriter writer(file);
+  kudzu::trace::SetSink(&writer);
+  PW_LOG_INFO("Tracing to %s", path);
+}
+
+}  // namespace
+
 extern "C" int main() {
   pw::system::Init();
+  StartTracing();
   // Sleep loop rather than return on this thread so the process isn't closed.
   while (true) {
     pw::this_thread::sleep_for(std::chrono::seconds(10));
@@ -57,10 +57,22 @@
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
-#define configGENERATE_RUN_TIME_STATS           0
-#define configUSE_TRACE_FACILITY                0
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
+// Run-time stats count microseconds on the RP2040's 1 MHz timer. See boot.cc.
+#ifdef __cplusplus
+extern "C" {
+#endif
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+#ifdef __cplusplus
+}
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() configureTimerForRunTimeStats()
+#define portGET_RUN_TIME_COUNTER_VALUE()        getRunTimeCounterValue()
+
 #define configUSE_CO_ROUTINES                   0
 #define configMAX_CO_ROUTINE_PRIORITIES         1
 
@@ -0,0 +1,269 @@
+# Copyright 2024 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Generate a kudzu::AaFont header from a TrueType font.
+
+Each glyph is rendered with FreeType through Pillow, quantized to 2 or 4 bits
+of coverage per pixel and packed into a single atlas. Advance widths and
+kerning pairs come from the font itself; kerning is read through FreeType, so
+fonts which only kern through GPOS need a Pillow built with libraqm.
+
+Usage:
+
+.. code-block:: bash
+
+   python -m kudzu_tools.aa_font --size 12 --bits-per-pixel 4 \\
+       --name kSans12 --output sans_12.h
+"""
+
+import argparse
+from pathlib import Path
+import sys
+from typing import List, NamedTuple, Optional, Tuple
+
+from PIL import Image, ImageDraw, ImageFont
+
+_HEADER = """\
+// Generated by kudzu_tools.aa_font from {source}. Do not edit.
+#pragma once
+
+#include <cstdint>
+
+#include "libkudzu/aa_font.h"
+
+namespace {namespace} {{
+"""
+
+
+class Glyph(NamedTuple):
+    offset: int
+    width: int
+    height: int
+    x_offset: int
+    y_offset: int
+    advance: int
+
+
+def _clamp(value: int, low: int, high: int) -> int:
+    return max(low, min(high, value))
+
+
+def _load_font(
+    font_path: Optional[Path], size: int
+) -> ImageFont.FreeTypeFont:
+    if font_path is None:
+        # Pillow's bundled scalable font.
+        return ImageFont.load_default(size=size)
+    return ImageFont.truetype(str(font_path), size)
+
+
+def _pack_rows(
+    image: Image.Image, bits_per_pixel: int
+) -> Tuple[List[int], bool]:
+    """Quantize and pack an 'L' image. Returns the bytes and whether any
+    pixel had coverage."""
+    max_level = (1 << bits_per_pixel) - 1
+    pixels_per_byte = 8 // bits_per_pixel
+    width, height = image.size
+    data = image.load()
+    packed: List[int] = []
+    covered = False
+    for y in range(height):
+        row_bytes = [0] * ((width + pixels_per_byte - 1) // pixels_per_byte)
+        for x in range(width):
+            level = (data[x, y] * max_level + 127) // 255
+            if level:
+                covered = True
+            shift = 8 - bits_per_pixel * (x % pixels_per_byte + 1)
+            row_bytes[x // pixels_per_byte] |= level << shift
+        packed.extend(row_bytes)
+    return packed, covered
+
+
+def _render_glyphs(
+    font: ImageFont.FreeTypeFont,
+    chars: str,
+    bits_per_pixel: int,
+) -> Tuple[List[Glyph], List[int]]:
+    glyphs: List[Glyph] = []
+    atlas: List[int] = []
+    for char in chars:
+        advance = _clamp(round(font.getlength(char)), 0, 255)
+        left, top, right, bottom = font.getbbox(char)
+        width = right - left
+        height = bottom - top
+        packed: List[int] = []
+        covered = False
+        if width and height:
+            image = Image.new('L', (width, height), 0)
+            ImageDraw.Draw(image).text((-left, -top), char, font=font, fill=255)
+            # The layout box is looser than the ink; crop to save atlas space.
+            ink = image.getbbox()
+            if ink is not None:
+                image = image.crop(ink)
+                left += ink[0]
+                top += ink[1]
+                packed, covered = _pack_rows(image, bits_per_pixel)
+        if not covered:
+            # Whitespace only needs an advance.
+            glyphs.append(Glyph(len(atlas), 0, 0, 0, 0, advance))
+            continue
+        if image.width > 255 or image.height > 255:
+            raise ValueError(f'Glyph {char!r} is larger than 255 pixels')
+        glyphs.append(
+            Glyph(
+                len(atlas),
+                image.width,
+                image.height,
+                _clamp(left, -128, 127),
+                _clamp(top, -128, 127),
+                advance,
+            )
+        )
+        atlas.extend(packed)
+    return glyphs, atlas
+
+
+def _kerning_pairs(
+    font: ImageFont.FreeTypeFont, chars: str
+) -> List[Tuple[str, str, int]]:
+    advances = {char: font.getlength(char) for char in chars}
+    pairs = []
+    for left in chars:
+        for right in chars:
+            adjust = round(
+                font.getlength(left + right) - advances[left] - advances[right]
+            )
+            if adjust:
+                pairs.append((left, right, _clamp(adjust, -128, 127)))
+    return pairs
+
+
+def _char_literal(char: str) -> str:
+    if char in ('\\', "'"):
+        return f"'\\{char}'"
+    return f"'{char}'"
+
+
+def _format_bytes(data: List[int]) -> str:
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(
+            '    ' + ' '.join(f'0x{byte:02x},' for byte in data[i : i + 12])
+        )
+    return '\n'.join(lines)
+
+
+def generate(
+    font_path: Optional[Path],
+    size: int,
+    bits_per_pixel: int,
+    name: str,
+    namespace: str,
+    first_char: int,
+    last_char: int,
+) -> str:
+    """Returns the contents of a header defining the font `name`."""
+    font = _load_font(font_path, size)
+    chars = ''.join(chr(c) for c in range(first_char, last_char + 1))
+    glyphs, atlas = _render_glyphs(font, chars, bits_per_pixel)
+    kerning = _kerning_pairs(font, chars)
+    ascent, descent = font.getmetrics()
+
+    source = font_path.name if font_path else 'the Pillow default font'
+    out = [_HEADER.format(source=source, namespace=namespace)]
+
+    out.append(f'inline constexpr uint8_t {name}Atlas[] = {{')
+    out.append(_format_bytes(atlas if atlas else [0]))
+    out.append('};\n')
+
+    out.append(f'inline constexpr kudzu::AaGlyph {name}Glyphs[] = {{')
+    for char, glyph in zip(chars, glyphs):
+        out.append(
+            f'    {{{glyph.offset}, {glyph.width}, {glyph.height}, '
+            f'{glyph.x_offset}, {glyph.y_offset}, {glyph.advance}}},'
+            f'  // {char!r}'
+        )
+    out.append('};\n')
+
+    kerning_span = 'pw::span<const kudzu::AaKerningPair>()'
+    if kerning:
+        out.append(
+            f'inline constexpr kudzu::AaKerningPair {name}Kerning[] = {{'
+        )
+        for left, right, adjust in kerning:
+            out.append(
+                f'    {{{_char_literal(left)}, {_char_literal(right)}, '
+                f'{adjust}}},'
+            )
+        out.append('};\n')
+        kerning_span = f'{name}Kerning'
+
+    out.append(f'inline constexpr kudzu::AaFont {name} = {{')
+    out.append(f'    .bits_per_pixel = {bits_per_pixel},')
+    out.append(f'    .line_height = {_clamp(ascent + descent, 0, 255)},')
+    out.append(f'    .ascent = {_clamp(ascent, 0, 255)},')
+    out.append(f'    .first_char = {_char_literal(chars[0])},')
+    out.append(f'    .last_char = {_char_literal(chars[-1])},')
+    out.append(f'    .glyphs = {name}Glyphs,')
+    out.append(f'    .atlas = {name}Atlas,')
+    out.append(f'    .kerning = {kerning_span},')
+    out.append('};\n')
+
+    out.append(f'}}  // namespace {namespace}\n')
+    return '\n'.join(out)
+
+
+def _parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        '--font',
+        type=Path,
+        help='TrueType or OpenType font file. Defaults to the font bundled '
+        'with Pillow.',
+    )
+    parser.add_argument('--size', type=int, required=True, help='Pixel size')
+    parser.add_argument(
+        '--bits-per-pixel', type=int, choices=(2, 4), default=4
+    )
+    parser.add_argument(
+        '--name', required=True, help='C++ name of the AaFont constant'
+    )
+    parser.add_argument('--namespace', default='kudzu::fonts')
+    parser.add_argument('--first-char', type=int, default=0x20)
+    parser.add_argument('--last-char', type=int, default=0x7E)
+    parser.add_argument('--output', type=Path, required=True)
+    return parser.parse_args()
+
+
+def main() -> int:
+    args = _parse_args()
+    if not 0x20 <= args.first_char <= args.last_char <= 0x7E:
+        print('Only printable ASCII is supported', file=sys.stderr)
+        return 1
+    header = generate(
+        args.font,
+        args.size,
+        args.bits_per_pixel,
+        args.name,
+        args.namespace,
+        args.first_char,
+        args.last_char,
+    )
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_text(header)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
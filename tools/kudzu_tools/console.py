@@ -11,17 +11,210 @@
 # WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 # License for the specific language governing permissions and limitations under
 # the License.
-"""Wraps pw_system's console to inject additional RPC protos."""
+"""Wraps pw_system's console to inject additional RPC protos.
+
+Device telemetry can be watched live from the console's Python REPL:
+
+.. code-block:: python
+
+   from kudzu_tools.console import stream_telemetry
+   call = stream_telemetry(device, interval_ms=500, samples_per_batch=2)
+   # Each sample is logged on the kudzu.telemetry logger. To stop:
+   call.cancel()
+
+Per-task CPU use since the last check can be logged with
+``log_cpu_usage(device)``, frames which went over the app's budget with
+``log_frame_overruns(device)``, each I2C device's bus use with
+``log_i2c_stats(device)`` and each peripheral's health with
+``log_device_health(device)``.
+"""
 
 import argparse
+import logging
 import sys
-from typing import Optional
+from typing import Any, Optional
 
 from pw_protobuf_protos import common_pb2
 import pw_system.console
 from kudzu import kudzu_pb2
 from pw_rpc import echo_pb2
 
+_TELEMETRY_LOG = logging.getLogger('kudzu.telemetry')
+
+
+def format_telemetry_sample(sample: Any) -> str:
+    """Formats a kudzu.rpc.TelemetrySample as a single line."""
+    parts = [f'up {sample.uptime_ms / 1000:.1f}s']
+    if sample.frames_per_second:
+        parts.append(
+            f'{sample.frames_per_second} fps '
+            f'p50 {sample.frame_p50_us / 1000:.1f} '
+            f'p95 {sample.frame_p95_us / 1000:.1f} '
+            f'p99 {sample.frame_p99_us / 1000:.1f} '
+            f'max {sample.frame_max_us / 1000:.1f} ms'
+        )
+    parts.append(
+        f'heap {sample.heap_used_bytes / 1024:.1f}'
+        f'/{sample.heap_high_water_bytes / 1024:.1f} KiB'
+    )
+    if sample.HasField('battery_millivolts'):
+        parts.append(
+            f'battery {sample.battery_millivolts} mV '
+            f'{sample.battery_percent}%'
+        )
+    parts.append(f'{sample.package_temp:.1f} C')
+
+    tasks = []
+    for task in sample.tasks:
+        cpu = (
+            f' {task.cpu_permille / 10:.1f}%'
+            if task.HasField('cpu_permille')
+            else ''
+        )
+        tasks.append(f'{task.name}{cpu} {task.stack_high_water_bytes}B free')
+    if tasks:
+        parts.append(', '.join(tasks))
+    return ' | '.join(parts)
+
+
+def stream_telemetry(
+    device: Any, interval_ms: int = 1000, samples_per_batch: int = 1
+) -> Any:
+    """Starts streaming telemetry from a pw_system device.
+
+    Each sample is logged on the kudzu.telemetry logger as it arrives. Returns
+    the RPC call; cancel it to stop the stream.
+    """
+    rpc = device.rpcs.kudzu.rpc.Kudzu.StreamTelemetry
+
+    def on_next(_call: Any, batch: Any) -> None:
+        for sample in batch.samples:
+            _TELEMETRY_LOG.info('%s', format_telemetry_sample(sample))
+
+    def on_error(_call: Any, error: Any) -> None:
+        _TELEMETRY_LOG.error('Telemetry stream failed: %s', error)
+
+    return rpc.invoke(
+        kudzu_pb2.TelemetryRequest(
+            interval_ms=interval_ms, samples_per_batch=samples_per_batch
+        ),
+        on_next=on_next,
+        on_error=on_error,
+    )
+
+
+def log_cpu_usage(device: Any) -> None:
+    """Logs each task's share of the CPU since the previous call."""
+    status, response = device.rpcs.kudzu.rpc.Kudzu.CpuUsage()
+    if not status.ok():
+        _TELEMETRY_LOG.error('CpuUsage failed: %s', status)
+        return
+    _TELEMETRY_LOG.info(
+        'CPU use over the last %.1fs', response.interval_us / 1_000_000
+    )
+    for task in sorted(response.tasks, key=lambda t: -t.run_time_us):
+        _TELEMETRY_LOG.info(
+            '%-16s %5.1f%% %9d us %6d B stack free',
+            task.name,
+            task.cpu_permille / 10,
+            task.run_time_us,
+            task.stack_high_water_bytes,
+        )
+
+
+_TASK_STATES = ('running', 'ready', 'blocked', 'suspended', 'deleted')
+
+
+def log_frame_overruns(device: Any, clear: bool = False) -> None:
+    """Logs the frames which went over budget, optionally emptying the log."""
+    status, overruns = device.rpcs.kudzu.rpc.Kudzu.FrameOverruns(clear=clear)
+    if not status.ok():
+        _TELEMETRY_LOG.error('FrameOverruns failed: %s', status)
+        return
+    if not overruns:
+        _TELEMETRY_LOG.info('No frame overruns')
+    for overrun in overruns:
+        when = f'{overrun.uptime_ms / 1000:.1f}s'
+        if overrun.boots_ago:
+            when += f', {overrun.boots_ago} resets ago'
+        _TELEMETRY_LOG.info(
+            '#%d at %s: %d us of %d (acquire %d, draw %d, flush %d) I2C %s',
+            overrun.sequence,
+            when,
+            overrun.frame_us,
+            overrun.budget_us,
+            overrun.acquire_us,
+            overrun.draw_us,
+            overrun.flush_us,
+            '/'.join(str(count) for count in overrun.i2c_transactions),
+        )
+        for task in overrun.tasks:
+            state = (
+                _TASK_STATES[task.state]
+                if task.state < len(_TASK_STATES)
+                else str(task.state)
+            )
+            _TELEMETRY_LOG.info(
+                '  %-12s %-9s pri %d %6d B stack free',
+                task.name,
+                state,
+                task.priority,
+                task.stack_high_water_bytes,
+            )
+
+
+def log_i2c_stats(device: Any, reset: bool = False) -> None:
+    """Logs each I2C device's bus use, optionally starting a new window."""
+    status, response = device.rpcs.kudzu.rpc.Kudzu.I2cStats(reset=reset)
+    if not status.ok():
+        _TELEMETRY_LOG.error('I2cStats failed: %s', status)
+        return
+    for bus in response.buses:
+        window_us = max(bus.window_ms * 1000, 1)
+        _TELEMETRY_LOG.info('%s over the last %.1fs', bus.name, window_us / 1e6)
+        for dev in bus.devices:
+            _TELEMETRY_LOG.info(
+                '  0x%02x %6d tx %5.1f%% busy, us p50 %d p95 %d p99 %d max %d, '
+                '%d NACKs %d timeouts %d errors',
+                dev.address,
+                dev.transactions,
+                100 * dev.busy_us / window_us,
+                dev.latency_p50_us,
+                dev.latency_p95_us,
+                dev.latency_p99_us,
+                dev.latency_max_us,
+                dev.nacks,
+                dev.timeouts,
+                dev.errors,
+            )
+        if bus.untracked_transactions:
+            _TELEMETRY_LOG.info(
+                '  %d transactions to other devices',
+                bus.untracked_transactions,
+            )
+
+
+def log_device_health(device: Any) -> None:
+    """Logs each peripheral's health as of its last background probe."""
+    status, response = device.rpcs.kudzu.rpc.Kudzu.DeviceHealth()
+    if not status.ok():
+        _TELEMETRY_LOG.error('DeviceHealth failed: %s', status)
+        return
+    states = kudzu_pb2.DeviceHealthState.Enum
+    for dev in response.devices:
+        last_seen = (
+            f'seen {dev.ms_since_seen / 1000:.1f}s ago'
+            if dev.HasField('ms_since_seen')
+            else 'never seen'
+        )
+        _TELEMETRY_LOG.info(
+            '%-14s %-8s %s, %d failed probes in a row',
+            dev.name,
+            states.Name(dev.state),
+            last_seen,
+            dev.consecutive_failures,
+        )
+
 
 def main(args: Optional[argparse.Namespace] = None) -> int:
     compiled_protos = [